@@ -62,6 +62,7 @@ find %{buildroot} -name '*.la' -delete
 
 %files devel
 %{_includedir}/vmrest.h
+%{_includedir}/vmrestclient.h
 %{_lib64dir}/*.so
 
 %changelog
@@ -0,0 +1,30 @@
+/* C-REST-Engine
+*
+* Copyright (c) 2017 VMware, Inc. All Rights Reserved.
+*
+* This product is licensed to you under the Apache 2.0 license (the "License").
+* You may not use this product except in compliance with the Apache 2.0 License.
+*
+* This product may include a number of subcomponents with separate copyright
+* notices and license terms. Your use of these subcomponents is subject to the
+* terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+*
+*/
+
+/**** Receive polls ring this many times before sleeping. Budget doubles when data shows up
+      while polling and halves when it had to sleep. ****/
+#define VMREST_SHM_CLIENT_SPIN_INITIAL          256
+#define VMREST_SHM_CLIENT_SPIN_MIN              16
+#define VMREST_SHM_CLIENT_SPIN_MAX              (64 * 1024)
+
+/**** Send on full ring yields this many times, then sleeps VMREST_SHM_CLIENT_FULL_SLEEP_US ****/
+#define VMREST_SHM_CLIENT_FULL_SPINS            1000
+#define VMREST_SHM_CLIENT_FULL_SLEEP_US         1000
+
+#define VMREST_SHM_CLIENT_RESPONSE_CHUNK        4096
+
+#if defined(__x86_64__) || defined(__i386__)
+#define VMREST_SHM_CLIENT_CPU_RELAX()           __builtin_ia32_pause()
+#else
+#define VMREST_SHM_CLIENT_CPU_RELAX()           __asm__ __volatile__("" ::: "memory")
+#endif
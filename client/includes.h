@@ -14,6 +14,16 @@
 #include <config.h>
 
 #include <vmrestsys.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sched.h>
+#include <poll.h>
+#include <strings.h>
 #include <vmrestdefines.h>
 #include <vmsock.h>
 #include <vmrestcommon.h>
+#include <vmrestshm.h>
+#include <vmrestclient.h>
+#include "defines.h"
+#include "structs.h"
@@ -0,0 +1,642 @@
+/* C-REST-Engine
+*
+* Copyright (c) 2017 VMware, Inc. All Rights Reserved.
+*
+* This product is licensed to you under the Apache 2.0 license (the "License").
+* You may not use this product except in compliance with the Apache 2.0 License.
+*
+* This product may include a number of subcomponents with separate copyright
+* notices and license terms. Your use of these subcomponents is subject to the
+* terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+*
+*/
+
+#include "includes.h"
+
+static
+VOID
+VmRESTShmClientWake(
+    int                              fd
+    )
+{
+    uint64_t                         one = 1;
+
+    if (write(fd, &one, sizeof(one)) < 0)
+    {
+        /**** Server end may be gone, it is seen through bProducerClosed ****/
+    }
+}
+
+static
+uint32_t
+VmRESTShmClientReceiveHello(
+    int                              sock,
+    PVMREST_SHM_HELLO                pHello,
+    int*                             pFds
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    union
+    {
+        struct cmsghdr               align;
+        char                         buf[CMSG_SPACE(sizeof(int) * VMREST_SHM_FD_COUNT)];
+    } control;
+    struct iovec                     iov = {0};
+    struct msghdr                    msg = {0};
+    struct cmsghdr*                  pCmsg = NULL;
+    ssize_t                          nRead = 0;
+
+    iov.iov_base = pHello;
+    iov.iov_len = sizeof(*pHello);
+
+    memset(&control, 0, sizeof(control));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    do
+    {
+        nRead = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    } while ((nRead < 0) && (errno == EINTR));
+
+    pCmsg = CMSG_FIRSTHDR(&msg);
+    if ((pCmsg != NULL) &&
+        (pCmsg->cmsg_level == SOL_SOCKET) &&
+        (pCmsg->cmsg_type == SCM_RIGHTS) &&
+        (pCmsg->cmsg_len == CMSG_LEN(sizeof(int) * VMREST_SHM_FD_COUNT)))
+    {
+        memcpy(pFds, CMSG_DATA(pCmsg), sizeof(int) * VMREST_SHM_FD_COUNT);
+    }
+    else
+    {
+        dwError = REST_ENGINE_FAILURE;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if ((nRead != (ssize_t)sizeof(*pHello)) ||
+        (pHello->magic != VMREST_SHM_MAGIC) ||
+        (pHello->version != VMREST_SHM_VERSION) ||
+        (pHello->nFds != VMREST_SHM_FD_COUNT) ||
+        (pHello->nRingBytes == 0) ||
+        (pHello->nRingBytes & (pHello->nRingBytes - 1)))
+    {
+        dwError = REST_ENGINE_FAILURE;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+uint32_t
+VmRESTShmClientConnect(
+    const char*                      pszSocketPath,
+    PVMREST_SHM_CLIENT*              ppClient
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    PVMREST_SHM_CLIENT               pClient = NULL;
+    struct sockaddr_un               addr = {0};
+    socklen_t                        addrLen = 0;
+    size_t                           len = 0;
+    VMREST_SHM_HELLO                 hello = {0};
+    int                              fds[VMREST_SHM_FD_COUNT] = { -1, -1, -1 };
+    void*                            pMap = MAP_FAILED;
+    size_t                           nMapBytes = 0;
+    int                              sock = -1;
+    uint32_t                         iFd = 0;
+
+    if (IsNullOrEmptyString(pszSocketPath) || !ppClient)
+    {
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    len = strlen(pszSocketPath);
+    if (len >= sizeof(addr.sun_path))
+    {
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Same naming as server, leading '@' is abstract namespace ****/
+    addr.sun_family = AF_UNIX;
+    memcpy(addr.sun_path, pszSocketPath, len);
+    if (pszSocketPath[0] == '@')
+    {
+        addr.sun_path[0] = '\0';
+        addrLen = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + len);
+    }
+    else
+    {
+        addrLen = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + len + 1);
+    }
+
+    sock = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (sock < 0)
+    {
+        dwError = REST_ENGINE_FAILURE;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if (connect(sock, (struct sockaddr*)&addr, addrLen) < 0)
+    {
+        dwError = REST_ENGINE_FAILURE;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTShmClientReceiveHello(
+                  sock,
+                  &hello,
+                  fds
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    nMapBytes = VMREST_SHM_MAP_BYTES(hello.nRingBytes);
+    pMap = mmap(NULL, nMapBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fds[VMREST_SHM_FD_MEMORY], 0);
+    if (pMap == MAP_FAILED)
+    {
+        dwError = REST_ENGINE_FAILURE;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if ((((PVMREST_SHM_HEADER)pMap)->magic != VMREST_SHM_MAGIC) ||
+        (((PVMREST_SHM_HEADER)pMap)->nRingBytes != hello.nRingBytes))
+    {
+        dwError = REST_ENGINE_FAILURE;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pClient = calloc(1, sizeof(*pClient));
+    if (!pClient)
+    {
+        dwError = REST_ERROR_NO_MEMORY;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pClient->pHeader = (PVMREST_SHM_HEADER)pMap;
+    pClient->nMapBytes = nMapBytes;
+    pClient->nRingBytes = hello.nRingBytes;
+    pClient->wakeServerFd = fds[VMREST_SHM_FD_WAKE_SERVER];
+    pClient->wakeClientFd = fds[VMREST_SHM_FD_WAKE_CLIENT];
+    pClient->nSpinBudget = VMREST_SHM_CLIENT_SPIN_INITIAL;
+    fds[VMREST_SHM_FD_WAKE_SERVER] = -1;
+    fds[VMREST_SHM_FD_WAKE_CLIENT] = -1;
+    pMap = MAP_FAILED;
+
+    *ppClient = pClient;
+
+cleanup:
+
+    /**** Mapping keeps memory alive ****/
+    for (iFd = 0; iFd < VMREST_SHM_FD_COUNT; iFd++)
+    {
+        if (fds[iFd] >= 0)
+        {
+            close(fds[iFd]);
+        }
+    }
+    if (sock >= 0)
+    {
+        close(sock);
+    }
+
+    return dwError;
+
+error:
+
+    if (pMap != MAP_FAILED)
+    {
+        munmap(pMap, nMapBytes);
+    }
+    if (ppClient)
+    {
+        *ppClient = NULL;
+    }
+
+    goto cleanup;
+}
+
+uint32_t
+VmRESTShmClientSend(
+    PVMREST_SHM_CLIENT               pClient,
+    const char*                      pBuf,
+    uint32_t                         nLen
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    PVMREST_SHM_RING                 pRing = NULL;
+    uint32_t                         nSent = 0;
+    uint32_t                         nWritten = 0;
+    uint32_t                         iSpin = 0;
+
+    if (!pClient || (!pBuf && nLen))
+    {
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pRing = &pClient->pHeader->request;
+
+    while (nSent < nLen)
+    {
+        if (__atomic_load_n(&pClient->pHeader->response.bProducerClosed, __ATOMIC_ACQUIRE))
+        {
+            dwError = REST_ENGINE_CONNECTION_CLOSED;
+        }
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        nWritten = VmRESTShmRingWrite(
+                       pRing,
+                       VMREST_SHM_REQUEST_DATA(pClient->pHeader),
+                       pClient->nRingBytes,
+                       (pBuf + nSent),
+                       (nLen - nSent)
+                       );
+        if (nWritten > 0)
+        {
+            nSent += nWritten;
+            iSpin = 0;
+
+            /**** Wake server per chunk, it drains ring while we wait for space ****/
+            if (VmRESTShmRingNeedsWakeup(pRing))
+            {
+                VmRESTShmClientWake(pClient->wakeServerFd);
+            }
+        }
+        else if (++iSpin < VMREST_SHM_CLIENT_FULL_SPINS)
+        {
+            sched_yield();
+        }
+        else
+        {
+            usleep(VMREST_SHM_CLIENT_FULL_SLEEP_US);
+        }
+    }
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+uint32_t
+VmRESTShmClientReceive(
+    PVMREST_SHM_CLIENT               pClient,
+    char*                            pBuf,
+    uint32_t                         nLen,
+    uint32_t*                        pnRead,
+    int                              waitMs
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    PVMREST_SHM_RING                 pRing = NULL;
+    const char*                      pData = NULL;
+    struct pollfd                    pfd = {0};
+    uint64_t                         count = 0;
+    uint32_t                         nRead = 0;
+    uint32_t                         iSpin = 0;
+    int                              ret = 0;
+
+    if (!pClient || !pBuf || !nLen || !pnRead)
+    {
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pRing = &pClient->pHeader->response;
+    pData = VMREST_SHM_RESPONSE_DATA(pClient->pHeader);
+
+    for (;;)
+    {
+        /**** Busy poll first, a sleep and wakeup cost more than a fast handler ****/
+        for (iSpin = 0; ; iSpin++)
+        {
+            nRead = VmRESTShmRingRead(pRing, pData, pClient->nRingBytes, pBuf, nLen);
+            if (nRead > 0)
+            {
+                if ((iSpin > 0) && (pClient->nSpinBudget < VMREST_SHM_CLIENT_SPIN_MAX))
+                {
+                    pClient->nSpinBudget *= 2;
+                }
+                goto cleanup;
+            }
+
+            if (__atomic_load_n(&pRing->bProducerClosed, __ATOMIC_ACQUIRE))
+            {
+                /**** Data written before close is visible now ****/
+                nRead = VmRESTShmRingRead(pRing, pData, pClient->nRingBytes, pBuf, nLen);
+                if (nRead == 0)
+                {
+                    dwError = REST_ENGINE_CONNECTION_CLOSED;
+                }
+                BAIL_ON_VMREST_ERROR(dwError);
+                goto cleanup;
+            }
+
+            if (iSpin >= pClient->nSpinBudget)
+            {
+                break;
+            }
+            VMREST_SHM_CLIENT_CPU_RELAX();
+        }
+
+        if (pClient->nSpinBudget > VMREST_SHM_CLIENT_SPIN_MIN)
+        {
+            pClient->nSpinBudget /= 2;
+        }
+
+        if ((VmRESTShmRingPrepareWait(pRing) > 0) ||
+            __atomic_load_n(&pRing->bProducerClosed, __ATOMIC_ACQUIRE))
+        {
+            continue;
+        }
+
+        pfd.fd = pClient->wakeClientFd;
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+
+        ret = poll(&pfd, 1, waitMs);
+        if (ret == 0)
+        {
+            dwError = REST_ENGINE_TIMEOUT;
+        }
+        else if ((ret < 0) && (errno != EINTR))
+        {
+            dwError = REST_ENGINE_FAILURE;
+        }
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        if ((ret > 0) && (read(pClient->wakeClientFd, &count, sizeof(count)) < 0))
+        {
+            count = 0;
+        }
+    }
+
+cleanup:
+
+    if (pnRead)
+    {
+        *pnRead = nRead;
+    }
+
+    return dwError;
+
+error:
+
+    nRead = 0;
+
+    goto cleanup;
+}
+
+/**** Length of complete response at start of pBuf, 0 while more is needed. *pbUntilClose is
+      set when response has no length and ends with connection. ****/
+static
+uint32_t
+VmRESTShmClientResponseLength(
+    const char*                      pBuf,
+    uint32_t                         nLen,
+    BOOLEAN*                         pbUntilClose
+    )
+{
+    const char*                      pHeaderEnd = NULL;
+    const char*                      pLine = NULL;
+    const char*                      pLineEnd = NULL;
+    const char*                      pTrailerEnd = NULL;
+    uint64_t                         nContentLength = 0;
+    uint64_t                         nChunk = 0;
+    uint64_t                         pos = 0;
+    uint32_t                         nHeaderLen = 0;
+    int                              status = 0;
+    BOOLEAN                          bContentLength = FALSE;
+    BOOLEAN                          bChunked = FALSE;
+
+    *pbUntilClose = FALSE;
+
+    pHeaderEnd = memmem(pBuf, nLen, "\r\n\r\n", 4);
+    if (!pHeaderEnd)
+    {
+        return 0;
+    }
+    nHeaderLen = (uint32_t)(pHeaderEnd - pBuf) + 4;
+
+    if ((nLen > 9) && (strncmp(pBuf, "HTTP/", 5) == 0) && (pLine = memchr(pBuf, ' ', nHeaderLen)))
+    {
+        status = atoi(pLine + 1);
+    }
+
+    for (pLine = memmem(pBuf, nHeaderLen, "\r\n", 2); pLine && (pLine < pHeaderEnd); pLine = pLineEnd)
+    {
+        pLine += 2;
+        pLineEnd = memmem(pLine, (size_t)(pHeaderEnd + 2 - pLine), "\r\n", 2);
+
+        if (strncasecmp(pLine, "Content-Length:", 15) == 0)
+        {
+            nContentLength = strtoull(pLine + 15, NULL, 10);
+            bContentLength = TRUE;
+        }
+        else if ((strncasecmp(pLine, "Transfer-Encoding:", 18) == 0) &&
+                 pLineEnd && memmem(pLine, (size_t)(pLineEnd - pLine), "chunked", 7))
+        {
+            bChunked = TRUE;
+        }
+    }
+
+    if (((status >= 100) && (status < 200)) || (status == 204) || (status == 304))
+    {
+        return nHeaderLen;
+    }
+
+    if (bChunked)
+    {
+        pos = nHeaderLen;
+        for (;;)
+        {
+            pLineEnd = (pos < nLen) ? memmem(pBuf + pos, nLen - pos, "\r\n", 2) : NULL;
+            if (!pLineEnd)
+            {
+                return 0;
+            }
+
+            nChunk = strtoull(pBuf + pos, NULL, 16);
+            if (nChunk == 0)
+            {
+                /**** Last chunk, then optional trailers and empty line ****/
+                pTrailerEnd = memmem(pLineEnd, nLen - (uint32_t)(pLineEnd - pBuf), "\r\n\r\n", 4);
+                return pTrailerEnd ? (uint32_t)(pTrailerEnd - pBuf) + 4 : 0;
+            }
+
+            pos = (uint64_t)(pLineEnd - pBuf) + 2 + nChunk + 2;
+            if (pos > nLen)
+            {
+                return 0;
+            }
+        }
+    }
+
+    if (bContentLength)
+    {
+        return ((nHeaderLen + nContentLength) <= nLen) ? (uint32_t)(nHeaderLen + nContentLength) : 0;
+    }
+
+    *pbUntilClose = TRUE;
+    return 0;
+}
+
+uint32_t
+VmRESTShmClientRequest(
+    PVMREST_SHM_CLIENT               pClient,
+    const char*                      pszRequest,
+    uint32_t                         nRequestLen,
+    char**                           ppszResponse,
+    uint32_t*                        pnResponseLen,
+    int                              waitMs
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    char*                            pszResponse = NULL;
+    char*                            pszNew = NULL;
+    uint32_t                         nAlloc = 0;
+    uint32_t                         nData = 0;
+    uint32_t                         nRead = 0;
+    uint32_t                         nTotal = 0;
+    BOOLEAN                          bUntilClose = FALSE;
+
+    if (!pClient || !pszRequest || !nRequestLen || !ppszResponse || !pnResponseLen)
+    {
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTShmClientSend(
+                  pClient,
+                  pszRequest,
+                  nRequestLen
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    nAlloc = VMREST_SHM_CLIENT_RESPONSE_CHUNK;
+    pszResponse = malloc(nAlloc + 1);
+    if (!pszResponse)
+    {
+        dwError = REST_ERROR_NO_MEMORY;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    while (nTotal == 0)
+    {
+        if (nData == nAlloc)
+        {
+            pszNew = realloc(pszResponse, ((size_t)nAlloc * 2) + 1);
+            if (!pszNew)
+            {
+                dwError = REST_ERROR_NO_MEMORY;
+            }
+            BAIL_ON_VMREST_ERROR(dwError);
+
+            pszResponse = pszNew;
+            nAlloc *= 2;
+        }
+
+        dwError = VmRESTShmClientReceive(
+                      pClient,
+                      (pszResponse + nData),
+                      (nAlloc - nData),
+                      &nRead,
+                      waitMs
+                      );
+        if ((dwError == REST_ENGINE_CONNECTION_CLOSED) && bUntilClose)
+        {
+            dwError = REST_ENGINE_SUCCESS;
+            nTotal = nData;
+            break;
+        }
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        nData += nRead;
+        pszResponse[nData] = '\0';
+
+        nTotal = VmRESTShmClientResponseLength(
+                     pszResponse,
+                     nData,
+                     &bUntilClose
+                     );
+    }
+
+    pszResponse[nTotal] = '\0';
+
+    *ppszResponse = pszResponse;
+    *pnResponseLen = nTotal;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    if (pszResponse)
+    {
+        free(pszResponse);
+    }
+    if (ppszResponse)
+    {
+        *ppszResponse = NULL;
+    }
+    if (pnResponseLen)
+    {
+        *pnResponseLen = 0;
+    }
+
+    goto cleanup;
+}
+
+void
+VmRESTShmClientFreeResponse(
+    char*                            pszResponse
+    )
+{
+    if (pszResponse)
+    {
+        free(pszResponse);
+    }
+}
+
+void
+VmRESTShmClientClose(
+    PVMREST_SHM_CLIENT               pClient
+    )
+{
+    if (!pClient)
+    {
+        return;
+    }
+
+    if (pClient->pHeader)
+    {
+        __atomic_store_n(&pClient->pHeader->request.bProducerClosed, 1, __ATOMIC_RELEASE);
+        if (VmRESTShmRingNeedsWakeup(&pClient->pHeader->request))
+        {
+            VmRESTShmClientWake(pClient->wakeServerFd);
+        }
+        munmap(pClient->pHeader, pClient->nMapBytes);
+    }
+    if (pClient->wakeServerFd >= 0)
+    {
+        close(pClient->wakeServerFd);
+    }
+    if (pClient->wakeClientFd >= 0)
+    {
+        close(pClient->wakeClientFd);
+    }
+
+    free(pClient);
+}
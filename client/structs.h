@@ -0,0 +1,22 @@
+/* C-REST-Engine
+*
+* Copyright (c) 2017 VMware, Inc. All Rights Reserved.
+*
+* This product is licensed to you under the Apache 2.0 license (the "License").
+* You may not use this product except in compliance with the Apache 2.0 License.
+*
+* This product may include a number of subcomponents with separate copyright
+* notices and license terms. Your use of these subcomponents is subject to the
+* terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+*
+*/
+
+typedef struct _VMREST_SHM_CLIENT
+{
+    PVMREST_SHM_HEADER               pHeader;
+    size_t                           nMapBytes;
+    uint32_t                         nRingBytes;
+    int                              wakeServerFd;
+    int                              wakeClientFd;
+    uint32_t                         nSpinBudget;
+} VMREST_SHM_CLIENT;
@@ -0,0 +1,924 @@
+/* C-REST-Engine
+*
+* Copyright (c) 2017 VMware, Inc. All Rights Reserved.
+*
+* This product is licensed to you under the Apache 2.0 license (the "License").
+* You may not use this product except in compliance with the Apache 2.0 License.
+*
+* This product may include a number of subcomponents with separate copyright
+* notices and license terms. Your use of these subcomponents is subject to the
+* terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+*
+*/
+
+#include "includes.h"
+
+/**** A thread keeps rings of this many access logs at a time, beyond that it writes synchronously ****/
+#define VMREST_ACCESS_LOG_THREAD_RINGS       4
+/**** Writer wakes at least this often, producers wake it early once their ring is half full ****/
+#define VMREST_ACCESS_LOG_FLUSH_INTERVAL_MS  20
+/**** Ring segments gathered into one writev, a ring gives at most two ****/
+#define VMREST_ACCESS_LOG_MAX_IOV            64
+#define VMREST_ACCESS_LOG_BATCH_RINGS        (VMREST_ACCESS_LOG_MAX_IOV / 2)
+#define VMREST_ACCESS_LOG_TIME_LEN           32
+/**** Most bytes a field takes in a record, longer values are cut ****/
+#define VMREST_ACCESS_LOG_MAX_IP             64
+#define VMREST_ACCESS_LOG_MAX_METHOD         32
+#define VMREST_ACCESS_LOG_MAX_ROUTE          512
+#define VMREST_ACCESS_LOG_FILE_MODE          0640
+
+typedef struct _VMREST_ACCESS_LOG_TIME_CACHE
+{
+    time_t                           sec;
+    char                             szTime[VMREST_ACCESS_LOG_TIME_LEN];
+} VMREST_ACCESS_LOG_TIME_CACHE, *PVMREST_ACCESS_LOG_TIME_CACHE;
+
+/**** Formatted records, owning thread produces, writer consumes. head and tail are
+      free running byte counters, size is a power of two. A record may wrap at ring
+      end, writer hands both parts to same writev so it stays whole in file. Writer
+      frees ring once owner has exited and ring is written out. ****/
+typedef struct _VMREST_ACCESS_LOG_RING
+{
+    uint32_t                         head;
+    char                             pad0[60];
+    uint32_t                         tail;
+    char                             pad1[60];
+    uint64_t                         nDropped;
+    uint32_t                         bThreadGone;
+    uint32_t                         nBytes;
+    BOOLEAN                          bDrained;
+    char*                            pData;
+    struct _VMREST_ACCESS_LOG_RING*  pNext;
+} VMREST_ACCESS_LOG_RING, *PVMREST_ACCESS_LOG_RING;
+
+typedef struct _VMREST_ACCESS_LOG
+{
+    VMREST_THREAD_SLOT_OWNER         slotOwner;
+    PVMREST_HANDLE                   pRESTHandle;
+    PVMREST_MUTEX                    pMutex;
+    PVMREST_COND                     pCond;
+    VMREST_THREAD                    thread;
+    BOOLEAN                          bThreadStarted;
+    uint32_t                         bShutdown;
+    uint32_t                         bReopen;
+    VMREST_ACCESS_LOG_FORMAT         format;
+    int                              fd;
+    uint64_t                         nFileBytes;
+    uint64_t                         nMaxFileBytes;
+    uint32_t                         nRingBytes;
+    PVMREST_ACCESS_LOG_RING          pRings;
+    char                             szPath[MAX_PATH_LEN];
+} VMREST_ACCESS_LOG;
+
+/**** Rings gathered for one writev, tails move only once it is done ****/
+typedef struct _VMREST_ACCESS_LOG_BATCH
+{
+    struct iovec                     iov[VMREST_ACCESS_LOG_MAX_IOV];
+    PVMREST_ACCESS_LOG_RING          pRing[VMREST_ACCESS_LOG_BATCH_RINGS];
+    uint32_t                         head[VMREST_ACCESS_LOG_BATCH_RINGS];
+    uint32_t                         bGone[VMREST_ACCESS_LOG_BATCH_RINGS];
+    uint32_t                         nIov;
+    uint32_t                         nRings;
+} VMREST_ACCESS_LOG_BATCH, *PVMREST_ACCESS_LOG_BATCH;
+
+typedef struct _VMREST_ACCESS_LOG_TEXT
+{
+    char*                            pCur;
+    char*                            pEnd;
+} VMREST_ACCESS_LOG_TEXT, *PVMREST_ACCESS_LOG_TEXT;
+
+static __thread VMREST_ACCESS_LOG_TIME_CACHE gAccessLogTimeCache;
+
+/**** Ring of exiting thread is freed by writer once written out ****/
+static
+VOID
+VmRESTAccessLogReleaseRing(
+    PVOID                            pSlot
+    )
+{
+    __atomic_store_n(&((PVMREST_ACCESS_LOG_RING)pSlot)->bThreadGone, 1, __ATOMIC_RELEASE);
+}
+
+static VMREST_THREAD_SLOT_REGISTRY   gAccessLogSlots =
+    VMREST_THREAD_SLOT_REGISTRY_INIT(VMREST_ACCESS_LOG_THREAD_RINGS, &VmRESTAccessLogReleaseRing);
+
+/**** Returns NULL when thread can not have a ring, caller then writes synchronously ****/
+static
+PVMREST_ACCESS_LOG_RING
+VmRESTAccessLogGetThreadRing(
+    PVMREST_ACCESS_LOG               pAccessLog
+    )
+{
+    PVMREST_ACCESS_LOG_RING          pRing = NULL;
+
+    if (VmRESTThreadSlotFind(&gAccessLogSlots, &pAccessLog->slotOwner, (PVOID*)&pRing))
+    {
+        return pRing;
+    }
+
+    /**** First record of this thread in this access log ****/
+    if (!VmRESTThreadSlotPrepare(&gAccessLogSlots))
+    {
+        return NULL;
+    }
+
+    if (VmRESTAllocateMemory(sizeof(VMREST_ACCESS_LOG_RING) + pAccessLog->nRingBytes, (PVOID*)&pRing, REST_MEM_LOG) == 0)
+    {
+        pRing->nBytes = pAccessLog->nRingBytes;
+        pRing->pData = (char*)(pRing + 1);
+
+        VmRESTLockMutex(pAccessLog->pMutex);
+        pRing->pNext = pAccessLog->pRings;
+        pAccessLog->pRings = pRing;
+        VmRESTUnlockMutex(pAccessLog->pMutex);
+    }
+
+    /**** Remember failed allocation as well, thread then stays synchronous ****/
+    VmRESTThreadSlotClaim(&gAccessLogSlots, &pAccessLog->slotOwner, pRing);
+
+    return pRing;
+}
+
+/**** Access log never holds up a request, a record not fitting is dropped ****/
+static
+void
+VmRESTAccessLogRingPut(
+    PVMREST_ACCESS_LOG               pAccessLog,
+    PVMREST_ACCESS_LOG_RING          pRing,
+    const char*                      pRecord,
+    uint32_t                         nLen
+    )
+{
+    uint32_t                         head = __atomic_load_n(&pRing->head, __ATOMIC_RELAXED);
+    uint32_t                         tail = __atomic_load_n(&pRing->tail, __ATOMIC_ACQUIRE);
+    uint32_t                         offset = head & (pRing->nBytes - 1);
+    uint32_t                         nFirst = pRing->nBytes - offset;
+
+    if ((pRing->nBytes - (head - tail)) < nLen)
+    {
+        __atomic_fetch_add(&pRing->nDropped, 1, __ATOMIC_RELAXED);
+        VmRESTConditionSignal(pAccessLog->pCond);
+        return;
+    }
+
+    if (nFirst > nLen)
+    {
+        nFirst = nLen;
+    }
+
+    memcpy(pRing->pData + offset, pRecord, nFirst);
+    memcpy(pRing->pData, pRecord + nFirst, nLen - nFirst);
+
+    __atomic_store_n(&pRing->head, head + nLen, __ATOMIC_RELEASE);
+
+    if ((head + nLen - tail) > (pRing->nBytes / 2))
+    {
+        VmRESTConditionSignal(pAccessLog->pCond);
+    }
+}
+
+static
+uint32_t
+VmRESTAccessLogWritev(
+    int                              fd,
+    struct iovec*                    pIov,
+    uint32_t                         nIov,
+    uint64_t*                        pnWritten
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    ssize_t                          nWritten = 0;
+
+    while (nIov > 0)
+    {
+        nWritten = writev(fd, pIov, (nIov > IOV_MAX) ? IOV_MAX : (int)nIov);
+        if (nWritten < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            dwError = errno;
+            break;
+        }
+
+        *pnWritten += nWritten;
+
+        /**** Short write, go on from where it stopped ****/
+        while ((nIov > 0) && ((size_t)nWritten >= pIov->iov_len))
+        {
+            nWritten -= pIov->iov_len;
+            pIov++;
+            nIov--;
+        }
+        if (nIov > 0)
+        {
+            pIov->iov_base = (char*)pIov->iov_base + nWritten;
+            pIov->iov_len -= nWritten;
+        }
+    }
+
+    return dwError;
+}
+
+/**** Writer only, holding access log mutex. Old file descriptor stays on failure. ****/
+static
+uint32_t
+VmRESTAccessLogOpen(
+    PVMREST_ACCESS_LOG               pAccessLog
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    const char*                      pszPath = pAccessLog->szPath;
+    struct stat                      st = {0};
+    int                              fd = -1;
+
+    fd = open(pszPath, O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, VMREST_ACCESS_LOG_FILE_MODE);
+    if (fd < 0)
+    {
+        VMREST_LOG_ERROR(pAccessLog->pRESTHandle, "Access log \"%s\" open failed, errno %d", pszPath, errno);
+        dwError = REST_ENGINE_FAILURE;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if (pAccessLog->fd >= 0)
+    {
+        close(pAccessLog->fd);
+    }
+
+    pAccessLog->fd = fd;
+    pAccessLog->nFileBytes = (fstat(fd, &st) == 0) ? (uint64_t)st.st_size : 0;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+/**** file.N-1 moves to file.N down to file moving to file.1, oldest falls off ****/
+static
+void
+VmRESTAccessLogRotate(
+    PVMREST_ACCESS_LOG               pAccessLog
+    )
+{
+    const char*                      pszPath = pAccessLog->szPath;
+    char                             szFrom[MAX_PATH_LEN + 16];
+    char                             szTo[MAX_PATH_LEN + 16];
+    uint32_t                         idx = 0;
+
+    for (idx = VMREST_ACCESS_LOG_ROTATE_KEEP; idx > 1; idx--)
+    {
+        snprintf(szFrom, sizeof(szFrom), "%s.%u", pszPath, idx - 1);
+        snprintf(szTo, sizeof(szTo), "%s.%u", pszPath, idx);
+        rename(szFrom, szTo);
+    }
+
+    snprintf(szTo, sizeof(szTo), "%s.1", pszPath);
+    if (rename(pszPath, szTo) != 0)
+    {
+        VMREST_LOG_ERROR_RATELIMITED(pAccessLog->pRESTHandle, "Access log rotation failed, errno %d", errno);
+        pAccessLog->nFileBytes = 0;
+        return;
+    }
+
+    VmRESTAccessLogOpen(pAccessLog);
+}
+
+/**** Writes gathered ring segments. Records are dropped when file can not take them,
+      rings must not fill up behind a bad file. ****/
+static
+uint64_t
+VmRESTAccessLogFlushBatch(
+    PVMREST_ACCESS_LOG               pAccessLog,
+    PVMREST_ACCESS_LOG_BATCH         pBatch
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    uint64_t                         nWritten = 0;
+    uint32_t                         idx = 0;
+
+    if (pBatch->nIov && (pAccessLog->fd >= 0))
+    {
+        dwError = VmRESTAccessLogWritev(
+                      pAccessLog->fd,
+                      pBatch->iov,
+                      pBatch->nIov,
+                      &nWritten
+                      );
+        if (dwError)
+        {
+            VMREST_LOG_ERROR_RATELIMITED(pAccessLog->pRESTHandle, "Access log write failed, errno %u", dwError);
+        }
+    }
+
+    for (idx = 0; idx < pBatch->nRings; idx++)
+    {
+        __atomic_store_n(&pBatch->pRing[idx]->tail, pBatch->head[idx], __ATOMIC_RELEASE);
+        if (pBatch->bGone[idx])
+        {
+            pBatch->pRing[idx]->bDrained = TRUE;
+        }
+    }
+
+    pBatch->nIov = 0;
+    pBatch->nRings = 0;
+
+    /**** Rotate between batches, file always ends on a whole record ****/
+    pAccessLog->nFileBytes += nWritten;
+    if (pAccessLog->nMaxFileBytes && (pAccessLog->nFileBytes >= pAccessLog->nMaxFileBytes))
+    {
+        VmRESTAccessLogRotate(pAccessLog);
+    }
+
+    return nWritten;
+}
+
+/**** Writer only, holding access log mutex. Returns bytes written. ****/
+static
+uint64_t
+VmRESTAccessLogDrain(
+    PVMREST_ACCESS_LOG               pAccessLog
+    )
+{
+    PVMREST_ACCESS_LOG_RING*         ppRing = &pAccessLog->pRings;
+    PVMREST_ACCESS_LOG_RING          pRing = NULL;
+    VMREST_ACCESS_LOG_BATCH          batch;
+    uint32_t                         bGone = 0;
+    uint32_t                         head = 0;
+    uint32_t                         tail = 0;
+    uint32_t                         offset = 0;
+    uint32_t                         nFirst = 0;
+    uint64_t                         nWritten = 0;
+    uint64_t                         nDropped = 0;
+
+    batch.nIov = 0;
+    batch.nRings = 0;
+
+    while (*ppRing)
+    {
+        pRing = *ppRing;
+
+        /**** Written out after its owner had gone ****/
+        if (pRing->bDrained)
+        {
+            *ppRing = pRing->pNext;
+            VmRESTFreeMemory(pRing, REST_MEM_LOG);
+            continue;
+        }
+
+        /**** Owner marks ring gone after its last record, so look at flag first ****/
+        bGone = __atomic_load_n(&pRing->bThreadGone, __ATOMIC_ACQUIRE);
+        tail = pRing->tail;
+        head = __atomic_load_n(&pRing->head, __ATOMIC_ACQUIRE);
+
+        nDropped += __atomic_exchange_n(&pRing->nDropped, 0, __ATOMIC_RELAXED);
+
+        if (head != tail)
+        {
+            offset = tail & (pRing->nBytes - 1);
+            nFirst = pRing->nBytes - offset;
+            if (nFirst > (head - tail))
+            {
+                nFirst = head - tail;
+            }
+
+            batch.iov[batch.nIov].iov_base = pRing->pData + offset;
+            batch.iov[batch.nIov].iov_len = nFirst;
+            batch.nIov++;
+
+            if ((head - tail) > nFirst)
+            {
+                batch.iov[batch.nIov].iov_base = pRing->pData;
+                batch.iov[batch.nIov].iov_len = (head - tail) - nFirst;
+                batch.nIov++;
+            }
+        }
+
+        if ((head != tail) || bGone)
+        {
+            batch.pRing[batch.nRings] = pRing;
+            batch.head[batch.nRings] = head;
+            batch.bGone[batch.nRings] = bGone;
+            batch.nRings++;
+        }
+
+        if (batch.nRings == VMREST_ACCESS_LOG_BATCH_RINGS)
+        {
+            nWritten += VmRESTAccessLogFlushBatch(pAccessLog, &batch);
+        }
+
+        ppRing = &pRing->pNext;
+    }
+
+    if (batch.nRings)
+    {
+        nWritten += VmRESTAccessLogFlushBatch(pAccessLog, &batch);
+    }
+
+    if (nDropped)
+    {
+        VMREST_LOG_WARNING(pAccessLog->pRESTHandle, "C-REST-ENGINE: %llu access log records dropped, ring full", (unsigned long long)nDropped);
+    }
+
+    return nWritten;
+}
+
+static
+DWORD
+VmRESTAccessLogWriterThreadProc(
+    PVOID                            pData
+    )
+{
+    PVMREST_ACCESS_LOG               pAccessLog = (PVMREST_ACCESS_LOG)pData;
+
+    VmRESTLockMutex(pAccessLog->pMutex);
+
+    while (!__atomic_load_n(&pAccessLog->bShutdown, __ATOMIC_ACQUIRE))
+    {
+        /**** What was queued before reopen belongs to old file ****/
+        if (__atomic_exchange_n(&pAccessLog->bReopen, 0, __ATOMIC_ACQUIRE))
+        {
+            VmRESTAccessLogDrain(pAccessLog);
+            VmRESTAccessLogOpen(pAccessLog);
+        }
+
+        if (VmRESTAccessLogDrain(pAccessLog) == 0)
+        {
+            VmRESTConditionTimedWait(pAccessLog->pCond, pAccessLog->pMutex, VMREST_ACCESS_LOG_FLUSH_INTERVAL_MS);
+        }
+    }
+
+    /**** Whatever was queued before shutdown ****/
+    VmRESTAccessLogDrain(pAccessLog);
+
+    VmRESTUnlockMutex(pAccessLog->pMutex);
+
+    return 0;
+}
+
+static
+void
+VmRESTAccessLogPut(
+    PVMREST_ACCESS_LOG_TEXT          pText,
+    const char*                      pszValue,
+    size_t                           nLen
+    )
+{
+    if (nLen > (size_t)(pText->pEnd - pText->pCur))
+    {
+        nLen = pText->pEnd - pText->pCur;
+    }
+
+    memcpy(pText->pCur, pszValue, nLen);
+    pText->pCur += nLen;
+}
+
+#define VMREST_ACCESS_LOG_PUT_LITERAL(pText, szLiteral) \
+    VmRESTAccessLogPut((pText), (szLiteral), sizeof(szLiteral) - 1)
+
+/**** printf costs more than rest of record put together ****/
+static
+void
+VmRESTAccessLogPutUint(
+    PVMREST_ACCESS_LOG_TEXT          pText,
+    uint64_t                         nValue
+    )
+{
+    char                             szDigits[24];
+    char*                            pDigit = szDigits + sizeof(szDigits);
+
+    do
+    {
+        *--pDigit = (char)('0' + (nValue % 10));
+        nValue /= 10;
+    } while (nValue);
+
+    VmRESTAccessLogPut(pText, pDigit, szDigits + sizeof(szDigits) - pDigit);
+}
+
+/**** Quoted and escaped, cut to nMax bytes of output. Bytes outside printable
+      ASCII are escaped too, so line is valid JSON whatever client sent. ****/
+static
+void
+VmRESTAccessLogPutJsonString(
+    PVMREST_ACCESS_LOG_TEXT          pText,
+    const char*                      pszValue,
+    uint32_t                         nMax
+    )
+{
+    static const char                szHex[] = "0123456789abcdef";
+    char*                            pLimit = pText->pCur + nMax - 1;
+    unsigned char                    c = 0;
+
+    if ((pLimit > (pText->pEnd - 1)) || (nMax < 2))
+    {
+        pLimit = pText->pEnd - 1;
+    }
+
+    VMREST_ACCESS_LOG_PUT_LITERAL(pText, "\"");
+
+    for (; pszValue && *pszValue; pszValue++)
+    {
+        c = (unsigned char)*pszValue;
+
+        if ((c == '"') || (c == '\\'))
+        {
+            if ((pLimit - pText->pCur) < 2)
+            {
+                break;
+            }
+            *pText->pCur++ = '\\';
+            *pText->pCur++ = (char)c;
+        }
+        else if ((c < 0x20) || (c >= 0x7f))
+        {
+            if ((pLimit - pText->pCur) < 6)
+            {
+                break;
+            }
+            memcpy(pText->pCur, "\\u00", 4);
+            pText->pCur[4] = szHex[c >> 4];
+            pText->pCur[5] = szHex[c & 0xf];
+            pText->pCur += 6;
+        }
+        else
+        {
+            if ((pLimit - pText->pCur) < 1)
+            {
+                break;
+            }
+            *pText->pCur++ = (char)c;
+        }
+    }
+
+    VMREST_ACCESS_LOG_PUT_LITERAL(pText, "\"");
+}
+
+/**** gmtime only when second changes ****/
+static
+const char*
+VmRESTAccessLogTimestamp(
+    PVMREST_ACCESS_LOG_TIME_CACHE    pCache,
+    time_t                           sec
+    )
+{
+    struct tm                        tmInfo = {0};
+
+    if ((pCache->sec != sec) || (pCache->szTime[0] == '\0'))
+    {
+        gmtime_r(&sec, &tmInfo);
+        strftime(pCache->szTime, sizeof(pCache->szTime), "%Y-%m-%dT%H:%M:%S", &tmInfo);
+        pCache->sec = sec;
+    }
+
+    return pCache->szTime;
+}
+
+/**** Phases of record in microseconds. Handshake belongs to first request of connection. ****/
+static
+void
+VmRESTAccessLogPhases(
+    PVMREST_ACCESS_LOG_ENTRY         pEntry,
+    uint32_t                         phaseUs[REST_PHASE_COUNT]
+    )
+{
+    uint64_t                         durationNs[REST_PHASE_COUNT] = {0};
+    PREST_REQUEST_TIMINGS            pTimings = pEntry->pTimings;
+    uint32_t                         idx = 0;
+
+    if (pTimings)
+    {
+        VmRESTMetricsGetPhaseDurations(pTimings, durationNs);
+
+        if ((pEntry->nConnRequests == 0) &&
+            pTimings->phaseNs[REST_PHASE_ACCEPT] &&
+            (pTimings->phaseNs[REST_PHASE_TLS_DONE] >= pTimings->phaseNs[REST_PHASE_ACCEPT]))
+        {
+            durationNs[REST_PHASE_TLS_DONE] = pTimings->phaseNs[REST_PHASE_TLS_DONE] - pTimings->phaseNs[REST_PHASE_ACCEPT];
+        }
+    }
+
+    for (idx = 0; idx < REST_PHASE_COUNT; idx++)
+    {
+        phaseUs[idx] = (durationNs[idx] / 1000 > UINT32_MAX) ? UINT32_MAX : (uint32_t)(durationNs[idx] / 1000);
+    }
+}
+
+/**** One line, fixed set of keys. Phases are those with a start, as in REST_PHASE_STATS. ****/
+static
+uint32_t
+VmRESTAccessLogFormatJson(
+    PVMREST_ACCESS_LOG_ENTRY         pEntry,
+    const struct timespec*           pTs,
+    char*                            pszRecord,
+    uint32_t                         nSize
+    )
+{
+    VMREST_ACCESS_LOG_TEXT           text = {0};
+    uint32_t                         phaseUs[REST_PHASE_COUNT] = {0};
+    const char*                      pszTime = VmRESTAccessLogTimestamp(&gAccessLogTimeCache, pTs->tv_sec);
+    char                             szFraction[8];
+    uint32_t                         usec = (uint32_t)(pTs->tv_nsec / 1000);
+    uint32_t                         idx = 0;
+    BOOLEAN                          bFirst = TRUE;
+
+    /**** Newline always fits ****/
+    text.pCur = pszRecord;
+    text.pEnd = pszRecord + nSize - 1;
+
+    for (idx = 6; idx > 0; idx--)
+    {
+        szFraction[idx] = (char)('0' + (usec % 10));
+        usec /= 10;
+    }
+    szFraction[0] = '.';
+
+    VmRESTAccessLogPhases(pEntry, phaseUs);
+
+    VMREST_ACCESS_LOG_PUT_LITERAL(&text, "{\"time\":\"");
+    VmRESTAccessLogPut(&text, pszTime, strlen(pszTime));
+    VmRESTAccessLogPut(&text, szFraction, 7);
+    VMREST_ACCESS_LOG_PUT_LITERAL(&text, "Z\",\"client\":");
+    VmRESTAccessLogPutJsonString(&text, pEntry->pszClientIP, VMREST_ACCESS_LOG_MAX_IP);
+    VMREST_ACCESS_LOG_PUT_LITERAL(&text, ",\"port\":");
+    if (pEntry->clientPort < 0)
+    {
+        VMREST_ACCESS_LOG_PUT_LITERAL(&text, "null");
+    }
+    else
+    {
+        VmRESTAccessLogPutUint(&text, (uint64_t)pEntry->clientPort);
+    }
+    VMREST_ACCESS_LOG_PUT_LITERAL(&text, ",\"method\":");
+    VmRESTAccessLogPutJsonString(&text, pEntry->pszMethod, VMREST_ACCESS_LOG_MAX_METHOD);
+    VMREST_ACCESS_LOG_PUT_LITERAL(&text, ",\"route\":");
+    VmRESTAccessLogPutJsonString(&text, pEntry->pszRoute, VMREST_ACCESS_LOG_MAX_ROUTE);
+    VMREST_ACCESS_LOG_PUT_LITERAL(&text, ",\"status\":");
+    VmRESTAccessLogPutUint(&text, pEntry->statusCode);
+    VMREST_ACCESS_LOG_PUT_LITERAL(&text, ",\"bytes_in\":");
+    VmRESTAccessLogPutUint(&text, pEntry->nBytesIn);
+    VMREST_ACCESS_LOG_PUT_LITERAL(&text, ",\"bytes_out\":");
+    VmRESTAccessLogPutUint(&text, pEntry->nBytesOut);
+    VMREST_ACCESS_LOG_PUT_LITERAL(&text, ",\"reuse\":");
+    VmRESTAccessLogPutUint(&text, pEntry->nConnRequests);
+    VMREST_ACCESS_LOG_PUT_LITERAL(&text, ",\"phase_us\":{");
+
+    for (idx = 0; idx < REST_PHASE_COUNT; idx++)
+    {
+        if ((idx == REST_PHASE_ACCEPT) || (idx == REST_PHASE_FIRST_BYTE_READ))
+        {
+            continue;
+        }
+
+        if (!bFirst)
+        {
+            VMREST_ACCESS_LOG_PUT_LITERAL(&text, ",");
+        }
+        bFirst = FALSE;
+
+        VMREST_ACCESS_LOG_PUT_LITERAL(&text, "\"");
+        VmRESTAccessLogPut(&text, VmRESTMetricsGetPhaseName(idx), strlen(VmRESTMetricsGetPhaseName(idx)));
+        VMREST_ACCESS_LOG_PUT_LITERAL(&text, "\":");
+        VmRESTAccessLogPutUint(&text, phaseUs[idx]);
+    }
+
+    VMREST_ACCESS_LOG_PUT_LITERAL(&text, "}}");
+
+    *text.pCur++ = '\n';
+
+    return (uint32_t)(text.pCur - pszRecord);
+}
+
+static
+uint32_t
+VmRESTAccessLogFormatBinary(
+    PVMREST_ACCESS_LOG_ENTRY         pEntry,
+    const struct timespec*           pTs,
+    char*                            pszRecord,
+    uint32_t                         nSize
+    )
+{
+    PREST_ACCESS_LOG_RECORD          pRecord = (PREST_ACCESS_LOG_RECORD)pszRecord;
+    char*                            pCur = (char*)(pRecord + 1);
+    size_t                           nIP = pEntry->pszClientIP ? strlen(pEntry->pszClientIP) : 0;
+    size_t                           nMethod = pEntry->pszMethod ? strlen(pEntry->pszMethod) : 0;
+    size_t                           nRoute = pEntry->pszRoute ? strlen(pEntry->pszRoute) : 0;
+    uint32_t                         nLen = 0;
+
+    nIP = (nIP > VMREST_ACCESS_LOG_MAX_IP) ? VMREST_ACCESS_LOG_MAX_IP : nIP;
+    nMethod = (nMethod > VMREST_ACCESS_LOG_MAX_METHOD) ? VMREST_ACCESS_LOG_MAX_METHOD : nMethod;
+    nRoute = (nRoute > VMREST_ACCESS_LOG_MAX_ROUTE) ? VMREST_ACCESS_LOG_MAX_ROUTE : nRoute;
+
+    memset(pRecord, 0, sizeof(REST_ACCESS_LOG_RECORD));
+    pRecord->version = VMREST_ACCESS_LOG_RECORD_VERSION;
+    pRecord->statusCode = (uint16_t)pEntry->statusCode;
+    pRecord->timeUs = (uint64_t)pTs->tv_sec * 1000000 + (uint64_t)(pTs->tv_nsec / 1000);
+    pRecord->nBytesIn = pEntry->nBytesIn;
+    pRecord->nBytesOut = pEntry->nBytesOut;
+    pRecord->nConnRequests = pEntry->nConnRequests;
+    pRecord->clientPort = pEntry->clientPort;
+    pRecord->nClientIPLen = (uint8_t)nIP;
+    pRecord->nMethodLen = (uint8_t)nMethod;
+    pRecord->nRouteLen = (uint16_t)nRoute;
+
+    VmRESTAccessLogPhases(pEntry, pRecord->phaseUs);
+
+    memcpy(pCur, pEntry->pszClientIP, nIP);
+    pCur += nIP;
+    memcpy(pCur, pEntry->pszMethod, nMethod);
+    pCur += nMethod;
+    memcpy(pCur, pEntry->pszRoute, nRoute);
+    pCur += nRoute;
+
+    nLen = (uint32_t)(pCur - pszRecord);
+    nLen = (nLen + 7) & ~((uint32_t)7);
+    memset(pCur, 0, pszRecord + nLen - pCur);
+
+    pRecord->nLen = nLen;
+
+    return nLen;
+}
+
+static
+void
+VmRESTFreeAccessLogInternal(
+    PVMREST_ACCESS_LOG               pAccessLog
+    )
+{
+    PVMREST_ACCESS_LOG_RING          pRing = NULL;
+
+    VmRESTThreadSlotRemoveOwner(&gAccessLogSlots, &pAccessLog->slotOwner);
+
+    if (pAccessLog->bThreadStarted)
+    {
+        VmRESTLockMutex(pAccessLog->pMutex);
+        __atomic_store_n(&pAccessLog->bShutdown, 1, __ATOMIC_RELEASE);
+        VmRESTConditionSignal(pAccessLog->pCond);
+        VmRESTUnlockMutex(pAccessLog->pMutex);
+
+        VmRESTThreadJoin(&pAccessLog->thread, NULL);
+    }
+
+    while (pAccessLog->pRings)
+    {
+        pRing = pAccessLog->pRings;
+        pAccessLog->pRings = pRing->pNext;
+        VmRESTFreeMemory(pRing, REST_MEM_LOG);
+    }
+
+    if (pAccessLog->fd >= 0)
+    {
+        close(pAccessLog->fd);
+    }
+    if (pAccessLog->pCond)
+    {
+        VmRESTFreeCondition(pAccessLog->pCond);
+    }
+    if (pAccessLog->pMutex)
+    {
+        VmRESTFreeMutex(pAccessLog->pMutex);
+    }
+    VmRESTFreeMemory(pAccessLog, REST_MEM_LOG);
+}
+
+uint32_t
+VmRESTCreateAccessLog(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVMREST_ACCESS_LOG*              ppAccessLog
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    PVMREST_ACCESS_LOG               pAccessLog = NULL;
+
+    if (!pRESTHandle || !pRESTHandle->pRESTConfig || !ppAccessLog)
+    {
+        dwError = REST_ENGINE_FAILURE;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateMemory(
+                  sizeof(VMREST_ACCESS_LOG),
+                  (PVOID*)&pAccessLog,
+                  REST_MEM_LOG
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pAccessLog->fd = -1;
+    pAccessLog->pRESTHandle = pRESTHandle;
+    pAccessLog->format = pRESTHandle->pRESTConfig->accessLogFormat;
+    snprintf(pAccessLog->szPath, sizeof(pAccessLog->szPath), "%s", pRESTHandle->pRESTConfig->pszAccessLogFile);
+    pAccessLog->nRingBytes = pRESTHandle->pRESTConfig->nAccessLogRingBytes;
+    pAccessLog->nMaxFileBytes = (uint64_t)pRESTHandle->pRESTConfig->accessLogMaxMB * 1024 * 1024;
+
+    dwError = VmRESTAllocateNamedMutex(&pAccessLog->pMutex, "access_log");
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateCondition(&pAccessLog->pCond);
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAccessLogOpen(pAccessLog);
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    VmRESTThreadSlotAddOwner(&gAccessLogSlots, &pAccessLog->slotOwner);
+
+    dwError = VmRESTCreateThread(
+                  &pAccessLog->thread,
+                  FALSE,
+                  &VmRESTAccessLogWriterThreadProc,
+                  pAccessLog
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pAccessLog->bThreadStarted = TRUE;
+
+    *ppAccessLog = pAccessLog;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    if (pAccessLog)
+    {
+        VmRESTFreeAccessLogInternal(pAccessLog);
+    }
+
+    goto cleanup;
+}
+
+void
+VmRESTFreeAccessLog(
+    PVMREST_ACCESS_LOG               pAccessLog
+    )
+{
+    if (pAccessLog)
+    {
+        VmRESTFreeAccessLogInternal(pAccessLog);
+    }
+}
+
+void
+VmRESTAccessLogWrite(
+    PVMREST_ACCESS_LOG               pAccessLog,
+    PVMREST_ACCESS_LOG_ENTRY         pEntry
+    )
+{
+    uint64_t                         record[VMREST_ACCESS_LOG_MAX_RECORD / sizeof(uint64_t)];
+    PVMREST_ACCESS_LOG_RING          pRing = NULL;
+    struct timespec                  ts = {0};
+    uint64_t                         nWritten = 0;
+    uint32_t                         nLen = 0;
+    struct iovec                     iov = {0};
+
+    if (!pAccessLog || !pEntry)
+    {
+        return;
+    }
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    if (pAccessLog->format == VMREST_ACCESS_LOG_BINARY)
+    {
+        nLen = VmRESTAccessLogFormatBinary(pEntry, &ts, (char*)record, sizeof(record));
+    }
+    else
+    {
+        nLen = VmRESTAccessLogFormatJson(pEntry, &ts, (char*)record, sizeof(record));
+    }
+
+    pRing = VmRESTAccessLogGetThreadRing(pAccessLog);
+    if (pRing)
+    {
+        VmRESTAccessLogRingPut(pAccessLog, pRing, (const char*)record, nLen);
+    }
+    else
+    {
+        /**** Writer holds mutex while it writes, so records do not interleave ****/
+        iov.iov_base = record;
+        iov.iov_len = nLen;
+
+        VmRESTLockMutex(pAccessLog->pMutex);
+        if (pAccessLog->fd >= 0)
+        {
+            VmRESTAccessLogWritev(pAccessLog->fd, &iov, 1, &nWritten);
+            pAccessLog->nFileBytes += nWritten;
+        }
+        VmRESTUnlockMutex(pAccessLog->pMutex);
+    }
+}
+
+void
+VmRESTAccessLogReopen(
+    PVMREST_ACCESS_LOG               pAccessLog
+    )
+{
+    if (pAccessLog)
+    {
+        __atomic_store_n(&pAccessLog->bReopen, 1, __ATOMIC_RELEASE);
+    }
+}
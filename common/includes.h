@@ -30,5 +30,16 @@ typedef unsigned __int8 uint8_t;
 #include <vmrestdefines.h>
 #include <vmsock.h>
 #include <vmrestcommon.h>
+#include <vmrestshm.h>
 #include <syslog.h>
+#include <sys/time.h>
+#include <sys/mman.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#ifdef HAVE_MALLOC_USABLE_SIZE
+#include <malloc.h>
+#endif
+#if defined(__x86_64__)
+#include <x86intrin.h>
+#endif
 
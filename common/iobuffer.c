@@ -0,0 +1,381 @@
+/* C-REST-Engine
+*
+* Copyright (c) 2017 VMware, Inc. All Rights Reserved.
+*
+* This product is licensed to you under the Apache 2.0 license (the "License").
+* You may not use this product except in compliance with the Apache 2.0 License.
+*
+* This product may include a number of subcomponents with separate copyright
+* notices and license terms. Your use of these subcomponents is subject to the
+* terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+*
+*/
+
+#include "includes.h"
+
+/**** A thread can hold slots of this many pools at a time, beyond that it uses heap ****/
+#define VMREST_IOBUF_THREAD_CLAIMS           4
+
+static const size_t                  gIOBufClassSize[VMREST_IOBUF_CLASS_COUNT] =
+{
+    VMREST_IOBUF_SMALL_SIZE, VMREST_IOBUF_MEDIUM_SIZE, VMREST_IOBUF_LARGE_SIZE
+};
+
+static const uint32_t                gIOBufPerSlot[VMREST_IOBUF_CLASS_COUNT] =
+{
+    VMREST_IOBUF_SMALL_PER_SLOT, VMREST_IOBUF_MEDIUM_PER_SLOT, VMREST_IOBUF_LARGE_PER_SLOT
+};
+
+typedef struct _VMREST_IOBUF_FREE
+{
+    struct _VMREST_IOBUF_FREE*       pNext;
+} VMREST_IOBUF_FREE, *PVMREST_IOBUF_FREE;
+
+/**** Local lists are touched only by owner thread. Other threads return
+      buffers through remote lists with CAS push, owner takes whole remote
+      list in one exchange, so no ABA is possible ****/
+typedef struct _VMREST_IOBUF_SLOT
+{
+    uint32_t                         bOwned;
+    PVMREST_IOBUF_FREE               pLocal[VMREST_IOBUF_CLASS_COUNT];
+    PVMREST_IOBUF_FREE               pRemote[VMREST_IOBUF_CLASS_COUNT];
+} __attribute__((aligned(64))) VMREST_IOBUF_SLOT, *PVMREST_IOBUF_SLOT;
+
+typedef struct _VMREST_IOBUF_POOL
+{
+    VMREST_THREAD_SLOT_OWNER         slotOwner;
+    char*                            pBase;
+    size_t                           nLength;
+    size_t                           nSlotBytes;
+    size_t                           classOffset[VMREST_IOBUF_CLASS_COUNT];
+    uint32_t                         nSlots;
+    BOOLEAN                          bHugeTLB;
+    PVMREST_IOBUF_SLOT               pSlots;
+} VMREST_IOBUF_POOL;
+
+/**** Slot of exiting thread is handed to next thread asking for one,
+      along with buffers on its local lists ****/
+static
+VOID
+VmRESTIOBufReleaseSlot(
+    PVOID                            pSlot
+    )
+{
+    __atomic_store_n(&((PVMREST_IOBUF_SLOT)pSlot)->bOwned, 0, __ATOMIC_RELEASE);
+}
+
+static VMREST_THREAD_SLOT_REGISTRY   gIOBufSlots =
+    VMREST_THREAD_SLOT_REGISTRY_INIT(VMREST_IOBUF_THREAD_CLAIMS, &VmRESTIOBufReleaseSlot);
+
+/**** Returns NULL when no slot is left, caller then uses heap ****/
+static
+PVMREST_IOBUF_SLOT
+VmRESTIOBufGetThreadSlot(
+    PVMREST_IOBUF_POOL               pPool
+    )
+{
+    PVMREST_IOBUF_SLOT               pSlot = NULL;
+    uint32_t                         idx = 0;
+
+    if (VmRESTThreadSlotFind(&gIOBufSlots, &pPool->slotOwner, (PVOID*)&pSlot))
+    {
+        return pSlot;
+    }
+
+    /**** First use of this pool by this thread ****/
+    if (!VmRESTThreadSlotPrepare(&gIOBufSlots))
+    {
+        return NULL;
+    }
+
+    for (idx = 0; idx < pPool->nSlots; idx++)
+    {
+        if (__sync_bool_compare_and_swap(&pPool->pSlots[idx].bOwned, 0, 1))
+        {
+            pSlot = &pPool->pSlots[idx];
+            break;
+        }
+    }
+
+    /**** Remember failed claim as well, so scan is not repeated on every call ****/
+    VmRESTThreadSlotClaim(&gIOBufSlots, &pPool->slotOwner, pSlot);
+
+    return pSlot;
+}
+
+uint32_t
+VmRESTCreateIOBufferPool(
+    uint32_t                         nSlots,
+    BOOLEAN                          bHugePages,
+    PVMREST_IOBUF_POOL*              ppPool
+    )
+{
+    uint32_t                         dwError = 0;
+    PVMREST_IOBUF_POOL               pPool = NULL;
+    PVMREST_IOBUF_FREE               pBlock = NULL;
+    void*                            pMap = MAP_FAILED;
+    size_t                           nLength = 0;
+    uint32_t                         iSlot = 0;
+    uint32_t                         iClass = 0;
+    uint32_t                         iBuf = 0;
+
+    if (!ppPool || !nSlots)
+    {
+        dwError = EINVAL;
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
+    dwError = VmRESTAllocateMemory(
+                  sizeof(VMREST_IOBUF_POOL),
+                  (void**)&pPool,
+                  REST_MEM_OTHER
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pPool->pBase = MAP_FAILED;
+    pPool->nSlots = nSlots;
+
+    for (iClass = 0; iClass < VMREST_IOBUF_CLASS_COUNT; iClass++)
+    {
+        pPool->classOffset[iClass] = pPool->nSlotBytes;
+        pPool->nSlotBytes += gIOBufClassSize[iClass] * gIOBufPerSlot[iClass];
+    }
+    nLength = pPool->nSlotBytes * nSlots;
+
+#ifdef MAP_HUGETLB
+    if (bHugePages)
+    {
+        /**** Needs pages reserved in vm.nr_hugepages, silently use THP otherwise ****/
+        pPool->nLength = (nLength + VMREST_IOBUF_HUGE_PAGE_SIZE - 1) & ~((size_t)VMREST_IOBUF_HUGE_PAGE_SIZE - 1);
+        pMap = mmap(NULL, pPool->nLength, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        pPool->bHugeTLB = (pMap != MAP_FAILED);
+    }
+#endif
+
+    if (pMap == MAP_FAILED)
+    {
+        pPool->nLength = nLength;
+        pMap = mmap(NULL, pPool->nLength, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (pMap == MAP_FAILED)
+        {
+            dwError = ENOMEM;
+            BAIL_ON_VMREST_ERROR(dwError);
+        }
+#ifdef MADV_HUGEPAGE
+        if (bHugePages)
+        {
+            madvise(pMap, pPool->nLength, MADV_HUGEPAGE);
+        }
+#endif
+    }
+    pPool->pBase = (char*)pMap;
+
+    dwError = VmRESTAllocateMemory(
+                  nSlots * sizeof(VMREST_IOBUF_SLOT),
+                  (void**)&pPool->pSlots,
+                  REST_MEM_OTHER
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    for (iSlot = 0; iSlot < nSlots; iSlot++)
+    {
+        for (iClass = 0; iClass < VMREST_IOBUF_CLASS_COUNT; iClass++)
+        {
+            for (iBuf = gIOBufPerSlot[iClass]; iBuf > 0; iBuf--)
+            {
+                pBlock = (PVMREST_IOBUF_FREE)(pPool->pBase +
+                                              (iSlot * pPool->nSlotBytes) +
+                                              pPool->classOffset[iClass] +
+                                              ((iBuf - 1) * gIOBufClassSize[iClass]));
+                pBlock->pNext = pPool->pSlots[iSlot].pLocal[iClass];
+                pPool->pSlots[iSlot].pLocal[iClass] = pBlock;
+            }
+        }
+    }
+
+    VmRESTThreadSlotAddOwner(&gIOBufSlots, &pPool->slotOwner);
+
+    *ppPool = pPool;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    if (ppPool)
+    {
+        *ppPool = NULL;
+    }
+
+    if (pPool)
+    {
+        if (pPool->pBase != MAP_FAILED)
+        {
+            munmap(pPool->pBase, pPool->nLength);
+        }
+        VmRESTFreeMemory(pPool->pSlots, REST_MEM_OTHER);
+        VmRESTFreeMemory(pPool, REST_MEM_OTHER);
+        pPool = NULL;
+    }
+
+    goto cleanup;
+}
+
+void
+VmRESTFreeIOBufferPool(
+    PVMREST_IOBUF_POOL               pPool
+    )
+{
+    if (!pPool)
+    {
+        return;
+    }
+
+    VmRESTThreadSlotRemoveOwner(&gIOBufSlots, &pPool->slotOwner);
+
+    munmap(pPool->pBase, pPool->nLength);
+    VmRESTFreeMemory(pPool->pSlots, REST_MEM_OTHER);
+    VmRESTFreeMemory(pPool, REST_MEM_OTHER);
+}
+
+uint32_t
+VmRESTGetIOBuffer(
+    PVMREST_IOBUF_POOL               pPool,
+    size_t                           dwSize,
+    void**                           ppBuffer
+    )
+{
+    uint32_t                         dwError = 0;
+    PVMREST_IOBUF_SLOT               pSlot = NULL;
+    PVMREST_IOBUF_FREE               pBlock = NULL;
+    uint32_t                         iClass = 0;
+
+    if (!ppBuffer || !dwSize)
+    {
+        dwError = EINVAL;
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
+    if (pPool && (dwSize <= VMREST_IOBUF_LARGE_SIZE))
+    {
+        pSlot = VmRESTIOBufGetThreadSlot(pPool);
+    }
+
+    if (pSlot)
+    {
+        while (gIOBufClassSize[iClass] < dwSize)
+        {
+            iClass++;
+        }
+
+        /**** Use bigger class when own class runs dry ****/
+        for (; iClass < VMREST_IOBUF_CLASS_COUNT; iClass++)
+        {
+            if (!pSlot->pLocal[iClass] && __atomic_load_n(&pSlot->pRemote[iClass], __ATOMIC_RELAXED))
+            {
+                pSlot->pLocal[iClass] = __atomic_exchange_n(&pSlot->pRemote[iClass], NULL, __ATOMIC_ACQUIRE);
+            }
+
+            pBlock = pSlot->pLocal[iClass];
+            if (pBlock)
+            {
+                pSlot->pLocal[iClass] = pBlock->pNext;
+                *ppBuffer = pBlock;
+                goto cleanup;
+            }
+        }
+    }
+
+    dwError = VmRESTAllocateMemoryNoZero(
+                  dwSize,
+                  ppBuffer,
+                  REST_MEM_RESPONSE
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+void
+VmRESTReleaseIOBuffer(
+    PVMREST_IOBUF_POOL               pPool,
+    void*                            pBuffer
+    )
+{
+    PVMREST_IOBUF_SLOT               pSlot = NULL;
+    PVMREST_IOBUF_FREE               pBlock = (PVMREST_IOBUF_FREE)pBuffer;
+    PVMREST_IOBUF_FREE               pHead = NULL;
+    PVMREST_IOBUF_SLOT               pOwnSlot = NULL;
+    size_t                           offset = 0;
+    uint32_t                         iClass = VMREST_IOBUF_CLASS_COUNT - 1;
+
+    if (!pBuffer)
+    {
+        return;
+    }
+
+    if (!pPool || ((char*)pBuffer < pPool->pBase) ||
+        ((char*)pBuffer >= (pPool->pBase + (pPool->nSlotBytes * pPool->nSlots))))
+    {
+        VmRESTFreeMemory(pBuffer, REST_MEM_RESPONSE);
+        return;
+    }
+
+    /**** Buffer goes back to slot it was carved for ****/
+    offset = (char*)pBuffer - pPool->pBase;
+    pSlot = &pPool->pSlots[offset / pPool->nSlotBytes];
+    offset = offset % pPool->nSlotBytes;
+    while (offset < pPool->classOffset[iClass])
+    {
+        iClass--;
+    }
+
+    VmRESTThreadSlotFind(&gIOBufSlots, &pPool->slotOwner, (PVOID*)&pOwnSlot);
+    if (pSlot == pOwnSlot)
+    {
+        pBlock->pNext = pSlot->pLocal[iClass];
+        pSlot->pLocal[iClass] = pBlock;
+    }
+    else
+    {
+        pHead = __atomic_load_n(&pSlot->pRemote[iClass], __ATOMIC_RELAXED);
+        do
+        {
+            pBlock->pNext = pHead;
+        } while (!__atomic_compare_exchange_n(&pSlot->pRemote[iClass], &pHead, pBlock, TRUE, __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
+}
+
+uint32_t
+VmRESTGetIOBufferRegion(
+    PVMREST_IOBUF_POOL               pPool,
+    void**                           ppBase,
+    size_t*                          pLength
+    )
+{
+    uint32_t                         dwError = 0;
+
+    if (!pPool || !ppBase || !pLength)
+    {
+        dwError = EINVAL;
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
+    *ppBase = pPool->pBase;
+    *pLength = pPool->nLength;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
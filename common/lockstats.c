@@ -0,0 +1,483 @@
+/* C-REST-Engine
+*
+* Copyright (c) 2017 VMware, Inc. All Rights Reserved.
+*
+* This product is licensed to you under the Apache 2.0 license (the "License").
+* You may not use this product except in compliance with the Apache 2.0 License.
+*
+* This product may include a number of subcomponents with separate copyright
+* notices and license terms. Your use of these subcomponents is subject to the
+* terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+*
+*/
+
+#include "includes.h"
+
+/**** Updated by any thread with relaxed atomics, sized to a multiple of a cache line ****/
+typedef struct _VMREST_LOCK_SHARD
+{
+    uint64_t                         nAcquired;
+    uint64_t                         nContended;
+    uint64_t                         sumWaitNs;
+    uint64_t                         maxWaitNs;
+    uint64_t                         nHeld;
+    uint64_t                         sumHoldNs;
+    uint64_t                         maxHoldNs;
+    uint64_t                         waitHist[VMREST_LOCK_HIST_BUCKETS];
+    uint64_t                         holdHist[VMREST_LOCK_HIST_BUCKETS];
+    char                             pad[8];
+} VMREST_LOCK_SHARD, *PVMREST_LOCK_SHARD;
+
+/**** File name is compared by pointer, it comes from __FILE__ ****/
+typedef struct _VMREST_LOCK_SITE
+{
+    const char*                      pszFile;
+    int                              line;
+    uint64_t                         nContended;
+    uint64_t                         sumWaitNs;
+} VMREST_LOCK_SITE, *PVMREST_LOCK_SITE;
+
+/**** Classes are never freed, locks of a finished instance may still point to them ****/
+typedef struct _VMREST_LOCK_CLASS
+{
+    char                             szName[VMREST_LOCK_NAME_LEN];
+    VMREST_LOCK_SHARD                shard[VMREST_LOCK_SHARDS];
+    pthread_mutex_t                  siteMutex;
+    uint32_t                         nSites;
+    VMREST_LOCK_SITE                 site[VMREST_LOCK_MAX_SITES];
+} VMREST_LOCK_CLASS;
+
+uint32_t                             gVmRESTLockProfiling = 0;
+
+static __thread uint32_t             gLockShardIdx = VMREST_LOCK_SHARDS;
+
+static pthread_mutex_t               gLockMutex = PTHREAD_MUTEX_INITIALIZER;
+static PVMREST_LOCK_CLASS            gpLockClass[VMREST_LOCK_MAX_CLASSES];
+static uint32_t                      gnLockClasses = 0;
+static uint32_t                      gLockNextShard = 0;
+
+/**** Bucket 0 is 0 ns, bucket i is [2^(i-1), 2^i) ns ****/
+static
+uint32_t
+VmRESTLockBucketOf(
+    uint64_t                         ns
+    )
+{
+    uint32_t                         idx = 0;
+
+    if (ns == 0)
+    {
+        return 0;
+    }
+
+    idx = 64 - __builtin_clzll(ns);
+
+    return (idx < VMREST_LOCK_HIST_BUCKETS) ? idx : (VMREST_LOCK_HIST_BUCKETS - 1);
+}
+
+static
+uint64_t
+VmRESTLockQuantile(
+    uint64_t*                        pHist,
+    uint64_t                         nCount,
+    uint64_t                         max,
+    uint32_t                         percent
+    )
+{
+    uint64_t                         nTarget = 0;
+    uint64_t                         nSeen = 0;
+    uint64_t                         upper = 0;
+    uint32_t                         idx = 0;
+
+    if (nCount == 0)
+    {
+        return 0;
+    }
+
+    nTarget = ((nCount * percent) + 99) / 100;
+
+    for (idx = 0; idx < VMREST_LOCK_HIST_BUCKETS - 1; idx++)
+    {
+        nSeen += pHist[idx];
+        if (nSeen >= nTarget)
+        {
+            break;
+        }
+    }
+
+    upper = (idx == 0) ? 0 : ((1ULL << idx) - 1);
+
+    return (upper < max) ? upper : max;
+}
+
+/**** Threads are spread over shards round robin, a shard may have several writers ****/
+static
+PVMREST_LOCK_SHARD
+VmRESTLockGetShard(
+    PVMREST_LOCK_CLASS               pClass
+    )
+{
+    if (gLockShardIdx >= VMREST_LOCK_SHARDS)
+    {
+        gLockShardIdx = __atomic_fetch_add(&gLockNextShard, 1, __ATOMIC_RELAXED) % VMREST_LOCK_SHARDS;
+    }
+
+    return &pClass->shard[gLockShardIdx];
+}
+
+static
+void
+VmRESTLockStoreMax(
+    uint64_t*                        pMax,
+    uint64_t                         value
+    )
+{
+    uint64_t                         max = __atomic_load_n(pMax, __ATOMIC_RELAXED);
+
+    while ((value > max) &&
+           !__atomic_compare_exchange_n(pMax, &max, value, FALSE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+/**** Called on contended path only, lock being waited for is already taken ****/
+static
+void
+VmRESTLockRecordSite(
+    PVMREST_LOCK_CLASS               pClass,
+    const char*                      pszFile,
+    int                              line,
+    uint64_t                         waitNs
+    )
+{
+    PVMREST_LOCK_SITE                pSite = NULL;
+    uint32_t                         idx = 0;
+
+    pthread_mutex_lock(&pClass->siteMutex);
+
+    for (idx = 0; idx < pClass->nSites; idx++)
+    {
+        if ((pClass->site[idx].pszFile == pszFile) && (pClass->site[idx].line == line))
+        {
+            pSite = &pClass->site[idx];
+            break;
+        }
+    }
+
+    if (!pSite && (pClass->nSites < VMREST_LOCK_MAX_SITES))
+    {
+        pSite = &pClass->site[pClass->nSites++];
+        pSite->pszFile = pszFile;
+        pSite->line = line;
+    }
+
+    if (pSite)
+    {
+        pSite->nContended++;
+        pSite->sumWaitNs += waitNs;
+    }
+
+    pthread_mutex_unlock(&pClass->siteMutex);
+}
+
+PVMREST_LOCK_CLASS
+VmRESTLockGetClass(
+    const char*                      pszName
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    PVMREST_LOCK_CLASS               pClass = NULL;
+    PVMREST_LOCK_CLASS               pNewClass = NULL;
+    uint32_t                         idx = 0;
+
+    if (IsNullOrEmptyString(pszName))
+    {
+        pszName = VMREST_LOCK_NAME_OTHER;
+    }
+
+    pthread_mutex_lock(&gLockMutex);
+
+    for (idx = 0; idx < gnLockClasses; idx++)
+    {
+        if (strncmp(gpLockClass[idx]->szName, pszName, VMREST_LOCK_NAME_LEN - 1) == 0)
+        {
+            pClass = gpLockClass[idx];
+            break;
+        }
+    }
+
+    if (!pClass && (gnLockClasses < VMREST_LOCK_MAX_CLASSES))
+    {
+        dwError = VmRESTAllocateMemory(
+                      sizeof(VMREST_LOCK_CLASS),
+                      (PVOID*)&pNewClass,
+                      REST_MEM_OTHER
+                      );
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        snprintf(pNewClass->szName, sizeof(pNewClass->szName), "%s", pszName);
+
+        dwError = pthread_mutex_init(&pNewClass->siteMutex, NULL);
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        gpLockClass[gnLockClasses++] = pNewClass;
+        pClass = pNewClass;
+        pNewClass = NULL;
+    }
+
+    /**** Out of classes, lock is counted with unnamed ones if they have one ****/
+    for (idx = 0; !pClass && (idx < gnLockClasses); idx++)
+    {
+        if (strcmp(gpLockClass[idx]->szName, VMREST_LOCK_NAME_OTHER) == 0)
+        {
+            pClass = gpLockClass[idx];
+        }
+    }
+
+cleanup:
+
+    pthread_mutex_unlock(&gLockMutex);
+
+    return pClass;
+
+error:
+
+    if (pNewClass)
+    {
+        VmRESTFreeMemory(pNewClass, REST_MEM_OTHER);
+        pNewClass = NULL;
+    }
+
+    goto cleanup;
+}
+
+void
+VmRESTLockProfilingEnable(
+    void
+    )
+{
+    __atomic_store_n(&gVmRESTLockProfiling, 1, __ATOMIC_RELAXED);
+}
+
+void
+VmRESTLockRecordAcquire(
+    PVMREST_LOCK_CLASS               pClass,
+    uint64_t                         waitNs,
+    BOOLEAN                          bContended,
+    const char*                      pszFile,
+    int                              line
+    )
+{
+    PVMREST_LOCK_SHARD               pShard = NULL;
+
+    if (!pClass)
+    {
+        return;
+    }
+
+    pShard = VmRESTLockGetShard(pClass);
+
+    __atomic_fetch_add(&pShard->nAcquired, 1, __ATOMIC_RELAXED);
+
+    /**** Uncontended ones are the 0 ns bucket, worked out when stats are read ****/
+    if (bContended)
+    {
+        __atomic_fetch_add(&pShard->waitHist[VmRESTLockBucketOf(waitNs)], 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&pShard->nContended, 1, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&pShard->sumWaitNs, waitNs, __ATOMIC_RELAXED);
+        VmRESTLockStoreMax(&pShard->maxWaitNs, waitNs);
+
+        if (pszFile)
+        {
+            VmRESTLockRecordSite(pClass, pszFile, line, waitNs);
+        }
+    }
+}
+
+void
+VmRESTLockRecordHold(
+    PVMREST_LOCK_CLASS               pClass,
+    uint64_t                         holdNs
+    )
+{
+    PVMREST_LOCK_SHARD               pShard = NULL;
+
+    if (!pClass)
+    {
+        return;
+    }
+
+    pShard = VmRESTLockGetShard(pClass);
+
+    __atomic_fetch_add(&pShard->nHeld, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&pShard->sumHoldNs, holdNs, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&pShard->holdHist[VmRESTLockBucketOf(holdNs)], 1, __ATOMIC_RELAXED);
+    VmRESTLockStoreMax(&pShard->maxHoldNs, holdNs);
+}
+
+/**** Caller must hold gLockMutex ****/
+static
+void
+VmRESTLockFillStats(
+    PVMREST_LOCK_CLASS               pClass,
+    PREST_LOCK_STATS                 pStats
+    )
+{
+    PVMREST_LOCK_SHARD               pShard = NULL;
+    VMREST_LOCK_SITE                 site[VMREST_LOCK_MAX_SITES];
+    VMREST_LOCK_SITE                 swap = {0};
+    const char*                      pszBase = NULL;
+    uint32_t                         nSites = 0;
+    uint32_t                         iShard = 0;
+    uint32_t                         idx = 0;
+    uint32_t                         iNext = 0;
+
+    memset(pStats, 0, sizeof(*pStats));
+    snprintf(pStats->szName, sizeof(pStats->szName), "%s", pClass->szName);
+
+    for (iShard = 0; iShard < VMREST_LOCK_SHARDS; iShard++)
+    {
+        pShard = &pClass->shard[iShard];
+
+        pStats->nAcquired += __atomic_load_n(&pShard->nAcquired, __ATOMIC_RELAXED);
+        pStats->nContended += __atomic_load_n(&pShard->nContended, __ATOMIC_RELAXED);
+        pStats->sumWaitNs += __atomic_load_n(&pShard->sumWaitNs, __ATOMIC_RELAXED);
+        pStats->nHeld += __atomic_load_n(&pShard->nHeld, __ATOMIC_RELAXED);
+        pStats->sumHoldNs += __atomic_load_n(&pShard->sumHoldNs, __ATOMIC_RELAXED);
+        if (pShard->maxWaitNs > pStats->maxWaitNs)
+        {
+            pStats->maxWaitNs = pShard->maxWaitNs;
+        }
+        if (pShard->maxHoldNs > pStats->maxHoldNs)
+        {
+            pStats->maxHoldNs = pShard->maxHoldNs;
+        }
+        for (idx = 0; idx < VMREST_LOCK_HIST_BUCKETS; idx++)
+        {
+            pStats->waitHist[idx] += __atomic_load_n(&pShard->waitHist[idx], __ATOMIC_RELAXED);
+            pStats->holdHist[idx] += __atomic_load_n(&pShard->holdHist[idx], __ATOMIC_RELAXED);
+        }
+    }
+
+    /**** Counters are read while other threads update them ****/
+    if (pStats->nAcquired > pStats->nContended)
+    {
+        pStats->waitHist[0] += pStats->nAcquired - pStats->nContended;
+    }
+
+    pStats->p99WaitNs = VmRESTLockQuantile(pStats->waitHist, pStats->nAcquired, pStats->maxWaitNs, 99);
+    pStats->p99HoldNs = VmRESTLockQuantile(pStats->holdHist, pStats->nHeld, pStats->maxHoldNs, 99);
+
+    pthread_mutex_lock(&pClass->siteMutex);
+    nSites = pClass->nSites;
+    memcpy(site, pClass->site, nSites * sizeof(site[0]));
+    pthread_mutex_unlock(&pClass->siteMutex);
+
+    /**** Partial selection sort, only top waiters are needed ****/
+    for (idx = 0; (idx < nSites) && (idx < VMREST_LOCK_TOP_WAITERS); idx++)
+    {
+        for (iNext = idx + 1; iNext < nSites; iNext++)
+        {
+            if (site[iNext].sumWaitNs > site[idx].sumWaitNs)
+            {
+                swap = site[idx];
+                site[idx] = site[iNext];
+                site[iNext] = swap;
+            }
+        }
+
+        pszBase = strrchr(site[idx].pszFile, '/');
+        pszBase = pszBase ? (pszBase + 1) : site[idx].pszFile;
+
+        snprintf(
+            pStats->waiter[idx].szSite,
+            VMREST_LOCK_SITE_LEN,
+            "%s:%d",
+            pszBase,
+            site[idx].line
+            );
+        pStats->waiter[idx].nContended = site[idx].nContended;
+        pStats->waiter[idx].sumWaitNs = site[idx].sumWaitNs;
+        pStats->nWaiters++;
+    }
+}
+
+uint32_t
+VmRESTLockGetStats(
+    PREST_LOCK_STATS                 pStats,
+    uint32_t                         nMax,
+    uint32_t*                        pnCount
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    PREST_LOCK_STATS                 pAll = NULL;
+    REST_LOCK_STATS                  swap;
+    uint32_t                         nClasses = 0;
+    uint32_t                         idx = 0;
+    uint32_t                         iNext = 0;
+
+    if (!pnCount)
+    {
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pthread_mutex_lock(&gLockMutex);
+    nClasses = gnLockClasses;
+
+    if (!pStats || (nMax == 0) || (nClasses == 0))
+    {
+        pthread_mutex_unlock(&gLockMutex);
+        *pnCount = nClasses;
+        goto cleanup;
+    }
+
+    dwError = VmRESTAllocateMemory(
+                  nClasses * sizeof(REST_LOCK_STATS),
+                  (PVOID*)&pAll,
+                  REST_MEM_OTHER
+                  );
+    if (dwError)
+    {
+        pthread_mutex_unlock(&gLockMutex);
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    for (idx = 0; idx < nClasses; idx++)
+    {
+        VmRESTLockFillStats(gpLockClass[idx], &pAll[idx]);
+    }
+
+    pthread_mutex_unlock(&gLockMutex);
+
+    /**** Most waited for lock first ****/
+    for (idx = 0; (idx < nClasses) && (idx < nMax); idx++)
+    {
+        for (iNext = idx + 1; iNext < nClasses; iNext++)
+        {
+            if (pAll[iNext].sumWaitNs > pAll[idx].sumWaitNs)
+            {
+                swap = pAll[idx];
+                pAll[idx] = pAll[iNext];
+                pAll[iNext] = swap;
+            }
+        }
+        pStats[idx] = pAll[idx];
+    }
+
+    *pnCount = idx;
+
+cleanup:
+
+    if (pAll)
+    {
+        VmRESTFreeMemory(pAll, REST_MEM_OTHER);
+        pAll = NULL;
+    }
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
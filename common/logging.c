@@ -17,6 +17,87 @@
 #define EXTRA_LOG_MESSAGE_LEN 128
 #define MAX_LOG_MESSAGE_LEN   4096
 
+/**** A thread keeps rings of this many handles at a time, beyond that it logs synchronously ****/
+#define VMREST_LOG_THREAD_RINGS              4
+/**** Flusher wakes at least this often, producers wake it early once their ring is half full ****/
+#define VMREST_LOG_FLUSH_INTERVAL_MS         20
+/**** Producer waiting on a full ring looks again after this long ****/
+#define VMREST_LOG_FULL_WAIT_US              100
+/**** Record length marking unused end of ring, consumer goes on at ring start ****/
+#define VMREST_LOG_RECORD_WRAP               ((uint32_t)-1)
+#define VMREST_LOG_RECORD_BYTES(nLen) \
+    ((sizeof(VMREST_LOG_RECORD) + (nLen) + 7) & ~((uint32_t)7))
+/**** Rings snapshotted under logger mutex at a time ****/
+#define VMREST_LOG_BATCH_RINGS               32
+/**** Flusher formats lines here and hands them to one write() per drain ****/
+#define VMREST_LOG_WRITE_BYTES               (64 * 1024)
+#define VMREST_LOG_LINE_FORMAT               "%s:%lu t@%lu %-3.7s: %.*s\n"
+
+typedef struct _VMREST_LOG_TIME_CACHE
+{
+    time_t                           sec;
+    char                             szTime[EXTRA_LOG_MESSAGE_LEN];
+} VMREST_LOG_TIME_CACHE, *PVMREST_LOG_TIME_CACHE;
+
+/**** Formatted message follows header, not NUL terminated ****/
+typedef struct _VMREST_LOG_RECORD
+{
+    uint32_t                         nLen;
+    uint32_t                         level;
+    struct timeval                   tv;
+    unsigned long                    threadId;
+} VMREST_LOG_RECORD, *PVMREST_LOG_RECORD;
+
+/**** Owning thread produces, flusher consumes. head and tail are free running
+      byte counters, size is a power of two. Flusher frees ring once owner has
+      exited and ring is written out. ****/
+typedef struct _VMREST_LOG_RING
+{
+    uint32_t                         head;
+    char                             pad0[60];
+    uint32_t                         tail;
+    char                             pad1[60];
+    uint64_t                         nDropped;
+    uint32_t                         bThreadGone;
+    uint32_t                         nBytes;
+    BOOLEAN                          bDrained;
+    char*                            pData;
+    struct _VMREST_LOG_RING*         pNext;
+} VMREST_LOG_RING, *PVMREST_LOG_RING;
+
+typedef struct _VMREST_LOGGER
+{
+    VMREST_THREAD_SLOT_OWNER         slotOwner;
+    PVMREST_HANDLE                   pRESTHandle;
+    PVMREST_MUTEX                    pMutex;
+    PVMREST_COND                     pCond;
+    VMREST_THREAD                    thread;
+    BOOLEAN                          bThreadStarted;
+    uint32_t                         bShutdown;
+    uint32_t                         nRingBytes;
+    BOOLEAN                          bBlockWhenFull;
+    PVMREST_LOG_RING                 pRings;
+    VMREST_LOG_TIME_CACHE            timeCache;
+    char*                            pszOut;
+    uint32_t                         nOut;
+} VMREST_LOGGER;
+
+/**** Mutex only guards ring list. Flusher takes rings with their head under it,
+      then formats and writes with mutex released. Only flusher unlinks and
+      frees rings, so a ring and its pNext stay valid for it meanwhile. ****/
+typedef struct _VMREST_LOG_BATCH
+{
+    PVMREST_LOG_RING                 pRing[VMREST_LOG_BATCH_RINGS];
+    uint32_t                         head[VMREST_LOG_BATCH_RINGS];
+    uint32_t                         bGone[VMREST_LOG_BATCH_RINGS];
+    uint32_t                         nRings;
+} VMREST_LOG_BATCH, *PVMREST_LOG_BATCH;
+
+/**** Used by threads writing synchronously ****/
+static __thread VMREST_LOG_TIME_CACHE gLogTimeCache;
+
+__thread uint64_t                    gVmRESTLogTraceId = 0;
+
 static const char *
 logLevelToTag(
     int                              level
@@ -28,6 +109,533 @@ logLevelToSysLogLevel(
     int                              level
     );
 
+/**** strftime and localtime only when second changes ****/
+static
+const char*
+VmRESTLogTimestamp(
+    PVMREST_LOG_TIME_CACHE           pCache,
+    time_t                           sec
+    )
+{
+    struct tm                        tmInfo = {0};
+
+    if ((pCache->sec != sec) || (pCache->szTime[0] == '\0'))
+    {
+        localtime_r(&sec, &tmInfo);
+        strftime(pCache->szTime, sizeof(pCache->szTime) - 1, "%F %T", &tmInfo);
+        pCache->sec = sec;
+    }
+
+    return pCache->szTime;
+}
+
+static
+void
+VmRESTLogWriteLine(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVMREST_LOG_TIME_CACHE           pCache,
+    int                              level,
+    const struct timeval*            pTv,
+    unsigned long                    threadId,
+    const char*                      pszMessage,
+    uint32_t                         nLen
+    )
+{
+    const char*                      logLevelTag = logLevelToTag(level);
+    const char*                      pszTime = VmRESTLogTimestamp(pCache, pTv->tv_sec);
+
+    if (pRESTHandle->pRESTConfig->useSysLog)
+    {
+        syslog(logLevelToSysLogLevel(level), VMREST_LOG_LINE_FORMAT, pszTime, (long unsigned)(pTv->tv_usec), threadId, (logLevelTag? logLevelTag : "UNKNOWN"), (int)nLen, pszMessage);
+    }
+    else if (pRESTHandle->logFile != NULL)
+    {
+        fprintf(pRESTHandle->logFile, VMREST_LOG_LINE_FORMAT, pszTime, (long unsigned)(pTv->tv_usec), threadId, (logLevelTag? logLevelTag : "UNKNOWN"), (int)nLen, pszMessage);
+    }
+}
+
+/**** Ring of exiting thread is freed by flusher once drained ****/
+static
+VOID
+VmRESTLogReleaseRing(
+    PVOID                            pSlot
+    )
+{
+    __atomic_store_n(&((PVMREST_LOG_RING)pSlot)->bThreadGone, 1, __ATOMIC_RELEASE);
+}
+
+static VMREST_THREAD_SLOT_REGISTRY   gLogSlots =
+    VMREST_THREAD_SLOT_REGISTRY_INIT(VMREST_LOG_THREAD_RINGS, &VmRESTLogReleaseRing);
+
+/**** Returns NULL when thread can not have a ring, caller then logs synchronously ****/
+static
+PVMREST_LOG_RING
+VmRESTLogGetThreadRing(
+    PVMREST_LOGGER                   pLogger
+    )
+{
+    PVMREST_LOG_RING                 pRing = NULL;
+
+    if (VmRESTThreadSlotFind(&gLogSlots, &pLogger->slotOwner, (PVOID*)&pRing))
+    {
+        return pRing;
+    }
+
+    /**** First log of this thread on this handle ****/
+    if (!VmRESTThreadSlotPrepare(&gLogSlots))
+    {
+        return NULL;
+    }
+
+    if (VmRESTAllocateMemory(sizeof(VMREST_LOG_RING) + pLogger->nRingBytes, (PVOID*)&pRing, REST_MEM_LOG) == 0)
+    {
+        pRing->nBytes = pLogger->nRingBytes;
+        pRing->pData = (char*)(pRing + 1);
+
+        VmRESTLockMutex(pLogger->pMutex);
+        pRing->pNext = pLogger->pRings;
+        pLogger->pRings = pRing;
+        VmRESTUnlockMutex(pLogger->pMutex);
+    }
+
+    /**** Remember failed allocation as well, thread then stays synchronous ****/
+    VmRESTThreadSlotClaim(&gLogSlots, &pLogger->slotOwner, pRing);
+
+    return pRing;
+}
+
+static
+void
+VmRESTLogRingPut(
+    PVMREST_LOGGER                   pLogger,
+    PVMREST_LOG_RING                 pRing,
+    int                              level,
+    const struct timeval*            pTv,
+    const char*                      pszMessage,
+    uint32_t                         nLen
+    )
+{
+    PVMREST_LOG_RECORD               pRecord = NULL;
+    uint32_t                         nRecord = VMREST_LOG_RECORD_BYTES(nLen);
+    uint32_t                         head = 0;
+    uint32_t                         tail = 0;
+    uint32_t                         offset = 0;
+    uint32_t                         nEnd = 0;
+    uint32_t                         nNeed = 0;
+
+    for (;;)
+    {
+        head = __atomic_load_n(&pRing->head, __ATOMIC_RELAXED);
+        tail = __atomic_load_n(&pRing->tail, __ATOMIC_ACQUIRE);
+        offset = head & (pRing->nBytes - 1);
+        nEnd = pRing->nBytes - offset;
+
+        /**** Record never straddles ring end, rest of ring is skipped instead ****/
+        nNeed = nRecord + ((nEnd < nRecord) ? nEnd : 0);
+        if ((pRing->nBytes - (head - tail)) >= nNeed)
+        {
+            break;
+        }
+
+        if (!pLogger->bBlockWhenFull || __atomic_load_n(&pLogger->bShutdown, __ATOMIC_ACQUIRE))
+        {
+            __atomic_fetch_add(&pRing->nDropped, 1, __ATOMIC_RELAXED);
+            return;
+        }
+
+        VmRESTConditionSignal(pLogger->pCond);
+        usleep(VMREST_LOG_FULL_WAIT_US);
+    }
+
+    if (nEnd < nRecord)
+    {
+        ((PVMREST_LOG_RECORD)(pRing->pData + offset))->nLen = VMREST_LOG_RECORD_WRAP;
+        head += nEnd;
+        offset = 0;
+    }
+
+    pRecord = (PVMREST_LOG_RECORD)(pRing->pData + offset);
+    pRecord->nLen = nLen;
+    pRecord->level = level;
+    pRecord->tv = *pTv;
+    pRecord->threadId = (unsigned long)pthread_self();
+    memcpy(pRecord + 1, pszMessage, nLen);
+
+    __atomic_store_n(&pRing->head, head + nRecord, __ATOMIC_RELEASE);
+
+    if ((head + nRecord - tail) > (pRing->nBytes / 2))
+    {
+        VmRESTConditionSignal(pLogger->pCond);
+    }
+}
+
+/**** Flusher only. Hands formatted lines to log file, partial writes go on
+      where they stopped. ****/
+static
+void
+VmRESTLogFlushOut(
+    PVMREST_LOGGER                   pLogger
+    )
+{
+    FILE*                            logFile = pLogger->pRESTHandle->logFile;
+    uint32_t                         nWritten = 0;
+    ssize_t                          nRet = 0;
+
+    while (logFile && (nWritten < pLogger->nOut))
+    {
+        nRet = write(fileno(logFile), pLogger->pszOut + nWritten, pLogger->nOut - nWritten);
+        if (nRet < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            break;
+        }
+        nWritten += nRet;
+    }
+
+    pLogger->nOut = 0;
+}
+
+/**** Flusher only, logger mutex not held ****/
+static
+void
+VmRESTLogFlusherLine(
+    PVMREST_LOGGER                   pLogger,
+    int                              level,
+    const struct timeval*            pTv,
+    unsigned long                    threadId,
+    const char*                      pszMessage,
+    uint32_t                         nLen
+    )
+{
+    const char*                      logLevelTag = NULL;
+    const char*                      pszTime = NULL;
+    uint32_t                         nLine = 0;
+    int                              nRet = 0;
+
+    if (pLogger->pRESTHandle->pRESTConfig->useSysLog)
+    {
+        VmRESTLogWriteLine(pLogger->pRESTHandle, &pLogger->timeCache, level, pTv, threadId, pszMessage, nLen);
+        return;
+    }
+
+    logLevelTag = logLevelToTag(level);
+    pszTime = VmRESTLogTimestamp(&pLogger->timeCache, pTv->tv_sec);
+
+    /**** Longest line is message plus prefix, well below buffer size ****/
+    nLine = nLen + EXTRA_LOG_MESSAGE_LEN + 64;
+    if ((VMREST_LOG_WRITE_BYTES - pLogger->nOut) < nLine)
+    {
+        VmRESTLogFlushOut(pLogger);
+    }
+
+    nRet = snprintf(
+               pLogger->pszOut + pLogger->nOut,
+               VMREST_LOG_WRITE_BYTES - pLogger->nOut,
+               VMREST_LOG_LINE_FORMAT,
+               pszTime,
+               (long unsigned)(pTv->tv_usec),
+               threadId,
+               (logLevelTag? logLevelTag : "UNKNOWN"),
+               (int)nLen,
+               pszMessage
+               );
+    if (nRet > 0)
+    {
+        pLogger->nOut += ((uint32_t)nRet < (VMREST_LOG_WRITE_BYTES - pLogger->nOut)) ?
+                             (uint32_t)nRet : (VMREST_LOG_WRITE_BYTES - pLogger->nOut - 1);
+    }
+}
+
+/**** Flusher only, holding logger mutex. Takes up to a batch of rings with
+      something to write, starting at *ppRing, and unlinks rings written out
+      after their owner had gone into *ppFree. Returns link to go on from,
+      NULL at end of list. ****/
+static
+PVMREST_LOG_RING*
+VmRESTLogSnapshot(
+    PVMREST_LOG_RING*                ppRing,
+    PVMREST_LOG_BATCH                pBatch,
+    PVMREST_LOG_RING*                ppFree
+    )
+{
+    PVMREST_LOG_RING                 pRing = NULL;
+    uint32_t                         bGone = 0;
+    uint32_t                         head = 0;
+
+    pBatch->nRings = 0;
+
+    while (*ppRing && (pBatch->nRings < VMREST_LOG_BATCH_RINGS))
+    {
+        pRing = *ppRing;
+
+        if (pRing->bDrained)
+        {
+            *ppRing = pRing->pNext;
+            pRing->pNext = *ppFree;
+            *ppFree = pRing;
+            continue;
+        }
+
+        /**** Owner marks ring gone after its last record, so look at flag first ****/
+        bGone = __atomic_load_n(&pRing->bThreadGone, __ATOMIC_ACQUIRE);
+        head = __atomic_load_n(&pRing->head, __ATOMIC_ACQUIRE);
+
+        if ((head != pRing->tail) || bGone || __atomic_load_n(&pRing->nDropped, __ATOMIC_RELAXED))
+        {
+            pBatch->pRing[pBatch->nRings] = pRing;
+            pBatch->head[pBatch->nRings] = head;
+            pBatch->bGone[pBatch->nRings] = bGone;
+            pBatch->nRings++;
+        }
+
+        ppRing = &pRing->pNext;
+    }
+
+    return *ppRing ? ppRing : NULL;
+}
+
+/**** Flusher only, logger mutex not held. Returns records taken from rings. ****/
+static
+uint32_t
+VmRESTLogWriteBatch(
+    PVMREST_LOGGER                   pLogger,
+    PVMREST_LOG_BATCH                pBatch
+    )
+{
+    PVMREST_LOG_RING                 pRing = NULL;
+    PVMREST_LOG_RECORD               pRecord = NULL;
+    uint32_t                         idx = 0;
+    uint32_t                         tail = 0;
+    uint32_t                         offset = 0;
+    uint32_t                         nRecords = 0;
+    uint64_t                         nDropped = 0;
+    struct timeval                   tv = {0};
+    char                             szDropped[EXTRA_LOG_MESSAGE_LEN];
+
+    for (idx = 0; idx < pBatch->nRings; idx++)
+    {
+        pRing = pBatch->pRing[idx];
+        tail = pRing->tail;
+
+        while (tail != pBatch->head[idx])
+        {
+            offset = tail & (pRing->nBytes - 1);
+            pRecord = (PVMREST_LOG_RECORD)(pRing->pData + offset);
+            if (pRecord->nLen == VMREST_LOG_RECORD_WRAP)
+            {
+                tail += pRing->nBytes - offset;
+                continue;
+            }
+
+            VmRESTLogFlusherLine(
+                pLogger,
+                pRecord->level,
+                &pRecord->tv,
+                pRecord->threadId,
+                (const char*)(pRecord + 1),
+                pRecord->nLen
+                );
+            nRecords++;
+            tail += VMREST_LOG_RECORD_BYTES(pRecord->nLen);
+        }
+
+        /**** Lines are copied out, owner can reuse space right away ****/
+        __atomic_store_n(&pRing->tail, tail, __ATOMIC_RELEASE);
+
+        nDropped = __atomic_exchange_n(&pRing->nDropped, 0, __ATOMIC_RELAXED);
+        if (nDropped)
+        {
+            gettimeofday(&tv, NULL);
+            snprintf(szDropped, sizeof(szDropped), "C-REST-ENGINE: %lu log records dropped, log ring full", (unsigned long)nDropped);
+            VmRESTLogFlusherLine(
+                pLogger,
+                VMREST_LOG_LEVEL_WARNING,
+                &tv,
+                (unsigned long)pthread_self(),
+                szDropped,
+                strlen(szDropped)
+                );
+            nRecords++;
+        }
+
+        if (pBatch->bGone[idx])
+        {
+            pRing->bDrained = TRUE;
+        }
+    }
+
+    return nRecords;
+}
+
+/**** Flusher only, logger mutex not held. Returns records written. ****/
+static
+uint32_t
+VmRESTLogDrain(
+    PVMREST_LOGGER                   pLogger
+    )
+{
+    PVMREST_LOG_RING*                ppRing = &pLogger->pRings;
+    PVMREST_LOG_RING                 pFree = NULL;
+    PVMREST_LOG_RING                 pRing = NULL;
+    VMREST_LOG_BATCH                 batch;
+    uint32_t                         nRecords = 0;
+
+    while (ppRing)
+    {
+        VmRESTLockMutex(pLogger->pMutex);
+        ppRing = VmRESTLogSnapshot(ppRing, &batch, &pFree);
+        VmRESTUnlockMutex(pLogger->pMutex);
+
+        nRecords += VmRESTLogWriteBatch(pLogger, &batch);
+    }
+
+    VmRESTLogFlushOut(pLogger);
+
+    while (pFree)
+    {
+        pRing = pFree;
+        pFree = pRing->pNext;
+        VmRESTFreeMemory(pRing, REST_MEM_LOG);
+    }
+
+    return nRecords;
+}
+
+static
+DWORD
+VmRESTLogFlusherThreadProc(
+    PVOID                            pData
+    )
+{
+    PVMREST_LOGGER                   pLogger = (PVMREST_LOGGER)pData;
+
+    while (!__atomic_load_n(&pLogger->bShutdown, __ATOMIC_ACQUIRE))
+    {
+        if (VmRESTLogDrain(pLogger) == 0)
+        {
+            /**** Shutdown is set under mutex, look again before sleeping ****/
+            VmRESTLockMutex(pLogger->pMutex);
+            if (!__atomic_load_n(&pLogger->bShutdown, __ATOMIC_ACQUIRE))
+            {
+                VmRESTConditionTimedWait(pLogger->pCond, pLogger->pMutex, VMREST_LOG_FLUSH_INTERVAL_MS);
+            }
+            VmRESTUnlockMutex(pLogger->pMutex);
+        }
+    }
+
+    /**** Whatever was queued before shutdown ****/
+    VmRESTLogDrain(pLogger);
+
+    return 0;
+}
+
+static
+void
+VmRESTLogFreeLogger(
+    PVMREST_LOGGER                   pLogger
+    )
+{
+    PVMREST_LOG_RING                 pRing = NULL;
+
+    VmRESTThreadSlotRemoveOwner(&gLogSlots, &pLogger->slotOwner);
+
+    if (pLogger->bThreadStarted)
+    {
+        VmRESTLockMutex(pLogger->pMutex);
+        __atomic_store_n(&pLogger->bShutdown, 1, __ATOMIC_RELEASE);
+        VmRESTConditionSignal(pLogger->pCond);
+        VmRESTUnlockMutex(pLogger->pMutex);
+
+        VmRESTThreadJoin(&pLogger->thread, NULL);
+    }
+
+    while (pLogger->pRings)
+    {
+        pRing = pLogger->pRings;
+        pLogger->pRings = pRing->pNext;
+        VmRESTFreeMemory(pRing, REST_MEM_LOG);
+    }
+
+    if (pLogger->pszOut)
+    {
+        VmRESTFreeMemory(pLogger->pszOut, REST_MEM_LOG);
+    }
+    if (pLogger->pCond)
+    {
+        VmRESTFreeCondition(pLogger->pCond);
+    }
+    if (pLogger->pMutex)
+    {
+        VmRESTFreeMutex(pLogger->pMutex);
+    }
+    VmRESTFreeMemory(pLogger, REST_MEM_LOG);
+}
+
+static
+uint32_t
+VmRESTLogCreateLogger(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVMREST_LOGGER*                  ppLogger
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    PVMREST_LOGGER                   pLogger = NULL;
+
+    dwError = VmRESTAllocateMemory(
+                  sizeof(VMREST_LOGGER),
+                  (PVOID*)&pLogger,
+                  REST_MEM_LOG
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pLogger->pRESTHandle = pRESTHandle;
+    pLogger->nRingBytes = pRESTHandle->pRESTConfig->nLogRingBytes;
+    pLogger->bBlockWhenFull = pRESTHandle->pRESTConfig->blockOnLogFull;
+
+    dwError = VmRESTAllocateNamedMutex(&pLogger->pMutex, "log");
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateCondition(&pLogger->pCond);
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateMemoryNoZero(
+                  VMREST_LOG_WRITE_BYTES,
+                  (PVOID*)&pLogger->pszOut,
+                  REST_MEM_LOG
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    VmRESTThreadSlotAddOwner(&gLogSlots, &pLogger->slotOwner);
+
+    dwError = VmRESTCreateThread(
+                  &pLogger->thread,
+                  FALSE,
+                  &VmRESTLogFlusherThreadProc,
+                  pLogger
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pLogger->bThreadStarted = TRUE;
+
+    *ppLogger = pLogger;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    if (pLogger)
+    {
+        VmRESTLogFreeLogger(pLogger);
+    }
+
+    goto cleanup;
+}
+
 uint32_t
 VmRESTLogInitialize(
     PVMREST_HANDLE                   pRESTHandle
@@ -51,6 +659,16 @@ VmRESTLogInitialize(
     }
     BAIL_ON_VMREST_ERROR(dwError);
 
+    /**** Writes go to flusher thread, request threads only copy into their ring ****/
+    if (pRESTHandle->pRESTConfig->useAsyncLog)
+    {
+        dwError = VmRESTLogCreateLogger(
+                      pRESTHandle,
+                      &pRESTHandle->pLogger
+                      );
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
 cleanup:
 
     return dwError;
@@ -66,6 +684,16 @@ VmRESTLogTerminate(
     PVMREST_HANDLE                   pRESTHandle
     )
 {
+    PVMREST_LOGGER                   pLogger = NULL;
+
+    if (pRESTHandle && pRESTHandle->pLogger)
+    {
+        /**** Later log calls go synchronous, flusher writes out what is queued ****/
+        pLogger = pRESTHandle->pLogger;
+        pRESTHandle->pLogger = NULL;
+        VmRESTLogFreeLogger(pLogger);
+    }
+
     if (pRESTHandle && pRESTHandle->logFile != NULL)
     {
        fclose(pRESTHandle->logFile);
@@ -80,45 +708,100 @@ VmRESTLog(
     const char*       fmt,
     ...)
 {
-    char        extraLogMessage[EXTRA_LOG_MESSAGE_LEN] = {0};
     char        logMessage[MAX_LOG_MESSAGE_LEN];
-    struct      tm* tm_info = NULL;
     struct      timeval tv = {0};
-	
     va_list     va;
-    const char* logLevelTag = "";
-    int sysLogLevel = 0;
+    int         nLen = 0;
+    int         nPrefix = 0;
+    PVMREST_LOGGER   pLogger = NULL;
+    PVMREST_LOG_RING pRing = NULL;
 
     if (!pRESTHandle || !pRESTHandle->pRESTConfig)
     {
         return;
     }
 
-    if (level <= pRESTHandle->debugLogLevel)
+    if ((level <= pRESTHandle->debugLogLevel) || VMREST_LOG_TRACED(pRESTHandle))
     {
+        /**** Tag lines of a traced request so they can be grepped out together ****/
+        if (VMREST_LOG_TRACED(pRESTHandle))
+        {
+            nPrefix = snprintf(logMessage, sizeof(logMessage), "[trace %llu] ", (unsigned long long)gVmRESTLogTraceId);
+        }
+
         va_start( va, fmt );
-        vsnprintf( logMessage, sizeof(logMessage), fmt, va );
+        nLen = vsnprintf( logMessage + nPrefix, sizeof(logMessage) - nPrefix, fmt, va );
         logMessage[sizeof(logMessage)-1] = '\0';
         va_end( va );
+        if (nLen < 0)
+        {
+            nLen = nPrefix;
+        }
+        else if ((nLen += nPrefix) >= (int)sizeof(logMessage))
+        {
+            nLen = sizeof(logMessage) - 1;
+        }
         gettimeofday(&tv, NULL);
 
-        tm_info = localtime(&tv.tv_sec);
-        logLevelTag = logLevelToTag(level);
-        strftime(extraLogMessage, sizeof(extraLogMessage) - 1, "%F %T", tm_info);   
+        pLogger = pRESTHandle->pLogger;
+        if (pLogger)
+        {
+            pRing = VmRESTLogGetThreadRing(pLogger);
+        }
 
-        if (pRESTHandle->pRESTConfig->useSysLog)
+        if (pRing)
         {
-            sysLogLevel = logLevelToSysLogLevel(level);
-            syslog(sysLogLevel, "%s:%lu t@%lu %-3.7s: %s\n", extraLogMessage, (long unsigned)(tv.tv_usec), (unsigned long) pthread_self(),(logLevelTag? logLevelTag : "UNKNOWN"),logMessage);
+            VmRESTLogRingPut(pLogger, pRing, level, &tv, logMessage, nLen);
         }
-        else if (pRESTHandle->logFile != NULL)
+        else
         {
-            fprintf(pRESTHandle->logFile, "%s:%lu t@%lu %-3.7s: %s\n", extraLogMessage, (long unsigned)(tv.tv_usec), (unsigned long) pthread_self(),(logLevelTag? logLevelTag : "UNKNOWN"),logMessage);
-            fflush( pRESTHandle->logFile );
+            VmRESTLogWriteLine(pRESTHandle, &gLogTimeCache, level, &tv, (unsigned long)pthread_self(), logMessage, nLen);
+            if (!pRESTHandle->pRESTConfig->useSysLog && (pRESTHandle->logFile != NULL))
+            {
+                fflush( pRESTHandle->logFile );
+            }
         }
     }
 }
 
+BOOLEAN
+VmRESTLogRateAllow(
+    PVMREST_LOG_RATE                 pRate,
+    uint32_t*                        pnSuppressed
+    )
+{
+    struct timespec                  ts = {0};
+    uint64_t                         windowSec = 0;
+    uint64_t                         nowSec = 0;
+
+    /**** Window is a whole second, tick resolution is plenty and reading it
+          costs no more than a memory load ****/
+#ifdef CLOCK_MONOTONIC_COARSE
+    clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+#else
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+#endif
+    nowSec = (uint64_t)ts.tv_sec;
+
+    /**** First caller in a new second opens window, racing callers may get a few extra in ****/
+    windowSec = __atomic_load_n(&pRate->windowSec, __ATOMIC_RELAXED);
+    if ((windowSec != nowSec) &&
+        __atomic_compare_exchange_n(&pRate->windowSec, &windowSec, nowSec, FALSE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+        __atomic_store_n(&pRate->nInWindow, 0, __ATOMIC_RELAXED);
+    }
+
+    if (__atomic_fetch_add(&pRate->nInWindow, 1, __ATOMIC_RELAXED) >= VMREST_LOG_RATE_BURST)
+    {
+        __atomic_fetch_add(&pRate->nSuppressed, 1, __ATOMIC_RELAXED);
+        return FALSE;
+    }
+
+    *pnSuppressed = __atomic_exchange_n(&pRate->nSuppressed, 0, __ATOMIC_RELAXED);
+
+    return TRUE;
+}
+
 static const char *
 logLevelToTag(
     int level
@@ -13,10 +13,490 @@
 
 #include "includes.h"
 
+/**** Block sizes engine allocates per request - packets, header nodes, data buffers, URI and request line ****/
+static const uint32_t                gMemClassSize[VMREST_MEMORY_SIZE_CLASS_COUNT] =
+{
+    64, 128, 256, 512, 1024, 2048, 4096, 8192, 11264, 16384
+};
+
+typedef struct _VMREST_MEM_FREE_BLOCK
+{
+    struct _VMREST_MEM_FREE_BLOCK*   pNext;
+} VMREST_MEM_FREE_BLOCK, *PVMREST_MEM_FREE_BLOCK;
+
+/**** Live bytes are a delta until published, blocks are often freed by another thread ****/
+typedef struct _VMREST_MEM_CATEGORY_COUNTERS
+{
+    uint64_t                         nAlloc;
+    uint64_t                         nFree;
+    uint64_t                         nAllocBytes;
+    int64_t                          liveDelta;
+} VMREST_MEM_CATEGORY_COUNTERS, *PVMREST_MEM_CATEGORY_COUNTERS;
+
+typedef struct _VMREST_MEM_DEBUG_BLOCK
+{
+    void*                            pMemory;
+    size_t                           dwSize;
+    REST_MEM_CATEGORY                category;
+    const char*                      pszFile;
+    int                              line;
+    struct _VMREST_MEM_DEBUG_BLOCK*  pNext;
+} VMREST_MEM_DEBUG_BLOCK, *PVMREST_MEM_DEBUG_BLOCK;
+
+typedef struct _VMREST_MEM_DEBUG_SITE
+{
+    const char*                      pszFile;
+    int                              line;
+    REST_MEM_CATEGORY                category;
+    uint64_t                         nBlocks;
+    uint64_t                         nBytes;
+} VMREST_MEM_DEBUG_SITE, *PVMREST_MEM_DEBUG_SITE;
+
+typedef struct _VMREST_MEM_THREAD_CACHE
+{
+    PVMREST_MEM_FREE_BLOCK           pFreeList[VMREST_MEMORY_SIZE_CLASS_COUNT];
+    uint32_t                         nCached[VMREST_MEMORY_SIZE_CLASS_COUNT];
+    uint64_t                         nAlloc[VMREST_MEMORY_SIZE_CLASS_COUNT];
+    uint64_t                         nFree[VMREST_MEMORY_SIZE_CLASS_COUNT];
+    uint64_t                         nCacheHit[VMREST_MEMORY_SIZE_CLASS_COUNT];
+    uint64_t                         nLargeAlloc;
+    uint64_t                         nLargeFree;
+    VMREST_MEM_CATEGORY_COUNTERS     category[REST_MEM_CATEGORY_COUNT];
+    BOOLEAN                          bRegistered;
+    struct _VMREST_MEM_THREAD_CACHE* pNext;
+} VMREST_MEM_THREAD_CACHE, *PVMREST_MEM_THREAD_CACHE;
+
+static __thread VMREST_MEM_THREAD_CACHE gMemThreadCache;
+
+static pthread_mutex_t               gMemMutex = PTHREAD_MUTEX_INITIALIZER;
+static PVMREST_MEM_THREAD_CACHE      gpMemCacheList = NULL;
+static VMREST_MEM_THREAD_CACHE       gMemRetired;
+static REST_ALLOCATOR                gMemAllocator;
+static BOOLEAN                       gbMemInUse = FALSE;
+
+static int64_t                       gMemLiveBytes[REST_MEM_CATEGORY_COUNT];
+static int64_t                       gMemPeakBytes[REST_MEM_CATEGORY_COUNT];
+static __thread uint64_t*            gpMemConnBytes = NULL;
+
+static uint32_t                      gMemDebugRefs = 0;
+static uint64_t                      gMemDebugMismatches = 0;
+static pthread_mutex_t               gMemDebugMutex = PTHREAD_MUTEX_INITIALIZER;
+static PVMREST_MEM_DEBUG_BLOCK       gpMemDebugBuckets[VMREST_MEMORY_DEBUG_BUCKETS];
+
+static const char*                   gMemCategoryName[REST_MEM_CATEGORY_COUNT] =
+{
+    "other", "socket", "request", "response", "header", "payload", "tls", "log", "app"
+};
+
+static
+void
+VmRESTMemPublishLive(
+    REST_MEM_CATEGORY                category,
+    int64_t                          delta
+    )
+{
+    int64_t                          live = 0;
+    int64_t                          peak = 0;
+
+    live = __atomic_add_fetch(&gMemLiveBytes[category], delta, __ATOMIC_RELAXED);
+
+    peak = __atomic_load_n(&gMemPeakBytes[category], __ATOMIC_RELAXED);
+    while ((live > peak) &&
+           !__atomic_compare_exchange_n(&gMemPeakBytes[category], &peak, live, TRUE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+/**** Frees from later key destructors of this thread go straight to heap ****/
+static
+VOID
+VmRESTMemThreadCacheDestroy(
+    PVOID                            pSlot
+    )
+{
+    PVMREST_MEM_THREAD_CACHE         pCache = (PVMREST_MEM_THREAD_CACHE)pSlot;
+    PVMREST_MEM_THREAD_CACHE*        ppEntry = NULL;
+    PVMREST_MEM_FREE_BLOCK           pBlock = NULL;
+    uint32_t                         idx = 0;
+
+    pCache->bRegistered = FALSE;
+
+    for (idx = 0; idx < VMREST_MEMORY_SIZE_CLASS_COUNT; idx++)
+    {
+        while (pCache->pFreeList[idx])
+        {
+            pBlock = pCache->pFreeList[idx];
+            pCache->pFreeList[idx] = pBlock->pNext;
+            free(pBlock);
+        }
+        pCache->nCached[idx] = 0;
+    }
+
+    pthread_mutex_lock(&gMemMutex);
+
+    for (ppEntry = &gpMemCacheList; *ppEntry; ppEntry = &(*ppEntry)->pNext)
+    {
+        if (*ppEntry == pCache)
+        {
+            *ppEntry = pCache->pNext;
+            break;
+        }
+    }
+
+    for (idx = 0; idx < VMREST_MEMORY_SIZE_CLASS_COUNT; idx++)
+    {
+        gMemRetired.nAlloc[idx] += pCache->nAlloc[idx];
+        gMemRetired.nFree[idx] += pCache->nFree[idx];
+        gMemRetired.nCacheHit[idx] += pCache->nCacheHit[idx];
+    }
+    gMemRetired.nLargeAlloc += pCache->nLargeAlloc;
+    gMemRetired.nLargeFree += pCache->nLargeFree;
+
+    for (idx = 0; idx < REST_MEM_CATEGORY_COUNT; idx++)
+    {
+        gMemRetired.category[idx].nAlloc += pCache->category[idx].nAlloc;
+        gMemRetired.category[idx].nFree += pCache->category[idx].nFree;
+        gMemRetired.category[idx].nAllocBytes += pCache->category[idx].nAllocBytes;
+        if (pCache->category[idx].liveDelta)
+        {
+            VmRESTMemPublishLive((REST_MEM_CATEGORY)idx, pCache->category[idx].liveDelta);
+            pCache->category[idx].liveDelta = 0;
+        }
+    }
+
+    pthread_mutex_unlock(&gMemMutex);
+}
+
+/**** Caches belong to process, not to an instance ****/
+static VMREST_THREAD_SLOT_REGISTRY   gMemCacheSlots =
+    VMREST_THREAD_SLOT_REGISTRY_INIT(1, &VmRESTMemThreadCacheDestroy);
+
+/**** Returns NULL when thread is exiting, caller then uses heap directly ****/
+static
+PVMREST_MEM_THREAD_CACHE
+VmRESTMemGetThreadCache(
+    void
+    )
+{
+    PVMREST_MEM_THREAD_CACHE         pCache = &gMemThreadCache;
+
+    if (pCache->bRegistered)
+    {
+        return pCache;
+    }
+
+    if (!VmRESTThreadSlotPrepare(&gMemCacheSlots))
+    {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&gMemMutex);
+    pCache->pNext = gpMemCacheList;
+    gpMemCacheList = pCache;
+    pthread_mutex_unlock(&gMemMutex);
+
+    VmRESTThreadSlotClaim(&gMemCacheSlots, NULL, pCache);
+    pCache->bRegistered = TRUE;
+
+    return pCache;
+}
+
+/**** Smallest class which can hold dwSize, -1 if too large ****/
+static
+int
+VmRESTMemClassForSize(
+    size_t                           dwSize
+    )
+{
+    int                              idx = 0;
+
+    for (idx = 0; idx < VMREST_MEMORY_SIZE_CLASS_COUNT; idx++)
+    {
+        if (dwSize <= gMemClassSize[idx])
+        {
+            return idx;
+        }
+    }
+
+    return -1;
+}
+
+static
 uint32_t
-VmRESTAllocateMemory(
+VmRESTMemCacheLimit(
+    int                              idx
+    )
+{
+    uint32_t                         nLimit = VMREST_MEMORY_CACHE_MAX_BYTES / gMemClassSize[idx];
+
+    return (nLimit > VMREST_MEMORY_CACHE_MAX_BLOCKS) ? VMREST_MEMORY_CACHE_MAX_BLOCKS : nLimit;
+}
+
+/**** Bytes of a block, 0 when heap can not tell ****/
+static
+size_t
+VmRESTMemBlockBytes(
+    void*                            pMemory
+    )
+{
+#ifdef HAVE_MALLOC_USABLE_SIZE
+    if (!gMemAllocator.pfnAlloc)
+    {
+        return malloc_usable_size(pMemory);
+    }
+#else
+    (void)pMemory;
+#endif
+
+    return 0;
+}
+
+/**** Thread with no cache (exiting) counts straight into retired totals ****/
+static
+void
+VmRESTMemAccount(
+    PVMREST_MEM_THREAD_CACHE         pCache,
+    REST_MEM_CATEGORY                category,
+    BOOLEAN                          bAlloc,
+    size_t                           nBytes
+    )
+{
+    PVMREST_MEM_CATEGORY_COUNTERS    pCounters = NULL;
+    int64_t                          delta = bAlloc ? (int64_t)nBytes : -(int64_t)nBytes;
+
+    if ((uint32_t)category >= REST_MEM_CATEGORY_COUNT)
+    {
+        category = REST_MEM_OTHER;
+    }
+
+    if (bAlloc && gpMemConnBytes)
+    {
+        __atomic_fetch_add(gpMemConnBytes, nBytes, __ATOMIC_RELAXED);
+    }
+
+    if (!pCache)
+    {
+        pthread_mutex_lock(&gMemMutex);
+        pCounters = &gMemRetired.category[category];
+        if (bAlloc)
+        {
+            pCounters->nAlloc++;
+            pCounters->nAllocBytes += nBytes;
+        }
+        else
+        {
+            pCounters->nFree++;
+        }
+        pthread_mutex_unlock(&gMemMutex);
+
+        VmRESTMemPublishLive(category, delta);
+        return;
+    }
+
+    pCounters = &pCache->category[category];
+    if (bAlloc)
+    {
+        pCounters->nAlloc++;
+        pCounters->nAllocBytes += nBytes;
+    }
+    else
+    {
+        pCounters->nFree++;
+    }
+
+    pCounters->liveDelta += delta;
+    if ((pCounters->liveDelta >= VMREST_MEMORY_LIVE_BATCH_BYTES) ||
+        (pCounters->liveDelta <= -VMREST_MEMORY_LIVE_BATCH_BYTES))
+    {
+        VmRESTMemPublishLive(category, pCounters->liveDelta);
+        pCounters->liveDelta = 0;
+    }
+}
+
+static
+uint32_t
+VmRESTMemDebugBucket(
+    void*                            pMemory
+    )
+{
+    uintptr_t                        key = (uintptr_t)pMemory >> 4;
+
+    key ^= key >> 17;
+    key *= 0x9E3779B1u;
+
+    return (uint32_t)(key % VMREST_MEMORY_DEBUG_BUCKETS);
+}
+
+/**** Nodes come from libc, tracking must not recurse into tracked heap ****/
+static
+void
+VmRESTMemDebugInsert(
+    void*                            pMemory,
     size_t                           dwSize,
-    void**                           ppMemory
+    REST_MEM_CATEGORY                category,
+    const char*                      pszFile,
+    int                              line
+    )
+{
+    PVMREST_MEM_DEBUG_BLOCK          pBlock = NULL;
+    uint32_t                         iBucket = VmRESTMemDebugBucket(pMemory);
+
+    pthread_mutex_lock(&gMemDebugMutex);
+
+    for (pBlock = gpMemDebugBuckets[iBucket]; pBlock; pBlock = pBlock->pNext)
+    {
+        if (pBlock->pMemory == pMemory)
+        {
+            break;
+        }
+    }
+
+    if (!pBlock)
+    {
+        pBlock = malloc(sizeof(VMREST_MEM_DEBUG_BLOCK));
+        if (pBlock)
+        {
+            pBlock->pMemory = pMemory;
+            pBlock->pNext = gpMemDebugBuckets[iBucket];
+            gpMemDebugBuckets[iBucket] = pBlock;
+        }
+    }
+
+    if (pBlock)
+    {
+        pBlock->dwSize = dwSize;
+        pBlock->category = category;
+        pBlock->pszFile = pszFile;
+        pBlock->line = line;
+    }
+
+    pthread_mutex_unlock(&gMemDebugMutex);
+}
+
+/**** Blocks allocated before debug mode was entered are not found, that is fine ****/
+static
+void
+VmRESTMemDebugRemove(
+    void*                            pMemory,
+    REST_MEM_CATEGORY                category
+    )
+{
+    PVMREST_MEM_DEBUG_BLOCK*         ppBlock = NULL;
+    PVMREST_MEM_DEBUG_BLOCK          pBlock = NULL;
+
+    pthread_mutex_lock(&gMemDebugMutex);
+
+    for (ppBlock = &gpMemDebugBuckets[VmRESTMemDebugBucket(pMemory)]; *ppBlock; ppBlock = &(*ppBlock)->pNext)
+    {
+        if ((*ppBlock)->pMemory == pMemory)
+        {
+            pBlock = *ppBlock;
+            *ppBlock = pBlock->pNext;
+            if (pBlock->category != category)
+            {
+                gMemDebugMismatches++;
+            }
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&gMemDebugMutex);
+
+    free(pBlock);
+}
+
+static
+void*
+VmRESTMemAlloc(
+    size_t                           dwSize,
+    BOOLEAN                          bZero
+    )
+{
+    void*                            pMemory = NULL;
+    PVMREST_MEM_THREAD_CACHE         pCache = NULL;
+    PVMREST_MEM_FREE_BLOCK           pBlock = NULL;
+    int                              idx = 0;
+
+    gbMemInUse = TRUE;
+
+    idx = VmRESTMemClassForSize(dwSize);
+    pCache = VmRESTMemGetThreadCache();
+
+    if (gMemAllocator.pfnAlloc)
+    {
+        /**** Application allocator keeps its own caches ****/
+        pMemory = gMemAllocator.pfnAlloc(dwSize);
+        if (pMemory && bZero)
+        {
+            memset(pMemory, 0, dwSize);
+        }
+    }
+    else if (idx < 0)
+    {
+        pMemory = bZero ? calloc(1, dwSize) : malloc(dwSize);
+    }
+    else
+    {
+        if (pCache && pCache->pFreeList[idx])
+        {
+            pBlock = pCache->pFreeList[idx];
+            pCache->pFreeList[idx] = pBlock->pNext;
+            pCache->nCached[idx]--;
+            pCache->nCacheHit[idx]++;
+            pMemory = pBlock;
+        }
+        else
+        {
+            /**** Always full class size, so block can go back to this class when freed ****/
+            pMemory = malloc(gMemClassSize[idx]);
+        }
+
+        if (pMemory && bZero)
+        {
+            memset(pMemory, 0, dwSize);
+        }
+    }
+
+    if (pMemory && pCache)
+    {
+        if (idx < 0)
+        {
+            pCache->nLargeAlloc++;
+        }
+        else
+        {
+            pCache->nAlloc[idx]++;
+        }
+    }
+
+    return pMemory;
+}
+
+static
+void
+VmRESTMemTrackAlloc(
+    void*                            pMemory,
+    size_t                           dwSize,
+    REST_MEM_CATEGORY                category,
+    const char*                      pszFile,
+    int                              line
+    )
+{
+    VmRESTMemAccount(VmRESTMemGetThreadCache(), category, TRUE, VmRESTMemBlockBytes(pMemory));
+
+    if (__atomic_load_n(&gMemDebugRefs, __ATOMIC_RELAXED))
+    {
+        VmRESTMemDebugInsert(pMemory, dwSize, category, pszFile, line);
+    }
+}
+
+uint32_t
+VmRESTAllocateMemoryAt(
+    size_t                           dwSize,
+    void**                           ppMemory,
+    REST_MEM_CATEGORY                category,
+    const char*                      pszFile,
+    int                              line
     )
 {
     uint32_t                         dwError = 0;
@@ -28,13 +508,53 @@ VmRESTAllocateMemory(
         BAIL_ON_VMREST_ERROR(dwError);
     }
 
-    pMemory = calloc(1, dwSize);
+    pMemory = VmRESTMemAlloc(dwSize, TRUE);
     if (!pMemory)
     {
         dwError = ENOMEM;
         BAIL_ON_VMREST_ERROR(dwError);
     }
 
+    VmRESTMemTrackAlloc(pMemory, dwSize, category, pszFile, line);
+
+    *ppMemory = pMemory;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+uint32_t
+VmRESTAllocateMemoryNoZeroAt(
+    size_t                           dwSize,
+    void**                           ppMemory,
+    REST_MEM_CATEGORY                category,
+    const char*                      pszFile,
+    int                              line
+    )
+{
+    uint32_t                         dwError = 0;
+    void*                            pMemory = NULL;
+
+    if (!ppMemory || !dwSize)
+    {
+        dwError = EINVAL;
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
+    pMemory = VmRESTMemAlloc(dwSize, FALSE);
+    if (!pMemory)
+    {
+        dwError = ENOMEM;
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
+    VmRESTMemTrackAlloc(pMemory, dwSize, category, pszFile, line);
+
     *ppMemory = pMemory;
 
 cleanup:
@@ -42,7 +562,6 @@ cleanup:
     return dwError;
 
 error:
-    VMREST_SAFE_FREE_MEMORY(pMemory);
 
     goto cleanup;
 }
@@ -50,25 +569,88 @@ error:
 
 void
 VmRESTFreeMemory(
-    void*                            pMemory
+    void*                            pMemory,
+    REST_MEM_CATEGORY                category
     )
 {
-    if (pMemory)
+    PVMREST_MEM_THREAD_CACHE         pCache = NULL;
+    PVMREST_MEM_FREE_BLOCK           pBlock = NULL;
+    size_t                           usableSize = 0;
+#ifdef HAVE_MALLOC_USABLE_SIZE
+    int                              idx = 0;
+#endif
+
+    if (!pMemory)
+    {
+        return;
+    }
+
+    if (__atomic_load_n(&gMemDebugRefs, __ATOMIC_RELAXED))
+    {
+        VmRESTMemDebugRemove(pMemory, category);
+    }
+
+    pCache = VmRESTMemGetThreadCache();
+    usableSize = VmRESTMemBlockBytes(pMemory);
+
+    VmRESTMemAccount(pCache, category, FALSE, usableSize);
+
+    if (gMemAllocator.pfnFree)
+    {
+        gMemAllocator.pfnFree(pMemory);
+        return;
+    }
+
+#ifdef HAVE_MALLOC_USABLE_SIZE
+    /**** Blocks are plain heap blocks, class is found from usable size. Caller freed
+          buffers handed to application stay valid for free(). ****/
+    if (pCache)
     {
-        free(pMemory);
+        for (idx = VMREST_MEMORY_SIZE_CLASS_COUNT - 1; idx >= 0; idx--)
+        {
+            if (usableSize >= gMemClassSize[idx])
+            {
+                break;
+            }
+        }
+
+        if ((idx >= 0) && (usableSize < (gMemClassSize[idx] + VMREST_MEMORY_CLASS_SLACK)))
+        {
+            pCache->nFree[idx]++;
+            if (pCache->nCached[idx] < VmRESTMemCacheLimit(idx))
+            {
+                pBlock = (PVMREST_MEM_FREE_BLOCK)pMemory;
+                pBlock->pNext = pCache->pFreeList[idx];
+                pCache->pFreeList[idx] = pBlock;
+                pCache->nCached[idx]++;
+                return;
+            }
+        }
+        else if (idx == (VMREST_MEMORY_SIZE_CLASS_COUNT - 1))
+        {
+            pCache->nLargeFree++;
+        }
     }
+#else
+    (void)pBlock;
+#endif
 
+    free(pMemory);
 }
 
 uint32_t
-VmRESTReallocateMemory(
+VmRESTReallocateMemoryAt(
     void*                            pMemory,
     void**                           ppNewMemory,
-    size_t                           dwSize
+    size_t                           dwSize,
+    REST_MEM_CATEGORY                category,
+    const char*                      pszFile,
+    int                              line
     )
 {
     uint32_t                         dwError = 0;
     void*                            pNewMemory = NULL;
+    size_t                           oldBytes = 0;
 
     if (!ppNewMemory)
     {
@@ -78,11 +660,31 @@ VmRESTReallocateMemory(
 
     if (pMemory)
     {
-        pNewMemory = realloc(pMemory, dwSize);
+        oldBytes = VmRESTMemBlockBytes(pMemory);
+
+        if (gMemAllocator.pfnRealloc)
+        {
+            pNewMemory = gMemAllocator.pfnRealloc(pMemory, dwSize);
+        }
+        else
+        {
+            pNewMemory = realloc(pMemory, dwSize);
+        }
+
+        /**** Moved block counts as free of old one and allocation of new one ****/
+        if (pNewMemory)
+        {
+            if (__atomic_load_n(&gMemDebugRefs, __ATOMIC_RELAXED))
+            {
+                VmRESTMemDebugRemove(pMemory, category);
+            }
+            VmRESTMemAccount(VmRESTMemGetThreadCache(), category, FALSE, oldBytes);
+            VmRESTMemTrackAlloc(pNewMemory, dwSize, category, pszFile, line);
+        }
     }
     else
     {
-        dwError = VmRESTAllocateMemory(dwSize, &pNewMemory);
+        dwError = VmRESTAllocateMemoryAt(dwSize, &pNewMemory, category, pszFile, line);
         BAIL_ON_VMREST_ERROR(dwError);
     }
 
@@ -103,3 +705,252 @@ error:
     goto cleanup;
 }
 
+uint32_t
+VmRESTMemorySetAllocator(
+    PREST_ALLOCATOR                  pAllocator
+    )
+{
+    uint32_t                         dwError = 0;
+
+    if (pAllocator && (!pAllocator->pfnAlloc || !pAllocator->pfnRealloc || !pAllocator->pfnFree))
+    {
+        dwError = EINVAL;
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
+    /**** Blocks from one allocator must never reach free of other ****/
+    if (gbMemInUse)
+    {
+        dwError = EBUSY;
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
+    if (pAllocator)
+    {
+        gMemAllocator = *pAllocator;
+    }
+    else
+    {
+        memset(&gMemAllocator, 0, sizeof(gMemAllocator));
+    }
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+void
+VmRESTMemoryGetStats(
+    PREST_MEMORY_STATS               pStats
+    )
+{
+    PVMREST_MEM_THREAD_CACHE         pCache = NULL;
+    uint32_t                         idx = 0;
+    int64_t                          liveBytes[REST_MEM_CATEGORY_COUNT];
+
+    if (!pStats)
+    {
+        return;
+    }
+
+    memset(pStats, 0, sizeof(REST_MEMORY_STATS));
+
+    pthread_mutex_lock(&gMemMutex);
+
+    for (idx = 0; idx < VMREST_MEMORY_SIZE_CLASS_COUNT; idx++)
+    {
+        pStats->sizeClass[idx].classSize = gMemClassSize[idx];
+        pStats->sizeClass[idx].nAlloc = gMemRetired.nAlloc[idx];
+        pStats->sizeClass[idx].nFree = gMemRetired.nFree[idx];
+        pStats->sizeClass[idx].nCacheHit = gMemRetired.nCacheHit[idx];
+    }
+    pStats->nLargeAlloc = gMemRetired.nLargeAlloc;
+    pStats->nLargeFree = gMemRetired.nLargeFree;
+
+    for (idx = 0; idx < REST_MEM_CATEGORY_COUNT; idx++)
+    {
+        pStats->category[idx].nAlloc = gMemRetired.category[idx].nAlloc;
+        pStats->category[idx].nFree = gMemRetired.category[idx].nFree;
+        pStats->category[idx].nTotalBytes = gMemRetired.category[idx].nAllocBytes;
+        liveBytes[idx] = __atomic_load_n(&gMemLiveBytes[idx], __ATOMIC_RELAXED);
+    }
+
+    /**** Counters of live threads are read without their owner's knowledge, values are approximate ****/
+    for (pCache = gpMemCacheList; pCache; pCache = pCache->pNext)
+    {
+        for (idx = 0; idx < VMREST_MEMORY_SIZE_CLASS_COUNT; idx++)
+        {
+            pStats->sizeClass[idx].nAlloc += pCache->nAlloc[idx];
+            pStats->sizeClass[idx].nFree += pCache->nFree[idx];
+            pStats->sizeClass[idx].nCacheHit += pCache->nCacheHit[idx];
+            pStats->sizeClass[idx].nCached += pCache->nCached[idx];
+        }
+        pStats->nLargeAlloc += pCache->nLargeAlloc;
+        pStats->nLargeFree += pCache->nLargeFree;
+
+        for (idx = 0; idx < REST_MEM_CATEGORY_COUNT; idx++)
+        {
+            pStats->category[idx].nAlloc += pCache->category[idx].nAlloc;
+            pStats->category[idx].nFree += pCache->category[idx].nFree;
+            pStats->category[idx].nTotalBytes += pCache->category[idx].nAllocBytes;
+            liveBytes[idx] += pCache->category[idx].liveDelta;
+        }
+    }
+
+    pthread_mutex_unlock(&gMemMutex);
+
+    /**** Unpublished deltas can make a sum briefly negative or above published peak ****/
+    for (idx = 0; idx < REST_MEM_CATEGORY_COUNT; idx++)
+    {
+        pStats->category[idx].nLiveBytes = (liveBytes[idx] > 0) ? (uint64_t)liveBytes[idx] : 0;
+        pStats->category[idx].nPeakBytes = (uint64_t)__atomic_load_n(&gMemPeakBytes[idx], __ATOMIC_RELAXED);
+        if (pStats->category[idx].nPeakBytes < pStats->category[idx].nLiveBytes)
+        {
+            pStats->category[idx].nPeakBytes = pStats->category[idx].nLiveBytes;
+        }
+    }
+
+    pStats->nDebugMismatches = __atomic_load_n(&gMemDebugMismatches, __ATOMIC_RELAXED);
+    pStats->bCustomAllocator = (gMemAllocator.pfnAlloc != NULL);
+#ifdef HAVE_MALLOC_USABLE_SIZE
+    pStats->bByteCounts = !pStats->bCustomAllocator;
+#else
+    pStats->bByteCounts = FALSE;
+#endif
+}
+
+void
+VmRESTMemorySetConnection(
+    uint64_t*                        pnConnBytes
+    )
+{
+    gpMemConnBytes = pnConnBytes;
+}
+
+void
+VmRESTMemoryDebugEnable(
+    void
+    )
+{
+    __atomic_fetch_add(&gMemDebugRefs, 1, __ATOMIC_RELAXED);
+}
+
+/**** Engine structures, log and application copies are still legitimately held at shutdown ****/
+static
+BOOLEAN
+VmRESTMemDebugIsReported(
+    REST_MEM_CATEGORY                category
+    )
+{
+    return ((category != REST_MEM_OTHER) &&
+            (category != REST_MEM_LOG) &&
+            (category != REST_MEM_APP));
+}
+
+void
+VmRESTMemoryDebugReport(
+    PVMREST_HANDLE                   pRESTHandle
+    )
+{
+    VMREST_MEM_DEBUG_SITE            sites[VMREST_MEMORY_DEBUG_MAX_SITES];
+    PVMREST_MEM_DEBUG_BLOCK          pBlock = NULL;
+    PVMREST_MEM_DEBUG_BLOCK          pNext = NULL;
+    uint32_t                         nSites = 0;
+    uint32_t                         nLeft = 0;
+    uint32_t                         iBucket = 0;
+    uint32_t                         iSite = 0;
+    uint64_t                         nBlocks = 0;
+    uint64_t                         nBytes = 0;
+    uint64_t                         nDropped = 0;
+
+    pthread_mutex_lock(&gMemDebugMutex);
+
+    nLeft = __atomic_sub_fetch(&gMemDebugRefs, 1, __ATOMIC_RELAXED);
+    if (nLeft)
+    {
+        pthread_mutex_unlock(&gMemDebugMutex);
+        VMREST_LOG_INFO(pRESTHandle,"Memory debug report skipped, %u instances still live", nLeft);
+        return;
+    }
+
+    /**** Last instance, table is emptied as it is walked ****/
+    memset(sites, 0, sizeof(sites));
+
+    for (iBucket = 0; iBucket < VMREST_MEMORY_DEBUG_BUCKETS; iBucket++)
+    {
+        for (pBlock = gpMemDebugBuckets[iBucket]; pBlock; pBlock = pNext)
+        {
+            pNext = pBlock->pNext;
+
+            if (VmRESTMemDebugIsReported(pBlock->category))
+            {
+                for (iSite = 0; iSite < nSites; iSite++)
+                {
+                    if ((sites[iSite].line == pBlock->line) &&
+                        (sites[iSite].category == pBlock->category) &&
+                        !strcmp(sites[iSite].pszFile, pBlock->pszFile))
+                    {
+                        break;
+                    }
+                }
+
+                if ((iSite == nSites) && (nSites < VMREST_MEMORY_DEBUG_MAX_SITES))
+                {
+                    sites[iSite].pszFile = pBlock->pszFile;
+                    sites[iSite].line = pBlock->line;
+                    sites[iSite].category = pBlock->category;
+                    nSites++;
+                }
+
+                if (iSite < nSites)
+                {
+                    sites[iSite].nBlocks++;
+                    sites[iSite].nBytes += pBlock->dwSize;
+                }
+                else
+                {
+                    nDropped++;
+                }
+
+                nBlocks++;
+                nBytes += pBlock->dwSize;
+            }
+
+            free(pBlock);
+        }
+        gpMemDebugBuckets[iBucket] = NULL;
+    }
+
+    pthread_mutex_unlock(&gMemDebugMutex);
+
+    if (!nBlocks)
+    {
+        VMREST_LOG_INFO(pRESTHandle,"Memory debug report: no outstanding blocks, %llu category mismatches",
+            (unsigned long long)__atomic_load_n(&gMemDebugMismatches, __ATOMIC_RELAXED));
+        return;
+    }
+
+    VMREST_LOG_ERROR(pRESTHandle,"Memory debug report: %llu blocks, %llu bytes outstanding at shutdown, %llu category mismatches",
+        (unsigned long long)nBlocks,
+        (unsigned long long)nBytes,
+        (unsigned long long)__atomic_load_n(&gMemDebugMismatches, __ATOMIC_RELAXED));
+
+    for (iSite = 0; iSite < nSites; iSite++)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"  %s:%d (%s) %llu blocks, %llu bytes",
+            sites[iSite].pszFile,
+            sites[iSite].line,
+            gMemCategoryName[sites[iSite].category],
+            (unsigned long long)sites[iSite].nBlocks,
+            (unsigned long long)sites[iSite].nBytes);
+    }
+
+    if (nDropped)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"  %llu more blocks from other sites", (unsigned long long)nDropped);
+    }
+}
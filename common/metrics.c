@@ -0,0 +1,1592 @@
+/* C-REST-Engine
+*
+* Copyright (c) 2017 VMware, Inc. All Rights Reserved.
+*
+* This product is licensed to you under the Apache 2.0 license (the "License").
+* You may not use this product except in compliance with the Apache 2.0 License.
+*
+* This product may include a number of subcomponents with separate copyright
+* notices and license terms. Your use of these subcomponents is subject to the
+* terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+*
+*/
+
+#include "includes.h"
+
+#define VMREST_METRICS_HIST_SUB              (1 << VMREST_METRICS_HIST_SUB_BITS)
+#define VMREST_METRICS_METHODS               (sizeof(gMetricsMethod) / sizeof(gMetricsMethod[0]))
+#define VMREST_METRICS_ROUTE_ANY             "*"
+#define VMREST_METRICS_TEXT_INITIAL_SIZE     4096
+#define VMREST_METRICS_LABELS_INITIAL_SIZE   256
+
+/**** Slot 0 takes methods not in table ****/
+static const char*                   gMetricsMethod[] =
+{
+    "OTHER", "GET", "PUT", "POST", "DELETE", "OPTIONS", "HEAD", "CONNECT", "PATCH"
+};
+
+/**** Prometheus buckets are a subset of histogram bucket edges, 2^k us ****/
+static const uint32_t                gMetricsPromEdgeShift[] =
+{
+    4, 6, 8, 10, 12, 14, 16, 18, 20, 22, 24, 26
+};
+
+/**** Phase histograms are in ns, 2^k ns from about 1 us to 1 s ****/
+static const uint32_t                gMetricsPhaseEdgeShift[] =
+{
+    10, 12, 14, 16, 18, 20, 22, 24, 26, 28, 30
+};
+
+static const char*                   gMetricsCpuPhaseName[REST_CPU_PHASE_COUNT] =
+{
+    "parse", "handler", "serialize"
+};
+
+static const char*                   gMetricsPhaseName[REST_PHASE_COUNT] =
+{
+    "accept", "tls_done", "first_byte_read", "request_line", "headers_done",
+    "body_done", "handler_start", "handler_end", "first_byte_written", "last_byte_written"
+};
+
+/**** Phase each request phase counts from, REST_PHASE_COUNT for none. TLS done
+      is counted at handshake, once per connection ****/
+static const REST_PHASE              gMetricsPhaseFrom[REST_PHASE_COUNT] =
+{
+    REST_PHASE_COUNT,
+    REST_PHASE_COUNT,
+    REST_PHASE_COUNT,
+    REST_PHASE_FIRST_BYTE_READ,
+    REST_PHASE_REQUEST_LINE,
+    REST_PHASE_HEADERS_DONE,
+    REST_PHASE_BODY_DONE,
+    REST_PHASE_HANDLER_START,
+    REST_PHASE_FIRST_BYTE_READ,
+    REST_PHASE_FIRST_BYTE_WRITTEN
+};
+
+typedef struct _VMREST_METRICS_HISTOGRAM
+{
+    uint64_t                         nCount;
+    uint64_t                         sum;
+    uint64_t                         max;
+    uint64_t                         bucket[VMREST_METRICS_HIST_BUCKETS];
+} VMREST_METRICS_HISTOGRAM, *PVMREST_METRICS_HISTOGRAM;
+
+typedef struct _VMREST_METRICS_CPU
+{
+    uint64_t                         nSamples;
+    uint64_t                         cpuNs[REST_CPU_PHASE_COUNT];
+} VMREST_METRICS_CPU, *PVMREST_METRICS_CPU;
+
+/**** Written by owning thread only, other threads just read. Histograms and CPU
+      counts are allocated on first request of a route and method and never move. ****/
+typedef struct _VMREST_METRICS_SHARD
+{
+    uint64_t                         counter[VMREST_METRIC_COUNT];
+    uint64_t                         nResponses[VMREST_STATS_STATUS_CLASSES];
+    PVMREST_METRICS_HISTOGRAM        pLatency[VMREST_METRICS_MAX_ROUTES][VMREST_METRICS_METHODS];
+    PVMREST_METRICS_CPU              pCpu[VMREST_METRICS_MAX_ROUTES][VMREST_METRICS_METHODS];
+    PVMREST_METRICS_HISTOGRAM        pPhase[REST_PHASE_COUNT];
+    uint32_t                         bThreadGone;
+    BOOLEAN                          bShared;
+    struct _VMREST_METRICS_SHARD*    pNext;
+} VMREST_METRICS_SHARD, *PVMREST_METRICS_SHARD;
+
+/**** Shard of an exiting thread is kept, its counts still count, and handed
+      to next thread which needs one ****/
+typedef struct _VMREST_METRICS
+{
+    VMREST_THREAD_SLOT_OWNER         slotOwner;
+    PVMREST_MUTEX                    pMutex;
+    PVMREST_METRICS_SHARD            pShards;
+    VMREST_METRICS_SHARD             sharedShard;
+    uint32_t                         nRoutes;
+    char*                            pszRoute[VMREST_METRICS_MAX_ROUTES];
+} VMREST_METRICS;
+
+/**** TSC is used only when kernel trusts it as clocksource, it is then
+      invariant and synchronized across CPUs ****/
+typedef struct _VMREST_METRICS_CLOCK
+{
+    BOOLEAN                          bTsc;
+    uint64_t                         baseTsc;
+    uint64_t                         baseNs;
+    uint64_t                         nsPerTick32;
+} VMREST_METRICS_CLOCK;
+
+typedef struct _VMREST_METRICS_TEXT
+{
+    char*                            pszText;
+    uint32_t                         nLen;
+    uint32_t                         nSize;
+    uint32_t                         dwError;
+} VMREST_METRICS_TEXT, *PVMREST_METRICS_TEXT;
+
+static pthread_once_t                gMetricsClockOnce = PTHREAD_ONCE_INIT;
+static VMREST_METRICS_CLOCK          gMetricsClock = {0};
+
+static
+uint32_t
+VmRESTMetricsBucketOf(
+    uint64_t                         value
+    )
+{
+    uint32_t                         msb = 0;
+    uint32_t                         idx = 0;
+
+    if (value < (2 * VMREST_METRICS_HIST_SUB))
+    {
+        return (uint32_t)value;
+    }
+
+    msb = 63 - __builtin_clzll(value);
+    idx = ((msb - VMREST_METRICS_HIST_SUB_BITS + 1) * VMREST_METRICS_HIST_SUB) +
+          (uint32_t)((value >> (msb - VMREST_METRICS_HIST_SUB_BITS)) & (VMREST_METRICS_HIST_SUB - 1));
+
+    return (idx < VMREST_METRICS_HIST_BUCKETS) ? idx : (VMREST_METRICS_HIST_BUCKETS - 1);
+}
+
+/**** Largest value falling into bucket ****/
+static
+uint64_t
+VmRESTMetricsBucketUpper(
+    uint32_t                         idx
+    )
+{
+    uint32_t                         shift = 0;
+
+    if (idx < (2 * VMREST_METRICS_HIST_SUB))
+    {
+        return idx;
+    }
+
+    shift = (idx / VMREST_METRICS_HIST_SUB) - 1;
+
+    return (((uint64_t)VMREST_METRICS_HIST_SUB + (idx % VMREST_METRICS_HIST_SUB) + 1) << shift) - 1;
+}
+
+static
+void
+VmRESTMetricsMergeHistogram(
+    PVMREST_METRICS_HISTOGRAM        pTotal,
+    PVMREST_METRICS_HISTOGRAM        pHist
+    )
+{
+    uint32_t                         idx = 0;
+
+    if (!pHist)
+    {
+        return;
+    }
+
+    pTotal->nCount += pHist->nCount;
+    pTotal->sum += pHist->sum;
+    if (pHist->max > pTotal->max)
+    {
+        pTotal->max = pHist->max;
+    }
+    for (idx = 0; idx < VMREST_METRICS_HIST_BUCKETS; idx++)
+    {
+        pTotal->bucket[idx] += pHist->bucket[idx];
+    }
+}
+
+static
+void
+VmRESTMetricsMergeCpu(
+    PREST_CPU_STATS                  pTotal,
+    PVMREST_METRICS_CPU              pCpu
+    )
+{
+    uint32_t                         idx = 0;
+
+    if (!pCpu)
+    {
+        return;
+    }
+
+    pTotal->nSamples += pCpu->nSamples;
+    for (idx = 0; idx < REST_CPU_PHASE_COUNT; idx++)
+    {
+        pTotal->cpuNs[idx] += pCpu->cpuNs[idx];
+    }
+}
+
+static
+uint64_t
+VmRESTMetricsQuantile(
+    PVMREST_METRICS_HISTOGRAM        pHist,
+    uint32_t                         percent
+    )
+{
+    uint64_t                         nTarget = 0;
+    uint64_t                         nSeen = 0;
+    uint64_t                         upper = 0;
+    uint32_t                         idx = 0;
+
+    if (pHist->nCount == 0)
+    {
+        return 0;
+    }
+
+    nTarget = ((pHist->nCount * percent) + 99) / 100;
+
+    for (idx = 0; idx < VMREST_METRICS_HIST_BUCKETS; idx++)
+    {
+        nSeen += pHist->bucket[idx];
+        if (nSeen >= nTarget)
+        {
+            break;
+        }
+    }
+
+    upper = VmRESTMetricsBucketUpper((idx < VMREST_METRICS_HIST_BUCKETS) ? idx : (VMREST_METRICS_HIST_BUCKETS - 1));
+
+    return (upper < pHist->max) ? upper : pHist->max;
+}
+
+static
+void
+VmRESTMetricsFillLatency(
+    PVMREST_METRICS_HISTOGRAM        pHist,
+    PREST_LATENCY_STATS              pLatency
+    )
+{
+    pLatency->nCount = pHist->nCount;
+    pLatency->sumUs = pHist->sum;
+    pLatency->p50Us = VmRESTMetricsQuantile(pHist, 50);
+    pLatency->p90Us = VmRESTMetricsQuantile(pHist, 90);
+    pLatency->p99Us = VmRESTMetricsQuantile(pHist, 99);
+    pLatency->maxUs = pHist->max;
+}
+
+static
+void
+VmRESTMetricsFillPhase(
+    PVMREST_METRICS_HISTOGRAM        pHist,
+    PREST_PHASE_STATS                pPhase
+    )
+{
+    pPhase->nCount = pHist->nCount;
+    pPhase->sumNs = pHist->sum;
+    pPhase->p50Ns = VmRESTMetricsQuantile(pHist, 50);
+    pPhase->p90Ns = VmRESTMetricsQuantile(pHist, 90);
+    pPhase->p99Ns = VmRESTMetricsQuantile(pHist, 99);
+    pPhase->maxNs = pHist->max;
+}
+
+static
+VOID
+VmRESTMetricsReleaseShard(
+    PVOID                            pSlot
+    )
+{
+    __atomic_store_n(&((PVMREST_METRICS_SHARD)pSlot)->bThreadGone, 1, __ATOMIC_RELEASE);
+}
+
+static VMREST_THREAD_SLOT_REGISTRY   gMetricsSlots =
+    VMREST_THREAD_SLOT_REGISTRY_INIT(VMREST_METRICS_THREAD_SHARDS, &VmRESTMetricsReleaseShard);
+
+/**** Slow path, once per thread and instance ****/
+static
+PVMREST_METRICS_SHARD
+VmRESTMetricsClaimShard(
+    PVMREST_METRICS                  pMetrics
+    )
+{
+    PVMREST_METRICS_SHARD            pShard = NULL;
+
+    if (!VmRESTThreadSlotPrepare(&gMetricsSlots))
+    {
+        return &pMetrics->sharedShard;
+    }
+
+    VmRESTLockMutex(pMetrics->pMutex);
+
+    for (pShard = pMetrics->pShards; pShard; pShard = pShard->pNext)
+    {
+        if (__atomic_load_n(&pShard->bThreadGone, __ATOMIC_ACQUIRE))
+        {
+            pShard->bThreadGone = 0;
+            break;
+        }
+    }
+
+    if (!pShard && (VmRESTAllocateMemory(sizeof(VMREST_METRICS_SHARD), (PVOID*)&pShard, REST_MEM_OTHER) == 0))
+    {
+        pShard->pNext = pMetrics->pShards;
+        pMetrics->pShards = pShard;
+    }
+
+    VmRESTUnlockMutex(pMetrics->pMutex);
+
+    if (!pShard)
+    {
+        return &pMetrics->sharedShard;
+    }
+
+    VmRESTThreadSlotClaim(&gMetricsSlots, &pMetrics->slotOwner, pShard);
+
+    return pShard;
+}
+
+static
+PVMREST_METRICS_SHARD
+VmRESTMetricsGetShard(
+    PVMREST_METRICS                  pMetrics
+    )
+{
+    PVMREST_METRICS_SHARD            pShard = NULL;
+
+    if (VmRESTThreadSlotFind(&gMetricsSlots, &pMetrics->slotOwner, (PVOID*)&pShard))
+    {
+        return pShard;
+    }
+
+    return VmRESTMetricsClaimShard(pMetrics);
+}
+
+/**** Shared shard takes threads without a shard of their own, it needs atomics ****/
+static
+void
+VmRESTMetricsBump(
+    PVMREST_METRICS_SHARD            pShard,
+    uint64_t*                        pCounter,
+    uint64_t                         nValue
+    )
+{
+    if (pShard->bShared)
+    {
+        __atomic_fetch_add(pCounter, nValue, __ATOMIC_RELAXED);
+    }
+    else
+    {
+        *pCounter += nValue;
+    }
+}
+
+static
+PVMREST_METRICS_HISTOGRAM
+VmRESTMetricsGetHistogram(
+    PVMREST_METRICS_HISTOGRAM*       ppSlot
+    )
+{
+    PVMREST_METRICS_HISTOGRAM        pHist = NULL;
+    PVMREST_METRICS_HISTOGRAM        pExpected = NULL;
+
+    pHist = __atomic_load_n(ppSlot, __ATOMIC_ACQUIRE);
+    if (pHist)
+    {
+        return pHist;
+    }
+
+    if (VmRESTAllocateMemory(sizeof(VMREST_METRICS_HISTOGRAM), (PVOID*)&pHist, REST_MEM_OTHER) != 0)
+    {
+        return NULL;
+    }
+
+    if (!__atomic_compare_exchange_n(ppSlot, &pExpected, pHist,
+                                     FALSE, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE))
+    {
+        VmRESTFreeMemory(pHist, REST_MEM_OTHER);
+        pHist = pExpected;
+    }
+
+    return pHist;
+}
+
+static
+PVMREST_METRICS_CPU
+VmRESTMetricsGetCpu(
+    PVMREST_METRICS_CPU*             ppSlot
+    )
+{
+    PVMREST_METRICS_CPU              pCpu = NULL;
+    PVMREST_METRICS_CPU              pExpected = NULL;
+
+    pCpu = __atomic_load_n(ppSlot, __ATOMIC_ACQUIRE);
+    if (pCpu)
+    {
+        return pCpu;
+    }
+
+    if (VmRESTAllocateMemory(sizeof(VMREST_METRICS_CPU), (PVOID*)&pCpu, REST_MEM_OTHER) != 0)
+    {
+        return NULL;
+    }
+
+    if (!__atomic_compare_exchange_n(ppSlot, &pExpected, pCpu,
+                                     FALSE, __ATOMIC_RELEASE, __ATOMIC_ACQUIRE))
+    {
+        VmRESTFreeMemory(pCpu, REST_MEM_OTHER);
+        pCpu = pExpected;
+    }
+
+    return pCpu;
+}
+
+static
+void
+VmRESTMetricsAddSample(
+    PVMREST_METRICS_SHARD            pShard,
+    PVMREST_METRICS_HISTOGRAM        pHist,
+    uint64_t                         value
+    )
+{
+    uint64_t                         max = 0;
+
+    VmRESTMetricsBump(pShard, &pHist->bucket[VmRESTMetricsBucketOf(value)], 1);
+    VmRESTMetricsBump(pShard, &pHist->sum, value);
+    VmRESTMetricsBump(pShard, &pHist->nCount, 1);
+
+    max = __atomic_load_n(&pHist->max, __ATOMIC_RELAXED);
+    while ((value > max) &&
+           !__atomic_compare_exchange_n(&pHist->max, &max, value, FALSE, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    {
+    }
+}
+
+static
+void
+VmRESTMetricsFreeHistograms(
+    PVMREST_METRICS_SHARD            pShard
+    )
+{
+    uint32_t                         iRoute = 0;
+    uint32_t                         iMethod = 0;
+    uint32_t                         iPhase = 0;
+
+    for (iRoute = 0; iRoute < VMREST_METRICS_MAX_ROUTES; iRoute++)
+    {
+        for (iMethod = 0; iMethod < VMREST_METRICS_METHODS; iMethod++)
+        {
+            if (pShard->pLatency[iRoute][iMethod])
+            {
+                VmRESTFreeMemory(pShard->pLatency[iRoute][iMethod], REST_MEM_OTHER);
+                pShard->pLatency[iRoute][iMethod] = NULL;
+            }
+            if (pShard->pCpu[iRoute][iMethod])
+            {
+                VmRESTFreeMemory(pShard->pCpu[iRoute][iMethod], REST_MEM_OTHER);
+                pShard->pCpu[iRoute][iMethod] = NULL;
+            }
+        }
+    }
+
+    for (iPhase = 0; iPhase < REST_PHASE_COUNT; iPhase++)
+    {
+        if (pShard->pPhase[iPhase])
+        {
+            VmRESTFreeMemory(pShard->pPhase[iPhase], REST_MEM_OTHER);
+            pShard->pPhase[iPhase] = NULL;
+        }
+    }
+}
+
+static
+uint64_t
+VmRESTMetricsClockNs(
+    void
+    )
+{
+    struct timespec                  ts = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000000) + (uint64_t)ts.tv_nsec;
+}
+
+static
+void
+VmRESTMetricsCalibrateClock(
+    void
+    )
+{
+#if defined(__x86_64__)
+    FILE*                            fp = NULL;
+    char                             szSource[32] = {0};
+    uint64_t                         startNs = 0;
+    uint64_t                         startTsc = 0;
+    uint64_t                         endNs = 0;
+    uint64_t                         endTsc = 0;
+
+    fp = fopen(VMREST_METRICS_CLOCKSOURCE_PATH, "r");
+    if (!fp)
+    {
+        return;
+    }
+    if (!fgets(szSource, sizeof(szSource), fp) || (strncmp(szSource, "tsc", 3) != 0) ||
+        ((szSource[3] != '\n') && (szSource[3] != '\0')))
+    {
+        fclose(fp);
+        return;
+    }
+    fclose(fp);
+
+    /**** Ratio against clock_gettime over a short busy wait, once per process ****/
+    startNs = VmRESTMetricsClockNs();
+    startTsc = __rdtsc();
+    do
+    {
+        endNs = VmRESTMetricsClockNs();
+    } while ((endNs - startNs) < VMREST_METRICS_CLOCK_CALIBRATE_NS);
+    endTsc = __rdtsc();
+
+    if (endTsc <= startTsc)
+    {
+        return;
+    }
+
+    gMetricsClock.nsPerTick32 = ((endNs - startNs) << 32) / (endTsc - startTsc);
+    gMetricsClock.baseTsc = endTsc;
+    gMetricsClock.baseNs = endNs;
+    gMetricsClock.bTsc = TRUE;
+#endif
+}
+
+uint32_t
+VmRESTCreateMetrics(
+    PVMREST_METRICS*                 ppMetrics
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    PVMREST_METRICS                  pMetrics = NULL;
+
+    if (!ppMetrics)
+    {
+        dwError = REST_ERROR_INVALID_HANDLER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateMemory(
+                  sizeof(VMREST_METRICS),
+                  (PVOID*)&pMetrics,
+                  REST_MEM_OTHER
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateNamedMutex(&pMetrics->pMutex, "metrics");
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pMetrics->sharedShard.bShared = TRUE;
+
+    pthread_once(&gMetricsClockOnce, &VmRESTMetricsCalibrateClock);
+
+    dwError = VmRESTAllocateMemory(
+                  sizeof(VMREST_METRICS_ROUTE_ANY),
+                  (PVOID*)&pMetrics->pszRoute[0],
+                  REST_MEM_OTHER
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    strcpy(pMetrics->pszRoute[0], VMREST_METRICS_ROUTE_ANY);
+    pMetrics->nRoutes = 1;
+
+    VmRESTThreadSlotAddOwner(&gMetricsSlots, &pMetrics->slotOwner);
+
+    *ppMetrics = pMetrics;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    if (pMetrics)
+    {
+        if (pMetrics->pMutex)
+        {
+            VmRESTFreeMutex(pMetrics->pMutex);
+        }
+        VmRESTFreeMemory(pMetrics, REST_MEM_OTHER);
+    }
+
+    goto cleanup;
+}
+
+void
+VmRESTFreeMetrics(
+    PVMREST_METRICS                  pMetrics
+    )
+{
+    PVMREST_METRICS_SHARD            pShard = NULL;
+    uint32_t                         iRoute = 0;
+
+    if (!pMetrics)
+    {
+        return;
+    }
+
+    /**** Once removed, exiting threads no longer touch its shards ****/
+    VmRESTThreadSlotRemoveOwner(&gMetricsSlots, &pMetrics->slotOwner);
+
+    VmRESTMetricsFreeHistograms(&pMetrics->sharedShard);
+
+    while (pMetrics->pShards)
+    {
+        pShard = pMetrics->pShards;
+        pMetrics->pShards = pShard->pNext;
+
+        VmRESTMetricsFreeHistograms(pShard);
+        VmRESTFreeMemory(pShard, REST_MEM_OTHER);
+    }
+
+    for (iRoute = 0; iRoute < pMetrics->nRoutes; iRoute++)
+    {
+        VmRESTFreeMemory(pMetrics->pszRoute[iRoute], REST_MEM_OTHER);
+    }
+
+    VmRESTFreeMutex(pMetrics->pMutex);
+    VmRESTFreeMemory(pMetrics, REST_MEM_OTHER);
+}
+
+uint32_t
+VmRESTMetricsGetRouteId(
+    PVMREST_METRICS                  pMetrics,
+    const char*                      pszRoute
+    )
+{
+    uint32_t                         routeId = 0;
+    uint32_t                         idx = 0;
+    size_t                           nLen = 0;
+
+    if (!pMetrics || IsNullOrEmptyString(pszRoute))
+    {
+        return 0;
+    }
+
+    nLen = strlen(pszRoute);
+
+    VmRESTLockMutex(pMetrics->pMutex);
+
+    /**** Slot of an unregistered endpoint is kept, endpoint may come back ****/
+    for (idx = 1; idx < pMetrics->nRoutes; idx++)
+    {
+        if (strcmp(pMetrics->pszRoute[idx], pszRoute) == 0)
+        {
+            routeId = idx;
+            break;
+        }
+    }
+
+    if ((routeId == 0) && (pMetrics->nRoutes < VMREST_METRICS_MAX_ROUTES) &&
+        (VmRESTAllocateMemory(nLen + 1, (PVOID*)&pMetrics->pszRoute[pMetrics->nRoutes], REST_MEM_OTHER) == 0))
+    {
+        memcpy(pMetrics->pszRoute[pMetrics->nRoutes], pszRoute, nLen + 1);
+        routeId = pMetrics->nRoutes++;
+    }
+
+    VmRESTUnlockMutex(pMetrics->pMutex);
+
+    return routeId;
+}
+
+const char*
+VmRESTMetricsGetRouteName(
+    PVMREST_METRICS                  pMetrics,
+    uint32_t                         routeId
+    )
+{
+    /**** Slot is filled before request can carry its id ****/
+    if (!pMetrics || (routeId >= VMREST_METRICS_MAX_ROUTES) || !pMetrics->pszRoute[routeId])
+    {
+        return VMREST_METRICS_ROUTE_ANY;
+    }
+
+    return pMetrics->pszRoute[routeId];
+}
+
+void
+VmRESTMetricsAdd(
+    PVMREST_METRICS                  pMetrics,
+    VMREST_METRIC                    metric,
+    uint64_t                         nValue
+    )
+{
+    PVMREST_METRICS_SHARD            pShard = NULL;
+
+    if (!pMetrics || (metric >= VMREST_METRIC_COUNT))
+    {
+        return;
+    }
+
+    pShard = VmRESTMetricsGetShard(pMetrics);
+
+    VmRESTMetricsBump(pShard, &pShard->counter[metric], nValue);
+}
+
+static
+uint32_t
+VmRESTMetricsGetMethodId(
+    const char*                      pszMethod
+    )
+{
+    uint32_t                         idx = 0;
+
+    if (pszMethod)
+    {
+        for (idx = 1; idx < VMREST_METRICS_METHODS; idx++)
+        {
+            if (strcmp(pszMethod, gMetricsMethod[idx]) == 0)
+            {
+                return idx;
+            }
+        }
+    }
+
+    return 0;
+}
+
+void
+VmRESTMetricsRecordRequest(
+    PVMREST_METRICS                  pMetrics,
+    uint32_t                         routeId,
+    const char*                      pszMethod,
+    uint32_t                         statusCode,
+    uint64_t                         latencyUs
+    )
+{
+    PVMREST_METRICS_SHARD            pShard = NULL;
+    PVMREST_METRICS_HISTOGRAM        pHist = NULL;
+    uint32_t                         methodId = 0;
+    uint32_t                         statusClass = 0;
+
+    if (!pMetrics)
+    {
+        return;
+    }
+
+    methodId = VmRESTMetricsGetMethodId(pszMethod);
+
+    if (routeId >= VMREST_METRICS_MAX_ROUTES)
+    {
+        routeId = 0;
+    }
+
+    statusClass = statusCode / 100;
+    if ((statusClass < 1) || (statusClass >= VMREST_STATS_STATUS_CLASSES))
+    {
+        statusClass = 0;
+    }
+
+    pShard = VmRESTMetricsGetShard(pMetrics);
+
+    VmRESTMetricsBump(pShard, &pShard->nResponses[statusClass], 1);
+
+    pHist = VmRESTMetricsGetHistogram(&pShard->pLatency[routeId][methodId]);
+    if (!pHist)
+    {
+        return;
+    }
+
+    VmRESTMetricsAddSample(pShard, pHist, latencyUs);
+}
+
+void
+VmRESTMetricsRecordCpu(
+    PVMREST_METRICS                  pMetrics,
+    uint32_t                         routeId,
+    const char*                      pszMethod,
+    const uint64_t                   cpuNs[REST_CPU_PHASE_COUNT]
+    )
+{
+    PVMREST_METRICS_SHARD            pShard = NULL;
+    PVMREST_METRICS_CPU              pCpu = NULL;
+    uint32_t                         methodId = 0;
+    uint32_t                         idx = 0;
+
+    if (!pMetrics || !cpuNs)
+    {
+        return;
+    }
+
+    if (routeId >= VMREST_METRICS_MAX_ROUTES)
+    {
+        routeId = 0;
+    }
+
+    methodId = VmRESTMetricsGetMethodId(pszMethod);
+
+    pShard = VmRESTMetricsGetShard(pMetrics);
+
+    pCpu = VmRESTMetricsGetCpu(&pShard->pCpu[routeId][methodId]);
+    if (!pCpu)
+    {
+        return;
+    }
+
+    for (idx = 0; idx < REST_CPU_PHASE_COUNT; idx++)
+    {
+        VmRESTMetricsBump(pShard, &pCpu->cpuNs[idx], cpuNs[idx]);
+    }
+    VmRESTMetricsBump(pShard, &pCpu->nSamples, 1);
+}
+
+void
+VmRESTMetricsRecordPhase(
+    PVMREST_METRICS                  pMetrics,
+    REST_PHASE                       phase,
+    uint64_t                         nValueNs
+    )
+{
+    PVMREST_METRICS_SHARD            pShard = NULL;
+    PVMREST_METRICS_HISTOGRAM        pHist = NULL;
+
+    if (!pMetrics || (phase >= REST_PHASE_COUNT))
+    {
+        return;
+    }
+
+    pShard = VmRESTMetricsGetShard(pMetrics);
+
+    pHist = VmRESTMetricsGetHistogram(&pShard->pPhase[phase]);
+    if (!pHist)
+    {
+        return;
+    }
+
+    VmRESTMetricsAddSample(pShard, pHist, nValueNs);
+}
+
+void
+VmRESTMetricsRecordTimings(
+    PVMREST_METRICS                  pMetrics,
+    PREST_REQUEST_TIMINGS            pTimings
+    )
+{
+    PVMREST_METRICS_SHARD            pShard = NULL;
+    PVMREST_METRICS_HISTOGRAM        pHist = NULL;
+    uint64_t                         fromNs = 0;
+    uint64_t                         toNs = 0;
+    uint32_t                         idx = 0;
+
+    if (!pMetrics || !pTimings)
+    {
+        return;
+    }
+
+    pShard = VmRESTMetricsGetShard(pMetrics);
+
+    for (idx = 0; idx < REST_PHASE_COUNT; idx++)
+    {
+        if (gMetricsPhaseFrom[idx] == REST_PHASE_COUNT)
+        {
+            continue;
+        }
+
+        fromNs = pTimings->phaseNs[gMetricsPhaseFrom[idx]];
+        toNs = pTimings->phaseNs[idx];
+        if (!fromNs || (toNs < fromNs))
+        {
+            continue;
+        }
+
+        pHist = VmRESTMetricsGetHistogram(&pShard->pPhase[idx]);
+        if (pHist)
+        {
+            VmRESTMetricsAddSample(pShard, pHist, toNs - fromNs);
+        }
+    }
+}
+
+void
+VmRESTMetricsGetPhaseDurations(
+    PREST_REQUEST_TIMINGS            pTimings,
+    uint64_t                         durationNs[REST_PHASE_COUNT]
+    )
+{
+    uint64_t                         fromNs = 0;
+    uint64_t                         toNs = 0;
+    uint32_t                         idx = 0;
+
+    for (idx = 0; idx < REST_PHASE_COUNT; idx++)
+    {
+        durationNs[idx] = 0;
+
+        if (gMetricsPhaseFrom[idx] == REST_PHASE_COUNT)
+        {
+            continue;
+        }
+
+        fromNs = pTimings->phaseNs[gMetricsPhaseFrom[idx]];
+        toNs = pTimings->phaseNs[idx];
+        if (fromNs && (toNs >= fromNs))
+        {
+            durationNs[idx] = toNs - fromNs;
+        }
+    }
+}
+
+const char*
+VmRESTMetricsGetPhaseName(
+    REST_PHASE                       phase
+    )
+{
+    if ((unsigned)phase >= REST_PHASE_COUNT)
+    {
+        return "unknown";
+    }
+
+    return gMetricsPhaseName[phase];
+}
+
+uint64_t
+VmRESTMetricsNowNs(
+    void
+    )
+{
+#if defined(__x86_64__)
+    uint64_t                         tsc = 0;
+
+    if (gMetricsClock.bTsc)
+    {
+        tsc = __rdtsc();
+        if (tsc < gMetricsClock.baseTsc)
+        {
+            return gMetricsClock.baseNs;
+        }
+        return gMetricsClock.baseNs +
+               (uint64_t)(((unsigned __int128)(tsc - gMetricsClock.baseTsc) * gMetricsClock.nsPerTick32) >> 32);
+    }
+#endif
+
+    return VmRESTMetricsClockNs();
+}
+
+uint64_t
+VmRESTMetricsThreadCpuNs(
+    void
+    )
+{
+    struct timespec                  ts = {0};
+
+    if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0)
+    {
+        return 0;
+    }
+
+    return ((uint64_t)ts.tv_sec * 1000000000) + (uint64_t)ts.tv_nsec;
+}
+
+/**** Counts of live threads are read while they change, values are approximate ****/
+static
+void
+VmRESTMetricsSumShard(
+    PVMREST_METRICS                  pMetrics,
+    PVMREST_METRICS_SHARD            pShard,
+    uint64_t*                        pCounter,
+    PREST_STATS                      pStats,
+    PVMREST_METRICS_HISTOGRAM        pTotal,
+    PVMREST_METRICS_HISTOGRAM        pPhaseTotal
+    )
+{
+    uint32_t                         idx = 0;
+    uint32_t                         iRoute = 0;
+    uint32_t                         iMethod = 0;
+
+    for (idx = 0; idx < VMREST_METRIC_COUNT; idx++)
+    {
+        pCounter[idx] += pShard->counter[idx];
+    }
+    for (idx = 0; idx < VMREST_STATS_STATUS_CLASSES; idx++)
+    {
+        pStats->nResponses[idx] += pShard->nResponses[idx];
+    }
+    for (iRoute = 0; iRoute < pMetrics->nRoutes; iRoute++)
+    {
+        for (iMethod = 0; iMethod < VMREST_METRICS_METHODS; iMethod++)
+        {
+            VmRESTMetricsMergeHistogram(
+                pTotal,
+                __atomic_load_n(&pShard->pLatency[iRoute][iMethod], __ATOMIC_ACQUIRE)
+                );
+            VmRESTMetricsMergeCpu(
+                &pStats->cpu,
+                __atomic_load_n(&pShard->pCpu[iRoute][iMethod], __ATOMIC_ACQUIRE)
+                );
+        }
+    }
+    for (idx = 0; idx < REST_PHASE_COUNT; idx++)
+    {
+        VmRESTMetricsMergeHistogram(
+            &pPhaseTotal[idx],
+            __atomic_load_n(&pShard->pPhase[idx], __ATOMIC_ACQUIRE)
+            );
+    }
+}
+
+/**** Caller must hold registry lock ****/
+static
+void
+VmRESTMetricsSumRoute(
+    PVMREST_METRICS                  pMetrics,
+    uint32_t                         routeId,
+    uint32_t                         methodId,
+    PVMREST_METRICS_HISTOGRAM        pTotal
+    )
+{
+    PVMREST_METRICS_SHARD            pShard = NULL;
+
+    memset(pTotal, 0, sizeof(VMREST_METRICS_HISTOGRAM));
+
+    VmRESTMetricsMergeHistogram(
+        pTotal,
+        __atomic_load_n(&pMetrics->sharedShard.pLatency[routeId][methodId], __ATOMIC_ACQUIRE)
+        );
+
+    for (pShard = pMetrics->pShards; pShard; pShard = pShard->pNext)
+    {
+        VmRESTMetricsMergeHistogram(
+            pTotal,
+            __atomic_load_n(&pShard->pLatency[routeId][methodId], __ATOMIC_ACQUIRE)
+            );
+    }
+}
+
+/**** Caller must hold registry lock ****/
+static
+void
+VmRESTMetricsSumRouteCpu(
+    PVMREST_METRICS                  pMetrics,
+    uint32_t                         routeId,
+    uint32_t                         methodId,
+    PREST_CPU_STATS                  pTotal
+    )
+{
+    PVMREST_METRICS_SHARD            pShard = NULL;
+
+    memset(pTotal, 0, sizeof(REST_CPU_STATS));
+
+    VmRESTMetricsMergeCpu(
+        pTotal,
+        __atomic_load_n(&pMetrics->sharedShard.pCpu[routeId][methodId], __ATOMIC_ACQUIRE)
+        );
+
+    for (pShard = pMetrics->pShards; pShard; pShard = pShard->pNext)
+    {
+        VmRESTMetricsMergeCpu(
+            pTotal,
+            __atomic_load_n(&pShard->pCpu[routeId][methodId], __ATOMIC_ACQUIRE)
+            );
+    }
+}
+
+/**** Caller must hold registry lock ****/
+static
+void
+VmRESTMetricsSumPhase(
+    PVMREST_METRICS                  pMetrics,
+    uint32_t                         phase,
+    PVMREST_METRICS_HISTOGRAM        pTotal
+    )
+{
+    PVMREST_METRICS_SHARD            pShard = NULL;
+
+    memset(pTotal, 0, sizeof(VMREST_METRICS_HISTOGRAM));
+
+    VmRESTMetricsMergeHistogram(
+        pTotal,
+        __atomic_load_n(&pMetrics->sharedShard.pPhase[phase], __ATOMIC_ACQUIRE)
+        );
+
+    for (pShard = pMetrics->pShards; pShard; pShard = pShard->pNext)
+    {
+        VmRESTMetricsMergeHistogram(
+            pTotal,
+            __atomic_load_n(&pShard->pPhase[phase], __ATOMIC_ACQUIRE)
+            );
+    }
+}
+
+void
+VmRESTMetricsGetStats(
+    PVMREST_METRICS                  pMetrics,
+    PREST_STATS                      pStats
+    )
+{
+    VMREST_METRICS_HISTOGRAM         total = {0};
+    PVMREST_METRICS_HISTOGRAM        pPhaseTotal = NULL;
+    PVMREST_METRICS_SHARD            pShard = NULL;
+    uint64_t                         counter[VMREST_METRIC_COUNT] = {0};
+    uint32_t                         idx = 0;
+
+    if (!pMetrics || !pStats)
+    {
+        return;
+    }
+
+    memset(pStats, 0, sizeof(REST_STATS));
+
+    /**** Phase totals are too big for stack of a request thread ****/
+    if (VmRESTAllocateMemory(REST_PHASE_COUNT * sizeof(VMREST_METRICS_HISTOGRAM), (PVOID*)&pPhaseTotal, REST_MEM_OTHER) != 0)
+    {
+        return;
+    }
+
+    VmRESTLockMutex(pMetrics->pMutex);
+
+    VmRESTMetricsSumShard(pMetrics, &pMetrics->sharedShard, counter, pStats, &total, pPhaseTotal);
+    for (pShard = pMetrics->pShards; pShard; pShard = pShard->pNext)
+    {
+        VmRESTMetricsSumShard(pMetrics, pShard, counter, pStats, &total, pPhaseTotal);
+    }
+
+    VmRESTUnlockMutex(pMetrics->pMutex);
+
+    pStats->nBytesIn = counter[VMREST_METRIC_BYTES_IN];
+    pStats->nBytesOut = counter[VMREST_METRIC_BYTES_OUT];
+    pStats->nAccepts = counter[VMREST_METRIC_ACCEPTS];
+    pStats->nTimeouts = counter[VMREST_METRIC_TIMEOUTS];
+    pStats->nHandshakes = counter[VMREST_METRIC_HANDSHAKES];
+    pStats->nHandshakeFailures = counter[VMREST_METRIC_HANDSHAKE_FAILURES];
+
+    VmRESTMetricsFillLatency(&total, &pStats->latency);
+
+    for (idx = 0; idx < REST_PHASE_COUNT; idx++)
+    {
+        VmRESTMetricsFillPhase(&pPhaseTotal[idx], &pStats->phase[idx]);
+    }
+
+    VmRESTFreeMemory(pPhaseTotal, REST_MEM_OTHER);
+}
+
+void
+VmRESTMetricsGetRouteStats(
+    PVMREST_METRICS                  pMetrics,
+    PREST_ROUTE_STATS                pInfo,
+    uint32_t                         nMax,
+    uint32_t*                        pnCount
+    )
+{
+    VMREST_METRICS_HISTOGRAM         total = {0};
+    uint32_t                         iRoute = 0;
+    uint32_t                         iMethod = 0;
+    uint32_t                         nCount = 0;
+
+    if (!pMetrics || !pnCount)
+    {
+        return;
+    }
+
+    VmRESTLockMutex(pMetrics->pMutex);
+
+    for (iRoute = 0; iRoute < pMetrics->nRoutes; iRoute++)
+    {
+        for (iMethod = 0; iMethod < VMREST_METRICS_METHODS; iMethod++)
+        {
+            VmRESTMetricsSumRoute(pMetrics, iRoute, iMethod, &total);
+            if (total.nCount == 0)
+            {
+                continue;
+            }
+
+            if (pInfo && nMax)
+            {
+                if (nCount >= nMax)
+                {
+                    break;
+                }
+                memset(&pInfo[nCount], 0, sizeof(REST_ROUTE_STATS));
+                strncpy(pInfo[nCount].szRoute, pMetrics->pszRoute[iRoute], VMREST_STATS_ROUTE_LEN - 1);
+                strncpy(pInfo[nCount].szMethod, gMetricsMethod[iMethod], VMREST_STATS_METHOD_LEN - 1);
+                VmRESTMetricsFillLatency(&total, &pInfo[nCount].latency);
+                VmRESTMetricsSumRouteCpu(pMetrics, iRoute, iMethod, &pInfo[nCount].cpu);
+            }
+            nCount++;
+        }
+    }
+
+    VmRESTUnlockMutex(pMetrics->pMutex);
+
+    *pnCount = nCount;
+}
+
+void
+VmRESTMetricsGetLatencyHistogram(
+    PVMREST_METRICS                  pMetrics,
+    uint64_t*                        pBucket,
+    uint64_t*                        pUpper
+    )
+{
+    VMREST_METRICS_HISTOGRAM         total = {0};
+    PVMREST_METRICS_SHARD            pShard = NULL;
+    uint32_t                         iRoute = 0;
+    uint32_t                         iMethod = 0;
+    uint32_t                         idx = 0;
+
+    if (!pMetrics || !pBucket)
+    {
+        return;
+    }
+
+    VmRESTLockMutex(pMetrics->pMutex);
+
+    for (iRoute = 0; iRoute < pMetrics->nRoutes; iRoute++)
+    {
+        for (iMethod = 0; iMethod < VMREST_METRICS_METHODS; iMethod++)
+        {
+            VmRESTMetricsMergeHistogram(
+                &total,
+                __atomic_load_n(&pMetrics->sharedShard.pLatency[iRoute][iMethod], __ATOMIC_ACQUIRE)
+                );
+            for (pShard = pMetrics->pShards; pShard; pShard = pShard->pNext)
+            {
+                VmRESTMetricsMergeHistogram(
+                    &total,
+                    __atomic_load_n(&pShard->pLatency[iRoute][iMethod], __ATOMIC_ACQUIRE)
+                    );
+            }
+        }
+    }
+
+    VmRESTUnlockMutex(pMetrics->pMutex);
+
+    for (idx = 0; idx < VMREST_METRICS_HIST_BUCKETS; idx++)
+    {
+        pBucket[idx] = total.bucket[idx];
+        if (pUpper)
+        {
+            pUpper[idx] = VmRESTMetricsBucketUpper(idx);
+        }
+    }
+}
+
+static
+void
+VmRESTMetricsPrint(
+    PVMREST_METRICS_TEXT             pText,
+    const char*                      fmt,
+    ...
+    )
+{
+    va_list                          va;
+    int                              nLen = 0;
+    uint32_t                         nSize = 0;
+    char*                            pszText = NULL;
+
+    if (pText->dwError)
+    {
+        return;
+    }
+
+    for (;;)
+    {
+        va_start(va, fmt);
+        nLen = vsnprintf(pText->pszText + pText->nLen, pText->nSize - pText->nLen, fmt, va);
+        va_end(va);
+
+        if (nLen < 0)
+        {
+            pText->dwError = REST_ENGINE_FAILURE;
+            return;
+        }
+
+        if ((pText->nLen + (uint32_t)nLen) < pText->nSize)
+        {
+            pText->nLen += nLen;
+            return;
+        }
+
+        nSize = pText->nSize * 2;
+        while (nSize <= (pText->nLen + (uint32_t)nLen))
+        {
+            nSize *= 2;
+        }
+
+        pText->dwError = VmRESTReallocateMemory(
+                             pText->pszText,
+                             (PVOID*)&pszText,
+                             nSize,
+                             REST_MEM_RESPONSE
+                             );
+        if (pText->dwError)
+        {
+            return;
+        }
+        pText->pszText = pszText;
+        pText->nSize = nSize;
+    }
+}
+
+/**** Label value with backslash, quote and newline escaped ****/
+static
+void
+VmRESTMetricsPrintLabel(
+    PVMREST_METRICS_TEXT             pText,
+    const char*                      pszValue
+    )
+{
+    const char*                      p = NULL;
+
+    for (p = pszValue; *p; p++)
+    {
+        if (*p == '\\' || *p == '"')
+        {
+            VmRESTMetricsPrint(pText, "\\%c", *p);
+        }
+        else if (*p == '\n')
+        {
+            VmRESTMetricsPrint(pText, "\\n");
+        }
+        else
+        {
+            VmRESTMetricsPrint(pText, "%c", *p);
+        }
+    }
+}
+
+static
+void
+VmRESTMetricsPrintCounter(
+    PVMREST_METRICS_TEXT             pText,
+    const char*                      pszName,
+    const char*                      pszType,
+    const char*                      pszHelp,
+    uint64_t                         value
+    )
+{
+    VmRESTMetricsPrint(pText, "# HELP %s %s\n# TYPE %s %s\n%s %llu\n",
+                       pszName, pszHelp, pszName, pszType, pszName, (unsigned long long)value);
+}
+
+/**** Bucket of 2^k starts at (k - SUB_BITS + 1) * SUB, all below it are < 2^k ****/
+static
+void
+VmRESTMetricsPrintHistogram(
+    PVMREST_METRICS_TEXT             pText,
+    const char*                      pszName,
+    const char*                      pszLabels,
+    PVMREST_METRICS_HISTOGRAM        pHist,
+    const uint32_t*                  pEdgeShift,
+    uint32_t                         nEdges,
+    double                           unitsPerSecond
+    )
+{
+    uint32_t                         iEdge = 0;
+    uint32_t                         iBucket = 0;
+    uint32_t                         nEdgeBucket = 0;
+    uint64_t                         nCumulative = 0;
+
+    for (iEdge = 0; iEdge < nEdges; iEdge++)
+    {
+        nEdgeBucket = (pEdgeShift[iEdge] - VMREST_METRICS_HIST_SUB_BITS + 1) * VMREST_METRICS_HIST_SUB;
+        for (; (iBucket < nEdgeBucket) && (iBucket < VMREST_METRICS_HIST_BUCKETS); iBucket++)
+        {
+            nCumulative += pHist->bucket[iBucket];
+        }
+
+        VmRESTMetricsPrint(pText, "%s_bucket{%s,le=\"%.6f\"} %llu\n",
+                           pszName, pszLabels,
+                           (double)(1ULL << pEdgeShift[iEdge]) / unitsPerSecond,
+                           (unsigned long long)nCumulative);
+    }
+
+    VmRESTMetricsPrint(pText, "%s_bucket{%s,le=\"+Inf\"} %llu\n"
+                              "%s_sum{%s} %.9f\n"
+                              "%s_count{%s} %llu\n",
+                       pszName, pszLabels, (unsigned long long)pHist->nCount,
+                       pszName, pszLabels, (double)pHist->sum / unitsPerSecond,
+                       pszName, pszLabels, (unsigned long long)pHist->nCount);
+}
+
+uint32_t
+VmRESTMetricsFormat(
+    PVMREST_METRICS                  pMetrics,
+    PREST_STATS                      pStats,
+    char**                           ppszText,
+    uint32_t*                        pnLen
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    VMREST_METRICS_TEXT              text = {0};
+    VMREST_METRICS_TEXT              labels = {0};
+    VMREST_METRICS_HISTOGRAM         total = {0};
+    REST_CPU_STATS                   cpu = {0};
+    uint32_t                         iRoute = 0;
+    uint32_t                         iMethod = 0;
+    uint32_t                         iPhase = 0;
+    uint32_t                         idx = 0;
+
+    if (!pMetrics || !pStats || !ppszText || !pnLen)
+    {
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateMemoryNoZero(
+                  VMREST_METRICS_TEXT_INITIAL_SIZE,
+                  (PVOID*)&text.pszText,
+                  REST_MEM_RESPONSE
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    text.nSize = VMREST_METRICS_TEXT_INITIAL_SIZE;
+
+    dwError = VmRESTAllocateMemoryNoZero(
+                  VMREST_METRICS_LABELS_INITIAL_SIZE,
+                  (PVOID*)&labels.pszText,
+                  REST_MEM_RESPONSE
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    labels.nSize = VMREST_METRICS_LABELS_INITIAL_SIZE;
+
+    VmRESTMetricsPrint(&text, "# HELP vmrest_responses_total Responses sent by status class.\n"
+                              "# TYPE vmrest_responses_total counter\n");
+    for (idx = 0; idx < VMREST_STATS_STATUS_CLASSES; idx++)
+    {
+        if (idx == 0)
+        {
+            VmRESTMetricsPrint(&text, "vmrest_responses_total{class=\"other\"} %llu\n",
+                               (unsigned long long)pStats->nResponses[idx]);
+        }
+        else
+        {
+            VmRESTMetricsPrint(&text, "vmrest_responses_total{class=\"%uxx\"} %llu\n",
+                               idx, (unsigned long long)pStats->nResponses[idx]);
+        }
+    }
+
+    VmRESTMetricsPrintCounter(&text, "vmrest_bytes_received_total", "counter", "Bytes read from clients.", pStats->nBytesIn);
+    VmRESTMetricsPrintCounter(&text, "vmrest_bytes_sent_total", "counter", "Bytes written to clients.", pStats->nBytesOut);
+    VmRESTMetricsPrintCounter(&text, "vmrest_accepts_total", "counter", "Connections accepted.", pStats->nAccepts);
+    VmRESTMetricsPrintCounter(&text, "vmrest_timeouts_total", "counter", "Connections closed on idle or request timeout.", pStats->nTimeouts);
+    VmRESTMetricsPrintCounter(&text, "vmrest_tls_handshakes_total", "counter", "TLS handshakes completed.", pStats->nHandshakes);
+    VmRESTMetricsPrintCounter(&text, "vmrest_tls_handshake_failures_total", "counter", "TLS handshakes failed.", pStats->nHandshakeFailures);
+
+    VmRESTMetricsPrint(&text, "# HELP vmrest_connections Open client connections.\n"
+                              "# TYPE vmrest_connections gauge\n"
+                              "vmrest_connections{state=\"active\"} %u\n"
+                              "vmrest_connections{state=\"idle\"} %u\n",
+                              pStats->nActiveConnections, pStats->nIdleConnections);
+
+    VmRESTMetricsPrint(&text, "# HELP vmrest_request_duration_seconds Time from first request byte read to response completion.\n"
+                              "# TYPE vmrest_request_duration_seconds histogram\n");
+
+    VmRESTLockMutex(pMetrics->pMutex);
+
+    for (iRoute = 0; iRoute < pMetrics->nRoutes; iRoute++)
+    {
+        for (iMethod = 0; iMethod < VMREST_METRICS_METHODS; iMethod++)
+        {
+            VmRESTMetricsSumRoute(pMetrics, iRoute, iMethod, &total);
+            if (total.nCount == 0)
+            {
+                continue;
+            }
+
+            labels.nLen = 0;
+            VmRESTMetricsPrint(&labels, "route=\"");
+            VmRESTMetricsPrintLabel(&labels, pMetrics->pszRoute[iRoute]);
+            VmRESTMetricsPrint(&labels, "\",method=\"%s\"", gMetricsMethod[iMethod]);
+            text.dwError = text.dwError ? text.dwError : labels.dwError;
+
+            VmRESTMetricsPrintHistogram(
+                &text,
+                "vmrest_request_duration_seconds",
+                labels.pszText,
+                &total,
+                gMetricsPromEdgeShift,
+                sizeof(gMetricsPromEdgeShift) / sizeof(gMetricsPromEdgeShift[0]),
+                1000000.0
+                );
+        }
+    }
+
+    /**** Sampled requests only, samples count goes along to scale them ****/
+    VmRESTMetricsPrint(&text, "# HELP vmrest_request_cpu_seconds_total Thread CPU time of sampled requests by phase.\n"
+                              "# TYPE vmrest_request_cpu_seconds_total counter\n");
+
+    for (iRoute = 0; iRoute < pMetrics->nRoutes; iRoute++)
+    {
+        for (iMethod = 0; iMethod < VMREST_METRICS_METHODS; iMethod++)
+        {
+            VmRESTMetricsSumRouteCpu(pMetrics, iRoute, iMethod, &cpu);
+            if (cpu.nSamples == 0)
+            {
+                continue;
+            }
+
+            for (idx = 0; idx < REST_CPU_PHASE_COUNT; idx++)
+            {
+                VmRESTMetricsPrint(&text, "vmrest_request_cpu_seconds_total{route=\"");
+                VmRESTMetricsPrintLabel(&text, pMetrics->pszRoute[iRoute]);
+                VmRESTMetricsPrint(&text, "\",method=\"%s\",phase=\"%s\"} %.9f\n",
+                                   gMetricsMethod[iMethod], gMetricsCpuPhaseName[idx],
+                                   (double)cpu.cpuNs[idx] / 1000000000.0);
+            }
+        }
+    }
+
+    VmRESTMetricsPrint(&text, "# HELP vmrest_request_cpu_samples_total Requests sampled for thread CPU time.\n"
+                              "# TYPE vmrest_request_cpu_samples_total counter\n");
+
+    for (iRoute = 0; iRoute < pMetrics->nRoutes; iRoute++)
+    {
+        for (iMethod = 0; iMethod < VMREST_METRICS_METHODS; iMethod++)
+        {
+            VmRESTMetricsSumRouteCpu(pMetrics, iRoute, iMethod, &cpu);
+            if (cpu.nSamples == 0)
+            {
+                continue;
+            }
+
+            VmRESTMetricsPrint(&text, "vmrest_request_cpu_samples_total{route=\"");
+            VmRESTMetricsPrintLabel(&text, pMetrics->pszRoute[iRoute]);
+            VmRESTMetricsPrint(&text, "\",method=\"%s\"} %llu\n",
+                               gMetricsMethod[iMethod], (unsigned long long)cpu.nSamples);
+        }
+    }
+
+    VmRESTMetricsPrint(&text, "# HELP vmrest_request_phase_duration_seconds Time taken to reach request phase from phase it counts from.\n"
+                              "# TYPE vmrest_request_phase_duration_seconds histogram\n");
+
+    for (iPhase = 0; iPhase < REST_PHASE_COUNT; iPhase++)
+    {
+        VmRESTMetricsSumPhase(pMetrics, iPhase, &total);
+        if (total.nCount == 0)
+        {
+            continue;
+        }
+
+        labels.nLen = 0;
+        VmRESTMetricsPrint(&labels, "phase=\"%s\"", gMetricsPhaseName[iPhase]);
+        text.dwError = text.dwError ? text.dwError : labels.dwError;
+
+        VmRESTMetricsPrintHistogram(
+            &text,
+            "vmrest_request_phase_duration_seconds",
+            labels.pszText,
+            &total,
+            gMetricsPhaseEdgeShift,
+            sizeof(gMetricsPhaseEdgeShift) / sizeof(gMetricsPhaseEdgeShift[0]),
+            1000000000.0
+            );
+    }
+
+    VmRESTUnlockMutex(pMetrics->pMutex);
+
+    dwError = text.dwError;
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    *ppszText = text.pszText;
+    *pnLen = text.nLen;
+
+cleanup:
+
+    if (labels.pszText)
+    {
+        VmRESTFreeMemory(labels.pszText, REST_MEM_RESPONSE);
+    }
+
+    return dwError;
+
+error:
+
+    if (text.pszText)
+    {
+        VmRESTFreeMemory(text.pszText, REST_MEM_RESPONSE);
+    }
+
+    goto cleanup;
+}
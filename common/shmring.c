@@ -0,0 +1,148 @@
+/* C-REST-Engine
+*
+* Copyright (c) 2017 VMware, Inc. All Rights Reserved.
+*
+* This product is licensed to you under the Apache 2.0 license (the "License").
+* You may not use this product except in compliance with the Apache 2.0 License.
+*
+* This product may include a number of subcomponents with separate copyright
+* notices and license terms. Your use of these subcomponents is subject to the
+* terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+*
+*/
+
+#include "includes.h"
+
+/**** Copies as much of pBuf as fits, returns bytes copied. Producer side only. ****/
+uint32_t
+VmRESTShmRingWrite(
+    PVMREST_SHM_RING                 pRing,
+    char*                            pData,
+    uint32_t                         nRingBytes,
+    const char*                      pBuf,
+    uint32_t                         nLen
+    )
+{
+    uint32_t                         head = 0;
+    uint32_t                         tail = 0;
+    uint32_t                         nFree = 0;
+    uint32_t                         offset = 0;
+    uint32_t                         nFirst = 0;
+
+    head = __atomic_load_n(&pRing->head, __ATOMIC_RELAXED);
+    tail = __atomic_load_n(&pRing->tail, __ATOMIC_ACQUIRE);
+
+    nFree = nRingBytes - (head - tail);
+    if (nLen > nFree)
+    {
+        nLen = nFree;
+    }
+
+    if (nLen > 0)
+    {
+        offset = head & (nRingBytes - 1);
+        nFirst = nRingBytes - offset;
+        if (nFirst > nLen)
+        {
+            nFirst = nLen;
+        }
+
+        memcpy(pData + offset, pBuf, nFirst);
+        memcpy(pData, pBuf + nFirst, nLen - nFirst);
+
+        __atomic_store_n(&pRing->head, head + nLen, __ATOMIC_RELEASE);
+    }
+
+    return nLen;
+}
+
+/**** Copies at most nLen bytes out of ring, returns bytes copied. Consumer side only. ****/
+uint32_t
+VmRESTShmRingRead(
+    PVMREST_SHM_RING                 pRing,
+    const char*                      pData,
+    uint32_t                         nRingBytes,
+    char*                            pBuf,
+    uint32_t                         nLen
+    )
+{
+    uint32_t                         head = 0;
+    uint32_t                         tail = 0;
+    uint32_t                         nUsed = 0;
+    uint32_t                         offset = 0;
+    uint32_t                         nFirst = 0;
+
+    tail = __atomic_load_n(&pRing->tail, __ATOMIC_RELAXED);
+    head = __atomic_load_n(&pRing->head, __ATOMIC_ACQUIRE);
+
+    nUsed = head - tail;
+    if (nLen > nUsed)
+    {
+        nLen = nUsed;
+    }
+
+    if (nLen > 0)
+    {
+        offset = tail & (nRingBytes - 1);
+        nFirst = nRingBytes - offset;
+        if (nFirst > nLen)
+        {
+            nFirst = nLen;
+        }
+
+        memcpy(pBuf, pData + offset, nFirst);
+        memcpy(pBuf + nFirst, pData, nLen - nFirst);
+
+        __atomic_store_n(&pRing->tail, tail + nLen, __ATOMIC_RELEASE);
+    }
+
+    return nLen;
+}
+
+uint32_t
+VmRESTShmRingUsed(
+    PVMREST_SHM_RING                 pRing
+    )
+{
+    return __atomic_load_n(&pRing->head, __ATOMIC_ACQUIRE) -
+           __atomic_load_n(&pRing->tail, __ATOMIC_ACQUIRE);
+}
+
+/**** Consumer found ring empty and is about to block on its eventfd. Announce it,
+      then look again, producer may have written before it could see the flag.
+      Returns bytes available, consumer must not block when it is non zero. ****/
+uint32_t
+VmRESTShmRingPrepareWait(
+    PVMREST_SHM_RING                 pRing
+    )
+{
+    uint32_t                         nUsed = 0;
+
+    __atomic_store_n(&pRing->bConsumerWaiting, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    nUsed = VmRESTShmRingUsed(pRing);
+    if (nUsed || __atomic_load_n(&pRing->bProducerClosed, __ATOMIC_ACQUIRE))
+    {
+        __atomic_store_n(&pRing->bConsumerWaiting, 0, __ATOMIC_RELAXED);
+    }
+
+    return nUsed;
+}
+
+/**** Producer after publishing data or closing. Non zero when consumer is blocked
+      and has to be woken through its eventfd. Only one producer wins the flag. ****/
+uint32_t
+VmRESTShmRingNeedsWakeup(
+    PVMREST_SHM_RING                 pRing
+    )
+{
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    if (!__atomic_load_n(&pRing->bConsumerWaiting, __ATOMIC_RELAXED))
+    {
+        return 0;
+    }
+
+    return __atomic_exchange_n(&pRing->bConsumerWaiting, 0, __ATOMIC_SEQ_CST);
+}
@@ -111,6 +111,8 @@ VmRESTStartProtocolServer(
     DWORD                            iThr = 0;
     PVM_WORKER_THREAD_DATA           pThreadData = NULL;
     BOOLEAN                          bNoIpV6 = FALSE;
+    BOOLEAN                          bGroupMember = FALSE;
+    BOOLEAN                          bGroupHost = FALSE;
 
     if (!pRESTHandle || !(pRESTHandle->pRESTConfig))
     {
@@ -121,47 +123,100 @@ VmRESTStartProtocolServer(
 
     pSockContext =  pRESTHandle->pSockContext;
 
-    dwError = VmRESTAllocateMutex(&pSockContext->pMutex);
-    BAIL_ON_VMREST_ERROR(dwError);
-
-    /**** Handle IPv4 case ****/
+    /**** Host of an engine group runs only queue and workers, members only listeners ****/
+    bGroupMember = VMREST_IS_ENGINE_GROUP_MEMBER(pRESTHandle);
+    bGroupHost = (pRESTHandle->pEngineGroup != NULL) && !bGroupMember;
 
-    dwError = VmwSockStartServer(
-                         pRESTHandle,
-                        dwFlags | VM_SOCK_CREATE_FLAGS_TCP |
-                                  VM_SOCK_CREATE_FLAGS_IPV4,
-                        &pSockContext->pListenerTCP
-                        );
+    dwError = VmRESTAllocateNamedMutex(&pSockContext->pMutex, "sock_context");
     BAIL_ON_VMREST_ERROR(dwError);
 
-#ifdef AF_INET6
-    /**** Handle IPv6 case ****/
+    /**** Signalled by transport when connections are drained and when last worker is done ****/
+    dwError = VmRESTAllocateCondition(&pSockContext->pStopCond);
+    BAIL_ON_VMREST_ERROR(dwError);
 
-    dwError = VmwSockStartServer(
-                   pRESTHandle,
-                   dwFlags | VM_SOCK_CREATE_FLAGS_TCP |
-                          VM_SOCK_CREATE_FLAGS_IPV6,
-                   &pSockContext->pListenerTCP6
-                   );
-    if (dwError != REST_ENGINE_SUCCESS)
+    if (bGroupHost || pRESTHandle->pRESTConfig->disableTCP)
     {
-        VMREST_LOG_WARNING(pRESTHandle,"%s","Problem in IpV6 configuation.. Server listening ONLY on IPv4 Address !!");
         bNoIpV6 = TRUE;
     }
+    else
+    {
+        /**** Handle IPv4 case ****/
+
+        dwError = VmwSockStartServer(
+                             pRESTHandle,
+                            dwFlags | VM_SOCK_CREATE_FLAGS_TCP |
+                                      VM_SOCK_CREATE_FLAGS_IPV4,
+                            &pSockContext->pListenerTCP
+                            );
+        BAIL_ON_VMREST_ERROR(dwError);
+
+#ifdef AF_INET6
+        /**** Handle IPv6 case ****/
+
+        dwError = VmwSockStartServer(
+                       pRESTHandle,
+                       dwFlags | VM_SOCK_CREATE_FLAGS_TCP |
+                              VM_SOCK_CREATE_FLAGS_IPV6,
+                       &pSockContext->pListenerTCP6
+                       );
+        if (dwError != REST_ENGINE_SUCCESS)
+        {
+            VMREST_LOG_WARNING(pRESTHandle,"%s","Problem in IpV6 configuation.. Server listening ONLY on IPv4 Address !!");
+            bNoIpV6 = TRUE;
+        }
 #endif
+    }
 
-    dwError = VmwSockCreateEventQueue(
-                  pRESTHandle,
-                  &pSockContext->pEventQueue
-                  );
-    BAIL_ON_VMREST_ERROR(dwError);
+    /**** Handle unix domain socket case, for clients on same host ****/
+    if (!bGroupHost && !IsNullOrEmptyString(pRESTHandle->pRESTConfig->pszUnixSocketPath))
+    {
+        dwError = VmwSockStartServer(
+                       pRESTHandle,
+                       dwFlags | VM_SOCK_CREATE_FLAGS_UNIX,
+                       &pSockContext->pListenerUnix
+                       );
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
 
-    dwError = VmwSockAddEventToQueueInLock(
-                  pRESTHandle,
-                  pSockContext->pEventQueue,
-                  pSockContext->pListenerTCP
-                  );
-    BAIL_ON_VMREST_ERROR(dwError);
+    /**** Rendezvous socket of shared memory channels ****/
+    if (!bGroupHost && !IsNullOrEmptyString(pRESTHandle->pRESTConfig->pszShmSocketPath))
+    {
+        dwError = VmwSockStartServer(
+                       pRESTHandle,
+                       dwFlags | VM_SOCK_CREATE_FLAGS_UNIX | VM_SOCK_CREATE_FLAGS_SHM,
+                       &pSockContext->pListenerShm
+                       );
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
+    if (bGroupMember)
+    {
+        pSockContext->pEventQueue = pRESTHandle->pEngineGroup->pRESTHandle->pSockContext->pEventQueue;
+
+        dwError = VmwSockAttachEventQueue(
+                      pRESTHandle,
+                      pSockContext->pEventQueue
+                      );
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+    else
+    {
+        dwError = VmwSockCreateEventQueue(
+                      pRESTHandle,
+                      &pSockContext->pEventQueue
+                      );
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
+    if (pSockContext->pListenerTCP)
+    {
+        dwError = VmwSockAddEventToQueueInLock(
+                      pRESTHandle,
+                      pSockContext->pEventQueue,
+                      pSockContext->pListenerTCP
+                      );
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
 
 #ifdef AF_INET6
     if (!bNoIpV6)
@@ -175,9 +230,36 @@ VmRESTStartProtocolServer(
     }
 #endif
 
+    if (pSockContext->pListenerUnix)
+    {
+        dwError = VmwSockAddEventToQueueInLock(
+                      pRESTHandle,
+                      pSockContext->pEventQueue,
+                      pSockContext->pListenerUnix
+                      );
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
+    if (pSockContext->pListenerShm)
+    {
+        dwError = VmwSockAddEventToQueueInLock(
+                      pRESTHandle,
+                      pSockContext->pEventQueue,
+                      pSockContext->pListenerShm
+                      );
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
+    if (bGroupMember)
+    {
+        /**** Served by workers of the group ****/
+        goto cleanup;
+    }
+
     dwError = VmRESTAllocateMemory(
                   sizeof(PVMREST_THREAD) * ((int)(pRESTHandle->pRESTConfig->nWorkerThr)),
-                  (PVOID*)&pSockContext->pWorkerThreads
+                  (PVOID*)&pSockContext->pWorkerThreads,
+                  REST_MEM_OTHER
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -187,7 +269,8 @@ VmRESTStartProtocolServer(
     {
         dwError = VmRESTAllocateMemory(
                   sizeof(VM_WORKER_THREAD_DATA) ,
-                  (PVOID*)&pThreadData
+                  (PVOID*)&pThreadData,
+                  REST_MEM_OTHER
                   );
         BAIL_ON_VMREST_ERROR(dwError);
         pThreadData->pSockContext = pSockContext;
@@ -195,7 +278,8 @@ VmRESTStartProtocolServer(
 
         dwError = VmRESTAllocateMemory(
                       sizeof(VMREST_THREAD),
-                      (void **)&pSockContext->pWorkerThreads[iThr]
+                      (void **)&pSockContext->pWorkerThreads[iThr],
+                      REST_MEM_OTHER
                       );
         BAIL_ON_VMREST_ERROR(dwError);
 
@@ -220,7 +304,7 @@ cleanup:
 error:
     if (pThreadData != NULL)
     {
-        VmRESTFreeMemory(pThreadData);
+        VmRESTFreeMemory(pThreadData, REST_MEM_OTHER);
         pThreadData = NULL;
     }
 
@@ -263,6 +347,13 @@ VmRESTShutdownProtocolServer(
     if (pRESTHandle)
     {
         VmwSockShutdown(pRESTHandle);
+
+        /**** Connections and their buffers are gone, log still works ****/
+        if (pRESTHandle->pRESTConfig && pRESTHandle->pRESTConfig->enableMemoryDebug)
+        {
+            VmRESTMemoryDebugReport(pRESTHandle);
+        }
+
         VmRESTLogTerminate(pRESTHandle);
     }
 }
@@ -276,6 +367,7 @@ VmRESTSockWorkerThreadProc(
     DWORD                            dwError = 0;
     PVM_WORKER_THREAD_DATA           pWorkerData = (PVM_WORKER_THREAD_DATA)pData;
     PVMREST_HANDLE                   pRESTHandle = NULL;
+    PVMREST_HANDLE                   pSockHandle = NULL;
     PVMREST_SOCK_CONTEXT             pSockContext = NULL;
     PVM_SOCKET                       pSocket = NULL;
 
@@ -283,7 +375,7 @@ VmRESTSockWorkerThreadProc(
     {
         pRESTHandle = pWorkerData-> pRESTHandle;
         pSockContext = pWorkerData->pSockContext;
-        VmRESTFreeMemory(pWorkerData);
+        VmRESTFreeMemory(pWorkerData, REST_MEM_OTHER);
         pWorkerData = NULL;
     }
     else
@@ -306,8 +398,16 @@ VmRESTSockWorkerThreadProc(
         {
             break;
         }
+
+        /**** With an engine group, socket belongs to one of its member instances ****/
+        pSockHandle = pRESTHandle;
+        if (pSocket)
+        {
+            VmwSockGetSocketHandle(pRESTHandle, pSocket, &pSockHandle);
+        }
+
         dwError = VmRESTHandleSocketEvent(
-                         pRESTHandle,
+                        pSockHandle,
                         pSocket,
                         eventType,
                         pSockContext->pEventQueue,
@@ -430,6 +530,7 @@ VmRESTOnConnectionTimeout(
     }
 
     VMREST_LOG_DEBUG(pRESTHandle,"%s","Connection Timeout..Closing conn..");
+    VmRESTMetricsAdd(pRESTHandle->pMetrics, VMREST_METRIC_TIMEOUTS, 1);
 
     VmRESTSendFailureResponse(
         pRESTHandle,
@@ -501,6 +602,14 @@ VmRESTTcpReceiveNewData(
                       );
         BAIL_ON_VMREST_ERROR(dwError);
     }
+    else if (pRESTHandle->bTraceEnabled)
+    {
+        /**** Request picked for tracing on an earlier read, tag this thread again ****/
+        VmRESTGetRequestTraceId(
+            pRequest,
+            &gVmRESTLogTraceId
+            );
+    }
 
     /**** Do socket read ****/
     dwError = VmwSockRead(
@@ -536,7 +645,7 @@ VmRESTTcpReceiveNewData(
     {
         /**** Server has limit on maximum size of payload ****/
         dwError = 413;
-        VMREST_LOG_ERROR(pRESTHandle,"%s","Request payload too large..closing connection");
+        VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"%s","Request payload too large..closing connection");
         BAIL_ON_VMREST_ERROR(dwError);
     }
 
@@ -591,11 +700,13 @@ cleanup:
         }
     }
 
+    gVmRESTLogTraceId = 0;
+
     return dwError;
 
 error:
 
-    VMREST_LOG_ERROR(pRESTHandle,"ERROR code %u", dwError);
+    VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"ERROR code %u", dwError);
 
     goto cleanup;
 }
@@ -637,8 +748,33 @@ VmRESTSockContextFree(
         BAIL_ON_VMREST_ERROR(dwError);
         VmwSockClose( pRESTHandle, pSockContext->pListenerTCP6);
     }
+    if (pSockContext->pListenerUnix)
+    {
+        dwError = VmwSockDeleteEventFromQueue(
+                      pRESTHandle,
+                      pSockContext->pEventQueue,
+                      pSockContext->pListenerUnix
+                      );
+        BAIL_ON_VMREST_ERROR(dwError);
+        VmwSockClose( pRESTHandle, pSockContext->pListenerUnix);
+    }
+    if (pSockContext->pListenerShm)
+    {
+        dwError = VmwSockDeleteEventFromQueue(
+                      pRESTHandle,
+                      pSockContext->pEventQueue,
+                      pSockContext->pListenerShm
+                      );
+        BAIL_ON_VMREST_ERROR(dwError);
+        VmwSockClose( pRESTHandle, pSockContext->pListenerShm);
+    }
 
-    if (pSockContext->pEventQueue)
+    if (VMREST_IS_ENGINE_GROUP_MEMBER(pRESTHandle))
+    {
+        /**** Queue and workers stay for other members, group host closes them ****/
+        dwError = VmwSockDetachEventQueue(pRESTHandle, pSockContext->pEventQueue, waitSecond);
+    }
+    else if (pSockContext->pEventQueue)
     {
         dwError = VmwSockCloseEventQueue(pRESTHandle, pSockContext->pEventQueue, waitSecond);
     }
@@ -654,6 +790,16 @@ VmRESTSockContextFree(
         VmwSockRelease( pRESTHandle, pSockContext->pListenerTCP6);
     }
 
+    if (pSockContext->pListenerUnix)
+    {
+        VmwSockRelease( pRESTHandle, pSockContext->pListenerUnix);
+    }
+
+    if (pSockContext->pListenerShm)
+    {
+        VmwSockRelease( pRESTHandle, pSockContext->pListenerShm);
+    }
+
     if (pSockContext->pWorkerThreads)
     {
         DWORD iThr = 0;
@@ -668,7 +814,12 @@ VmRESTSockContextFree(
             }
         }
 
-        VmRESTFreeMemory(pSockContext->pWorkerThreads);
+        VmRESTFreeMemory(pSockContext->pWorkerThreads, REST_MEM_OTHER);
+    }
+    if (pSockContext->pStopCond)
+    {
+        VmRESTFreeCondition(pSockContext->pStopCond);
+        pSockContext->pStopCond = NULL;
     }
     if (pSockContext->pMutex)
     {
@@ -739,6 +890,35 @@ error:
     goto cleanup;
 }
 
+uint32_t
+VmRESTCommonSendFileAtOnce(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    int                              fd,
+    uint64_t                         offset,
+    uint32_t                         nBytes
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+
+    dwError = VmwSockSendFile(
+                  pRESTHandle,
+                  pSocket,
+                  fd,
+                  offset,
+                  nBytes
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
 uint32_t
 VmRESTCommonGetPeerInfo(
     PVMREST_HANDLE                   pRESTHandle,
@@ -768,3 +948,205 @@ error:
     goto cleanup;
 }
 
+uint32_t
+VmRESTCommonGetPeerCredentials(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    int*                             pPid,
+    uint32_t*                        pUid,
+    uint32_t*                        pGid
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+
+    dwError = VmwSockGetPeerCredentials(
+                  pRESTHandle,
+                  pSocket,
+                  pPid,
+                  pUid,
+                  pGid
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+uint32_t
+VmRESTCommonGetConnectionState(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    uint64_t*                        pAcceptNs,
+    uint64_t*                        pTlsDoneNs,
+    uint32_t*                        pnRequests
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+
+    dwError = VmwSockGetConnectionState(
+                  pRESTHandle,
+                  pSocket,
+                  pAcceptNs,
+                  pTlsDoneNs,
+                  pnRequests
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+
+/**** Stands between engine and caller sink, remembers whether caller refused data ****/
+typedef struct _VMREST_LOOPBACK_SINK
+{
+    REST_RESPONSE_SINK               sink;
+    PREST_RESPONSE_SINK              pCallerSink;
+    BOOLEAN                          bRefused;
+} VMREST_LOOPBACK_SINK, *PVMREST_LOOPBACK_SINK;
+
+static
+uint32_t
+VmRESTLoopbackSinkWrite(
+    void*                            pContext,
+    const char*                      pData,
+    uint32_t                         nLen
+    )
+{
+    PVMREST_LOOPBACK_SINK            pLoopbackSink = (PVMREST_LOOPBACK_SINK)pContext;
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+
+    /**** Engine tries an error response after a failed write, that one is refused as well ****/
+    if (pLoopbackSink->bRefused)
+    {
+        return REST_ENGINE_CONNECTION_CLOSED;
+    }
+
+    dwError = pLoopbackSink->pCallerSink->pfnWrite(pLoopbackSink->pCallerSink->pContext, pData, nLen);
+    if (dwError)
+    {
+        pLoopbackSink->bRefused = TRUE;
+    }
+
+    return dwError;
+}
+
+uint32_t
+VmRESTDispatchLoopback(
+    PVMREST_HANDLE                   pRESTHandle,
+    char const*                      pszRequest,
+    uint32_t                         nLen,
+    PREST_RESPONSE_SINK              pSink
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    VMREST_LOOPBACK_SINK             loopbackSink = {{0}};
+    PVM_SOCKET                       pSocket = NULL;
+    PREST_REQUEST                    pRequest = NULL;
+    char*                            pszBuffer = NULL;
+    uint32_t                         nProcessed = 0;
+
+    if (!pRESTHandle || !pszRequest || (nLen == 0) || !pSink || !pSink->pfnWrite)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if (nLen >= pRESTHandle->pRESTConfig->maxDataPerConnMB)
+    {
+        /**** Same payload limit as network clients, config holds it in bytes by now ****/
+        dwError = 413;
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Request payload too large");
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    loopbackSink.sink.pfnWrite = &VmRESTLoopbackSinkWrite;
+    loopbackSink.sink.pContext = &loopbackSink;
+    loopbackSink.pCallerSink = pSink;
+
+    dwError = VmwSockCreateLoopback(
+                  pRESTHandle,
+                  &loopbackSink.sink,
+                  &pSocket
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Parser relies on NUL terminated data, caller buffer is const ****/
+    dwError = VmRESTAllocateMemoryNoZero(
+                  nLen + 1,
+                  (PVOID*)&pszBuffer,
+                  REST_MEM_REQUEST
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    memcpy(pszBuffer, pszRequest, nLen);
+    pszBuffer[nLen] = '\0';
+
+    dwError = VmRESTGetRequestHandle(
+                  pRESTHandle,
+                  pSocket,
+                  &pRequest
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Runs handler and writes response into sink. Malformed requests get their
+          error response here as well and come back as success. ****/
+    dwError = VmRESTProcessBuffer(
+                  pRESTHandle,
+                  pszBuffer,
+                  nLen,
+                  pRequest,
+                  &nProcessed
+                  );
+    if (dwError == REST_ENGINE_MORE_IO_REQUIRED)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Incomplete request of %u bytes", nLen);
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Engine treats failed write like a lost peer, caller has to learn about it ****/
+    if (loopbackSink.bRefused)
+    {
+        dwError = REST_ENGINE_CONNECTION_CLOSED;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+
+    if (pRequest)
+    {
+        VmRESTFreeRequestHandle(
+            pRESTHandle,
+            pRequest
+            );
+    }
+    if (pszBuffer)
+    {
+        VmRESTFreeMemory(pszBuffer, REST_MEM_REQUEST);
+    }
+    if (pSocket)
+    {
+        VmwSockRelease(
+            pRESTHandle,
+            pSocket
+            );
+    }
+
+    gVmRESTLogTraceId = 0;
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
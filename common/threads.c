@@ -42,6 +42,18 @@ DWORD
 VmRESTAllocateMutex(
     PVMREST_MUTEX*                   ppMutex
 )
+{
+    return VmRESTAllocateNamedMutex(
+               ppMutex,
+               NULL
+               );
+}
+
+DWORD
+VmRESTAllocateNamedMutex(
+    PVMREST_MUTEX*                   ppMutex,
+    const char*                      pszName
+)
 {
     DWORD                            dwError = ERROR_SUCCESS;
     PVMREST_MUTEX                    pVmRESTMutex = NULL;
@@ -54,20 +66,24 @@ VmRESTAllocateMutex(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(VMREST_MUTEX),
-                  ((PVOID*)&pVmRESTMutex)
+                  ((PVOID*)&pVmRESTMutex),
+                  REST_MEM_OTHER
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
     dwError = VmRESTInitializeMutexContent( pVmRESTMutex );
     BAIL_ON_VMREST_ERROR(dwError);
 
+    /**** No class only means lock is not profiled ****/
+    pVmRESTMutex->pClass = VmRESTLockGetClass(pszName);
+
     *ppMutex = pVmRESTMutex;
     pVmRESTMutex = NULL;
 
 error:
     if (pVmRESTMutex)
     {
-        VmRESTFreeMemory(pVmRESTMutex);
+        VmRESTFreeMemory(pVmRESTMutex, REST_MEM_OTHER);
         pVmRESTMutex = NULL;
     }
 
@@ -88,6 +104,7 @@ VmRESTInitializeMutexContent(
     }
 
     memset( &(pMutex->critSect), 0, sizeof(pthread_mutex_t) );
+    pMutex->lockedNs = 0;
 
     dwError = pthread_mutex_init(
                   &(pMutex->critSect),
@@ -110,7 +127,7 @@ VmRESTFreeMutex(
     VmRESTFreeMutexContent(pMutex);
     if (pMutex)
     { 
-        VmRESTFreeMemory(pMutex);
+        VmRESTFreeMemory(pMutex, REST_MEM_OTHER);
         pMutex = NULL;
     }
 }
@@ -127,10 +144,90 @@ VmRESTFreeMutexContent(
     }
 }
 
+/**** Trylock first so contended acquisitions and their wait can be told apart.
+      Lock got by trylock takes no timestamp, hold time is only measured for
+      acquisitions which had to wait ****/
+static
 DWORD
-VmRESTLockMutex(
+VmRESTLockMutexProfiled(
+    PVMREST_MUTEX                    pMutex,
+    const char*                      pszFile,
+    int                              line
+)
+{
+    DWORD                            dwError = ERROR_SUCCESS;
+    uint64_t                         startNs = 0;
+
+    dwError = pthread_mutex_trylock( &(pMutex->critSect) );
+    if (dwError == EBUSY)
+    {
+        startNs = VmRESTMetricsNowNs();
+        dwError = pthread_mutex_lock( &(pMutex->critSect) );
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        pMutex->lockedNs = VmRESTMetricsNowNs();
+
+        VmRESTLockRecordAcquire(
+            pMutex->pClass,
+            pMutex->lockedNs - startNs,
+            TRUE,
+            pszFile,
+            line
+            );
+    }
+    else
+    {
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        VmRESTLockRecordAcquire(pMutex->pClass, 0, FALSE, NULL, 0);
+    }
+
+error:
+
+    return dwError;
+}
+
+/**** Caller holds pMutex, hold time goes on after condition wait only if it
+      was measured before ****/
+static
+VOID
+VmRESTMutexBeginHold(
+    PVMREST_MUTEX                    pMutex,
+    BOOLEAN                          bTimed
+)
+{
+    if (bTimed)
+    {
+        pMutex->lockedNs = VmRESTMetricsNowNs();
+    }
+}
+
+static
+BOOLEAN
+VmRESTMutexEndHold(
     PVMREST_MUTEX                    pMutex
 )
+{
+    uint64_t                         lockedNs = pMutex->lockedNs;
+
+    if (lockedNs)
+    {
+        pMutex->lockedNs = 0;
+        VmRESTLockRecordHold(
+            pMutex->pClass,
+            VmRESTMetricsNowNs() - lockedNs
+            );
+    }
+
+    return (lockedNs != 0);
+}
+
+DWORD
+VmRESTLockMutexAt(
+    PVMREST_MUTEX                    pMutex,
+    const char*                      pszFile,
+    int                              line
+)
 {
     DWORD                            dwError = ERROR_SUCCESS;
 
@@ -144,7 +241,14 @@ VmRESTLockMutex(
         BAIL_ON_VMREST_ERROR(dwError);
     }
 
-    dwError = pthread_mutex_lock( &(pMutex->critSect) );
+    if (gVmRESTLockProfiling && pMutex->pClass)
+    {
+        dwError = VmRESTLockMutexProfiled(pMutex, pszFile, line);
+    }
+    else
+    {
+        dwError = pthread_mutex_lock( &(pMutex->critSect) );
+    }
     BAIL_ON_VMREST_ERROR(dwError);
 
 error:
@@ -169,6 +273,8 @@ VmRESTUnlockMutex(
         BAIL_ON_VMREST_ERROR(dwError);
     }
 
+    VmRESTMutexEndHold(pMutex);
+
     dwError = pthread_mutex_unlock( &(pMutex->critSect) );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -202,7 +308,8 @@ VmRESTAllocateCondition(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(VMREST_COND),
-                  ((PVOID*)&pVmRESTCond)
+                  ((PVOID*)&pVmRESTCond),
+                  REST_MEM_OTHER
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -216,7 +323,7 @@ error:
 
     if (pVmRESTCond)
     {
-        VmRESTFreeMemory(pVmRESTCond);
+        VmRESTFreeMemory(pVmRESTCond, REST_MEM_OTHER);
         pVmRESTCond = NULL;
     }
 
@@ -255,7 +362,7 @@ VmRESTFreeCondition(
     VmRESTFreeConditionContent( pCondition );
     if (pCondition)
     {
-        VmRESTFreeMemory(pCondition);
+        VmRESTFreeMemory(pCondition, REST_MEM_OTHER);
         pCondition = NULL;
     }
 }
@@ -279,6 +386,7 @@ VmRESTConditionWait(
 )
 {
     DWORD                            dwError = ERROR_SUCCESS;
+    BOOLEAN                          bTimed = FALSE;
 
     if ( ( pCondition == NULL )
          ||
@@ -293,10 +401,14 @@ VmRESTConditionWait(
         BAIL_ON_VMREST_ERROR(dwError);
     }
 
+    /**** Mutex is released while waiting, that is not held time ****/
+    bTimed = VmRESTMutexEndHold(pMutex);
+
     dwError = pthread_cond_wait(
                   &(pCondition->cond),
                   &(pMutex->critSect)
                   );
+    VmRESTMutexBeginHold(pMutex, bTimed);
     BAIL_ON_VMREST_ERROR(dwError);
 
 error:
@@ -313,7 +425,7 @@ VmRESTConditionTimedWait(
 {
     DWORD                            dwError = ERROR_SUCCESS;
     struct timespec                  ts = {0};
-    BOOLEAN                          bLocked = FALSE;
+    BOOLEAN                          bTimed = FALSE;
 
     if ( ( pCondition == NULL )
          ||
@@ -328,37 +440,57 @@ VmRESTConditionTimedWait(
         BAIL_ON_VMREST_ERROR(dwError);
     }
 
-    ts.tv_sec = time(NULL) + dwMilliseconds/1000;
-    ts.tv_nsec = 0;
-
-    dwError = VmRESTLockMutex(pMutex);
-    BAIL_ON_VMREST_ERROR(dwError);
+    /**** Like VmRESTConditionWait, caller holds pMutex. Returns ETIMEDOUT when time is up. ****/
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += dwMilliseconds / 1000;
+    ts.tv_nsec += (dwMilliseconds % 1000) * 1000000;
+    if (ts.tv_nsec >= 1000000000)
+    {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000;
+    }
 
-    bLocked = TRUE;
+    bTimed = VmRESTMutexEndHold(pMutex);
 
     dwError = pthread_cond_timedwait(
                   &(pCondition->cond),
                   &(pMutex->critSect),
                   &ts
                   );
+    VmRESTMutexBeginHold(pMutex, bTimed);
     BAIL_ON_VMREST_ERROR(dwError);
 
-cleanup:
+error:
+
+    return dwError;
+}
 
-    if (bLocked)
+DWORD
+VmRESTConditionSignal(
+    PVMREST_COND                     pCondition
+)
+{
+    DWORD                            dwError = ERROR_SUCCESS;
+
+    if ( ( pCondition == NULL )
+         ||
+         ( pCondition->bInitialized == FALSE )
+       )
     {
-        VmRESTUnlockMutex(pMutex);
+        dwError = ERROR_INVALID_PARAMETER;
+        BAIL_ON_VMREST_ERROR(dwError);
     }
 
-    return dwError;
+    dwError = pthread_cond_signal( &(pCondition->cond) );
+    BAIL_ON_VMREST_ERROR(dwError);
 
 error:
 
-    goto cleanup;
+    return dwError;
 }
 
 DWORD
-VmRESTConditionSignal(
+VmRESTConditionBroadcast(
     PVMREST_COND                     pCondition
 )
 {
@@ -373,7 +505,7 @@ VmRESTConditionSignal(
         BAIL_ON_VMREST_ERROR(dwError);
     }
 
-    dwError = pthread_cond_signal( &(pCondition->cond) );
+    dwError = pthread_cond_broadcast( &(pCondition->cond) );
     BAIL_ON_VMREST_ERROR(dwError);
 
 error:
@@ -417,7 +549,7 @@ ThreadFunction(
 error:
    if (pArgs)
     {
-        VmRESTFreeMemory(pArgs);
+        VmRESTFreeMemory(pArgs, REST_MEM_OTHER);
         pArgs = NULL;
     }
 
@@ -456,7 +588,8 @@ VmRESTCreateThread(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(VMREST_THREAD_START_INFO),
-                  ((PVOID*)&pThreadStartInfo)
+                  ((PVOID*)&pThreadStartInfo),
+                  REST_MEM_OTHER
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -487,7 +620,7 @@ error:
 
     if (pThreadStartInfo)
     {
-        VmRESTFreeMemory(pThreadStartInfo);
+        VmRESTFreeMemory(pThreadStartInfo, REST_MEM_OTHER);
         pThreadStartInfo = NULL;
     }
 
@@ -537,7 +670,7 @@ VmRESTFreeThread(
 {
     if ( pThread != NULL )
     {
-        VmRESTFreeMemory(pThread);
+        VmRESTFreeMemory(pThread, REST_MEM_OTHER);
 
         /**** nothing to free really ****/
 #ifndef _WIN32
@@ -550,6 +683,18 @@ DWORD
 VmRESTAllocateRWLock(
     PVMREST_RWLOCK*                  ppLock
     )
+{
+    return VmRESTAllocateNamedRWLock(
+               ppLock,
+               NULL
+               );
+}
+
+DWORD
+VmRESTAllocateNamedRWLock(
+    PVMREST_RWLOCK*                  ppLock,
+    const char*                      pszName
+    )
 {
     DWORD                            dwError = ERROR_SUCCESS;
     PVMREST_RWLOCK                   pLock = NULL;
@@ -562,7 +707,8 @@ VmRESTAllocateRWLock(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(VMREST_RWLOCK),
-                  (void**)&pLock
+                  (void**)&pLock,
+                  REST_MEM_OTHER
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -584,6 +730,8 @@ VmRESTAllocateRWLock(
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
+    pLock->pClass = VmRESTLockGetClass(pszName);
+
     *ppLock = pLock;
 
 cleanup:
@@ -591,7 +739,7 @@ cleanup:
 error:
     if (pLock)
     {
-        VmRESTFreeMemory(pLock);
+        VmRESTFreeMemory(pLock, REST_MEM_OTHER);
         pLock = NULL;
     } 
     goto cleanup;
@@ -604,20 +752,94 @@ VmRESTFreeRWLock(
 {
     pthread_key_delete(pLock->readKey);
     pthread_key_delete(pLock->writeKey);
-    VmRESTFreeMemory(pLock);
+    VmRESTFreeMemory(pLock, REST_MEM_OTHER);
+}
+
+/**** Only first lock of a thread gets here, nested ones are counted in keys. Hold
+      time is kept for write locks which had to wait, readers share lock and have
+      no single start. Lock got by trylock takes no timestamp ****/
+static
+void
+VmRESTRWLockAcquire(
+    PVMREST_RWLOCK                   pLock,
+    BOOLEAN                          bWrite,
+    const char*                      pszFile,
+    int                              line
+    )
+{
+    uint64_t                         startNs = 0;
+    uint64_t                         nowNs = 0;
+
+    if (!gVmRESTLockProfiling || !pLock->pClass)
+    {
+        if (bWrite)
+        {
+            pthread_rwlock_wrlock(&pLock->rwLock);
+        }
+        else
+        {
+            pthread_rwlock_rdlock(&pLock->rwLock);
+        }
+        return;
+    }
+
+    if ((bWrite ? pthread_rwlock_trywrlock(&pLock->rwLock) : pthread_rwlock_tryrdlock(&pLock->rwLock)) == 0)
+    {
+        VmRESTLockRecordAcquire(pLock->pClass, 0, FALSE, NULL, 0);
+        return;
+    }
+
+    startNs = VmRESTMetricsNowNs();
+    if (bWrite)
+    {
+        pthread_rwlock_wrlock(&pLock->rwLock);
+    }
+    else
+    {
+        pthread_rwlock_rdlock(&pLock->rwLock);
+    }
+
+    nowNs = VmRESTMetricsNowNs();
+    if (bWrite)
+    {
+        pLock->lockedNs = nowNs;
+    }
+
+    VmRESTLockRecordAcquire(
+        pLock->pClass,
+        nowNs - startNs,
+        TRUE,
+        pszFile,
+        line
+        );
 }
 
+/**** Trylock that got lock, it did not wait ****/
+static
 void
-VmRESTLockRead(
+VmRESTRWLockTryAcquired(
     PVMREST_RWLOCK                   pLock
     )
+{
+    if (gVmRESTLockProfiling && pLock->pClass)
+    {
+        VmRESTLockRecordAcquire(pLock->pClass, 0, FALSE, NULL, 0);
+    }
+}
+
+void
+VmRESTLockReadAt(
+    PVMREST_RWLOCK                   pLock,
+    const char*                      pszFile,
+    int                              line
+    )
 {
     int* pWriteLockCount = VmRESTGetLockKey(&pLock->writeKey);
     int* pReadLockCount = VmRESTGetLockKey(&pLock->readKey);
 
     if (!pWriteLockCount || !pReadLockCount)
     {
-        pthread_rwlock_rdlock(&pLock->rwLock);
+        VmRESTRWLockAcquire(pLock, FALSE, pszFile, line);
     }
     else
     {
@@ -632,7 +854,7 @@ VmRESTLockRead(
         {
             if (*pReadLockCount == 0)
             {
-                pthread_rwlock_rdlock(&pLock->rwLock);
+                VmRESTRWLockAcquire(pLock, FALSE, pszFile, line);
             }
         }
         (*pReadLockCount)++;
@@ -663,6 +885,10 @@ VmRESTTryLockRead(
             if (*pReadLockCount == 0)
             {
                 result = pthread_rwlock_tryrdlock(&pLock->rwLock);
+                if (!result)
+                {
+                    VmRESTRWLockTryAcquired(pLock);
+                }
             }
             else
             {
@@ -714,20 +940,22 @@ VmRESTUnlockRead(
 }
 
 void
-VmRESTLockWrite(
-    PVMREST_RWLOCK                   pLock
+VmRESTLockWriteAt(
+    PVMREST_RWLOCK                   pLock,
+    const char*                      pszFile,
+    int                              line
     )
 {
     int*                             pWriteLockCount = VmRESTGetLockKey(&pLock->writeKey);
     if (!pWriteLockCount)
     {
-        pthread_rwlock_wrlock(&pLock->rwLock);
+        VmRESTRWLockAcquire(pLock, TRUE, pszFile, line);
     }
     else
     {
         if (*pWriteLockCount == 0)
         {
-            pthread_rwlock_wrlock(&pLock->rwLock);
+            VmRESTRWLockAcquire(pLock, TRUE, pszFile, line);
         }
         (*pWriteLockCount)++;
     }
@@ -752,6 +980,10 @@ VmRESTTryLockWrite(
             if (*pWriteLockCount <= 0)
             {
                 result = pthread_rwlock_trywrlock(&pLock->rwLock);
+                if (!result)
+                {
+                    VmRESTRWLockTryAcquired(pLock);
+                }
             }
             else
             {
@@ -781,6 +1013,11 @@ VmRESTUnlockWrite(
     {
         if (*pWriteLockCount ==1)
         {
+            if (pLock->lockedNs)
+            {
+                VmRESTLockRecordHold(pLock->pClass, VmRESTMetricsNowNs() - pLock->lockedNs);
+                pLock->lockedNs = 0;
+            }
             pthread_rwlock_unlock(&pLock->rwLock);
         }
 
@@ -797,7 +1034,7 @@ VmRESTFreeLockCount(
     void*                            pkeyData
     )
 {
-    VmRESTFreeMemory(pkeyData);
+    VmRESTFreeMemory(pkeyData, REST_MEM_OTHER);
 }
 
 static
@@ -812,7 +1049,7 @@ VmRESTGetLockKey(
     int*                             pCount = (int*)pthread_getspecific(*pLockKey);
     if (!pCount)
     {
-        dwError = VmRESTAllocateMemory(sizeof(int), (void**)&(pCounter));
+        dwError = VmRESTAllocateMemory(sizeof(int), (void**)&(pCounter), REST_MEM_OTHER);
         BAIL_ON_VMREST_ERROR(dwError);
 
         dwError = pthread_setspecific(*pLockKey, pCounter);
@@ -828,7 +1065,7 @@ cleanup:
 error:
     if (pCounter)
     {
-        VmRESTFreeMemory(pCounter);
+        VmRESTFreeMemory(pCounter, REST_MEM_OTHER);
         pCounter = NULL;
     }
     goto cleanup;
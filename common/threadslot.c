@@ -0,0 +1,248 @@
+/* C-REST-Engine
+*
+* Copyright (c) 2017 VMware, Inc. All Rights Reserved.
+*
+* This product is licensed to you under the Apache 2.0 license (the "License").
+* You may not use this product except in compliance with the Apache 2.0 License.
+*
+* This product may include a number of subcomponents with separate copyright
+* notices and license terms. Your use of these subcomponents is subject to the
+* terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+*
+*/
+
+#include "includes.h"
+
+typedef struct _VMREST_THREAD_SLOT_CLAIM
+{
+    PVMREST_THREAD_SLOT_REGISTRY     pRegistry;
+    PVMREST_THREAD_SLOT_OWNER        pOwner;
+    uint64_t                         ownerId;
+    PVOID                            pSlot;
+} VMREST_THREAD_SLOT_CLAIM, *PVMREST_THREAD_SLOT_CLAIM;
+
+/**** Claims of all registries, touched only by owning thread ****/
+typedef struct _VMREST_THREAD_SLOTS
+{
+    VMREST_THREAD_SLOT_CLAIM         claim[VMREST_THREAD_SLOT_MAX_CLAIMS];
+    uint32_t                         nClaims;
+    BOOLEAN                          bRegistered;
+    BOOLEAN                          bExiting;
+} VMREST_THREAD_SLOTS, *PVMREST_THREAD_SLOTS;
+
+static __thread VMREST_THREAD_SLOTS  gThreadSlots;
+
+static pthread_once_t                gThreadSlotOnce = PTHREAD_ONCE_INIT;
+static pthread_key_t                 gThreadSlotKey;
+static BOOLEAN                       gbThreadSlotKeyValid = FALSE;
+
+/**** Caller must hold registry mutex, NULL owner is never removed ****/
+static
+BOOLEAN
+VmRESTThreadSlotOwnerLive(
+    PVMREST_THREAD_SLOT_REGISTRY     pRegistry,
+    PVMREST_THREAD_SLOT_OWNER        pOwner,
+    uint64_t                         ownerId
+    )
+{
+    PVMREST_THREAD_SLOT_OWNER        pEntry = NULL;
+
+    if (!pOwner)
+    {
+        return TRUE;
+    }
+
+    for (pEntry = pRegistry->pOwners; pEntry; pEntry = pEntry->pNext)
+    {
+        if ((pEntry == pOwner) && (pEntry->ownerId == ownerId))
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/**** Slots of owners removed meanwhile were freed with their owner ****/
+static
+void
+VmRESTThreadSlotDestroy(
+    void*                            pData
+    )
+{
+    PVMREST_THREAD_SLOTS             pThread = (PVMREST_THREAD_SLOTS)pData;
+    PVMREST_THREAD_SLOT_CLAIM        pClaim = NULL;
+    uint32_t                         idx = 0;
+
+    if (!pThread)
+    {
+        return;
+    }
+
+    /**** Later key destructors of this thread get no slot ****/
+    pThread->bExiting = TRUE;
+
+    for (idx = 0; idx < pThread->nClaims; idx++)
+    {
+        pClaim = &pThread->claim[idx];
+        if (!pClaim->pSlot)
+        {
+            continue;
+        }
+
+        pthread_mutex_lock(&pClaim->pRegistry->mutex);
+
+        if (VmRESTThreadSlotOwnerLive(pClaim->pRegistry, pClaim->pOwner, pClaim->ownerId))
+        {
+            pClaim->pRegistry->pfnRelease(pClaim->pSlot);
+        }
+
+        pthread_mutex_unlock(&pClaim->pRegistry->mutex);
+    }
+    pThread->nClaims = 0;
+}
+
+static
+void
+VmRESTThreadSlotCreateKey(
+    void
+    )
+{
+    if (pthread_key_create(&gThreadSlotKey, &VmRESTThreadSlotDestroy) == 0)
+    {
+        gbThreadSlotKeyValid = TRUE;
+    }
+}
+
+void
+VmRESTThreadSlotAddOwner(
+    PVMREST_THREAD_SLOT_REGISTRY     pRegistry,
+    PVMREST_THREAD_SLOT_OWNER        pOwner
+    )
+{
+    pthread_mutex_lock(&pRegistry->mutex);
+    pOwner->ownerId = ++pRegistry->nextOwnerId;
+    pOwner->pNext = pRegistry->pOwners;
+    pRegistry->pOwners = pOwner;
+    pthread_mutex_unlock(&pRegistry->mutex);
+}
+
+void
+VmRESTThreadSlotRemoveOwner(
+    PVMREST_THREAD_SLOT_REGISTRY     pRegistry,
+    PVMREST_THREAD_SLOT_OWNER        pOwner
+    )
+{
+    PVMREST_THREAD_SLOT_OWNER*       ppEntry = NULL;
+
+    pthread_mutex_lock(&pRegistry->mutex);
+
+    for (ppEntry = &pRegistry->pOwners; *ppEntry; ppEntry = &(*ppEntry)->pNext)
+    {
+        if (*ppEntry == pOwner)
+        {
+            *ppEntry = pOwner->pNext;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&pRegistry->mutex);
+}
+
+BOOLEAN
+VmRESTThreadSlotFind(
+    PVMREST_THREAD_SLOT_REGISTRY     pRegistry,
+    PVMREST_THREAD_SLOT_OWNER        pOwner,
+    PVOID*                           ppSlot
+    )
+{
+    PVMREST_THREAD_SLOTS             pThread = &gThreadSlots;
+    uint64_t                         ownerId = pOwner ? pOwner->ownerId : 0;
+    uint32_t                         idx = 0;
+
+    for (idx = 0; idx < pThread->nClaims; idx++)
+    {
+        if ((pThread->claim[idx].pRegistry == pRegistry) &&
+            (pThread->claim[idx].pOwner == pOwner) &&
+            (pThread->claim[idx].ownerId == ownerId))
+        {
+            *ppSlot = pThread->claim[idx].pSlot;
+            return TRUE;
+        }
+    }
+
+    *ppSlot = NULL;
+
+    return FALSE;
+}
+
+BOOLEAN
+VmRESTThreadSlotPrepare(
+    PVMREST_THREAD_SLOT_REGISTRY     pRegistry
+    )
+{
+    PVMREST_THREAD_SLOTS             pThread = &gThreadSlots;
+    PVMREST_THREAD_SLOT_CLAIM        pClaim = NULL;
+    uint32_t                         idx = 0;
+    uint32_t                         nKept = 0;
+    uint32_t                         nOwn = 0;
+
+    if (pThread->bExiting)
+    {
+        return FALSE;
+    }
+
+    if (!pThread->bRegistered)
+    {
+        pthread_once(&gThreadSlotOnce, &VmRESTThreadSlotCreateKey);
+        if (!gbThreadSlotKeyValid || pthread_setspecific(gThreadSlotKey, pThread))
+        {
+            return FALSE;
+        }
+        pThread->bRegistered = TRUE;
+    }
+
+    /**** Forget claims on owners of this registry which are gone ****/
+    pthread_mutex_lock(&pRegistry->mutex);
+
+    for (idx = 0; idx < pThread->nClaims; idx++)
+    {
+        pClaim = &pThread->claim[idx];
+        if (pClaim->pRegistry == pRegistry)
+        {
+            if (!VmRESTThreadSlotOwnerLive(pRegistry, pClaim->pOwner, pClaim->ownerId))
+            {
+                continue;
+            }
+            nOwn++;
+        }
+        pThread->claim[nKept++] = *pClaim;
+    }
+    pThread->nClaims = nKept;
+
+    pthread_mutex_unlock(&pRegistry->mutex);
+
+    return (nOwn < pRegistry->nMaxClaims) && (pThread->nClaims < VMREST_THREAD_SLOT_MAX_CLAIMS);
+}
+
+void
+VmRESTThreadSlotClaim(
+    PVMREST_THREAD_SLOT_REGISTRY     pRegistry,
+    PVMREST_THREAD_SLOT_OWNER        pOwner,
+    PVOID                            pSlot
+    )
+{
+    PVMREST_THREAD_SLOTS             pThread = &gThreadSlots;
+    PVMREST_THREAD_SLOT_CLAIM        pClaim = NULL;
+
+    if (pThread->nClaims >= VMREST_THREAD_SLOT_MAX_CLAIMS)
+    {
+        return;
+    }
+
+    pClaim = &pThread->claim[pThread->nClaims++];
+    pClaim->pRegistry = pRegistry;
+    pClaim->pOwner = pOwner;
+    pClaim->ownerId = pOwner ? pOwner->ownerId : 0;
+    pClaim->pSlot = pSlot;
+}
@@ -50,6 +50,9 @@
 #define     REST_ENGINE_SSL_CONFIG_FILE                    113
 #define     REST_ENGINE_NO_DEBUG_LOGGING                   114
 #define     REST_ENGINE_BAD_LOG_LEVEL                      115
+#define     REST_ENGINE_NO_PEER_CREDENTIALS                116
+#define     REST_ENGINE_CONNECTION_CLOSED                  117
+#define     REST_ENGINE_TIMEOUT                            118
 #define     REST_ENGINE_MORE_IO_REQUIRED                   7001
 #define     REST_ENGINE_IO_COMPLETED                       0
 
@@ -68,6 +71,19 @@
 #define     SSL_DATA_TYPE_KEY                               1
 #define     SSL_DATA_TYPE_CERT                              2
 #define     MAX_DEAMON_NAME_LEN                             20
+#define     VMREST_MEMORY_SIZE_CLASS_COUNT                  10
+#define     VMREST_MAX_LISTEN_FDS                           4
+#define     VMREST_MAX_UNIX_SOCKET_PATH_LEN                 108
+#define     VMREST_UNIX_PEER_ADDRESS                        "unix"
+#define     VMREST_LOOPBACK_PEER_ADDRESS                    "loopback"
+#define     VMREST_METRICS_URI                              "/metrics"
+#define     VMREST_STATS_ROUTE_LEN                          128
+#define     VMREST_STATS_METHOD_LEN                         16
+#define     VMREST_STATS_STATUS_CLASSES                     6
+#define     VMREST_LOCK_NAME_LEN                            32
+#define     VMREST_LOCK_SITE_LEN                            64
+#define     VMREST_LOCK_HIST_BUCKETS                        32
+#define     VMREST_LOCK_TOP_WAITERS                         4
 
 typedef enum
 {
@@ -77,8 +93,16 @@ typedef enum
    VMREST_LOG_LEVEL_DEBUG
 } VMREST_LOG_LEVEL;
 
+typedef enum
+{
+   VMREST_ACCESS_LOG_JSON = 0,
+   VMREST_ACCESS_LOG_BINARY
+} VMREST_ACCESS_LOG_FORMAT;
+
 typedef struct _VMREST_HANDLE* PVMREST_HANDLE;
 
+typedef struct _VMREST_ENGINE_GROUP* PVMREST_ENGINE_GROUP;
+
 typedef struct _VM_REST_HTTP_REQUEST_PACKET*  PREST_REQUEST;
 
 typedef struct _VM_REST_HTTP_RESPONSE_PACKET* PREST_RESPONSE;
@@ -126,15 +150,315 @@ typedef struct _REST_CONF
     bool                             isSecure;
     bool                             useSysLog;
     VMREST_LOG_LEVEL                 debugLogLevel;
+    /**** Fields below are read only when structure was prepared by VmRESTInitConfig() ****/
+    uint32_t                         initMagic;
+    uint32_t                         nHandshakeThr;
+    uint32_t                         nHandshakeQueueDepth;
+    uint32_t                         nTLSRecordRampBytes;
+    uint32_t                         nTLSRecordIdleMs;
+    uint32_t                         nShmRingBytes;
+    uint32_t                         nLogRingBytes;
+    uint32_t                         nAccessLogRingBytes;
+    uint32_t                         accessLogMaxMB;
+    uint32_t                         traceSampleRate;
+    uint32_t                         statsShmIntervalMs;
+    uint32_t                         cpuSampleRate;
+    uint32_t                         nListenFds;
+    int                              listenFds[VMREST_MAX_LISTEN_FDS];
+    char*                            pszAccessLogFile;
+    char*                            pszUnixSocketPath;
+    uint32_t                         unixSocketMode;
+    char*                            pszShmSocketPath;
+    char*                            pszTraceClientIP;
+    char*                            pszTraceRoute;
+    char*                            pszTraceHeader;
+    bool                             useKernelTLS;
+    bool                             useHugePages;
+    bool                             disableTCP;
+    bool                             useAsyncLog;
+    bool                             blockOnLogFull;
+    bool                             enableMetricsEndpoint;
+    bool                             enableLockProfiling;
+    bool                             enableMemoryDebug;
+    VMREST_ACCESS_LOG_FORMAT         accessLogFormat;
 } REST_CONF, *PREST_CONF;
 
+typedef struct _REST_HANDSHAKE_STATS
+{
+    uint64_t                         nQueued;
+    uint64_t                         nCompleted;
+    uint64_t                         nFailed;
+    uint64_t                         nRejected;
+    uint32_t                         nQueueDepth;
+    uint32_t                         nMaxQueueDepth;
+} REST_HANDSHAKE_STATS, *PREST_HANDSHAKE_STATS;
+
+typedef enum
+{
+   VMREST_CONN_PHASE_NEW = 0,
+   VMREST_CONN_PHASE_HANDSHAKE,
+   VMREST_CONN_PHASE_ACTIVE,
+   VMREST_CONN_PHASE_IDLE,
+   VMREST_CONN_PHASE_CLOSING
+} VMREST_CONN_PHASE;
+
+typedef struct _REST_CONNECTION_INFO
+{
+    int                              fd;
+    VMREST_CONN_PHASE                phase;
+    uint32_t                         nRequests;
+    uint64_t                         nBytesIn;
+    uint64_t                         nBytesOut;
+    uint64_t                         nAllocBytes;
+    uint64_t                         idleMs;
+} REST_CONNECTION_INFO, *PREST_CONNECTION_INFO;
+
+typedef void* (*PFN_REST_ALLOC)(
+    size_t                           size
+    );
+
+typedef void* (*PFN_REST_REALLOC)(
+    void*                            pMemory,
+    size_t                           size
+    );
+
+typedef void (*PFN_REST_FREE)(
+    void*                            pMemory
+    );
+
+typedef struct _REST_ALLOCATOR
+{
+    PFN_REST_ALLOC                   pfnAlloc;
+    PFN_REST_REALLOC                 pfnRealloc;
+    PFN_REST_FREE                    pfnFree;
+} REST_ALLOCATOR, *PREST_ALLOCATOR;
+
+typedef struct _REST_MEMORY_CLASS_STATS
+{
+    uint32_t                         classSize;
+    uint64_t                         nAlloc;
+    uint64_t                         nFree;
+    uint64_t                         nCacheHit;
+    uint64_t                         nCached;
+} REST_MEMORY_CLASS_STATS, *PREST_MEMORY_CLASS_STATS;
+
+/**** What library heap blocks are used for. APP are copies handed to application (Freed by caller) ****/
+typedef enum
+{
+   REST_MEM_OTHER = 0,
+   REST_MEM_SOCKET,
+   REST_MEM_REQUEST,
+   REST_MEM_RESPONSE,
+   REST_MEM_HEADER,
+   REST_MEM_PAYLOAD,
+   REST_MEM_TLS,
+   REST_MEM_LOG,
+   REST_MEM_APP,
+   REST_MEM_CATEGORY_COUNT
+} REST_MEM_CATEGORY;
+
+/**** Bytes are 0 when block sizes can not be read, e.g. with application allocator ****/
+typedef struct _REST_MEMORY_CATEGORY_STATS
+{
+    uint64_t                         nAlloc;
+    uint64_t                         nFree;
+    uint64_t                         nTotalBytes;
+    uint64_t                         nLiveBytes;
+    uint64_t                         nPeakBytes;
+} REST_MEMORY_CATEGORY_STATS, *PREST_MEMORY_CATEGORY_STATS;
+
+typedef struct _REST_MEMORY_STATS
+{
+    REST_MEMORY_CLASS_STATS          sizeClass[VMREST_MEMORY_SIZE_CLASS_COUNT];
+    REST_MEMORY_CATEGORY_STATS       category[REST_MEM_CATEGORY_COUNT];
+    uint64_t                         nLargeAlloc;
+    uint64_t                         nLargeFree;
+    uint64_t                         nDebugMismatches;
+    bool                             bCustomAllocator;
+    bool                             bByteCounts;
+} REST_MEMORY_STATS, *PREST_MEMORY_STATS;
+
+/**** Percentiles are upper bounds of histogram buckets, within 12.5% of true value ****/
+typedef struct _REST_LATENCY_STATS
+{
+    uint64_t                         nCount;
+    uint64_t                         sumUs;
+    uint64_t                         p50Us;
+    uint64_t                         p90Us;
+    uint64_t                         p99Us;
+    uint64_t                         maxUs;
+} REST_LATENCY_STATS, *PREST_LATENCY_STATS;
+
+/**** Points a request passes, in order they are normally reached. Accept and
+      TLS handshake belong to connection and are shared by all its requests ****/
+typedef enum
+{
+    REST_PHASE_ACCEPT = 0,
+    REST_PHASE_TLS_DONE,
+    REST_PHASE_FIRST_BYTE_READ,
+    REST_PHASE_REQUEST_LINE,
+    REST_PHASE_HEADERS_DONE,
+    REST_PHASE_BODY_DONE,
+    REST_PHASE_HANDLER_START,
+    REST_PHASE_HANDLER_END,
+    REST_PHASE_FIRST_BYTE_WRITTEN,
+    REST_PHASE_LAST_BYTE_WRITTEN,
+    REST_PHASE_COUNT
+} REST_PHASE;
+
+/**** Monotonic nanoseconds, only differences are meaningful, 0 for a phase not reached ****/
+typedef struct _REST_REQUEST_TIMINGS
+{
+    uint64_t                         phaseNs[REST_PHASE_COUNT];
+} REST_REQUEST_TIMINGS, *PREST_REQUEST_TIMINGS;
+
+#define     VMREST_ACCESS_LOG_RECORD_VERSION                1
+
+/**** One request in binary access log, host byte order. Client IP, method and route
+      follow in that order, not NUL terminated, then padding up to nLen, a multiple
+      of 8. timeUs is wall clock at completion, since epoch. phaseUs is time taken to
+      reach each phase as in REST_PHASE_STATS, TLS done only on first request of a
+      connection, 0 for a phase not reached ****/
+typedef struct _REST_ACCESS_LOG_RECORD
+{
+    uint32_t                         nLen;
+    uint16_t                         version;
+    uint16_t                         statusCode;
+    uint64_t                         timeUs;
+    uint64_t                         nBytesIn;
+    uint64_t                         nBytesOut;
+    uint32_t                         phaseUs[REST_PHASE_COUNT];
+    uint32_t                         nConnRequests;
+    int32_t                          clientPort;
+    uint8_t                          nClientIPLen;
+    uint8_t                          nMethodLen;
+    uint16_t                         nRouteLen;
+} REST_ACCESS_LOG_RECORD, *PREST_ACCESS_LOG_RECORD;
+
+/**** Time taken to reach a phase, in REST_STATS phase[]. TLS done counts from accept, once per
+      connection. First byte written counts from first byte read, every other phase from the one
+      listed before it. Accept and first byte read have nothing to count from and stay empty ****/
+typedef struct _REST_PHASE_STATS
+{
+    uint64_t                         nCount;
+    uint64_t                         sumNs;
+    uint64_t                         p50Ns;
+    uint64_t                         p90Ns;
+    uint64_t                         p99Ns;
+    uint64_t                         maxNs;
+} REST_PHASE_STATS, *PREST_PHASE_STATS;
+
+/**** Where thread CPU of a request goes. Parse covers reading request and routing it,
+      handler is route callback less response serialization done from within it ****/
+typedef enum
+{
+    REST_CPU_PARSE = 0,
+    REST_CPU_HANDLER,
+    REST_CPU_SERIALIZE,
+    REST_CPU_PHASE_COUNT
+} REST_CPU_PHASE;
+
+/**** Sums over sampled requests only, scale by latency nCount / nSamples to estimate all ****/
+typedef struct _REST_CPU_STATS
+{
+    uint64_t                         nSamples;
+    uint64_t                         cpuNs[REST_CPU_PHASE_COUNT];
+} REST_CPU_STATS, *PREST_CPU_STATS;
+
+/**** nResponses is indexed by status class, 2 for 2xx, 0 counts anything outside 1xx-5xx ****/
+typedef struct _REST_STATS
+{
+    uint64_t                         nResponses[VMREST_STATS_STATUS_CLASSES];
+    uint64_t                         nBytesIn;
+    uint64_t                         nBytesOut;
+    uint64_t                         nAccepts;
+    uint64_t                         nTimeouts;
+    uint64_t                         nHandshakes;
+    uint64_t                         nHandshakeFailures;
+    uint32_t                         nActiveConnections;
+    uint32_t                         nIdleConnections;
+    REST_LATENCY_STATS               latency;
+    REST_PHASE_STATS                 phase[REST_PHASE_COUNT];
+    REST_CPU_STATS                   cpu;
+} REST_STATS, *PREST_STATS;
+
+typedef struct _REST_ROUTE_STATS
+{
+    char                             szRoute[VMREST_STATS_ROUTE_LEN];
+    char                             szMethod[VMREST_STATS_METHOD_LEN];
+    REST_LATENCY_STATS               latency;
+    REST_CPU_STATS                   cpu;
+} REST_ROUTE_STATS, *PREST_ROUTE_STATS;
+
+/**** Call site, file:line, which had to wait for a lock ****/
+typedef struct _REST_LOCK_WAITER_STATS
+{
+    char                             szSite[VMREST_LOCK_SITE_LEN];
+    uint64_t                         nContended;
+    uint64_t                         sumWaitNs;
+} REST_LOCK_WAITER_STATS, *PREST_LOCK_WAITER_STATS;
+
+/**** Locks are counted per name, all sockets share one entry. Acquisition is
+      contended when trylock fails first. Bucket 0 of a histogram counts 0 ns,
+      bucket i below 2^i ns, last bucket anything longer. Uncontended
+      acquisitions wait 0 ns and take no timestamp, so hold times (nHeld)
+      are of acquisitions which had to wait. Read locks have no hold time ****/
+typedef struct _REST_LOCK_STATS
+{
+    char                             szName[VMREST_LOCK_NAME_LEN];
+    uint64_t                         nAcquired;
+    uint64_t                         nContended;
+    uint64_t                         sumWaitNs;
+    uint64_t                         p99WaitNs;
+    uint64_t                         maxWaitNs;
+    uint64_t                         nHeld;
+    uint64_t                         sumHoldNs;
+    uint64_t                         p99HoldNs;
+    uint64_t                         maxHoldNs;
+    uint64_t                         waitHist[VMREST_LOCK_HIST_BUCKETS];
+    uint64_t                         holdHist[VMREST_LOCK_HIST_BUCKETS];
+    uint32_t                         nWaiters;
+    REST_LOCK_WAITER_STATS           waiter[VMREST_LOCK_TOP_WAITERS];
+} REST_LOCK_STATS, *PREST_LOCK_STATS;
+
+/**** Gets response bytes of VmRESTDispatchBuffer in order, non zero return aborts the response ****/
+typedef uint32_t (*PFN_REST_RESPONSE_SINK)(
+    void*                            pContext,
+    const char*                      pData,
+    uint32_t                         nLen
+    );
+
+typedef struct _REST_RESPONSE_SINK
+{
+    PFN_REST_RESPONSE_SINK           pfnWrite;
+    void*                            pContext;
+} REST_RESPONSE_SINK, *PREST_RESPONSE_SINK;
+
 typedef struct _REST_ENDPOINT
 {
     char*                             pszEndPointURI;
     PREST_PROCESSOR                   pHandler;
     struct _REST_ENDPOINT*            next;
+    uint32_t                          metricsRouteId;
 } REST_ENDPOINT, *PREST_ENDPOINT;
 
+/*
+ * @brief Fill configuration with defaults
+ *
+ * Zeroes the structure, sets default values and marks it as prepared.
+ * VmRESTInit() ignores every field after debugLogLevel unless the
+ * configuration went through this call; such callers get defaults.
+ *
+ * @param[out]                       Rest engine configuration.
+ * @return                           Returns 0 for success.
+ */
+
+VMREST_API
+uint32_t
+VmRESTInitConfig(
+    PREST_CONF                       pConfig
+    );
+
 /*
  * @brief Rest engine initialization
  *
@@ -507,10 +831,256 @@ VmRESTSetDataZC(
     uint32_t                         nBytes
     );
 
+/*
+ * @brief Send a file region as response payload.
+ * Make sure VmRESTSetDataLength() is not used to set data length before call to this.
+ * This API will set data length in HTTP response equals to nBytes. Payload is sent
+ * with sendfile() on plain connections and SSL_sendfile() when kernel TLS is active
+ * on the connection, otherwise it falls back to read and write.
+ *
+ * @param[in]                        Handle to Library instance.
+ * @param[in]                        Reference to HTTP Response object.
+ * @param[in]                        Open file descriptor.(Application owned, close if required)
+ * @param[in]                        Offset in file to start sending from.
+ * @param[in]                        Number of bytes to send.
+ * @return                           Returns REST_ENGINE_IO_COMPLETED for success,
+ *                                   or Error codes.
+ */
+VMREST_API
+uint32_t
+VmRESTSetDataFromFile(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_RESPONSE*                  ppResponse,
+    int                              fd,
+    uint64_t                         offset,
+    uint32_t                         nBytes
+    );
+
+/*
+ * @brief Get TLS handshake pool statistics.
+ *        All counters are zero when handshakes run inline (nHandshakeThr = 0).
+ *
+ * @param[in]                        Handle to Library instance.
+ * @param[out]                       Pointer to stats structure to fill.
+ * @return                           Returns 0 for success
+ */
+VMREST_API
+uint32_t
+VmRESTGetHandshakeStats(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_HANDSHAKE_STATS            pStats
+    );
+
+/*
+ * @brief Get snapshot of live client connections.
+ *        With NULL pInfo or nMax 0 only number of live connections is returned.
+ *
+ * @param[in]                        Handle to Library instance.
+ * @param[out]                       Array to fill, can be NULL.
+ * @param[in]                        Number of entries in array.
+ * @param[out]                       Number of entries filled (or live connections).
+ * @return                           Returns 0 for success
+ */
+VMREST_API
+uint32_t
+VmRESTGetConnections(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_CONNECTION_INFO            pInfo,
+    uint32_t                         nMax,
+    uint32_t*                        pnCount
+    );
+
+/*
+ * @brief Replace library heap allocator, e.g. with jemalloc or an arena.
+ *        Must be called before VmRESTInit() of first instance.
+ *        Buffers returned to caller (Freed by caller) must then be released
+ *        with pfnFree of the installed allocator. NULL restores built-in allocator.
+ *
+ * @param[in]                        Allocator callbacks, all three must be set.
+ * @return                           Returns 0 for success
+ */
+VMREST_API
+uint32_t
+VmRESTSetAllocator(
+    PREST_ALLOCATOR                  pAllocator
+    );
+
+/*
+ * @brief Get per size class and per category allocation counters of
+ *        library heap. Counters are process wide and cover all instances.
+ *        Live bytes of threads are published in batches, so live and peak
+ *        values may lag by a few tens of KB per thread.
+ *
+ * @param[out]                       Pointer to stats structure to fill.
+ * @return                           Returns 0 for success
+ */
+VMREST_API
+uint32_t
+VmRESTGetMemoryStats(
+    PREST_MEMORY_STATS               pStats
+    );
+
+/*
+ * @brief Get wait and hold times of library locks, most waited for first.
+ *        Locks are only measured once an instance was initialized with
+ *        REST_CONF enableLockProfiling, which then stays on for the process.
+ *        Counters are process wide and cover all instances.
+ *        With NULL pStats or nMax 0 only number of entries is returned.
+ *
+ * @param[out]                       Array to fill, can be NULL.
+ * @param[in]                        Number of entries in array.
+ * @param[out]                       Number of entries filled (or available).
+ * @return                           Returns 0 for success
+ */
+VMREST_API
+uint32_t
+VmRESTGetLockStats(
+    PREST_LOCK_STATS                 pStats,
+    uint32_t                         nMax,
+    uint32_t*                        pnCount
+    );
+
+/*
+ * @brief Reload server certificate and private key without restart.
+ *        New SSL context is built and swapped in for new handshakes only,
+ *        established connections keep old context until they close.
+ *        Pass NULL buffers to reload from configured certificate and key files.
+ *
+ * @param[in]                        Handle to Library instance.
+ * @param[in]                        PEM certificate (chain) buffer or NULL.
+ * @param[in]                        Size of certificate buffer.
+ * @param[in]                        PEM private key buffer or NULL.
+ * @param[in]                        Size of key buffer.
+ * @return                           Returns 0 for success
+ */
+VMREST_API
+uint32_t
+VmRESTReloadSSLContext(
+    PVMREST_HANDLE                   pRESTHandle,
+    char const*                      pszCertBuffer,
+    uint32_t                         certBufferSize,
+    char const*                      pszKeyBuffer,
+    uint32_t                         keyBufferSize
+    );
+
+/*
+ * @brief Pass listening sockets of a started instance to a successor process
+ *        waiting in VmRESTReceiveListenerFds() on the given Unix socket path.
+ *        Both processes accept on the sockets until this one is stopped, so
+ *        no connection is refused during an upgrade.
+ *
+ * @param[in]                        Handle to Library instance.
+ * @param[in]                        Unix socket path the successor listens on.
+ * @return                           Returns 0 for success
+ */
+VMREST_API
+uint32_t
+VmRESTSendListenerFds(
+    PVMREST_HANDLE                   pRESTHandle,
+    char const*                      pszSocketPath
+    );
+
+/*
+ * @brief Wait on a Unix socket path for listening sockets sent by a running
+ *        instance with VmRESTSendListenerFds(). Call between VmRESTInit() and
+ *        VmRESTStart(), the received sockets are then used instead of binding.
+ *        Sockets passed by systemd socket activation (LISTEN_FDS) or set in
+ *        REST_CONF listenFds are picked up by VmRESTStart() without this call.
+ *
+ * @param[in]                        Handle to Library instance.
+ * @param[in]                        Unix socket path to listen on.
+ * @param[in]                        Time to wait for the sender.
+ * @return                           Returns 0 for success
+ */
+VMREST_API
+uint32_t
+VmRESTReceiveListenerFds(
+    PVMREST_HANDLE                   pRESTHandle,
+    char const*                      pszSocketPath,
+    uint32_t                         waitSeconds
+    );
+
+/*
+ * @brief Run one raw HTTP request through parser, router and handler on the
+ *        calling thread, without any socket. Response is handed to sink as it
+ *        is written. Allowed between VmRESTStart() and VmRESTStop().
+ *        VmRESTGetConnectionInfo() reports VMREST_LOOPBACK_PEER_ADDRESS
+ *        and port 0 for such requests.
+ *
+ * @param[in]                        Handle to Library instance.
+ * @param[in]                        Complete HTTP request, including payload.
+ * @param[in]                        Request length.
+ * @param[in]                        Response sink.
+ * @return                           Returns 0 for success, REST_ENGINE_MORE_IO_REQUIRED
+ *                                   if request is incomplete, REST_ENGINE_CONNECTION_CLOSED
+ *                                   if sink refused the response.
+ */
+VMREST_API
+uint32_t
+VmRESTDispatchBuffer(
+    PVMREST_HANDLE                   pRESTHandle,
+    char const*                      pszRequest,
+    uint32_t                         nLen,
+    PREST_RESPONSE_SINK              pSink
+    );
+
+/*
+ * @brief Create an engine group. The group runs one event queue and one pool
+ *        of worker threads that serve all instances joined to it, so several
+ *        services in a process share CPU instead of running a pool each.
+ *
+ * @param[in]                        Worker threads of the group, 0 for one per
+ *                                   online CPU.
+ * @param[out]                       Engine group object.
+ * @return                           Returns 0 for success
+ */
+VMREST_API
+uint32_t
+VmRESTCreateEngineGroup(
+    uint32_t                         nWorkerThr,
+    PVMREST_ENGINE_GROUP*            ppEngineGroup
+    );
+
+/*
+ * @brief Make an instance a member of an engine group. Call between
+ *        VmRESTInit() and VmRESTStart(). The instance keeps its own listeners,
+ *        config, SSL context and endpoints, its connections are served by the
+ *        group workers. nWorkerThr and nHandshakeThr of its config are not used.
+ *        VmRESTStop() drains only connections of this instance.
+ *
+ * @param[in]                        Handle to Library instance.
+ * @param[in]                        Engine group object.
+ * @return                           Returns 0 for success
+ */
+VMREST_API
+uint32_t
+VmRESTJoinEngineGroup(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVMREST_ENGINE_GROUP             pEngineGroup
+    );
+
+/*
+ * @brief Stop group workers and free the engine group. All members must be
+ *        shut down with VmRESTShutdown() first.
+ *
+ * @param[in]                        Engine group object.
+ * @param[in]                        Time to wait for workers to leave.
+ * @return                           Returns 0 for success
+ */
+VMREST_API
+uint32_t
+VmRESTFreeEngineGroup(
+    PVMREST_ENGINE_GROUP             pEngineGroup,
+    uint32_t                         waitSeconds
+    );
+
 /**
- * @brief Stop the REST Engine
+ * @brief Stop the REST Engine. New connections are refused at once, requests
+ *        in flight are allowed to finish and idle keep-alive connections are
+ *        closed. Returns as soon as the last connection is gone.
  * @param[in]                        Handle to Library instance.
- * @param[in]                        Time to wait for clean shutdown
+ * @param[in]                        Time to wait for clean shutdown, connections
+ *                                   still open after it are closed
  * @return                           Returns 0 for success
  */
 VMREST_API 
@@ -615,6 +1185,112 @@ VmRESTGetConnectionInfo(
     char**                           ppszIpAddress,
     int*                             pPort
     );
+
+/*
+ * @brief Get credentials of peer process, for connections accepted on the
+ *        unix domain socket listener. VmRESTGetConnectionInfo reports
+ *        VMREST_UNIX_PEER_ADDRESS and port 0 for such connections.
+ *
+ * @param[in]                        Request object.
+ * @param[out]                       Process id of peer.
+ * @param[out]                       User id of peer.
+ * @param[out]                       Group id of peer.
+ * @return                           Returns 0 success, REST_ENGINE_NO_PEER_CREDENTIALS
+ *                                   if request did not come over unix domain socket.
+ */
+VMREST_API
+uint32_t
+VmRESTGetConnectionPeerCredentials(
+    PREST_REQUEST                    pRequest,
+    int*                             pPid,
+    uint32_t*                        pUid,
+    uint32_t*                        pGid
+    );
+
+/*
+ * @brief Get trace id of request. Requests matching REST_CONF trace sample
+ *        rate, client IP, route prefix or header are logged at DEBUG level
+ *        whatever the configured level, each line tagged with this id.
+ *
+ * @param[in]                        Request object.
+ * @param[out]                       Trace id, 0 if request is not traced.
+ * @return                           Returns 0 success.
+ */
+VMREST_API
+uint32_t
+VmRESTGetRequestTraceId(
+    PREST_REQUEST                    pRequest,
+    uint64_t*                        pTraceId
+    );
+
+/*
+ * @brief Get request, traffic and connection counters of instance. Counters
+ *        are summed from per thread shards without stopping request threads,
+ *        so they are approximate while requests are in flight.
+ *        Also served as Prometheus text at VMREST_METRICS_URI when
+ *        REST_CONF enableMetricsEndpoint is set.
+ *
+ * @param[in]                        Handle to Library instance.
+ * @param[out]                       Pointer to stats structure to fill.
+ * @return                           Returns 0 for success
+ */
+VMREST_API
+uint32_t
+VmRESTGetStats(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_STATS                      pStats
+    );
+
+/*
+ * @brief Get request count and latency per registered endpoint and HTTP method.
+ *        Requests not matched to an endpoint are reported under route "*".
+ *        With NULL pInfo or nMax 0 only number of entries is returned.
+ *
+ * @param[in]                        Handle to Library instance.
+ * @param[out]                       Array to fill, can be NULL.
+ * @param[in]                        Number of entries in array.
+ * @param[out]                       Number of entries filled (or available).
+ * @return                           Returns 0 for success
+ */
+VMREST_API
+uint32_t
+VmRESTGetRouteStats(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_ROUTE_STATS                pInfo,
+    uint32_t                         nMax,
+    uint32_t*                        pnCount
+    );
+
+/*
+ * @brief Get timestamps of phases request has passed so far. Called from
+ *        handler, phases after handler start are not reached yet.
+ *
+ * @param[in]                        Request object.
+ * @param[out]                       Timings structure to fill.
+ * @return                           Returns 0 success.
+ */
+VMREST_API
+uint32_t
+VmRESTGetRequestTimings(
+    PREST_REQUEST                    pRequest,
+    PREST_REQUEST_TIMINGS            pTimings
+    );
+
+/*
+ * @brief Ask access log writer to close and open its file again, for use after
+ *        the file was moved away. Only sets a flag, safe in a signal handler.
+ *        Records queued before are written to old file.
+ *
+ * @param[in]                        Handle to Library instance.
+ * @return                           Returns 0 success, REST_ENGINE_FAILURE when
+ *                                   access log is not configured.
+ */
+VMREST_API
+uint32_t
+VmRESTReopenAccessLog(
+    PVMREST_HANDLE                   pRESTHandle
+    );
+
 /*
  * @brief Set payload in HTTP response object.
  *
@@ -0,0 +1,118 @@
+/* C-REST-Engine
+*
+* Copyright (c) 2017 VMware, Inc. All Rights Reserved.
+*
+* This product is licensed to you under the Apache 2.0 license (the "License").
+* You may not use this product except in compliance with the Apache 2.0 License.
+*
+* This product may include a number of subcomponents with separate copyright
+* notices and license terms. Your use of these subcomponents is subject to the
+* terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+*
+*/
+
+#ifndef __VMREST_CLIENT_H__
+#define __VMREST_CLIENT_H__
+
+#include <vmrest.h>
+
+typedef struct _VMREST_SHM_CLIENT* PVMREST_SHM_CLIENT;
+
+/*
+ * @brief Open shared memory channel to a local REST engine instance.
+ *        Server must be configured with same REST_CONF pszShmSocketPath.
+ *        Leading '@' selects the abstract socket namespace.
+ *
+ * @param[in]                        Rendezvous unix domain socket path.
+ * @param[out]                       Channel handle.
+ * @return                           Returns 0 for success.
+ */
+VMREST_API
+uint32_t
+VmRESTShmClientConnect(
+    const char*                      pszSocketPath,
+    PVMREST_SHM_CLIENT*              ppClient
+    );
+
+/*
+ * @brief Write raw HTTP request bytes into channel. Blocks while
+ *        request ring is full.
+ *
+ * @param[in]                        Channel handle.
+ * @param[in]                        Data to send.
+ * @param[in]                        Data length.
+ * @return                           Returns 0 for success, REST_ENGINE_CONNECTION_CLOSED
+ *                                   if server has closed the channel.
+ */
+VMREST_API
+uint32_t
+VmRESTShmClientSend(
+    PVMREST_SHM_CLIENT               pClient,
+    const char*                      pBuf,
+    uint32_t                         nLen
+    );
+
+/*
+ * @brief Read response bytes from channel. Polls ring for a short while
+ *        before sleeping, polling time adapts to how fast server answers.
+ *
+ * @param[in]                        Channel handle.
+ * @param[out]                       Buffer to fill.
+ * @param[in]                        Buffer length.
+ * @param[out]                       Bytes read, at least one on success.
+ * @param[in]                        Milliseconds to wait for data, -1 waits forever.
+ * @return                           Returns 0 for success, REST_ENGINE_TIMEOUT or
+ *                                   REST_ENGINE_CONNECTION_CLOSED.
+ */
+VMREST_API
+uint32_t
+VmRESTShmClientReceive(
+    PVMREST_SHM_CLIENT               pClient,
+    char*                            pBuf,
+    uint32_t                         nLen,
+    uint32_t*                        pnRead,
+    int                              waitMs
+    );
+
+/*
+ * @brief Send one HTTP request and read one complete response, framed by
+ *        Content-Length or chunked encoding. Response holds status line,
+ *        headers and body as sent by server. Not for HEAD requests.
+ *
+ * @param[in]                        Channel handle.
+ * @param[in]                        Complete HTTP request.
+ * @param[in]                        Request length.
+ * @param[out]                       Response, NUL terminated, free with VmRESTShmClientFreeResponse.
+ * @param[out]                       Response length.
+ * @param[in]                        Milliseconds to wait for each part of response, -1 waits forever.
+ * @return                           Returns 0 for success.
+ */
+VMREST_API
+uint32_t
+VmRESTShmClientRequest(
+    PVMREST_SHM_CLIENT               pClient,
+    const char*                      pszRequest,
+    uint32_t                         nRequestLen,
+    char**                           ppszResponse,
+    uint32_t*                        pnResponseLen,
+    int                              waitMs
+    );
+
+VMREST_API
+void
+VmRESTShmClientFreeResponse(
+    char*                            pszResponse
+    );
+
+/*
+ * @brief Close channel. Server closes its end once it has seen the close.
+ *
+ * @param[in]                        Channel handle.
+ */
+VMREST_API
+void
+VmRESTShmClientClose(
+    PVMREST_SHM_CLIENT               pClient
+    );
+
+#endif /* __VMREST_CLIENT_H__ */
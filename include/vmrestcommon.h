@@ -33,6 +33,9 @@ typedef enum
     VMREST_LOG_TYPE_SYSLOG
 } VMREST_LOG_TYPE;
 
+/**** Per thread log rings and their flusher thread, only when useAsyncLog is set ****/
+typedef struct _VMREST_LOGGER *PVMREST_LOGGER;
+
 uint32_t
 VmRESTLogInitialize(
     PVMREST_HANDLE                   pRESTHandle
@@ -50,20 +53,60 @@ VmRESTLog(
    const char*                       fmt,
    ...);
 
+/**** Trace id of request this thread is working on, 0 when none is traced.
+      Traced requests log at DEBUG whatever the handle level. ****/
+extern __thread uint64_t             gVmRESTLogTraceId;
+
+#define VMREST_LOG_TRACED( pRESTHandle )                                  \
+    ((pRESTHandle)->bTraceEnabled && gVmRESTLogTraceId)
+
+
+/**** Build time floor, calls above it are compiled out with their arguments.
+      configure --with-min-log-level sets it. ****/
+#ifndef VMREST_MIN_LOG_LEVEL
+#define VMREST_MIN_LOG_LEVEL                       VMREST_LOG_LEVEL_DEBUG
+#endif
+
+#define VMREST_LOG_UNLIKELY(x)                     __builtin_expect(!!(x), 0)
+
+/**** Level is checked here, arguments are evaluated only for messages written ****/
+#define VMREST_LOG_ENABLED( pRESTHandle, Level )                          \
+    (((Level) <= VMREST_MIN_LOG_LEVEL) &&                                 \
+     VMREST_LOG_UNLIKELY((pRESTHandle) &&                                 \
+                         (((int)(Level) <= (pRESTHandle)->debugLogLevel) || \
+                          VMREST_LOG_TRACED(pRESTHandle))))
 
-#if 1 //ndef WIN32
+/**** Messages one call site may write per second, rest is counted and
+      reported with next message written from that site ****/
+#define VMREST_LOG_RATE_BURST                      10
 
+typedef struct _VMREST_LOG_RATE
+{
+    uint64_t                         windowSec;
+    uint32_t                         nInWindow;
+    uint32_t                         nSuppressed;
+} VMREST_LOG_RATE, *PVMREST_LOG_RATE;
+
+BOOLEAN
+VmRESTLogRateAllow(
+    PVMREST_LOG_RATE                 pRate,
+    uint32_t*                        pnSuppressed
+    );
 
-#define VMREST_LOG_( Level, Format, ... )          \
-    do                                             \
-    {                                              \
-        VmRESTLog(                                 \
-               Level,                              \
-               Format,                             \
-               ##__VA_ARGS__);                     \
+#define VMREST_LOG_( pRESTHandle, Level, Format, ... )\
+    do                                               \
+    {                                                \
+        if (VMREST_LOG_ENABLED(pRESTHandle, Level))  \
+        {                                            \
+            VmRESTLog(                               \
+                   pRESTHandle,                      \
+                   Level,                            \
+                   Format,                           \
+                   ##__VA_ARGS__);                   \
+        }                                            \
     } while (0)
 
-#define VMREST_LOG_GENERAL_( pRESTHandle,Level, Format, ... ) \
+#define VMREST_LOG_GENERAL_( pRESTHandle, Level, Format, ... ) \
     VMREST_LOG_( pRESTHandle, Level, Format, ##__VA_ARGS__ )
 
 #define VMREST_LOG_WARNING( pRESTHandle,Format, ... )         \
@@ -89,23 +132,35 @@ VmRESTLog(
     Format " [file: %s][line: %d]",               \
     ##__VA_ARGS__, __FILE__, __LINE__ )
 
-#else
-
-#define VMREST_LOG_( pRESTHandle,Level, Format, ... )\
-    do                                               \
-    {                                                \
-        VmRESTLog(                                   \
-               pRESTHandle,                          \
-               Level,                                \
-               Format,                               \
-               ##__VA_ARGS__);                       \
+/**** For errors a remote peer can trigger at will, limit is per call site.
+      Count of dropped messages is appended only when there were any ****/
+#define VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,Format, ... )            \
+    do                                                                    \
+    {                                                                     \
+        static VMREST_LOG_RATE _logRate;                                  \
+        uint32_t _nSuppressed = 0;                                        \
+        if (VMREST_LOG_ENABLED(pRESTHandle, VMREST_LOG_LEVEL_ERROR) &&    \
+            VmRESTLogRateAllow(&_logRate, &_nSuppressed))                 \
+        {                                                                 \
+            if (_nSuppressed)                                             \
+            {                                                             \
+                VmRESTLog(                                                \
+                    pRESTHandle,                                          \
+                    VMREST_LOG_LEVEL_ERROR,                               \
+                    Format " [file: %s][line: %d][suppressed: %u]",       \
+                    ##__VA_ARGS__, __FILE__, __LINE__, _nSuppressed);     \
+            }                                                             \
+            else                                                          \
+            {                                                             \
+                VmRESTLog(                                                \
+                    pRESTHandle,                                          \
+                    VMREST_LOG_LEVEL_ERROR,                               \
+                    Format " [file: %s][line: %d]",                       \
+                    ##__VA_ARGS__, __FILE__, __LINE__);                   \
+            }                                                             \
+        }                                                                 \
     } while (0)
 
-#define VMREST_LOG_GENERAL_( pRESTHandle, Level, Format, ... ) \
-    VMREST_LOG_( pRESTHandle,Level, Format, ##__VA_ARGS__ )
-
-#endif
-
 #define VMW_REST_PORT                 (81)
 #define VMW_REST_DEFAULT_THREAD_COUNT (5)
 
@@ -124,28 +179,63 @@ VmRESTLog(
 
 
 /*
- * @brief Allocation of heap memory for rest engine.
+ * @brief Allocation of heap memory for rest engine. Use through
+ *        VmRESTAllocateMemory(), which records calling site.
+ *
+ * @param[in]                        size of memory to be allocated
+ * @param[out]                       pointer to allocated memory
+ * @param[in]                        category block is accounted to
+ * @param[in]                        source file of caller
+ * @param[in]                        source line of caller
+ * @return Returns 0 for success
+ */
+uint32_t
+VmRESTAllocateMemoryAt(
+    size_t                           dwSize,
+    void**                           ppMemory,
+    REST_MEM_CATEGORY                category,
+    const char*                      pszFile,
+    int                              line
+    );
+
+#define VmRESTAllocateMemory(dwSize, ppMemory, category) \
+    VmRESTAllocateMemoryAt((dwSize), (ppMemory), (category), __FILE__, __LINE__)
+
+/*
+ * @brief Allocation of heap memory which is not zeroed. For buffers
+ *        fully overwritten by caller.
  *
  * @param[in]                        size of memory to be allocated
  * @param[out]                       pointer to allocated memory
+ * @param[in]                        category block is accounted to
+ * @param[in]                        source file of caller
+ * @param[in]                        source line of caller
  * @return Returns 0 for success
  */
 uint32_t
-VmRESTAllocateMemory(
+VmRESTAllocateMemoryNoZeroAt(
     size_t                           dwSize,
-    void**                           ppMemory
+    void**                           ppMemory,
+    REST_MEM_CATEGORY                category,
+    const char*                      pszFile,
+    int                              line
     );
 
+#define VmRESTAllocateMemoryNoZero(dwSize, ppMemory, category) \
+    VmRESTAllocateMemoryNoZeroAt((dwSize), (ppMemory), (category), __FILE__, __LINE__)
+
 /*
  * @brief Free of head memory for rest engine.
  *
  * @param[in]                        pointer to allocated memory
+ * @param[in]                        category block was allocated with
  * @return Returns 0 for success
  */
 
 void
 VmRESTFreeMemory(
-    void*                            pMemory
+    void*                            pMemory,
+    REST_MEM_CATEGORY                category
     );
 
 /*
@@ -161,15 +251,427 @@ VmRESTFreeMemory(
  * @param[in]                        pointer to old memory.
  * @param[out]                       pointer to hold new memory location
  * @param[out]                       size of new memory
+ * @param[in]                        category of old and new memory
+ * @param[in]                        source file of caller
+ * @param[in]                        source line of caller
  * @return Returns 1 for failure, 0 for success,
  */
 uint32_t
-VmRESTReallocateMemory(
+VmRESTReallocateMemoryAt(
     void*                            pMemory,
     void**                           ppNewMemory,
-    size_t                           dwSize
+    size_t                           dwSize,
+    REST_MEM_CATEGORY                category,
+    const char*                      pszFile,
+    int                              line
+    );
+
+#define VmRESTReallocateMemory(pMemory, ppNewMemory, dwSize, category) \
+    VmRESTReallocateMemoryAt((pMemory), (ppNewMemory), (dwSize), (category), __FILE__, __LINE__)
+
+/*
+ * @brief Install application allocator, NULL restores built-in one.
+ * @param[in]                        allocator callbacks
+ * @return Returns 0 for success
+ */
+uint32_t
+VmRESTMemorySetAllocator(
+    PREST_ALLOCATOR                  pAllocator
+    );
+
+/*
+ * @brief Collect size class and category counters of all threads.
+ * @param[out]                       stats to be filled
+ */
+void
+VmRESTMemoryGetStats(
+    PREST_MEMORY_STATS               pStats
+    );
+
+/*
+ * @brief Account blocks allocated by calling thread to a connection
+ *        as well, until next call. NULL stops it.
+ * @param[in]                        connection byte counter or NULL
+ */
+void
+VmRESTMemorySetConnection(
+    uint64_t*                        pnConnBytes
+    );
+
+/*
+ * @brief Start tracking every block, for one more instance.
+ */
+void
+VmRESTMemoryDebugEnable(
+    void
+    );
+
+/*
+ * @brief Leave debug mode for one instance. Last instance to leave logs
+ *        blocks still outstanding, grouped by allocating site.
+ * @param[in]                        handle to log to
+ */
+void
+VmRESTMemoryDebugReport(
+    PVMREST_HANDLE                   pRESTHandle
+    );
+
+typedef struct _VMREST_IOBUF_POOL *PVMREST_IOBUF_POOL;
+
+/*
+ * @brief Create pool of size classed I/O buffers carved from one mapping.
+ * @param[in]                        number of per thread slots
+ * @param[in]                        try huge page backed mapping first
+ * @param[out]                       pointer to created pool
+ * @return Returns 0 for success
+ */
+uint32_t
+VmRESTCreateIOBufferPool(
+    uint32_t                         nSlots,
+    BOOLEAN                          bHugePages,
+    PVMREST_IOBUF_POOL*              ppPool
+    );
+
+/*
+ * @brief Unmap pool. No buffer of the pool must be in use.
+ * @param[in]                        pool
+ */
+void
+VmRESTFreeIOBufferPool(
+    PVMREST_IOBUF_POOL               pPool
+    );
+
+/*
+ * @brief Get I/O buffer of at least given size. Content is not zeroed.
+ *        Falls back to heap when pool is NULL, exhausted or size is over
+ *        largest class.
+ * @param[in]                        pool, can be NULL
+ * @param[in]                        size of buffer needed
+ * @param[out]                       pointer to buffer
+ * @return Returns 0 for success
+ */
+uint32_t
+VmRESTGetIOBuffer(
+    PVMREST_IOBUF_POOL               pPool,
+    size_t                           dwSize,
+    void**                           ppBuffer
+    );
+
+/*
+ * @brief Return buffer obtained from VmRESTGetIOBuffer. Can be called from
+ *        any thread.
+ * @param[in]                        pool, can be NULL
+ * @param[in]                        buffer
+ */
+void
+VmRESTReleaseIOBuffer(
+    PVMREST_IOBUF_POOL               pPool,
+    void*                            pBuffer
+    );
+
+/*
+ * @brief Mapping backing all pool buffers, for registration with kernel
+ *        (io_uring fixed buffers).
+ * @param[in]                        pool
+ * @param[out]                       start of mapping
+ * @param[out]                       length of mapping
+ * @return Returns 0 for success
+ */
+uint32_t
+VmRESTGetIOBufferRegion(
+    PVMREST_IOBUF_POOL               pPool,
+    void**                           ppBase,
+    size_t*                          pLength
+    );
+
+typedef struct _VMREST_METRICS *PVMREST_METRICS;
+
+typedef enum
+{
+    VMREST_METRIC_BYTES_IN = 0,
+    VMREST_METRIC_BYTES_OUT,
+    VMREST_METRIC_ACCEPTS,
+    VMREST_METRIC_TIMEOUTS,
+    VMREST_METRIC_HANDSHAKES,
+    VMREST_METRIC_HANDSHAKE_FAILURES,
+    VMREST_METRIC_COUNT
+} VMREST_METRIC;
+
+/*
+ * @brief Create metrics registry of one instance.
+ * @param[out]                       pointer to created registry
+ * @return Returns 0 for success
+ */
+uint32_t
+VmRESTCreateMetrics(
+    PVMREST_METRICS*                 ppMetrics
     );
 
+/*
+ * @brief Free registry. No thread must be recording into it any more.
+ * @param[in]                        registry
+ */
+void
+VmRESTFreeMetrics(
+    PVMREST_METRICS                  pMetrics
+    );
+
+/*
+ * @brief Get route slot for endpoint URI, same URI always maps to same slot.
+ *        Takes registry lock, call at endpoint registration, not per request.
+ * @param[in]                        registry, can be NULL
+ * @param[in]                        endpoint URI
+ * @return Returns slot, 0 (route "*") when registry is full
+ */
+uint32_t
+VmRESTMetricsGetRouteId(
+    PVMREST_METRICS                  pMetrics,
+    const char*                      pszRoute
+    );
+
+/*
+ * @brief Endpoint URI of route slot. Slots are never reused, name stays valid
+ *        as long as registry.
+ * @param[in]                        registry, can be NULL
+ * @param[in]                        route slot
+ * @return Returns URI, "*" for slot 0 or unknown slot
+ */
+const char*
+VmRESTMetricsGetRouteName(
+    PVMREST_METRICS                  pMetrics,
+    uint32_t                         routeId
+    );
+
+/*
+ * @brief Add to counter in calling thread's shard. Lock free.
+ * @param[in]                        registry, can be NULL
+ * @param[in]                        counter
+ * @param[in]                        amount
+ */
+void
+VmRESTMetricsAdd(
+    PVMREST_METRICS                  pMetrics,
+    VMREST_METRIC                    metric,
+    uint64_t                         nValue
+    );
+
+/*
+ * @brief Count completed request in calling thread's shard. Lock free.
+ * @param[in]                        registry, can be NULL
+ * @param[in]                        route slot
+ * @param[in]                        HTTP method
+ * @param[in]                        HTTP status code
+ * @param[in]                        latency in microseconds
+ */
+void
+VmRESTMetricsRecordRequest(
+    PVMREST_METRICS                  pMetrics,
+    uint32_t                         routeId,
+    const char*                      pszMethod,
+    uint32_t                         statusCode,
+    uint64_t                         latencyUs
+    );
+
+/*
+ * @brief Count time taken to reach a phase in calling thread's shard. Lock free.
+ * @param[in]                        registry, can be NULL
+ * @param[in]                        phase reached
+ * @param[in]                        nanoseconds since phase it counts from
+ */
+void
+VmRESTMetricsRecordPhase(
+    PVMREST_METRICS                  pMetrics,
+    REST_PHASE                       phase,
+    uint64_t                         nValueNs
+    );
+
+/*
+ * @brief Count phases of completed request, each from phase it starts at.
+ *        Connection phases are left out, they are counted once per connection.
+ * @param[in]                        registry, can be NULL
+ * @param[in]                        request timestamps
+ */
+void
+VmRESTMetricsRecordTimings(
+    PVMREST_METRICS                  pMetrics,
+    PREST_REQUEST_TIMINGS            pTimings
+    );
+
+/*
+ * @brief Count thread CPU of a sampled request in calling thread's shard. Lock free.
+ * @param[in]                        registry, can be NULL
+ * @param[in]                        route slot
+ * @param[in]                        HTTP method
+ * @param[in]                        CPU nanoseconds per REST_CPU_PHASE
+ */
+void
+VmRESTMetricsRecordCpu(
+    PVMREST_METRICS                  pMetrics,
+    uint32_t                         routeId,
+    const char*                      pszMethod,
+    const uint64_t                   cpuNs[REST_CPU_PHASE_COUNT]
+    );
+
+/*
+ * @brief Time taken to reach each phase, counted as in REST_PHASE_STATS.
+ *        Phases not reached and connection phases are left 0.
+ * @param[in]                        request timestamps
+ * @param[out]                       nanoseconds per phase
+ */
+void
+VmRESTMetricsGetPhaseDurations(
+    PREST_REQUEST_TIMINGS            pTimings,
+    uint64_t                         durationNs[REST_PHASE_COUNT]
+    );
+
+/*
+ * @brief Name of phase in metrics labels and access log.
+ * @param[in]                        phase
+ * @return Returns name, "unknown" for a phase out of range
+ */
+const char*
+VmRESTMetricsGetPhaseName(
+    REST_PHASE                       phase
+    );
+
+/*
+ * @brief Monotonic clock for request timings. Reads TSC when kernel uses it
+ *        as clocksource, else clock_gettime.
+ * @return Returns nanoseconds, starts near CLOCK_MONOTONIC but may drift from it
+ */
+uint64_t
+VmRESTMetricsNowNs(
+    void
+    );
+
+/*
+ * @brief CPU time consumed by calling thread. A system call on most kernels,
+ *        callers sample rather than read it on every request.
+ * @return Returns nanoseconds, 0 if clock is not available
+ */
+uint64_t
+VmRESTMetricsThreadCpuNs(
+    void
+    );
+
+/*
+ * @brief Sum counters and latency of all shards. Connection gauges are
+ *        left for caller.
+ * @param[in]                        registry
+ * @param[out]                       stats to be filled
+ */
+void
+VmRESTMetricsGetStats(
+    PVMREST_METRICS                  pMetrics,
+    PREST_STATS                      pStats
+    );
+
+/*
+ * @brief Sum latency and CPU of all shards per route and method.
+ * @param[in]                        registry
+ * @param[out]                       array to fill, can be NULL
+ * @param[in]                        number of entries in array
+ * @param[out]                       number of entries filled (or available)
+ */
+void
+VmRESTMetricsGetRouteStats(
+    PVMREST_METRICS                  pMetrics,
+    PREST_ROUTE_STATS                pInfo,
+    uint32_t                         nMax,
+    uint32_t*                        pnCount
+    );
+
+/*
+ * @brief Merged request latency histogram of all routes and methods, in us.
+ * @param[in]                        registry
+ * @param[out]                       count of each bucket, VMREST_METRICS_HIST_BUCKETS entries
+ * @param[out]                       largest value of each bucket, can be NULL
+ */
+void
+VmRESTMetricsGetLatencyHistogram(
+    PVMREST_METRICS                  pMetrics,
+    uint64_t*                        pBucket,
+    uint64_t*                        pUpper
+    );
+
+/*
+ * @brief Render stats and per route histograms in Prometheus text format.
+ * @param[in]                        registry
+ * @param[in]                        stats collected by caller
+ * @param[out]                       text (Freed by caller)
+ * @param[out]                       text length
+ * @return Returns 0 for success
+ */
+uint32_t
+VmRESTMetricsFormat(
+    PVMREST_METRICS                  pMetrics,
+    PREST_STATS                      pStats,
+    char**                           ppszText,
+    uint32_t*                        pnLen
+    );
+
+/**** Per thread access log rings and their writer thread, only when pszAccessLogFile is set ****/
+typedef struct _VMREST_ACCESS_LOG *PVMREST_ACCESS_LOG;
+
+/**** Stats segment and its publisher thread, only when statsShmIntervalMs is set ****/
+typedef struct _VMREST_STATS_PUBLISHER *PVMREST_STATS_PUBLISHER;
+
+/**** Request as seen by access log, strings are only read during the call ****/
+typedef struct _VMREST_ACCESS_LOG_ENTRY
+{
+    const char*                      pszClientIP;
+    int                              clientPort;
+    const char*                      pszMethod;
+    const char*                      pszRoute;
+    uint32_t                         statusCode;
+    uint64_t                         nBytesIn;
+    uint64_t                         nBytesOut;
+    uint32_t                         nConnRequests;
+    PREST_REQUEST_TIMINGS            pTimings;
+} VMREST_ACCESS_LOG_ENTRY, *PVMREST_ACCESS_LOG_ENTRY;
+
+/*
+ * @brief Open access log file of instance and start its writer thread.
+ * @param[in]                        instance handle, config has file, format and sizes
+ * @param[out]                       pointer to created access log
+ * @return Returns 0 for success
+ */
+uint32_t
+VmRESTCreateAccessLog(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVMREST_ACCESS_LOG*              ppAccessLog
+    );
+
+/*
+ * @brief Write out queued records, stop writer and close file. No thread must
+ *        be writing records any more.
+ * @param[in]                        access log
+ */
+void
+VmRESTFreeAccessLog(
+    PVMREST_ACCESS_LOG               pAccessLog
+    );
+
+/*
+ * @brief Format record and queue it in calling thread's ring. Never blocks,
+ *        record is dropped and counted when ring is full.
+ * @param[in]                        access log, can be NULL
+ * @param[in]                        request to record
+ */
+void
+VmRESTAccessLogWrite(
+    PVMREST_ACCESS_LOG               pAccessLog,
+    PVMREST_ACCESS_LOG_ENTRY         pEntry
+    );
+
+/*
+ * @brief Have writer reopen file. Async signal safe.
+ * @param[in]                        access log
+ */
+void
+VmRESTAccessLogReopen(
+    PVMREST_ACCESS_LOG               pAccessLog
+    );
 
 uint32_t
 VmRESTUtilsConvertInttoString(
@@ -187,10 +689,14 @@ typedef pthread_t VMREST_THREAD;
 typedef VMREST_THREAD* PVMREST_THREAD;
 
 
+typedef struct _VMREST_LOCK_CLASS *PVMREST_LOCK_CLASS;
+
 typedef struct _VMREST_MUTEX
 {
     uint8_t                          bInitialized;
     pthread_mutex_t                  critSect;
+    PVMREST_LOCK_CLASS               pClass;
+    uint64_t                         lockedNs;
 
 } VMREST_MUTEX, *PVMREST_MUTEX;
 
@@ -206,6 +712,8 @@ typedef struct _VMREST_RWLOCK
     pthread_key_t                    readKey;
     pthread_key_t                    writeKey;
     pthread_rwlock_t                 rwLock;
+    PVMREST_LOCK_CLASS               pClass;
+    uint64_t                         lockedNs;
 
 } VMREST_RWLOCK, *PVMREST_RWLOCK;
 
@@ -213,12 +721,18 @@ typedef struct _VMREST_RWLOCK
 typedef struct _VMREST_SOCK_CONTEXT
 {
     PVMREST_MUTEX                    pMutex;
+    PVMREST_COND                     pStopCond;
     uint8_t                          bShutdown;
+    BOOLEAN                          bDraining;
+    uint32_t                         nConnections;
     PVM_SOCKET                       pListenerUDP;
     PVM_SOCKET                       pListenerUDP6;
     PVM_SOCKET                       pListenerTCP;
     PVM_SOCKET                       pListenerTCP6;
+    PVM_SOCKET                       pListenerUnix;
+    PVM_SOCKET                       pListenerShm;
     PVM_SOCK_EVENT_QUEUE             pEventQueue;
+    PVM_SOCK_HANDSHAKE_POOL          pHandshakePool;
     PVMREST_THREAD*                  pWorkerThreads;
     uint32_t                         dwNumThreads;
 
@@ -231,6 +745,11 @@ typedef struct _SOCK_SSL_INFO
     bool                             bQueueInUse;
     uint32_t                         isCertSet;
     uint32_t                         isKeySet;
+    char*                            pszCertBuf;
+    uint32_t                         nCertBufLen;
+    char*                            pszKeyBuf;
+    uint32_t                         nKeyBufLen;
+    PVMREST_MUTEX                    pCtxMutex;
 
 } VM_SOCK_SSL_INFO, *PVM_SOCK_SSL_INFO;
 
@@ -243,16 +762,45 @@ typedef struct _REST_CONFIG
     uint32_t                         maxDataPerConnMB;
     uint32_t                         nWorkerThr;
     uint32_t                         nClientCnt;
+    uint32_t                         nHandshakeThr;
+    uint32_t                         nHandshakeQueueDepth;
+    uint32_t                         nTLSRecordRampBytes;
+    uint32_t                         nTLSRecordIdleMs;
+    uint32_t                         nShmRingBytes;
+    uint32_t                         nLogRingBytes;
+    uint32_t                         nAccessLogRingBytes;
+    uint32_t                         accessLogMaxMB;
+    uint32_t                         traceSampleRate;
+    uint32_t                         statsShmIntervalMs;
+    uint32_t                         cpuSampleRate;
+    uint32_t                         nListenFds;
+    int                              listenFds[VMREST_MAX_LISTEN_FDS];
     long                             SSLCtxOptionsFlag;
     bool                             isSecure;
     bool                             useSysLog;
+    bool                             useKernelTLS;
+    bool                             useHugePages;
+    bool                             disableTCP;
+    bool                             useAsyncLog;
+    bool                             blockOnLogFull;
+    bool                             enableMetricsEndpoint;
+    bool                             enableLockProfiling;
+    bool                             enableMemoryDebug;
+    uint32_t                         unixSocketMode;
+    char                             pszUnixSocketPath[VMREST_MAX_UNIX_SOCKET_PATH_LEN];
+    char                             pszShmSocketPath[VMREST_MAX_UNIX_SOCKET_PATH_LEN];
+    char                             pszTraceClientIP[VMREST_MAX_TRACE_FILTER_LEN];
+    char                             pszTraceRoute[VMREST_MAX_TRACE_FILTER_LEN];
+    char                             pszTraceHeader[VMREST_MAX_TRACE_FILTER_LEN];
     char                             pszSSLCertificate[MAX_PATH_LEN];
     char                             pszSSLKey[MAX_PATH_LEN];
     char                             pszDebugLogFile[MAX_PATH_LEN];
+    char                             pszAccessLogFile[MAX_PATH_LEN];
     char                             pszDaemonName[MAX_DEAMON_NAME_LEN];
     char                             pszSSLCipherList[VMREST_MAX_SSL_CIPHER_LIST_LEN];
     SSL_CTX*                         pSSLContext;
     VMREST_LOG_LEVEL                 debugLogLevel;
+    VMREST_ACCESS_LOG_FORMAT         accessLogFormat;
 } VM_REST_CONFIG, *PVM_REST_CONFIG;
 
 typedef struct _REST_ENG_GLOBALS *PREST_ENG_GLOBALS;
@@ -260,16 +808,36 @@ typedef struct _REST_ENG_GLOBALS *PREST_ENG_GLOBALS;
 typedef struct _VMREST_HANDLE
 {
     int                              debugLogLevel;
+    uint32_t                         bTraceEnabled;
+    uint64_t                         nextTraceId;
     int                              instanceState;
     FILE*                            logFile;
+    PVMREST_LOGGER                   pLogger;
     PVM_SOCK_PACKAGE                 pPackage;
     PVM_SOCK_SSL_INFO                pSSLInfo;
     PREST_PROCESSOR                  pHttpHandler;
     PREST_ENG_GLOBALS                pInstanceGlobal;
     PVMREST_SOCK_CONTEXT             pSockContext;
     PVM_REST_CONFIG                  pRESTConfig;
+    PVMREST_IOBUF_POOL               pIOBufPool;
+    PVMREST_METRICS                  pMetrics;
+    PVMREST_ACCESS_LOG               pAccessLog;
+    PVMREST_STATS_PUBLISHER          pStatsShm;
+    PVMREST_ENGINE_GROUP             pEngineGroup;
 } VMREST_HANDLE;
 
+/**** Host handle owns event queue and workers, members only bring listeners ****/
+typedef struct _VMREST_ENGINE_GROUP
+{
+    PVMREST_MUTEX                    pMutex;
+    PVMREST_HANDLE                   pRESTHandle;
+    uint32_t                         nMembers;
+} VMREST_ENGINE_GROUP;
+
+#define VMREST_IS_ENGINE_GROUP_MEMBER(pRESTHandle) \
+    (((pRESTHandle)->pEngineGroup != NULL) && \
+     ((pRESTHandle)->pEngineGroup->pRESTHandle != (pRESTHandle)))
+
 typedef struct _VM_WORKER_THREAD_DATA
 {
     PVMREST_SOCK_CONTEXT             pSockContext;
@@ -319,6 +887,15 @@ VmRESTCommonWriteDataAtOnce(
     uint32_t                         bytes
     );
 
+uint32_t
+VmRESTCommonSendFileAtOnce(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    int                              fd,
+    uint64_t                         offset,
+    uint32_t                         nBytes
+    );
+
 uint32_t
 VmRESTCommonGetPeerInfo(
     PVMREST_HANDLE                   pRESTHandle,
@@ -328,6 +905,32 @@ VmRESTCommonGetPeerInfo(
     int*                             pPortNo
     );
 
+uint32_t
+VmRESTCommonGetPeerCredentials(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    int*                             pPid,
+    uint32_t*                        pUid,
+    uint32_t*                        pGid
+    );
+
+uint32_t
+VmRESTCommonGetConnectionState(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    uint64_t*                        pAcceptNs,
+    uint64_t*                        pTlsDoneNs,
+    uint32_t*                        pnRequests
+    );
+
+uint32_t
+VmRESTDispatchLoopback(
+    PVMREST_HANDLE                   pRESTHandle,
+    char const*                      pszRequest,
+    uint32_t                         nLen,
+    PREST_RESPONSE_SINK              pSink
+    );
+
 uint32_t
 VmRESTGetRequestHandle(
     PVMREST_HANDLE                   pRESTHandle,
@@ -381,6 +984,16 @@ VmRESTAllocateMutex(
     PVMREST_MUTEX*                   ppMutex
     );
 
+/*
+ * @brief Allocate mutex counted under name by lock profiling, name is copied.
+ *        Mutexes of plain VmRESTAllocateMutex are counted as "other".
+ */
+DWORD
+VmRESTAllocateNamedMutex(
+    PVMREST_MUTEX*                   ppMutex,
+    const char*                      pszName
+    );
+
 DWORD
 VmRESTInitializeMutexContent(
     PVMREST_MUTEX                    pMutex
@@ -396,9 +1009,15 @@ VmRESTFreeMutexContent(
     PVMREST_MUTEX                    pMutex
     );
 
+/**** Call site is kept for top waiters of lock profiling ****/
+#define VmRESTLockMutex(pMutex) \
+    VmRESTLockMutexAt((pMutex), __FILE__, __LINE__)
+
 DWORD
-VmRESTLockMutex(
-    PVMREST_MUTEX                    pMutex
+VmRESTLockMutexAt(
+    PVMREST_MUTEX                    pMutex,
+    const char*                      pszFile,
+    int                              line
     );
 
 DWORD
@@ -449,6 +1068,11 @@ VmRESTConditionSignal(
     PVMREST_COND                     pCondition
     );
 
+DWORD
+VmRESTConditionBroadcast(
+    PVMREST_COND                     pCondition
+    );
+
 DWORD
 VmRESTCreateThread(
     PVMREST_THREAD                   pThread,
@@ -473,14 +1097,25 @@ VmRESTAllocateRWLock(
     PVMREST_RWLOCK*                  ppLock
     );
 
+DWORD
+VmRESTAllocateNamedRWLock(
+    PVMREST_RWLOCK*                  ppLock,
+    const char*                      pszName
+    );
+
 VOID
 VmRESTFreeRWLock(
     PVMREST_RWLOCK                   pLock
     );
 
+#define VmRESTLockRead(pLock) \
+    VmRESTLockReadAt((pLock), __FILE__, __LINE__)
+
 void
-VmRESTLockRead(
-    PVMREST_RWLOCK                   pLock
+VmRESTLockReadAt(
+    PVMREST_RWLOCK                   pLock,
+    const char*                      pszFile,
+    int                              line
     );
 
 int
@@ -493,9 +1128,14 @@ VmRESTUnlockRead(
     PVMREST_RWLOCK                   pLock
     );
 
+#define VmRESTLockWrite(pLock) \
+    VmRESTLockWriteAt((pLock), __FILE__, __LINE__)
+
 void
-VmRESTLockWrite(
-    PVMREST_RWLOCK                   pLock
+VmRESTLockWriteAt(
+    PVMREST_RWLOCK                   pLock,
+    const char*                      pszFile,
+    int                              line
     );
 
 int
@@ -510,6 +1150,159 @@ VmRESTUnlockWrite(
 
 /************ threads.c API's End ****************/
 
+/************ threadslot.c API's ****************/
+
+/**** Per thread slots of shared objects, e.g. a log ring per thread and logger.
+      An owner is registered with the registry of its kind, a thread claims at
+      most one slot per owner and keeps its claims in thread local storage.
+      When the thread exits, registry release runs under registry mutex for
+      each slot whose owner is still registered. An owner removed from its
+      registry is no longer touched by exiting threads, it frees slots itself. ****/
+typedef VOID (*PFN_VMREST_THREAD_SLOT_RELEASE)(PVOID pSlot);
+
+/**** Id tells owner from a later one allocated at same address ****/
+typedef struct _VMREST_THREAD_SLOT_OWNER
+{
+    uint64_t                         ownerId;
+    struct _VMREST_THREAD_SLOT_OWNER* pNext;
+} VMREST_THREAD_SLOT_OWNER, *PVMREST_THREAD_SLOT_OWNER;
+
+typedef struct _VMREST_THREAD_SLOT_REGISTRY
+{
+    pthread_mutex_t                  mutex;
+    PVMREST_THREAD_SLOT_OWNER        pOwners;
+    uint64_t                         nextOwnerId;
+    uint32_t                         nMaxClaims;
+    PFN_VMREST_THREAD_SLOT_RELEASE   pfnRelease;
+} VMREST_THREAD_SLOT_REGISTRY, *PVMREST_THREAD_SLOT_REGISTRY;
+
+#define VMREST_THREAD_SLOT_REGISTRY_INIT(nMaxClaims, pfnRelease) \
+    { PTHREAD_MUTEX_INITIALIZER, NULL, 0, (nMaxClaims), (pfnRelease) }
+
+/*
+ * @brief Register owner, threads can then claim slots of it.
+ */
+void
+VmRESTThreadSlotAddOwner(
+    PVMREST_THREAD_SLOT_REGISTRY     pRegistry,
+    PVMREST_THREAD_SLOT_OWNER        pOwner
+    );
+
+/*
+ * @brief Unregister owner before freeing its slots. Exiting threads do not
+ *        release slots of it once this returns.
+ */
+void
+VmRESTThreadSlotRemoveOwner(
+    PVMREST_THREAD_SLOT_REGISTRY     pRegistry,
+    PVMREST_THREAD_SLOT_OWNER        pOwner
+    );
+
+/*
+ * @brief Slot calling thread claimed of owner. Lock free.
+ * @param[in]                        pOwner, NULL for owner living as long as process
+ * @param[out]                       slot claimed, NULL if claim was remembered without slot
+ * @return Returns TRUE if thread has a claim on owner
+ */
+BOOLEAN
+VmRESTThreadSlotFind(
+    PVMREST_THREAD_SLOT_REGISTRY     pRegistry,
+    PVMREST_THREAD_SLOT_OWNER        pOwner,
+    PVOID*                           ppSlot
+    );
+
+/*
+ * @brief Get calling thread ready for a new claim in registry. Drops claims
+ *        on owners which are gone.
+ * @return Returns FALSE when thread is exiting or has no claim left, caller
+ *         then goes without a slot
+ */
+BOOLEAN
+VmRESTThreadSlotPrepare(
+    PVMREST_THREAD_SLOT_REGISTRY     pRegistry
+    );
+
+/*
+ * @brief Record claim of calling thread after successful VmRESTThreadSlotPrepare.
+ * @param[in]                        pSlot, NULL remembers that thread has no
+ *                                   slot so it does not try again
+ */
+void
+VmRESTThreadSlotClaim(
+    PVMREST_THREAD_SLOT_REGISTRY     pRegistry,
+    PVMREST_THREAD_SLOT_OWNER        pOwner,
+    PVOID                            pSlot
+    );
+
+/************ threadslot.c API's End ****************/
+
+/************ lockstats.c API's ****************/
+
+/**** Non zero once an instance enabled lock profiling, read on every lock ****/
+extern uint32_t                      gVmRESTLockProfiling;
+
+/*
+ * @brief Find or create stats class of lock name, NULL or empty name is "other".
+ * @param[in]                        name
+ * @return Returns class, NULL if none could be made and lock is not profiled
+ */
+PVMREST_LOCK_CLASS
+VmRESTLockGetClass(
+    const char*                      pszName
+    );
+
+/*
+ * @brief Start measuring locks, stays on for process.
+ */
+void
+VmRESTLockProfilingEnable(
+    void
+    );
+
+/*
+ * @brief Count an acquisition, call site is kept when contended.
+ * @param[in]                        class of lock
+ * @param[in]                        time waited, 0 when not contended
+ * @param[in]                        whether trylock failed first
+ * @param[in]                        file of call site, may be NULL
+ * @param[in]                        line of call site
+ */
+void
+VmRESTLockRecordAcquire(
+    PVMREST_LOCK_CLASS               pClass,
+    uint64_t                         waitNs,
+    BOOLEAN                          bContended,
+    const char*                      pszFile,
+    int                              line
+    );
+
+/*
+ * @brief Count time lock was held, from acquisition to release.
+ * @param[in]                        class of lock
+ * @param[in]                        time held
+ */
+void
+VmRESTLockRecordHold(
+    PVMREST_LOCK_CLASS               pClass,
+    uint64_t                         holdNs
+    );
+
+/*
+ * @brief Sum shards of all classes, most waited for first.
+ * @param[out]                       array to fill, can be NULL
+ * @param[in]                        number of entries in array
+ * @param[out]                       number of entries filled (or available)
+ * @return Returns 0 for success
+ */
+uint32_t
+VmRESTLockGetStats(
+    PREST_LOCK_STATS                 pStats,
+    uint32_t                         nMax,
+    uint32_t*                        pnCount
+    );
+
+/************ lockstats.c API's End ****************/
+
 
 #ifdef __cplusplus
 }
@@ -71,6 +71,7 @@
 #define VMREST_TRANSPORT_SOCK_SET_HANDLE_FAILED         61131
 #define VMREST_TRANSPORT_SOCK_DATA_OVER_LIMIT           61132
 #define VMREST_TRANSPORT_REMOTE_CONN_CLOSED             61133
+#define VMREST_TRANSPORT_HANDSHAKE_QUEUE_FULL           61134
 
 #define ERROR_TRANSPORT_INVALID_PARAMS                  61040
 #define ERROR_TRANSPORT_VALIDATION_FAILED               61041
@@ -82,18 +83,85 @@
 #define SSL_INFO_USE_APP_CONTEXT                        4
 
 #define VMREST_MAX_SSL_CIPHER_LIST_LEN                  256
+#define VMREST_MAX_TRACE_FILTER_LEN                     256
 #define VMREST_DEFAULT_SSL_CIPHER_LIST                  "!aNULL:kECDH+AESGCM:ECDH+AESGCM:RSA+AESGCM:kECDH+AES:ECDH+AES:RSA+AES"
 #define VMREST_DEFAULT_SSL_CTX_OPTION_FLAG              SSL_OP_NO_TLSv1|SSL_OP_NO_SSLv3|SSL_OP_NO_SSLv2
 
+#define VMREST_CONF_INIT_MAGIC                          0x52435446
+
 #define VMREST_DEFAULT_WORKER_THR_COUNT                 5
 #define VMREST_DEFAULT_CLIENT_COUNT                     100
 #define VMREST_DEFAULT_CONN_TIMEOUT_SEC                 60
 #define VMREST_DEFAULT_CONN_PAYLOAD_LIMIT_MB            25
+#define VMREST_DEFAULT_HANDSHAKE_QUEUE_DEPTH            1024
+#define VMREST_DEFAULT_TLS_RECORD_RAMP_BYTES            (1024 * 1024)
+#define VMREST_DEFAULT_TLS_RECORD_IDLE_MS               1000
+#define VMREST_DEFAULT_SHM_RING_BYTES                   (256 * 1024)
+#define VMREST_DEFAULT_LOG_RING_BYTES                   (64 * 1024)
+#define VMREST_DEFAULT_ACCESS_LOG_RING_BYTES            (256 * 1024)
 
 #define VMREST_MAX_WORKER_THR_COUNT                     100
 #define VMREST_MAX_CLIENT_COUNT                         10000
 #define VMREST_MAX_CONN_TIMEOUT_SEC                     600
 #define VMREST_MAX_CONN_PAYLOAD_LIMIT_MB                50
+#define VMREST_MAX_HANDSHAKE_THR_COUNT                  32
+#define VMREST_MAX_HANDSHAKE_QUEUE_DEPTH                65536
+#define VMREST_MAX_TLS_RECORD_IDLE_MS                   60000
+#define VMREST_MIN_SHM_RING_BYTES                       4096
+#define VMREST_MAX_SHM_RING_BYTES                       (64 * 1024 * 1024)
+#define VMREST_MIN_LOG_RING_BYTES                       8192
+#define VMREST_MIN_STATS_SHM_INTERVAL_MS                100
+#define VMREST_MAX_LOG_RING_BYTES                       (16 * 1024 * 1024)
+#define VMREST_MIN_ACCESS_LOG_RING_BYTES                8192
+#define VMREST_MAX_ACCESS_LOG_RING_BYTES                (16 * 1024 * 1024)
+
+/**** Per thread free list of each size class holds at most this many bytes ****/
+#define VMREST_MEMORY_CACHE_MAX_BYTES                   (256 * 1024)
+#define VMREST_MEMORY_CACHE_MAX_BLOCKS                  256
+/**** Freed block is cached in a class only if its usable size is close to class size ****/
+#define VMREST_MEMORY_CLASS_SLACK                       32
+/**** Live bytes of a category are published once a thread's change reaches this ****/
+#define VMREST_MEMORY_LIVE_BATCH_BYTES                  (64 * 1024)
+/**** Debug mode, every block is tracked in a hash table, report merges blocks by site ****/
+#define VMREST_MEMORY_DEBUG_BUCKETS                     4096
+#define VMREST_MEMORY_DEBUG_MAX_SITES                   64
+
+/**** Per thread slots, claims one thread can hold over all registries ****/
+#define VMREST_THREAD_SLOT_MAX_CLAIMS                   32
+
+/**** I/O buffer pool, buffers of each class carved for every per thread slot ****/
+#define VMREST_IOBUF_CLASS_COUNT                        3
+#define VMREST_IOBUF_SMALL_SIZE                         (4 * 1024)
+#define VMREST_IOBUF_MEDIUM_SIZE                        (16 * 1024)
+#define VMREST_IOBUF_LARGE_SIZE                         (64 * 1024)
+#define VMREST_IOBUF_SMALL_PER_SLOT                     16
+#define VMREST_IOBUF_MEDIUM_PER_SLOT                    8
+#define VMREST_IOBUF_LARGE_PER_SLOT                     4
+/**** Slots for threads other than workers and handshake threads ****/
+#define VMREST_IOBUF_SPARE_SLOTS                        4
+#define VMREST_IOBUF_HUGE_PAGE_SIZE                     (2 * 1024 * 1024)
+
+/**** Metrics, route slot 0 takes requests not matched to an endpoint ****/
+#define VMREST_METRICS_MAX_ROUTES                       64
+#define VMREST_METRICS_THREAD_SHARDS                    8
+#define VMREST_STATS_SPARE_CONNECTIONS                  16
+/**** Log-linear histogram, 8 linear buckets per power of two up to 2^32, us for
+      request latency and ns for phases ****/
+#define VMREST_METRICS_HIST_SUB_BITS                    3
+#define VMREST_METRICS_HIST_BUCKETS                     240
+#define VMREST_METRICS_CLOCKSOURCE_PATH                 "/sys/devices/system/clocksource/clocksource0/current_clocksource"
+#define VMREST_METRICS_CLOCK_CALIBRATE_NS               2000000
+
+/**** Access log, size rotation keeps file.1 (newest) to file.N ****/
+#define VMREST_ACCESS_LOG_ROTATE_KEEP                   4
+#define VMREST_ACCESS_LOG_MAX_RECORD                    1024
+
+/**** Lock profiling, locks are counted per name. Threads spread their updates
+      over shards of a name, contended call sites are kept per name ****/
+#define VMREST_LOCK_MAX_CLASSES                         32
+#define VMREST_LOCK_SHARDS                              8
+#define VMREST_LOCK_MAX_SITES                           32
+#define VMREST_LOCK_NAME_OTHER                          "other"
 
 
 #define TRUE                             1
@@ -140,10 +208,10 @@ extern "C" {
         }                                 \
     } while(0)
 
-#define VMREST_SAFE_FREE_MEMORY(PTR)       \
+#define VMREST_SAFE_FREE_MEMORY(PTR, CAT) \
     do {                                  \
         if ((PTR)) {                      \
-            VmRESTFreeMemory(PTR);         \
+            VmRESTFreeMemory(PTR, CAT);    \
             (PTR) = NULL;                 \
         }                                 \
     } while(0)
@@ -0,0 +1,106 @@
+/* C-REST-Engine
+*
+* Copyright (c) 2017 VMware, Inc. All Rights Reserved.
+*
+* This product is licensed to you under the Apache 2.0 license (the "License").
+* You may not use this product except in compliance with the Apache 2.0 License.
+*
+* This product may include a number of subcomponents with separate copyright
+* notices and license terms. Your use of these subcomponents is subject to the
+* terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+*
+*/
+
+#ifndef __VMREST_SHM_H__
+#define __VMREST_SHM_H__
+
+/**** Shared memory channel layout, common to server transport and client library.
+      Client connects to rendezvous unix socket and receives a memfd holding
+      VMREST_SHM_HEADER followed by request ring data and response ring data,
+      plus one eventfd to wake server and one eventfd to wake client. ****/
+
+#define VMREST_SHM_MAGIC                                0x564d5348
+#define VMREST_SHM_VERSION                              1
+#define VMREST_SHM_FD_MEMORY                            0
+#define VMREST_SHM_FD_WAKE_SERVER                       1
+#define VMREST_SHM_FD_WAKE_CLIENT                       2
+#define VMREST_SHM_FD_COUNT                             3
+
+/**** Single producer single consumer byte ring. head and tail are free running
+      byte counters, ring size is a power of two. Each sits on its own cache line. ****/
+typedef struct _VMREST_SHM_RING
+{
+    volatile uint32_t                head;
+    char                             pad0[60];
+    volatile uint32_t                tail;
+    char                             pad1[60];
+    volatile uint32_t                bConsumerWaiting;
+    volatile uint32_t                bProducerClosed;
+    char                             pad2[56];
+} VMREST_SHM_RING, *PVMREST_SHM_RING;
+
+typedef struct _VMREST_SHM_HEADER
+{
+    uint32_t                         magic;
+    uint32_t                         version;
+    uint32_t                         nRingBytes;
+    uint32_t                         reserved;
+    char                             pad[48];
+    VMREST_SHM_RING                  request;
+    VMREST_SHM_RING                  response;
+} VMREST_SHM_HEADER, *PVMREST_SHM_HEADER;
+
+/**** Data part of rendezvous message, fds travel as SCM_RIGHTS ****/
+typedef struct _VMREST_SHM_HELLO
+{
+    uint32_t                         magic;
+    uint32_t                         version;
+    uint32_t                         nRingBytes;
+    uint32_t                         nFds;
+} VMREST_SHM_HELLO, *PVMREST_SHM_HELLO;
+
+#define VMREST_SHM_MAP_BYTES(nRingBytes) \
+    (sizeof(VMREST_SHM_HEADER) + (2 * (size_t)(nRingBytes)))
+
+#define VMREST_SHM_REQUEST_DATA(pHeader) \
+    ((char*)(pHeader) + sizeof(VMREST_SHM_HEADER))
+
+#define VMREST_SHM_RESPONSE_DATA(pHeader) \
+    ((char*)(pHeader) + sizeof(VMREST_SHM_HEADER) + (pHeader)->nRingBytes)
+
+/**** shmring.c ****/
+
+uint32_t
+VmRESTShmRingWrite(
+    PVMREST_SHM_RING                 pRing,
+    char*                            pData,
+    uint32_t                         nRingBytes,
+    const char*                      pBuf,
+    uint32_t                         nLen
+    );
+
+uint32_t
+VmRESTShmRingRead(
+    PVMREST_SHM_RING                 pRing,
+    const char*                      pData,
+    uint32_t                         nRingBytes,
+    char*                            pBuf,
+    uint32_t                         nLen
+    );
+
+uint32_t
+VmRESTShmRingUsed(
+    PVMREST_SHM_RING                 pRing
+    );
+
+uint32_t
+VmRESTShmRingPrepareWait(
+    PVMREST_SHM_RING                 pRing
+    );
+
+uint32_t
+VmRESTShmRingNeedsWakeup(
+    PVMREST_SHM_RING                 pRing
+    );
+
+#endif /* __VMREST_SHM_H__ */
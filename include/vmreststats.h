@@ -0,0 +1,56 @@
+/* C-REST-Engine
+*
+* Copyright (c) 2017 VMware, Inc. All Rights Reserved.
+*
+* This product is licensed to you under the Apache 2.0 license (the "License").
+* You may not use this product except in compliance with the Apache 2.0 License.
+*
+* This product may include a number of subcomponents with separate copyright
+* notices and license terms. Your use of these subcomponents is subject to the
+* terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+*
+*/
+
+#ifndef __VMREST_STATS_H__
+#define __VMREST_STATS_H__
+
+/**** Stats segment layout, common to engine and rest-cli. Engine publishes a
+      snapshot of instance stats into POSIX shared memory object
+      VMREST_STATS_SHM_PREFIX<daemon>-<port> (/dev/shm on Linux) every interval,
+      readers map it read only. Any change of layout bumps version. ****/
+
+#define VMREST_STATS_SHM_MAGIC                          0x564d5354
+#define VMREST_STATS_SHM_VERSION                        2
+#define VMREST_STATS_SHM_PREFIX                         "/vmrest-"
+#define VMREST_STATS_SHM_DIR                            "/dev/shm"
+#define VMREST_STATS_SHM_NAME_LEN                       64
+#define VMREST_STATS_SHM_MAX_ROUTES                     128
+
+/**** Snapshot is under a seqlock. Writer makes seq odd, copies, then makes it
+      even again. Reader copies out and retries if seq was odd or changed. ****/
+typedef struct _VMREST_STATS_SHM
+{
+    uint32_t                         magic;
+    uint32_t                         version;
+    uint32_t                         nBytes;
+    uint32_t                         nMaxRoutes;
+    int32_t                          pid;
+    uint32_t                         serverPort;
+    uint32_t                         intervalMs;
+    volatile uint32_t                bStopped;
+    uint64_t                         startTimeMs;
+    char                             szDaemonName[MAX_DEAMON_NAME_LEN];
+    char                             pad0[20];
+
+    volatile uint32_t                seq;
+    uint32_t                         nRoutes;
+    uint64_t                         nUpdates;
+    uint64_t                         snapshotTimeMs;
+    uint64_t                         snapshotNs;
+    REST_STATS                       stats;
+    uint64_t                         latencyBucket[VMREST_METRICS_HIST_BUCKETS];
+    uint64_t                         latencyUpperUs[VMREST_METRICS_HIST_BUCKETS];
+    REST_ROUTE_STATS                 route[VMREST_STATS_SHM_MAX_ROUTES];
+} VMREST_STATS_SHM, *PVMREST_STATS_SHM;
+
+#endif /* __VMREST_STATS_H__ */
@@ -44,10 +44,13 @@ typedef UINT32                           VM_SOCK_CREATE_FLAGS;
 #define VM_SOCK_CREATE_FLAGS_UDP         0x00000008
 #define VM_SOCK_CREATE_FLAGS_REUSE_ADDR  0x00000010
 #define VM_SOCK_CREATE_FLAGS_NON_BLOCK   0x00000020
+#define VM_SOCK_CREATE_FLAGS_UNIX        0x00000040
+#define VM_SOCK_CREATE_FLAGS_SHM         0x00000080
 #define VM_SOCK_IS_SSL                   0x00000040
 
 typedef struct _VM_SOCKET*               PVM_SOCKET;
 typedef struct _VM_SOCK_EVENT_QUEUE*     PVM_SOCK_EVENT_QUEUE;
+typedef struct _VM_SOCK_HANDSHAKE_POOL*  PVM_SOCK_HANDSHAKE_POOL;
 
 typedef enum
 {
@@ -186,6 +189,38 @@ VmwSockCloseEventQueue(
     uint32_t                         waitSecond
     );
 
+/**
+ * @brief Puts a member of an engine group on the shared event queue.
+ *        Starts handshake threads of the member, queue and workers are shared.
+ *
+ * @param[in] Handle to library instance.
+ * @param[in] pQueue Pointer to shared event queue
+ *
+ * @return 0 on success
+ */
+DWORD
+VmwSockAttachEventQueue(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_EVENT_QUEUE             pQueue
+    );
+
+/**
+ * @brief Takes a member of an engine group off the shared event queue.
+ *        Waits for its connections to drain, queue and workers stay.
+ *
+ * @param[in] Handle to library instance.
+ * @param[in] pQueue Pointer to shared event queue
+ * @param[in] wait time for clean closure.
+ *
+ * @return 0 on success
+ */
+DWORD
+VmwSockDetachEventQueue(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_EVENT_QUEUE             pQueue,
+    uint32_t                         waitSecond
+    );
+
 /**
  * @brief Reads data from the socket
  *
@@ -222,6 +257,108 @@ VmwSockWrite(
     uint32_t                         nBufLen
 );
 
+/**
+ * @brief Sends a region of a file on the socket
+ *
+ * @param[in]     pRESTHandle  Handle to library instance.
+ * @param[in]     pSocket      Pointer to socket
+ * @param[in]     fd           File descriptor to send from
+ * @param[in]     offset       Offset in file to start from
+ * @param[in]     nBytes       Number of bytes to send
+ *
+ * @return 0 on success
+ */
+DWORD
+VmwSockSendFile(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    int                              fd,
+    uint64_t                         offset,
+    uint32_t                         nBytes
+    );
+
+/**
+ * @brief Get statistics of TLS handshake pool
+ *
+ * @param[in]     pRESTHandle  Handle to library instance.
+ * @param[out]    pStats       Stats to be filled
+ *
+ * @return 0 on success
+ */
+DWORD
+VmwSockGetHandshakeStats(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_HANDSHAKE_STATS            pStats
+    );
+
+/**
+ * @brief Get snapshot of live connections from connection table
+ *
+ * @param[in]     pRESTHandle  Handle to library instance.
+ * @param[out]    pInfo        Array to fill, can be NULL
+ * @param[in]     nMax         Number of entries in array
+ * @param[out]    pnCount      Entries filled, or live connections if pInfo is NULL
+ *
+ * @return 0 on success
+ */
+DWORD
+VmwSockGetConnections(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_CONNECTION_INFO            pInfo,
+    uint32_t                         nMax,
+    uint32_t*                        pnCount
+    );
+
+/**
+ * @brief Send listening sockets to successor process over Unix socket
+ *
+ * @param[in]     pRESTHandle   Handle to library instance.
+ * @param[in]     pszSocketPath Unix socket path successor listens on
+ *
+ * @return 0 on success
+ */
+DWORD
+VmwSockSendListenerFds(
+    PVMREST_HANDLE                   pRESTHandle,
+    const char*                      pszSocketPath
+    );
+
+/**
+ * @brief Receive listening sockets from running process over Unix socket
+ *
+ * @param[in]     pRESTHandle   Handle to library instance.
+ * @param[in]     pszSocketPath Unix socket path to listen on
+ * @param[in]     waitSeconds   Time to wait for sender
+ *
+ * @return 0 on success
+ */
+DWORD
+VmwSockReceiveListenerFds(
+    PVMREST_HANDLE                   pRESTHandle,
+    const char*                      pszSocketPath,
+    uint32_t                         waitSeconds
+    );
+
+/**
+ * @brief Build new SSL context and swap it in for new connections
+ *
+ * @param[in]     pRESTHandle  Handle to library instance.
+ * @param[in]     pszCertBuf   PEM certificate buffer, NULL to reload from file
+ * @param[in]     nCertBufLen  Length of certificate buffer
+ * @param[in]     pszKeyBuf    PEM private key buffer, NULL to reload from file
+ * @param[in]     nKeyBufLen   Length of key buffer
+ *
+ * @return 0 on success
+ */
+DWORD
+VmwSockReloadSSLContext(
+    PVMREST_HANDLE                   pRESTHandle,
+    const char*                      pszCertBuf,
+    uint32_t                         nCertBufLen,
+    const char*                      pszKeyBuf,
+    uint32_t                         nKeyBufLen
+    );
+
 /**
  * @brief Releases current reference to socket
  * @param[in] Handle to library instance.
@@ -259,6 +396,23 @@ VmwSockGetRequestHandle(
     PREST_REQUEST*                   ppRequest
     );
 
+/**
+ * @brief Library instance a socket belongs to, event queue may be shared
+ *        by several instances of an engine group.
+ *
+ * @param[in]     pRESTHandle  Handle to instance waiting on queue.
+ * @param[in]     pSocket      Pointer to socket
+ * @param[out]    ppSockHandle Handle to instance owning the socket
+ *
+ * @return 0 on success
+ */
+DWORD
+VmwSockGetSocketHandle(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    PVMREST_HANDLE*                  ppSockHandle
+    );
+
 DWORD
 VmwSockSetRequestHandle(
     PVMREST_HANDLE                   pRESTHandle,
@@ -277,6 +431,65 @@ VmwSockGetPeerInfo(
     int*                             pPortNo
     );
 
+/**
+ * @brief Credentials of the process at the other end of a unix domain
+ *        socket connection, as seen by the kernel at connect time.
+ *
+ * @param[in]     pRESTHandle  Handle to library instance.
+ * @param[in]     pSocket      Pointer to socket
+ * @param[out]    pPid         Peer process id
+ * @param[out]    pUid         Peer user id
+ * @param[out]    pGid         Peer group id
+ *
+ * @return 0 on success, ERROR_NOT_SUPPORTED if socket is not AF_UNIX
+ */
+DWORD
+VmwSockGetPeerCredentials(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    int*                             pPid,
+    uint32_t*                        pUid,
+    uint32_t*                        pGid
+    );
+
+/**
+ * @brief Creates an in-memory connection. Nothing is read from it, data
+ *        written to it goes to sink. Release with VmwSockRelease.
+ *
+ * @param[in]     pRESTHandle  Handle to library instance.
+ * @param[in]     pSink        Receiver of written data, must outlive socket
+ * @param[out]    ppSocket     Pointer to created socket
+ *
+ * @return 0 on success
+ */
+DWORD
+VmwSockCreateLoopback(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_RESPONSE_SINK              pSink,
+    PVM_SOCKET*                      ppSocket
+    );
+
+/**
+ * @brief When connection was accepted, when its TLS handshake completed and
+ *        how many requests it has completed.
+ *
+ * @param[in]     pRESTHandle  Handle to library instance.
+ * @param[in]     pSocket      Pointer to socket
+ * @param[out]    pAcceptNs    Accept time, VmRESTMetricsNowNs clock
+ * @param[out]    pTlsDoneNs   Handshake completion time, 0 without TLS
+ * @param[out]    pnRequests   Requests completed on connection so far
+ *
+ * @return 0 on success
+ */
+DWORD
+VmwSockGetConnectionState(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    uint64_t*                        pAcceptNs,
+    uint64_t*                        pTlsDoneNs,
+    uint32_t*                        pnRequests
+    );
+
 typedef enum
 {
     VM_SOCK_PROTOCOL_UNKNOWN = 0,
@@ -293,7 +506,8 @@ typedef enum
     VM_SOCK_TYPE_SIGNAL,
     VM_SOCK_TYPE_TIMER,
     VM_SOCK_TYPE_TCP_V4,
-    VM_SOCK_TYPE_TCP_V6
+    VM_SOCK_TYPE_TCP_V6,
+    VM_SOCK_TYPE_LOOPBACK
 } VM_SOCK_TYPE;
 
 typedef DWORD (*PFN_START_SERVER_SOCKET)(
@@ -347,6 +561,62 @@ typedef DWORD (*PFN_WRITE)(
                     uint32_t            nBufLen
                     );
 
+typedef DWORD (*PFN_SEND_FILE)(
+                    PVMREST_HANDLE      pRESTHandle,
+                    PVM_SOCKET          pSocket,
+                    int                 fd,
+                    uint64_t            offset,
+                    uint32_t            nBytes
+                    );
+
+typedef DWORD (*PFN_GET_HANDSHAKE_STATS)(
+                    PVMREST_HANDLE        pRESTHandle,
+                    PREST_HANDSHAKE_STATS pStats
+                    );
+
+typedef DWORD (*PFN_RELOAD_SSL_CONTEXT)(
+                    PVMREST_HANDLE        pRESTHandle,
+                    const char*           pszCertBuf,
+                    uint32_t              nCertBufLen,
+                    const char*           pszKeyBuf,
+                    uint32_t              nKeyBufLen
+                    );
+
+typedef DWORD (*PFN_GET_CONNECTIONS)(
+                    PVMREST_HANDLE        pRESTHandle,
+                    PREST_CONNECTION_INFO pInfo,
+                    uint32_t              nMax,
+                    uint32_t*             pnCount
+                    );
+
+typedef DWORD (*PFN_SEND_LISTENER_FDS)(
+                    PVMREST_HANDLE        pRESTHandle,
+                    const char*           pszSocketPath
+                    );
+
+typedef DWORD (*PFN_RECEIVE_LISTENER_FDS)(
+                    PVMREST_HANDLE        pRESTHandle,
+                    const char*           pszSocketPath,
+                    uint32_t              waitSeconds
+                    );
+
+typedef DWORD (*PFN_ATTACH_EVENT_QUEUE)(
+                    PVMREST_HANDLE        pRESTHandle,
+                    PVM_SOCK_EVENT_QUEUE  pQueue
+                    );
+
+typedef DWORD (*PFN_DETACH_EVENT_QUEUE)(
+                    PVMREST_HANDLE        pRESTHandle,
+                    PVM_SOCK_EVENT_QUEUE  pQueue,
+                    uint32_t              waitSecond
+                    );
+
+typedef DWORD (*PFN_GET_SOCKET_HANDLE)(
+                    PVMREST_HANDLE        pRESTHandle,
+                    PVM_SOCKET            pSocket,
+                    PVMREST_HANDLE*       ppSockHandle
+                    );
+
 typedef VOID (*PFN_RELEASE_SOCKET)(
                     PVMREST_HANDLE       pRESTHandle,
                     PVM_SOCKET           pSocket
@@ -379,6 +649,28 @@ typedef DWORD(*PFN_GET_PEER_INFO)(
                     int*                  pPortNo
                     );
 
+typedef DWORD(*PFN_GET_PEER_CREDENTIALS)(
+                    PVMREST_HANDLE        pRESTHandle,
+                    PVM_SOCKET            pSocket,
+                    int*                  pPid,
+                    uint32_t*             pUid,
+                    uint32_t*             pGid
+                    );
+
+typedef DWORD(*PFN_CREATE_LOOPBACK)(
+                    PVMREST_HANDLE        pRESTHandle,
+                    PREST_RESPONSE_SINK   pSink,
+                    PVM_SOCKET*           ppSocket
+                    );
+
+typedef DWORD(*PFN_GET_CONNECTION_STATE)(
+                    PVMREST_HANDLE        pRESTHandle,
+                    PVM_SOCKET            pSocket,
+                    uint64_t*             pAcceptNs,
+                    uint64_t*             pTlsDoneNs,
+                    uint32_t*             pnRequests
+                    );
+
 typedef struct _VM_SOCK_PACKAGE
 {
     PFN_START_SERVER_SOCKET             pfnStartServerSocket;
@@ -394,4 +686,16 @@ typedef struct _VM_SOCK_PACKAGE
     PFN_GET_REQUEST_HANDLE              pfnGetRequestHandle;
     PFN_SET_REQUEST_HANDLE              pfnSetRequestHandle;
     PFN_GET_PEER_INFO                   pfnGetPeerInfo;
+    PFN_SEND_FILE                       pfnSendFile;
+    PFN_GET_HANDSHAKE_STATS             pfnGetHandshakeStats;
+    PFN_RELOAD_SSL_CONTEXT              pfnReloadSSLContext;
+    PFN_GET_CONNECTIONS                 pfnGetConnections;
+    PFN_SEND_LISTENER_FDS               pfnSendListenerFds;
+    PFN_RECEIVE_LISTENER_FDS            pfnReceiveListenerFds;
+    PFN_ATTACH_EVENT_QUEUE              pfnAttachEventQueue;
+    PFN_DETACH_EVENT_QUEUE              pfnDetachEventQueue;
+    PFN_GET_SOCKET_HANDLE               pfnGetSocketHandle;
+    PFN_GET_PEER_CREDENTIALS            pfnGetPeerCredentials;
+    PFN_CREATE_LOOPBACK                 pfnCreateLoopback;
+    PFN_GET_CONNECTION_STATE            pfnGetConnectionState;
 } VM_SOCK_PACKAGE, *PVM_SOCK_PACKAGE;
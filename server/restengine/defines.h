@@ -69,9 +69,15 @@ typedef enum _VM_REST_INSTANCE_STATE
     VMREST_INSTANCE_INITIALIZED        = 1,
     VMREST_INSTANCE_STARTED            = 2,
     VMREST_INSTANCE_STOPPED            = 3,
-    VMREST_INSTANCE_SHUTDOWN           = 4
+    VMREST_INSTANCE_SHUTDOWN           = 4,
+    VMREST_INSTANCE_STOPPING           = 5
 }VM_REST_INSTANCE_STATE;
 
+/**** Requests in flight while stop drains connections may still read and send data ****/
+#define VMREST_INSTANCE_SERVING(pRESTHandle) \
+    (((pRESTHandle)->instanceState == VMREST_INSTANCE_STARTED) || \
+     ((pRESTHandle)->instanceState == VMREST_INSTANCE_STOPPING))
+
 typedef enum _VM_REST_PROCESSING_STATE
 {
     PROCESS_INVALID              = -1,
@@ -74,7 +74,8 @@ VmRESTAllocateHTTPRequestPacket(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(VM_REST_HTTP_REQUEST_PACKET),
-                  (void**)&pReqPacket
+                  (void**)&pReqPacket,
+                  REST_MEM_REQUEST
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -122,14 +123,14 @@ VmRESTFreeHTTPRequestPacket(
 
         if (pReqPacket->pszPayload)
         {
-            VmRESTFreeMemory(pReqPacket->pszPayload);
+            VmRESTFreeMemory(pReqPacket->pszPayload, REST_MEM_PAYLOAD);
             pReqPacket->pszPayload = NULL;
         }
 
         pReqPacket->requestLine = NULL;
         pReqPacket->miscHeader = NULL;
 
-        VmRESTFreeMemory(pReqPacket);
+        VmRESTFreeMemory(pReqPacket, REST_MEM_REQUEST);
 
         *ppReqPacket = NULL;
     }
@@ -148,7 +149,8 @@ VmRESTAllocateHTTPResponsePacket(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(VM_REST_HTTP_RESPONSE_PACKET),
-                  (void**)&pResPacket
+                  (void**)&pResPacket,
+                  REST_MEM_RESPONSE
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -209,7 +211,7 @@ VmRESTFreeHTTPResponsePacket(
         pResPacket->messageBody = NULL;
         pResPacket->miscHeader = NULL;
 
-        VmRESTFreeMemory(pResPacket);
+        VmRESTFreeMemory(pResPacket, REST_MEM_RESPONSE);
 
         *ppResPacket = NULL;
     }
@@ -227,20 +229,23 @@ VmRESTAllocateEndPoint(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(REST_ENDPOINT),
-                  (void**)&pEndPoint
+                  (void**)&pEndPoint,
+                  REST_MEM_OTHER
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
     dwError = VmRESTAllocateMemory(
                   MAX_URI_LEN,
-                  (void**)&pEndPointURI
+                  (void**)&pEndPointURI,
+                  REST_MEM_OTHER
                   );
     BAIL_ON_VMREST_ERROR(dwError);
     pEndPoint->pszEndPointURI = pEndPointURI;
 
     dwError = VmRESTAllocateMemory(
                   sizeof(REST_PROCESSOR),
-                  (void**)&pHandler
+                  (void**)&pHandler,
+                  REST_MEM_OTHER
                   );
     BAIL_ON_VMREST_ERROR(dwError);
     pEndPoint->pHandler = pHandler;
@@ -269,18 +274,20 @@ VmRESTFreeEndPoint(
         if (pEndPoint->pszEndPointURI)
         {
             VmRESTFreeMemory(
-                pEndPoint->pszEndPointURI
+                pEndPoint->pszEndPointURI,
+                REST_MEM_OTHER
                 );
             pEndPoint->pszEndPointURI = NULL;
         }
         if (pEndPoint->pHandler)
         {
             VmRESTFreeMemory(
-                pEndPoint->pHandler
+                pEndPoint->pHandler,
+                REST_MEM_OTHER
                 );
             pEndPoint->pHandler = NULL;
         }
-        VmRESTFreeMemory(pEndPoint);
+        VmRESTFreeMemory(pEndPoint, REST_MEM_OTHER);
     }
 }
 
@@ -299,13 +306,15 @@ VmRESTAllocateHandle(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(VMREST_HANDLE),
-                  (void**)&pRESTHandle
+                  (void**)&pRESTHandle,
+                  REST_MEM_OTHER
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
     dwError = VmRESTAllocateMemory(
                   sizeof(REST_ENG_GLOBALS),
-                  (void **)&pInstanceGlobal
+                  (void **)&pInstanceGlobal,
+                  REST_MEM_OTHER
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -313,7 +322,8 @@ VmRESTAllocateHandle(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(VM_REST_CONFIG),
-                  (void**)&pRESTConfig
+                  (void**)&pRESTConfig,
+                  REST_MEM_OTHER
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -321,7 +331,8 @@ VmRESTAllocateHandle(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(VMREST_SOCK_CONTEXT),
-                  (PVOID*)&pSockContext
+                  (PVOID*)&pSockContext,
+                  REST_MEM_OTHER
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -329,7 +340,8 @@ VmRESTAllocateHandle(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(VM_SOCK_PACKAGE),
-                  (void **)&pPackage
+                  (void **)&pPackage,
+                  REST_MEM_OTHER
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -337,12 +349,19 @@ VmRESTAllocateHandle(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(VM_SOCK_SSL_INFO),
-                  (void **)&pSSLInfo
+                  (void **)&pSSLInfo,
+                  REST_MEM_TLS
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
     pRESTHandle->pSSLInfo = pSSLInfo;
 
+    dwError = VmRESTAllocateNamedMutex(
+                  &pSSLInfo->pCtxMutex,
+                  "ssl_context"
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
     pRESTHandle->pHttpHandler = NULL;
 
     pRESTHandle->instanceState = VMREST_INSTANCE_UNINITIALIZED;
@@ -363,6 +382,31 @@ error:
     goto cleanup;
 }
 
+void
+VmRESTFreeSSLBuffers(
+     PVM_SOCK_SSL_INFO               pSSLInfo
+     )
+{
+    if (pSSLInfo)
+    {
+        /**** Key material must not linger in freed heap ****/
+        if (pSSLInfo->pszKeyBuf)
+        {
+            OPENSSL_cleanse(pSSLInfo->pszKeyBuf, pSSLInfo->nKeyBufLen);
+            VmRESTFreeMemory(pSSLInfo->pszKeyBuf, REST_MEM_TLS);
+            pSSLInfo->pszKeyBuf = NULL;
+            pSSLInfo->nKeyBufLen = 0;
+        }
+
+        if (pSSLInfo->pszCertBuf)
+        {
+            VmRESTFreeMemory(pSSLInfo->pszCertBuf, REST_MEM_TLS);
+            pSSLInfo->pszCertBuf = NULL;
+            pSSLInfo->nCertBufLen = 0;
+        }
+    }
+}
+
 void
 VmRESTFreeHandle(
      PVMREST_HANDLE                  pRESTHandle
@@ -370,37 +414,62 @@ VmRESTFreeHandle(
 {
     if (pRESTHandle)
     {
+        /**** Writes out what is queued, before config and debug log go ****/
+        if (pRESTHandle->pAccessLog)
+        {
+            VmRESTFreeAccessLog(pRESTHandle->pAccessLog);
+            pRESTHandle->pAccessLog = NULL;
+        }
+
         if (pRESTHandle->pInstanceGlobal)
         {
-            VmRESTFreeMemory(pRESTHandle->pInstanceGlobal);
+            VmRESTFreeMemory(pRESTHandle->pInstanceGlobal, REST_MEM_OTHER);
             pRESTHandle->pInstanceGlobal = NULL;
         }
 
         if (pRESTHandle->pRESTConfig)
         {
-             VmRESTFreeMemory(pRESTHandle->pRESTConfig);
+             VmRESTFreeMemory(pRESTHandle->pRESTConfig, REST_MEM_OTHER);
              pRESTHandle->pRESTConfig = NULL;
         }
 
         if (pRESTHandle->pSockContext)
         {
-            VmRESTFreeMemory(pRESTHandle->pSockContext);
+            VmRESTFreeMemory(pRESTHandle->pSockContext, REST_MEM_OTHER);
             pRESTHandle->pSockContext = NULL;
         }
 
+        if (pRESTHandle->pIOBufPool)
+        {
+            VmRESTFreeIOBufferPool(pRESTHandle->pIOBufPool);
+            pRESTHandle->pIOBufPool = NULL;
+        }
+
+        if (pRESTHandle->pMetrics)
+        {
+            VmRESTFreeMetrics(pRESTHandle->pMetrics);
+            pRESTHandle->pMetrics = NULL;
+        }
+
         if (pRESTHandle->pPackage)
         {
-            VmRESTFreeMemory(pRESTHandle->pPackage);
+            VmRESTFreeMemory(pRESTHandle->pPackage, REST_MEM_OTHER);
             pRESTHandle->pPackage = NULL;
         }
 
         if (pRESTHandle->pSSLInfo)
         {
-            VmRESTFreeMemory(pRESTHandle->pSSLInfo);
+            VmRESTFreeSSLBuffers(pRESTHandle->pSSLInfo);
+            if (pRESTHandle->pSSLInfo->pCtxMutex)
+            {
+                VmRESTFreeMutex(pRESTHandle->pSSLInfo->pCtxMutex);
+                pRESTHandle->pSSLInfo->pCtxMutex = NULL;
+            }
+            VmRESTFreeMemory(pRESTHandle->pSSLInfo, REST_MEM_TLS);
             pRESTHandle->pSSLInfo = NULL;
         }
 
-        VmRESTFreeMemory(pRESTHandle);
+        VmRESTFreeMemory(pRESTHandle, REST_MEM_OTHER);
     }
 }
 
@@ -416,7 +485,8 @@ VmRESTAllocateRequestLine(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(VM_REST_HTTP_REQUEST_LINE),
-                  (void**)&pReqLine
+                  (void**)&pReqLine,
+                  REST_MEM_REQUEST
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -436,7 +506,7 @@ VmRESTFreeRequestLine(
 {
     if (pReqLine)
     {
-        VmRESTFreeMemory(pReqLine);
+        VmRESTFreeMemory(pReqLine, REST_MEM_REQUEST);
     }
 }
 
@@ -451,7 +521,8 @@ VmRESTAllocateStatusLine(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(VM_REST_HTTP_STATUS_LINE),
-                  (void**)&pStatusLine
+                  (void**)&pStatusLine,
+                  REST_MEM_RESPONSE
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -471,7 +542,9 @@ VmRESTFreeStatusLine(
 {
     if (pStatusLine)
     {
-        VmRESTFreeMemory(pStatusLine
+        VmRESTFreeMemory(
+            pStatusLine,
+            REST_MEM_RESPONSE
             );
     }
 }
@@ -486,7 +559,8 @@ VmRESTAllocateMessageBody(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(VM_REST_HTTP_MESSAGE_BODY),
-                  (void**)&pMsgBody
+                  (void**)&pMsgBody,
+                  REST_MEM_PAYLOAD
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -506,7 +580,9 @@ VmRESTFreeMessageBody(
 {
     if (pMsgBody)
     {
-        VmRESTFreeMemory(pMsgBody
+        VmRESTFreeMemory(
+            pMsgBody,
+            REST_MEM_PAYLOAD
             );
     }
 }
@@ -522,7 +598,8 @@ VmRESTAllocateMiscQueue(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(MISC_HEADER_QUEUE),
-                  (void**)&pMiscQueue
+                  (void**)&pMiscQueue,
+                  REST_MEM_HEADER
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -547,7 +624,9 @@ VmRESTFreeMiscQueue(
         VmRESTRemoveAllHTTPMiscHeader(
             pMiscHeaderQueue
             );
-        VmRESTFreeMemory(pMiscHeaderQueue
+        VmRESTFreeMemory(
+            pMiscHeaderQueue,
+            REST_MEM_HEADER
             );
     }
 }
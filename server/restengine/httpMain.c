@@ -40,14 +40,55 @@ VmHTTPInit(
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
+    /**** Before transport so its locks are measured from first use ****/
+    if (pRESTHandle->pRESTConfig->enableLockProfiling)
+    {
+        VmRESTLockProfilingEnable();
+    }
+
+    if (pRESTHandle->pRESTConfig->enableMemoryDebug)
+    {
+        VmRESTMemoryDebugEnable();
+    }
+
     /**** Init logging and transport ****/
     dwError = VmRESTInitProtocolServer(
                   pRESTHandle
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
+    /**** I/O buffers for response serialization, one slot per engine thread ****/
+    dwError = VmRESTCreateIOBufferPool(
+                  (pRESTHandle->pRESTConfig->nWorkerThr +
+                   pRESTHandle->pRESTConfig->nHandshakeThr +
+                   VMREST_IOBUF_SPARE_SLOTS),
+                  pRESTHandle->pRESTConfig->useHugePages,
+                  &pRESTHandle->pIOBufPool
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTCreateMetrics(
+                  &pRESTHandle->pMetrics
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if (!IsNullOrEmptyString(pRESTHandle->pRESTConfig->pszAccessLogFile))
+    {
+        dwError = VmRESTCreateAccessLog(
+                      pRESTHandle,
+                      &pRESTHandle->pAccessLog
+                      );
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
     pRESTHandle->debugLogLevel = pRESTHandle->pRESTConfig->debugLogLevel;
 
+    /**** Any trace filter lets tagged requests log at DEBUG whatever the handle level ****/
+    pRESTHandle->bTraceEnabled = (pRESTHandle->pRESTConfig->traceSampleRate ||
+                                  !IsNullOrEmptyString(pRESTHandle->pRESTConfig->pszTraceClientIP) ||
+                                  !IsNullOrEmptyString(pRESTHandle->pRESTConfig->pszTraceRoute) ||
+                                  !IsNullOrEmptyString(pRESTHandle->pRESTConfig->pszTraceHeader));
+
     /**** Update context Info for this lib instance ****/
     pRESTHandle->pInstanceGlobal->useEndPoint = 0;
 
@@ -62,6 +103,55 @@ error:
     goto cleanup;
 }
 
+/**** Host handle of an engine group never listens nor does TLS, it only runs queue and workers ****/
+uint32_t
+VmHTTPInitEngineGroup(
+    PVMREST_HANDLE                   pRESTHandle,
+    uint32_t                         nWorkerThr
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    long                             nCpu = 0;
+
+    if (!pRESTHandle || !pRESTHandle->pRESTConfig)
+    {
+        dwError = REST_ERROR_INVALID_CONFIG;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if (nWorkerThr == 0)
+    {
+        nCpu = sysconf(_SC_NPROCESSORS_ONLN);
+        nWorkerThr = (nCpu > 0) ? (uint32_t)nCpu : VMREST_DEFAULT_WORKER_THR_COUNT;
+    }
+    if (nWorkerThr > VMREST_MAX_WORKER_THR_COUNT)
+    {
+        nWorkerThr = VMREST_MAX_WORKER_THR_COUNT;
+    }
+
+    pRESTHandle->pRESTConfig->nWorkerThr = nWorkerThr;
+    pRESTHandle->pRESTConfig->connTimeoutSec = VMREST_DEFAULT_CONN_TIMEOUT_SEC;
+    pRESTHandle->pRESTConfig->debugLogLevel = VMREST_LOG_LEVEL_ERROR;
+    pRESTHandle->pSSLInfo->isKeySet = SSL_INFO_NO_SSL_PLAIN;
+    pRESTHandle->pSSLInfo->isCertSet = SSL_INFO_NO_SSL_PLAIN;
+
+    dwError = VmRESTInitProtocolServer(
+                  pRESTHandle
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pRESTHandle->debugLogLevel = pRESTHandle->pRESTConfig->debugLogLevel;
+    pRESTHandle->pInstanceGlobal->useEndPoint = 0;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
 uint32_t
 VmHTTPStart(
     PVMREST_HANDLE                   pRESTHandle
@@ -74,6 +164,15 @@ VmHTTPStart(
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
+    /**** Listeners are up by now, stats segment is only a view and does not fail start ****/
+    if (pRESTHandle->pRESTConfig->statsShmIntervalMs && !pRESTHandle->pStatsShm)
+    {
+        if (VmRESTCreateStatsPublisher(pRESTHandle, &pRESTHandle->pStatsShm) != REST_ENGINE_SUCCESS)
+        {
+            VMREST_LOG_WARNING(pRESTHandle,"%s","C-REST-ENGINE: Stats segment not published");
+        }
+    }
+
     VMREST_LOG_INFO(pRESTHandle,"%s","C-REST_ENGINE: Library started ...");
 
 cleanup:
@@ -135,6 +234,13 @@ VmHTTPStop(
 
     VMREST_LOG_INFO(pRESTHandle,"%s","C-REST_ENGINE: Stopping library ... No more requests will be accepted");
 
+    /**** Publisher reads connection table, which goes away with protocol server ****/
+    if (pRESTHandle->pStatsShm)
+    {
+        VmRESTFreeStatsPublisher(pRESTHandle->pStatsShm);
+        pRESTHandle->pStatsShm = NULL;
+    }
+
     dwError = VmRESTStopProtocolServer(
                   pRESTHandle, 
                   waitSecond
@@ -158,6 +264,13 @@ VmHTTPShutdown(
     )
 {
     VMREST_LOG_INFO(pRESTHandle,"%s","C-REST-ENGINE: Shutting down Library");
+
+    if (pRESTHandle && pRESTHandle->pStatsShm)
+    {
+        VmRESTFreeStatsPublisher(pRESTHandle->pStatsShm);
+        pRESTHandle->pStatsShm = NULL;
+    }
+
     VmRESTShutdownProtocolServer(
         pRESTHandle
         );
@@ -167,3 +280,76 @@ VmHTTPShutdown(
         VmRESTFreeHandle(pRESTHandle);        
     }
 }
+
+uint32_t
+VmHTTPGetStats(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_STATS                      pStats
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    PREST_CONNECTION_INFO            pInfo = NULL;
+    uint32_t                         nCount = 0;
+    uint32_t                         idx = 0;
+
+    VmRESTMetricsGetStats(
+        pRESTHandle->pMetrics,
+        pStats
+        );
+
+    if (pRESTHandle->instanceState != VMREST_INSTANCE_STARTED)
+    {
+        goto cleanup;
+    }
+
+    /**** Connection gauges come from connection table, room for a few opened meanwhile ****/
+    dwError = VmwSockGetConnections(
+                  pRESTHandle,
+                  NULL,
+                  0,
+                  &nCount
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    nCount += VMREST_STATS_SPARE_CONNECTIONS;
+
+    dwError = VmRESTAllocateMemory(
+                  nCount * sizeof(REST_CONNECTION_INFO),
+                  (PVOID*)&pInfo,
+                  REST_MEM_OTHER
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmwSockGetConnections(
+                  pRESTHandle,
+                  pInfo,
+                  nCount,
+                  &nCount
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    for (idx = 0; idx < nCount; idx++)
+    {
+        if (pInfo[idx].phase == VMREST_CONN_PHASE_IDLE)
+        {
+            pStats->nIdleConnections++;
+        }
+        else
+        {
+            pStats->nActiveConnections++;
+        }
+    }
+
+cleanup:
+
+    if (pInfo)
+    {
+        VmRESTFreeMemory(pInfo, REST_MEM_OTHER);
+    }
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
@@ -139,13 +139,13 @@ cleanup:
 
     if (pszContentLen != NULL)
     {
-        VmRESTFreeMemory(pszContentLen);
+        VmRESTFreeMemory(pszContentLen, REST_MEM_APP);
         pszContentLen = NULL;
     }
 
     if (pszTransferEncoding != NULL)
     {
-        VmRESTFreeMemory(pszTransferEncoding);
+        VmRESTFreeMemory(pszTransferEncoding, REST_MEM_APP);
         pszTransferEncoding = NULL;
     }
 
@@ -258,17 +258,17 @@ cleanup:
 
     if (pszExpect)
     {
-        VmRESTFreeMemory(pszExpect);
+        VmRESTFreeMemory(pszExpect, REST_MEM_APP);
         pszExpect = NULL;
     }
     if (pszHttpURI)
     {
-        VmRESTFreeMemory(pszHttpURI);
+        VmRESTFreeMemory(pszHttpURI, REST_MEM_APP);
         pszHttpURI = NULL;
     }
     if (pszEndPointURI)
     {
-        VmRESTFreeMemory(pszEndPointURI);
+        VmRESTFreeMemory(pszEndPointURI, REST_MEM_APP);
         pszEndPointURI = NULL;
     }
 
@@ -281,7 +281,7 @@ cleanup:
     return dwError;
 
 error:
-    VMREST_LOG_ERROR(pRESTHandle,"Error in processing 100-Continue header, error code %u", dwError);
+    VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"Error in processing 100-Continue header, error code %u", dwError);
     goto cleanup;
 
 
@@ -512,6 +512,30 @@ error:
     goto cleanup;
 }
 
+/**** Writes block until data is with kernel, so a write returning is bytes written ****/
+static
+void
+VmRESTTimingsOnWrite(
+    PVM_REST_HTTP_RESPONSE_PACKET    pResPacket,
+    uint32_t                         nBytes
+    )
+{
+    PVM_REST_HTTP_REQUEST_PACKET     pRequest = pResPacket->requestPacket;
+
+    if (!pRequest)
+    {
+        return;
+    }
+
+    pRequest->nBytesOut += nBytes;
+    pRequest->timings.phaseNs[REST_PHASE_LAST_BYTE_WRITTEN] = VmRESTMetricsNowNs();
+    if (!pRequest->timings.phaseNs[REST_PHASE_FIRST_BYTE_WRITTEN])
+    {
+        pRequest->timings.phaseNs[REST_PHASE_FIRST_BYTE_WRITTEN] =
+            pRequest->timings.phaseNs[REST_PHASE_LAST_BYTE_WRITTEN];
+    }
+}
+
 uint32_t
 VmRESTSendHeader(
     PVMREST_HANDLE                   pRESTHandle,
@@ -526,7 +550,7 @@ VmRESTSendHeader(
     uint32_t                         size = 0;
     PVM_REST_HTTP_RESPONSE_PACKET    pResPacket = NULL;
 
-    if (!ppResPacket  || (*ppResPacket == NULL))
+    if (!pRESTHandle || !ppResPacket  || (*ppResPacket == NULL))
     {
         VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
         dwError = VMREST_HTTP_INVALID_PARAMS;
@@ -541,7 +565,8 @@ VmRESTSendHeader(
     BAIL_ON_VMREST_ERROR(dwError);
 
     /**** Allocate buffer to hold stream data *****/
-    dwError = VmRESTAllocateMemory(
+    dwError = VmRESTGetIOBuffer(
+                  pRESTHandle->pIOBufPool,
                   size,
                   (void**)&buffer
                   );
@@ -583,7 +608,11 @@ VmRESTSendHeader(
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
-    VmRESTFreeMemory(
+    VmRESTTimingsOnWrite(pResPacket, totalBytes);
+    pResPacket->bHeaderSent = TRUE;
+
+    VmRESTReleaseIOBuffer(
+        pRESTHandle->pIOBufPool,
         buffer
         );
     buffer = NULL;
@@ -593,7 +622,8 @@ cleanup:
 error:
     if (buffer)
     {
-        VmRESTFreeMemory(
+        VmRESTReleaseIOBuffer(
+            pRESTHandle->pIOBufPool,
             buffer
             );
         buffer = NULL;
@@ -616,14 +646,15 @@ VmRESTSendChunkedPayload(
     char*                            curr = NULL;
     PVM_REST_HTTP_RESPONSE_PACKET    pResPacket = NULL;
 
-    if (!ppResPacket  || (*ppResPacket == NULL))
+    if (!pRESTHandle || !ppResPacket  || (*ppResPacket == NULL))
     {
         VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
         dwError = VMREST_HTTP_INVALID_PARAMS;
     }
     BAIL_ON_VMREST_ERROR(dwError);
 
-    dwError = VmRESTAllocateMemory(
+    dwError = VmRESTGetIOBuffer(
+                  pRESTHandle->pIOBufPool,
                   (MAX_DATA_BUFFER_LEN + MAX_EXTRA_CRLF_BUF_SIZE),
                   (void**)&buffer
                   );
@@ -655,7 +686,10 @@ VmRESTSendChunkedPayload(
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
-    VmRESTFreeMemory(
+    VmRESTTimingsOnWrite(pResPacket, totalBytes);
+
+    VmRESTReleaseIOBuffer(
+        pRESTHandle->pIOBufPool,
         buffer
         );
     buffer = NULL;
@@ -665,7 +699,8 @@ cleanup:
 error:
     if (buffer)
     {
-        VmRESTFreeMemory(
+        VmRESTReleaseIOBuffer(
+            pRESTHandle->pIOBufPool,
             buffer
             );
         buffer = NULL;
@@ -688,7 +723,7 @@ VmRESTSendHeaderAndPayload(
     uint32_t                         size = 0;
     PVM_REST_HTTP_RESPONSE_PACKET    pResPacket = NULL;
 
-    if (!ppResPacket || (*ppResPacket == NULL))
+    if (!pRESTHandle || !ppResPacket || (*ppResPacket == NULL))
     {
         VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
         dwError = VMREST_HTTP_INVALID_PARAMS;
@@ -707,7 +742,8 @@ VmRESTSendHeaderAndPayload(
     size += MAX_DATA_BUFFER_LEN;
     size += 10;
 
-    dwError = VmRESTAllocateMemory(
+    dwError = VmRESTGetIOBuffer(
+                  pRESTHandle->pIOBufPool,
                   size,
                   (void**)&buffer
                   );
@@ -764,7 +800,10 @@ VmRESTSendHeaderAndPayload(
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
-    VmRESTFreeMemory(
+    VmRESTTimingsOnWrite(pResPacket, totalBytes);
+
+    VmRESTReleaseIOBuffer(
+        pRESTHandle->pIOBufPool,
         buffer
         );
     buffer = NULL;
@@ -774,7 +813,8 @@ cleanup:
 error:
     if (buffer)
     {
-        VmRESTFreeMemory(
+        VmRESTReleaseIOBuffer(
+            pRESTHandle->pIOBufPool,
             buffer
             );
         buffer = NULL;
@@ -783,6 +823,106 @@ error:
     goto cleanup;
 }
 
+/**** Per thread count towards next sampled request, avoids a shared counter on every request ****/
+static __thread uint32_t             gTraceSampleCount = 0;
+static __thread uint32_t             gCpuSampleCount = 0;
+
+/**** Charges thread CPU since last switch to phase which was running and starts
+      given one, REST_CPU_PHASE_COUNT stops. Returns phase which was running so
+      a nested caller can switch back. No clock read for requests not sampled ****/
+REST_CPU_PHASE
+VmRESTCpuSwitch(
+    PVM_REST_HTTP_REQUEST_PACKET     pRequest,
+    REST_CPU_PHASE                   phase
+    )
+{
+    PVMREST_REQUEST_CPU              pCpu = NULL;
+    REST_CPU_PHASE                   prevPhase = REST_CPU_PHASE_COUNT;
+    uint64_t                         nowNs = 0;
+
+    if (!pRequest || !pRequest->cpu.bSampled)
+    {
+        return REST_CPU_PHASE_COUNT;
+    }
+
+    pCpu = &pRequest->cpu;
+    prevPhase = pCpu->phase;
+
+    if ((prevPhase == REST_CPU_PHASE_COUNT) && (phase == REST_CPU_PHASE_COUNT))
+    {
+        return prevPhase;
+    }
+
+    nowNs = VmRESTMetricsThreadCpuNs();
+
+    if ((prevPhase < REST_CPU_PHASE_COUNT) && (nowNs > pCpu->lastNs))
+    {
+        pCpu->cpuNs[prevPhase] += nowNs - pCpu->lastNs;
+    }
+
+    pCpu->phase = phase;
+    pCpu->lastNs = nowNs;
+
+    return prevPhase;
+}
+
+/**** New request is matched on sample rate and client address, once headers are
+      in it is matched on route prefix and header. First match assigns trace id
+      and tags this thread's log lines with it. ****/
+void
+VmRESTTraceSelectRequest(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_REST_HTTP_REQUEST_PACKET     pRequest,
+    BOOLEAN                          bNewRequest
+    )
+{
+    PVM_REST_CONFIG                  pConfig = pRESTHandle->pRESTConfig;
+    BOOLEAN                          bTrace = FALSE;
+    char*                            pszValue = NULL;
+
+    if (pRequest->traceId)
+    {
+        return;
+    }
+
+    if (bNewRequest)
+    {
+        if (pConfig->traceSampleRate && (++gTraceSampleCount >= pConfig->traceSampleRate))
+        {
+            gTraceSampleCount = 0;
+            bTrace = TRUE;
+        }
+
+        if (!IsNullOrEmptyString(pConfig->pszTraceClientIP) &&
+            (strcmp(pRequest->clientIP, pConfig->pszTraceClientIP) == 0))
+        {
+            bTrace = TRUE;
+        }
+    }
+    else
+    {
+        if (!IsNullOrEmptyString(pConfig->pszTraceRoute) &&
+            (strncmp(pRequest->requestLine->uri, pConfig->pszTraceRoute, strlen(pConfig->pszTraceRoute)) == 0))
+        {
+            bTrace = TRUE;
+        }
+
+        if (!IsNullOrEmptyString(pConfig->pszTraceHeader) &&
+            (VmRESTGetHTTPMiscHeader(pRequest->miscHeader, pConfig->pszTraceHeader, &pszValue) == REST_ENGINE_SUCCESS) &&
+            pszValue)
+        {
+            bTrace = TRUE;
+        }
+    }
+
+    if (bTrace)
+    {
+        pRequest->traceId = __atomic_add_fetch(&pRESTHandle->nextTraceId, 1, __ATOMIC_RELAXED);
+        gVmRESTLogTraceId = pRequest->traceId;
+        VMREST_LOG_DEBUG(pRESTHandle,"Tracing request from %s:%d", pRequest->clientIP, pRequest->clientPort);
+    }
+}
+
 uint32_t
 VmRESTGetRequestHandle(
     PVMREST_HANDLE                   pRESTHandle,
@@ -819,6 +959,10 @@ VmRESTGetRequestHandle(
     pRequest->pszPayload = NULL;
     pRequest->nBytesGetPayload = 0;
     pRequest->payloadType = HTTP_PAYLOAD_TYPE_INVALID;
+    pRequest->metricsRouteId = 0;
+    pRequest->nBytesIn = 0;
+    pRequest->nBytesOut = 0;
+    memset(&pRequest->timings, 0, sizeof(REST_REQUEST_TIMINGS));
     
     pResponse->miscHeader->head = NULL;
     pResponse->bHeaderSent = FALSE;
@@ -840,6 +984,53 @@ VmRESTGetRequestHandle(
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
+    /**** Kernel vouches for peer of a unix domain socket, keep it for authorization ****/
+    pRequest->clientPid = -1;
+
+    if (strcmp(pRequest->clientIP, VMREST_UNIX_PEER_ADDRESS) == 0)
+    {
+        dwError = VmRESTCommonGetPeerCredentials(
+                      pRESTHandle,
+                      pSocket,
+                      &(pRequest->clientPid),
+                      &(pRequest->clientUid),
+                      &(pRequest->clientGid)
+                      );
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
+    dwError = VmRESTCommonGetConnectionState(
+                  pRESTHandle,
+                  pSocket,
+                  &(pRequest->timings.phaseNs[REST_PHASE_ACCEPT]),
+                  &(pRequest->timings.phaseNs[REST_PHASE_TLS_DONE]),
+                  &(pRequest->nConnRequests)
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Sampling and client filter need only peer info, decide now so whole request is traced ****/
+    pRequest->traceId = 0;
+
+    if (pRESTHandle->bTraceEnabled)
+    {
+        VmRESTTraceSelectRequest(
+            pRESTHandle,
+            pRequest,
+            TRUE
+            );
+    }
+
+    /**** CPU clock is a system call, only one in cpuSampleRate requests of a thread reads it ****/
+    memset(&pRequest->cpu, 0, sizeof(VMREST_REQUEST_CPU));
+    pRequest->cpu.phase = REST_CPU_PHASE_COUNT;
+
+    if (pRESTHandle->pRESTConfig->cpuSampleRate &&
+        (++gCpuSampleCount >= pRESTHandle->pRESTConfig->cpuSampleRate))
+    {
+        gCpuSampleCount = 0;
+        pRequest->cpu.bSampled = TRUE;
+    }
+
     *ppRequest = pRequest;
 
 cleanup:
@@ -868,18 +1059,137 @@ error:
 
 }
 
+/**** Phases as offsets from first byte read, traced requests only ****/
+static
+void
+VmRESTLogTimings(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_REQUEST_TIMINGS            pTimings
+    )
+{
+    uint64_t                         baseNs = pTimings->phaseNs[REST_PHASE_FIRST_BYTE_READ];
+    uint64_t                         offsetUs[REST_PHASE_COUNT] = {0};
+    uint32_t                         idx = 0;
+
+    for (idx = REST_PHASE_REQUEST_LINE; idx < REST_PHASE_COUNT; idx++)
+    {
+        if (baseNs && (pTimings->phaseNs[idx] >= baseNs))
+        {
+            offsetUs[idx] = (pTimings->phaseNs[idx] - baseNs) / 1000;
+        }
+    }
+
+    VMREST_LOG_DEBUG(
+        pRESTHandle,
+        "Request timings us: request line %llu headers %llu body %llu handler %llu-%llu written %llu-%llu",
+        (unsigned long long)offsetUs[REST_PHASE_REQUEST_LINE],
+        (unsigned long long)offsetUs[REST_PHASE_HEADERS_DONE],
+        (unsigned long long)offsetUs[REST_PHASE_BODY_DONE],
+        (unsigned long long)offsetUs[REST_PHASE_HANDLER_START],
+        (unsigned long long)offsetUs[REST_PHASE_HANDLER_END],
+        (unsigned long long)offsetUs[REST_PHASE_FIRST_BYTE_WRITTEN],
+        (unsigned long long)offsetUs[REST_PHASE_LAST_BYTE_WRITTEN]
+        );
+}
+
+/**** Record of a request which got a response ****/
+static
+void
+VmRESTLogAccess(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_REQUEST                    pRequest,
+    uint32_t                         statusCode
+    )
+{
+    VMREST_ACCESS_LOG_ENTRY          entry = {0};
+
+    entry.pszClientIP = pRequest->clientIP;
+    entry.clientPort = pRequest->clientPort;
+    entry.pszMethod = pRequest->requestLine->method;
+    entry.pszRoute = VmRESTMetricsGetRouteName(pRESTHandle->pMetrics, pRequest->metricsRouteId);
+    entry.statusCode = statusCode;
+    entry.nBytesIn = pRequest->nBytesIn;
+    entry.nBytesOut = pRequest->nBytesOut;
+    entry.nConnRequests = pRequest->nConnRequests;
+    entry.pTimings = &pRequest->timings;
+
+    VmRESTAccessLogWrite(
+        pRESTHandle->pAccessLog,
+        &entry
+        );
+}
+
 void
 VmRESTFreeRequestHandle(
     PVMREST_HANDLE                   pRESTHandle,
     PREST_REQUEST                    pRequest
     )
 {
+    PREST_REQUEST_TIMINGS            pTimings = NULL;
+    uint64_t                         latencyNs = 0;
+    uint32_t                         statusCode = 0;
+
     if (!pRESTHandle || !pRequest)
     {
         VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
         return;
     }
 
+    /**** Only requests which got a response count, aborted ones have no status ****/
+    if (pRequest->pResponse && pRequest->pResponse->bHeaderSent)
+    {
+        pTimings = &pRequest->timings;
+        if (pTimings->phaseNs[REST_PHASE_FIRST_BYTE_READ] &&
+            (pTimings->phaseNs[REST_PHASE_LAST_BYTE_WRITTEN] > pTimings->phaseNs[REST_PHASE_FIRST_BYTE_READ]))
+        {
+            latencyNs = pTimings->phaseNs[REST_PHASE_LAST_BYTE_WRITTEN] - pTimings->phaseNs[REST_PHASE_FIRST_BYTE_READ];
+        }
+
+        statusCode = (uint32_t)atoi(pRequest->pResponse->statusLine->statusCode);
+
+        VmRESTMetricsRecordRequest(
+            pRESTHandle->pMetrics,
+            pRequest->metricsRouteId,
+            pRequest->requestLine->method,
+            statusCode,
+            latencyNs / 1000
+            );
+
+        VmRESTMetricsRecordTimings(
+            pRESTHandle->pMetrics,
+            pTimings
+            );
+
+        if (pRequest->cpu.bSampled)
+        {
+            VmRESTCpuSwitch(pRequest, REST_CPU_PHASE_COUNT);
+
+            VmRESTMetricsRecordCpu(
+                pRESTHandle->pMetrics,
+                pRequest->metricsRouteId,
+                pRequest->requestLine->method,
+                pRequest->cpu.cpuNs
+                );
+        }
+
+        if (pRequest->traceId)
+        {
+            VmRESTLogTimings(
+                pRESTHandle,
+                pTimings
+                );
+        }
+
+        if (pRESTHandle->pAccessLog)
+        {
+            VmRESTLogAccess(
+                pRESTHandle,
+                pRequest,
+                statusCode
+                );
+        }
+    }
+
     if (pRequest->pResponse)
     {
         VmRESTFreeHTTPResponsePacket(
@@ -937,7 +1247,7 @@ VmRESTProcessRequestLine(
 
                 if(!VmRESTIsValidHTTPMethod(pRequest->requestLine->method))
                 {
-                    VMREST_LOG_ERROR(pRESTHandle,"%s","Bad HTTP method in request");
+                    VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"%s","Bad HTTP method in request");
                     dwError = METHOD_NOT_ALLOWED;
                 }
                 BAIL_ON_VMREST_ERROR(dwError);
@@ -958,32 +1268,32 @@ VmRESTProcessRequestLine(
 
                         if(!VmRESTIsValidHTTPVesion(pRequest->requestLine->version))
                         {
-                            VMREST_LOG_ERROR(pRESTHandle,"%s","Validation failed for HTTP version");
+                            VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"%s","Validation failed for HTTP version");
                             dwError = HTTP_VERSION_NOT_SUPPORTED;
                         }
                     }
                     else
                     {
-                        VMREST_LOG_ERROR(pRESTHandle,"Bad HTTP Version in request, length %u", (pszEndNewLine - pszSecondSpace));
+                        VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"Bad HTTP Version in request, length %u", (pszEndNewLine - pszSecondSpace));
                         dwError = HTTP_VERSION_NOT_SUPPORTED;
                     }
                 }
                 else
                 {
-                    VMREST_LOG_ERROR(pRESTHandle,"%s","Either Too large URI or URI not present");
+                    VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"%s","Either Too large URI or URI not present");
                     dwError =  REQUEST_URI_TOO_LARGE;
                 }
             }
             else
             {
-                 VMREST_LOG_ERROR(pRESTHandle,"%s","Either too large HTTP method or method not present");
+                 VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"%s","Either too large HTTP method or method not present");
                  dwError = METHOD_NOT_ALLOWED;
             }
         }
         else
         {
             dwError = BAD_REQUEST;
-            VMREST_LOG_ERROR(pRESTHandle,"%s","Request Line too large.");
+            VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"%s","Request Line too large.");
         }
         BAIL_ON_VMREST_ERROR(dwError);
 
@@ -1074,7 +1384,7 @@ VmRESTProcessHeaders(
         }
         if (nLineLen > MAX_REQ_LIN_LEN)
         {
-             VMREST_LOG_ERROR(pRESTHandle,"Header line too large, length %u", nLineLen);
+             VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"Header line too large, length %u", nLineLen);
              dwError = BAD_REQUEST;
         }
         BAIL_ON_VMREST_ERROR(dwError);
@@ -1091,7 +1401,7 @@ VmRESTProcessHeaders(
             }
             else
             {
-                VMREST_LOG_ERROR(pRESTHandle,"Header name empty or too large, AttLen %u, nLineLen %u", nAttrLen, nLineLen);
+                VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"Header name empty or too large, AttLen %u, nLineLen %u", nAttrLen, nLineLen);
                 dwError = BAD_REQUEST;
                 BAIL_ON_VMREST_ERROR(dwError);
             }
@@ -1105,7 +1415,7 @@ VmRESTProcessHeaders(
             }
             else
             {
-                VMREST_LOG_ERROR(pRESTHandle,"%s","Header value empty or too large");
+                VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"%s","Header value empty or too large");
                 dwError = BAD_REQUEST;
             }
             BAIL_ON_VMREST_ERROR(dwError);
@@ -1122,7 +1432,7 @@ VmRESTProcessHeaders(
         }
         else  /**** pszColonSeparator = NULL ****/
         {
-            VMREST_LOG_ERROR(pRESTHandle,"%s", "No Header separator(:) found in request line");
+            VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"%s", "No Header separator(:) found in request line");
             dwError = BAD_REQUEST;
             BAIL_ON_VMREST_ERROR(dwError);
         }
@@ -1147,7 +1457,7 @@ error:
     {
         *nProcessed = 0;
     }
-    VMREST_LOG_ERROR(pRESTHandle,"Failed while processing headers... dwError %u", dwError);
+    VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"Failed while processing headers... dwError %u", dwError);
     goto cleanup;
 
 }
@@ -1182,9 +1492,11 @@ VmRESTProcessPayload(
         /**** As size of payload is already know, allocate the memory just once ****/
         if ((pRequest->pszPayload ==  NULL) && (pRequest->dataRemaining > 0))
         {
-            dwError = VmRESTAllocateMemory(
+            /**** Filled completely by payload bytes read from socket ****/
+            dwError = VmRESTAllocateMemoryNoZero(
                           pRequest->dataRemaining,
-                          (void **)&pRequest->pszPayload
+                          (void **)&pRequest->pszPayload,
+                          REST_MEM_PAYLOAD
                           );
             BAIL_ON_VMREST_ERROR(dwError);
         }
@@ -1225,7 +1537,8 @@ VmRESTProcessPayload(
                     dwError = VmRESTReallocateMemory(
                                   (void *)pRequest->pszPayload,
                                   (void **)&pRequest->pszPayload,
-                                  (pRequest->nPayload + nChunkLen)
+                                  (pRequest->nPayload + nChunkLen),
+                                  REST_MEM_PAYLOAD
                                   );
                     BAIL_ON_VMREST_ERROR(dwError);
                     nCRLF = HTTP_CRLF_LEN;
@@ -1259,13 +1572,40 @@ error:
     }
     else
     {
-        VMREST_LOG_ERROR(pRESTHandle,"Failed while processing payload ... dwError %u", dwError);
+        VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"Failed while processing payload ... dwError %u", dwError);
     }
     goto cleanup;
 
 }
 
 
+/**** Phase reached when request moves to a processing state ****/
+static
+void
+VmRESTTimingsOnStateChange(
+    PVM_REST_HTTP_REQUEST_PACKET     pRequest,
+    VM_REST_PROCESSING_STATE         state
+    )
+{
+    switch (state)
+    {
+        case PROCESS_REQUEST_HEADERS:
+             pRequest->timings.phaseNs[REST_PHASE_REQUEST_LINE] = VmRESTMetricsNowNs();
+             break;
+
+        case PROCESS_REQUEST_PAYLOAD:
+             pRequest->timings.phaseNs[REST_PHASE_HEADERS_DONE] = VmRESTMetricsNowNs();
+             break;
+
+        case PROCESS_APPLICATION_CALLBACK:
+             pRequest->timings.phaseNs[REST_PHASE_BODY_DONE] = VmRESTMetricsNowNs();
+             break;
+
+        default:
+             break;
+    }
+}
+
 uint32_t
 VmRESTProcessBuffer(
     PVMREST_HANDLE                   pRESTHandle,
@@ -1293,6 +1633,13 @@ VmRESTProcessBuffer(
     currState = pRequest->state;
     *nBytesProcessed = 0;
 
+    if (!pRequest->timings.phaseNs[REST_PHASE_FIRST_BYTE_READ])
+    {
+        pRequest->timings.phaseNs[REST_PHASE_FIRST_BYTE_READ] = VmRESTMetricsNowNs();
+    }
+
+    VmRESTCpuSwitch(pRequest, REST_CPU_PARSE);
+
     while (!((nProcessed == 0) && (currState == prevState)) && (nTotalProcessed <= nBytes))
     {
         prevState = currState;
@@ -1320,6 +1667,15 @@ VmRESTProcessBuffer(
                                &nProcessed
                                );
                  BAIL_ON_VMREST_ERROR(dwError);
+
+                 if (pRESTHandle->bTraceEnabled && (pRequest->state != PROCESS_REQUEST_HEADERS))
+                 {
+                     VmRESTTraceSelectRequest(
+                         pRESTHandle,
+                         pRequest,
+                         FALSE
+                         );
+                 }
                  break;
 
             case PROCESS_REQUEST_PAYLOAD:
@@ -1353,6 +1709,14 @@ VmRESTProcessBuffer(
         VMREST_LOG_DEBUG(pRESTHandle,"Total bytes before %u, nProcessed %u", nTotalProcessed, nProcessed);
         nTotalProcessed += nProcessed;
         currState = pRequest->state;
+
+        if (currState != prevState)
+        {
+            VmRESTTimingsOnStateChange(
+                pRequest,
+                currState
+                );
+        }
     }
 
     /**** We are going to wait for next IO inless ****/
@@ -1363,12 +1727,18 @@ VmRESTProcessBuffer(
 
 cleanup:
 
+    if (pRequest)
+    {
+        pRequest->nBytesIn += nTotalProcessed;
+        VmRESTCpuSwitch(pRequest, REST_CPU_PHASE_COUNT);
+    }
+
     *nBytesProcessed = nTotalProcessed;
     return dwError;
 
 error:
 
-    VMREST_LOG_ERROR(pRESTHandle,"Process buffer failed with error code %u, sending failure response", dwError);
+    VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"Process buffer failed with error code %u, sending failure response", dwError);
     VmRESTSendFailureResponse(
         pRESTHandle,
         dwError,
@@ -1381,6 +1751,76 @@ error:
 
 }
 
+/**** Reserved endpoint, engine answers it before application handler ****/
+static
+uint32_t
+VmRESTServeMetrics(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_REST_HTTP_REQUEST_PACKET     pRequest,
+    PVM_REST_HTTP_RESPONSE_PACKET*   ppResponse
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    REST_STATS                       stats = {0};
+    char*                            pszText = NULL;
+    uint32_t                         nLen = 0;
+
+    pRequest->metricsRouteId = VmRESTMetricsGetRouteId(
+                                   pRESTHandle->pMetrics,
+                                   VMREST_METRICS_URI
+                                   );
+
+    dwError = VmHTTPGetStats(
+                  pRESTHandle,
+                  &stats
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTMetricsFormat(
+                  pRESTHandle->pMetrics,
+                  &stats,
+                  &pszText,
+                  &nLen
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTSetSuccessResponse(
+                  pRequest,
+                  ppResponse
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTSetHttpHeader(
+                  ppResponse,
+                  "Content-Type",
+                  "text/plain; version=0.0.4"
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Zero copy send is done once it returns ****/
+    dwError = VmRESTSetHttpPayloadZeroCopy(
+                  pRESTHandle,
+                  ppResponse,
+                  pszText,
+                  nLen
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+
+    if (pszText)
+    {
+        VmRESTFreeMemory(pszText, REST_MEM_RESPONSE);
+    }
+
+    return dwError;
+
+error:
+
+    VMREST_LOG_ERROR(pRESTHandle,"Serving metrics failed, error %u", dwError);
+    goto cleanup;
+}
+
 uint32_t
 VmRESTTriggerAppCb(
     PVMREST_HANDLE                   pRESTHandle,
@@ -1389,6 +1829,7 @@ VmRESTTriggerAppCb(
 )
 {
     uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    REST_CPU_PHASE                   prevPhase = REST_CPU_PHASE_COUNT;
 
     if (!pRequest || !ppResponse || !pRESTHandle)
     {
@@ -1404,15 +1845,34 @@ VmRESTTriggerAppCb(
     }
     BAIL_ON_VMREST_ERROR(dwError);
 
-    if (pRESTHandle->pHttpHandler->pfnHandleRequest)
+    pRequest->timings.phaseNs[REST_PHASE_HANDLER_START] = VmRESTMetricsNowNs();
+
+    if (pRESTHandle->pRESTConfig->enableMetricsEndpoint &&
+        (strcmp(pRequest->requestLine->method, "GET") == 0) &&
+        (strcmp(pRequest->requestLine->uri, VMREST_METRICS_URI) == 0))
+    {
+        prevPhase = VmRESTCpuSwitch(pRequest, REST_CPU_HANDLER);
+        dwError = VmRESTServeMetrics(pRESTHandle, pRequest, ppResponse);
+        VmRESTCpuSwitch(pRequest, prevPhase);
+    }
+    else if (pRESTHandle->pHttpHandler->pfnHandleRequest == &VmRestEngineHandler)
+    {
+        /**** Engine handler routes as part of parse and switches around route callback itself ****/
+        dwError = VmRestEngineHandler(pRESTHandle, pRequest, ppResponse);
+    }
+    else if (pRESTHandle->pHttpHandler->pfnHandleRequest)
     {
+        prevPhase = VmRESTCpuSwitch(pRequest, REST_CPU_HANDLER);
         dwError = pRESTHandle->pHttpHandler->pfnHandleRequest(pRESTHandle,pRequest, ppResponse);
+        VmRESTCpuSwitch(pRequest, prevPhase);
     }
     else
     {
         VMREST_LOG_ERROR(pRESTHandle,"%s","No Request callback registered");
         dwError = VMREST_APPLICATION_VALIDATION_FAILED;
     }
+
+    pRequest->timings.phaseNs[REST_PHASE_HANDLER_END] = VmRESTMetricsNowNs();
     BAIL_ON_VMREST_ERROR(dwError);
     
 
@@ -1455,7 +1915,7 @@ VmRESTSendFailureResponse(
 
     pResponse = pRequest->pResponse;
 
-    VMREST_LOG_ERROR(pRESTHandle,"Preparing to send negative response to client, Error %u...", errorCode);
+    VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"Preparing to send negative response to client, Error %u...", errorCode);
 
     switch(errorCode)
     {
@@ -1547,7 +2007,7 @@ cleanup:
     return dwError;
 
 error:
-    VMREST_LOG_ERROR(pRESTHandle,"%s", "Double failure observed while sending negative response...");
+    VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"%s", "Double failure observed while sending negative response...");
 
     goto cleanup;
 
@@ -1565,6 +2025,7 @@ VmRESTSetHttpPayloadZeroCopy(
     int                              ret = 0;
     PREST_RESPONSE                   pResponse = NULL;
     char                             pszContentLen[MAX_CONTENT_LEN_STR_SIZE] = {0};
+    REST_CPU_PHASE                   prevPhase = REST_CPU_PHASE_COUNT;
 
     if (!pRESTHandle  || !ppResponse)
     {
@@ -1592,6 +2053,7 @@ VmRESTSetHttpPayloadZeroCopy(
     BAIL_ON_VMREST_ERROR(dwError);
 
     pResponse = *ppResponse;
+    prevPhase = VmRESTCpuSwitch(pResponse ? pResponse->requestPacket : NULL, REST_CPU_SERIALIZE);
 
     /**** Send Header first ****/
     dwError = VmRESTSendHeader(
@@ -1609,10 +2071,13 @@ VmRESTSetHttpPayloadZeroCopy(
                       nBytes
                       );
         BAIL_ON_VMREST_ERROR(dwError);
+        VmRESTTimingsOnWrite(pResponse, nBytes);
     }
 
 cleanup:
 
+    VmRESTCpuSwitch(pResponse ? pResponse->requestPacket : NULL, prevPhase);
+
     return dwError;
 
 error:
@@ -1621,6 +2086,79 @@ error:
     goto cleanup;
 }
 
+uint32_t
+VmRESTSetHttpPayloadFromFile(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_RESPONSE*                  ppResponse,
+    int                              fd,
+    uint64_t                         offset,
+    uint32_t                         nBytes
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    int                              ret = 0;
+    PREST_RESPONSE                   pResponse = NULL;
+    char                             pszContentLen[MAX_CONTENT_LEN_STR_SIZE] = {0};
+    REST_CPU_PHASE                   prevPhase = REST_CPU_PHASE_COUNT;
+
+    if (!pRESTHandle  || !ppResponse || (fd < 0))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
+        dwError = VMREST_HTTP_INVALID_PARAMS;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    ret = snprintf(pszContentLen, MAX_CONTENT_LEN_STR_SIZE ,"%u", nBytes);
+
+    if ((ret < 0) || (ret >= MAX_CONTENT_LEN_STR_SIZE - 1))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Bad content length, nBytes %u", nBytes);
+        dwError = VMREST_HTTP_INVALID_PARAMS;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTSetHttpHeader(
+                  ppResponse,
+                  HTTP_HEADER_STR_CONTENT_LENGTH,
+                  pszContentLen
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pResponse = *ppResponse;
+    prevPhase = VmRESTCpuSwitch(pResponse ? pResponse->requestPacket : NULL, REST_CPU_SERIALIZE);
+
+    /**** Send Header first ****/
+    dwError = VmRESTSendHeader(
+                  pRESTHandle,
+                  ppResponse
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if (nBytes > 0)
+    {
+        dwError = VmRESTCommonSendFileAtOnce(
+                      pRESTHandle,
+                      pResponse->pSocket,
+                      fd,
+                      offset,
+                      nBytes
+                      );
+        BAIL_ON_VMREST_ERROR(dwError);
+        VmRESTTimingsOnWrite(pResponse, nBytes);
+    }
+
+cleanup:
+
+    VmRESTCpuSwitch(pResponse ? pResponse->requestPacket : NULL, prevPhase);
+
+    return dwError;
+
+error:
+
+    VMREST_LOG_ERROR(pRESTHandle,"%s","Set file payload Failed");
+    goto cleanup;
+}
+
 uint32_t
 VmRESTEntertainPersistentConn(
     PVMREST_HANDLE                   pRESTHandle,
@@ -1676,7 +2214,8 @@ cleanup:
     if (pszKeepAliveRequest)
     {
         VmRESTFreeMemory(
-            pszKeepAliveRequest
+            pszKeepAliveRequest,
+            REST_MEM_APP
             );
         pszKeepAliveRequest = NULL;
     }
@@ -0,0 +1,339 @@
+/* C-REST-Engine
+*
+* Copyright (c) 2017 VMware, Inc. All Rights Reserved.
+*
+* This product is licensed to you under the Apache 2.0 license (the "License").
+* You may not use this product except in compliance with the Apache 2.0 License.
+*
+* This product may include a number of subcomponents with separate copyright
+* notices and license terms. Your use of these subcomponents is subject to the
+* terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+*
+*/
+
+#include "includes.h"
+
+/**** Snapshot is built in pStage off the segment, only the copy in is under seqlock ****/
+typedef struct _VMREST_STATS_PUBLISHER
+{
+    PVMREST_HANDLE                   pRESTHandle;
+    PVMREST_MUTEX                    pMutex;
+    PVMREST_COND                     pCond;
+    VMREST_THREAD                    thread;
+    BOOLEAN                          bThreadStarted;
+    uint32_t                         bShutdown;
+    uint32_t                         intervalMs;
+    int                              fd;
+    dev_t                            dev;
+    ino_t                            ino;
+    PVMREST_STATS_SHM                pShm;
+    PVMREST_STATS_SHM                pStage;
+    char                             szName[VMREST_STATS_SHM_NAME_LEN];
+} VMREST_STATS_PUBLISHER;
+
+static
+uint64_t
+VmRESTStatsShmWallMs(
+    void
+    )
+{
+    struct timespec                  ts = {0};
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000) + ((uint64_t)ts.tv_nsec / 1000000);
+}
+
+/**** Daemon name may hold anything, object name must stay one path component ****/
+static
+void
+VmRESTStatsShmName(
+    PVMREST_HANDLE                   pRESTHandle,
+    char*                            pszName,
+    size_t                           nLen
+    )
+{
+    size_t                           idx = 0;
+    char                             c = '\0';
+
+    snprintf(
+        pszName,
+        nLen,
+        "%s%s-%u",
+        VMREST_STATS_SHM_PREFIX,
+        pRESTHandle->pRESTConfig->pszDaemonName,
+        pRESTHandle->pRESTConfig->serverPort
+        );
+
+    for (idx = 1; pszName[idx] != '\0'; idx++)
+    {
+        c = pszName[idx];
+        if (!isalnum((unsigned char)c) && (c != '-') && (c != '_') && (c != '.'))
+        {
+            pszName[idx] = '_';
+        }
+    }
+}
+
+static
+void
+VmRESTStatsShmPublish(
+    PVMREST_STATS_PUBLISHER          pPublisher
+    )
+{
+    PVMREST_HANDLE                   pRESTHandle = pPublisher->pRESTHandle;
+    PVMREST_STATS_SHM                pStage = pPublisher->pStage;
+    PVMREST_STATS_SHM                pShm = pPublisher->pShm;
+    uint32_t                         nRoutes = 0;
+    uint32_t                         seq = 0;
+    size_t                           offset = offsetof(VMREST_STATS_SHM, nRoutes);
+
+    if (VmHTTPGetStats(pRESTHandle, &pStage->stats) != REST_ENGINE_SUCCESS)
+    {
+        return;
+    }
+
+    VmRESTMetricsGetRouteStats(
+        pRESTHandle->pMetrics,
+        pStage->route,
+        VMREST_STATS_SHM_MAX_ROUTES,
+        &nRoutes
+        );
+
+    VmRESTMetricsGetLatencyHistogram(
+        pRESTHandle->pMetrics,
+        pStage->latencyBucket,
+        NULL
+        );
+
+    pStage->nRoutes = nRoutes;
+    pStage->nUpdates++;
+    pStage->snapshotTimeMs = VmRESTStatsShmWallMs();
+    pStage->snapshotNs = VmRESTMetricsNowNs();
+
+    /**** Single writer, readers retry while seq is odd or moved ****/
+    seq = pShm->seq;
+    __atomic_store_n(&pShm->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    memcpy((char*)pShm + offset, (char*)pStage + offset, sizeof(VMREST_STATS_SHM) - offset);
+
+    __atomic_store_n(&pShm->seq, seq + 2, __ATOMIC_RELEASE);
+}
+
+static
+DWORD
+VmRESTStatsShmThreadProc(
+    PVOID                            pData
+    )
+{
+    PVMREST_STATS_PUBLISHER          pPublisher = (PVMREST_STATS_PUBLISHER)pData;
+
+    VmRESTLockMutex(pPublisher->pMutex);
+
+    while (!__atomic_load_n(&pPublisher->bShutdown, __ATOMIC_ACQUIRE))
+    {
+        /**** Stats collection takes metrics and connection table locks, not this one ****/
+        VmRESTUnlockMutex(pPublisher->pMutex);
+        VmRESTStatsShmPublish(pPublisher);
+        VmRESTLockMutex(pPublisher->pMutex);
+
+        if (!__atomic_load_n(&pPublisher->bShutdown, __ATOMIC_ACQUIRE))
+        {
+            VmRESTConditionTimedWait(pPublisher->pCond, pPublisher->pMutex, pPublisher->intervalMs);
+        }
+    }
+
+    VmRESTUnlockMutex(pPublisher->pMutex);
+
+    return 0;
+}
+
+/**** A successor taking over listeners creates its own object under same name,
+      it must not be unlinked by predecessor ****/
+static
+void
+VmRESTStatsShmUnlink(
+    PVMREST_STATS_PUBLISHER          pPublisher
+    )
+{
+    struct stat                      st = {0};
+    int                              fd = -1;
+
+    fd = shm_open(pPublisher->szName, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        return;
+    }
+
+    if ((fstat(fd, &st) == 0) && (st.st_dev == pPublisher->dev) && (st.st_ino == pPublisher->ino))
+    {
+        shm_unlink(pPublisher->szName);
+    }
+
+    close(fd);
+}
+
+uint32_t
+VmRESTCreateStatsPublisher(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVMREST_STATS_PUBLISHER*         ppPublisher
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    PVMREST_STATS_PUBLISHER          pPublisher = NULL;
+    PVMREST_STATS_SHM                pShm = NULL;
+    struct stat                      st = {0};
+
+    if (!pRESTHandle || !pRESTHandle->pRESTConfig || !pRESTHandle->pMetrics || !ppPublisher)
+    {
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateMemory(
+                  sizeof(VMREST_STATS_PUBLISHER),
+                  (PVOID*)&pPublisher,
+                  REST_MEM_OTHER
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pPublisher->fd = -1;
+    pPublisher->pRESTHandle = pRESTHandle;
+    pPublisher->intervalMs = pRESTHandle->pRESTConfig->statsShmIntervalMs;
+
+    dwError = VmRESTAllocateMemory(
+                  sizeof(VMREST_STATS_SHM),
+                  (PVOID*)&pPublisher->pStage,
+                  REST_MEM_OTHER
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateNamedMutex(&pPublisher->pMutex, "stats_shm");
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateCondition(&pPublisher->pCond);
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    VmRESTStatsShmName(pRESTHandle, pPublisher->szName, sizeof(pPublisher->szName));
+
+    /**** Object left by a crashed process is replaced, readers still holding it see it never change ****/
+    shm_unlink(pPublisher->szName);
+
+    pPublisher->fd = shm_open(pPublisher->szName, O_CREAT | O_EXCL | O_RDWR, 0640);
+    if (pPublisher->fd < 0)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Failed to create stats segment %s, errno %d", pPublisher->szName, errno);
+        dwError = REST_ENGINE_FAILURE;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if ((fstat(pPublisher->fd, &st) != 0) ||
+        (ftruncate(pPublisher->fd, sizeof(VMREST_STATS_SHM)) != 0))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Failed to size stats segment %s, errno %d", pPublisher->szName, errno);
+        dwError = REST_ENGINE_FAILURE;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pPublisher->dev = st.st_dev;
+    pPublisher->ino = st.st_ino;
+
+    pShm = mmap(NULL, sizeof(VMREST_STATS_SHM), PROT_READ | PROT_WRITE, MAP_SHARED, pPublisher->fd, 0);
+    if (pShm == MAP_FAILED)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Failed to map stats segment %s, errno %d", pPublisher->szName, errno);
+        dwError = REST_ENGINE_FAILURE;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pPublisher->pShm = pShm;
+
+    /**** Fresh object is zero filled, readers ignore it until magic is set ****/
+    pShm->version = VMREST_STATS_SHM_VERSION;
+    pShm->nBytes = sizeof(VMREST_STATS_SHM);
+    pShm->nMaxRoutes = VMREST_STATS_SHM_MAX_ROUTES;
+    pShm->pid = (int32_t)getpid();
+    pShm->serverPort = pRESTHandle->pRESTConfig->serverPort;
+    pShm->intervalMs = pPublisher->intervalMs;
+    pShm->startTimeMs = VmRESTStatsShmWallMs();
+    snprintf(pShm->szDaemonName, sizeof(pShm->szDaemonName), "%s", pRESTHandle->pRESTConfig->pszDaemonName);
+
+    VmRESTMetricsGetLatencyHistogram(
+        pRESTHandle->pMetrics,
+        pShm->latencyBucket,
+        pShm->latencyUpperUs
+        );
+    memcpy(pPublisher->pStage->latencyUpperUs, pShm->latencyUpperUs, sizeof(pShm->latencyUpperUs));
+
+    __atomic_store_n(&pShm->magic, VMREST_STATS_SHM_MAGIC, __ATOMIC_RELEASE);
+
+    dwError = VmRESTCreateThread(
+                  &pPublisher->thread,
+                  FALSE,
+                  &VmRESTStatsShmThreadProc,
+                  pPublisher
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pPublisher->bThreadStarted = TRUE;
+
+    VMREST_LOG_INFO(pRESTHandle,"C-REST-ENGINE: Publishing stats to %s%s every %u ms",
+        VMREST_STATS_SHM_DIR, pPublisher->szName, pPublisher->intervalMs);
+
+    *ppPublisher = pPublisher;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    VmRESTFreeStatsPublisher(pPublisher);
+
+    goto cleanup;
+}
+
+void
+VmRESTFreeStatsPublisher(
+    PVMREST_STATS_PUBLISHER          pPublisher
+    )
+{
+    if (!pPublisher)
+    {
+        return;
+    }
+
+    if (pPublisher->bThreadStarted)
+    {
+        VmRESTLockMutex(pPublisher->pMutex);
+        __atomic_store_n(&pPublisher->bShutdown, 1, __ATOMIC_RELEASE);
+        VmRESTConditionSignal(pPublisher->pCond);
+        VmRESTUnlockMutex(pPublisher->pMutex);
+
+        VmRESTThreadJoin(&pPublisher->thread, NULL);
+    }
+
+    if (pPublisher->pShm)
+    {
+        __atomic_store_n(&pPublisher->pShm->bStopped, 1, __ATOMIC_RELEASE);
+        munmap(pPublisher->pShm, sizeof(VMREST_STATS_SHM));
+    }
+
+    if (pPublisher->fd >= 0)
+    {
+        VmRESTStatsShmUnlink(pPublisher);
+        close(pPublisher->fd);
+    }
+
+    if (pPublisher->pCond)
+    {
+        VmRESTFreeCondition(pPublisher->pCond);
+    }
+    if (pPublisher->pMutex)
+    {
+        VmRESTFreeMutex(pPublisher->pMutex);
+    }
+    VMREST_SAFE_FREE_MEMORY(pPublisher->pStage, REST_MEM_OTHER);
+    VmRESTFreeMemory(pPublisher, REST_MEM_OTHER);
+}
@@ -41,7 +41,8 @@ VmRESTGetHttpMethod(
 
     dwError = VmRESTAllocateMemory(
                  MAX_METHOD_LEN,
-                 (void **)&pMethod
+                 (void **)&pMethod,
+                 REST_MEM_APP
                  );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -85,7 +86,8 @@ VmRESTGetHttpURI(
 
     dwError = VmRESTAllocateMemory(
                  MAX_URI_LEN,
-                 (void **)&pHttpURI
+                 (void **)&pHttpURI,
+                 REST_MEM_APP
                  );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -138,7 +140,8 @@ VmRESTGetHttpVersion(
 
     dwError = VmRESTAllocateMemory(
                  MAX_VERSION_LEN,
-                 (void **)&pVersion
+                 (void **)&pVersion,
+                 REST_MEM_APP
                  );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -190,7 +193,8 @@ VmRESTGetHttpHeader(
          BAIL_ON_VMREST_ERROR(dwError);
          dwError = VmRESTAllocateMemory(
                        MAX_HTTP_HEADER_VAL_LEN,
-                       (void **)&headerValue
+                       (void **)&headerValue,
+                       REST_MEM_APP
                        );
          BAIL_ON_VMREST_ERROR(dwError);
          strncpy(headerValue, temp, (MAX_HTTP_HEADER_VAL_LEN - 1));
@@ -277,6 +281,7 @@ VmRESTSetHttpPayload(
     PREST_RESPONSE                   pResponse = NULL;
     char*                            contentLength = NULL;
     char*                            transferEncoding = NULL;
+    REST_CPU_PHASE                   prevPhase = REST_CPU_PHASE_COUNT;
 
 
     if (!ppResponse  || (*ppResponse == NULL) || !buffer || !bytesWritten)
@@ -288,6 +293,7 @@ VmRESTSetHttpPayload(
 
     pResponse = *ppResponse;
     *bytesWritten = 0;
+    prevPhase = VmRESTCpuSwitch(pResponse->requestPacket, REST_CPU_SERIALIZE);
 
     dwError = VmRESTGetHttpResponseHeader(
                   pResponse,
@@ -373,6 +379,10 @@ VmRESTSetHttpPayload(
     }
 
 cleanup:
+    if (pResponse)
+    {
+        VmRESTCpuSwitch(pResponse->requestPacket, prevPhase);
+    }
     return dwError;
 error:
     VMREST_LOG_ERROR(pRESTHandle,"Set Payload Failed with error Code %u", dwError);
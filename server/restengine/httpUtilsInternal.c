@@ -355,7 +355,8 @@ VmRESTFreeConfigFileStruct(
     if (pRESTConfig)
     {
         VmRESTFreeMemory(
-            pRESTConfig
+            pRESTConfig,
+            REST_MEM_OTHER
             );
     }
 }
@@ -374,12 +375,53 @@ VmRESTValidateConfig(
     }
     BAIL_ON_VMREST_ERROR(dwError);
 
-    if ((pRESTConfig->serverPort == 0) || (pRESTConfig->serverPort > MAX_PORT_NUMBER))
+    /**** Port is not needed when instance listens only on unix domain socket or shared memory ****/
+    if (pRESTConfig->disableTCP)
+    {
+        if (IsNullOrEmptyString(pRESTConfig->pszUnixSocketPath) && IsNullOrEmptyString(pRESTConfig->pszShmSocketPath))
+        {
+            dwError = REST_ERROR_INVALID_CONFIG;
+        }
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+    else if ((pRESTConfig->serverPort == 0) || (pRESTConfig->serverPort > MAX_PORT_NUMBER))
     {
         dwError = REST_ERROR_INVALID_CONFIG_PORT;
     }
     BAIL_ON_VMREST_ERROR(dwError);
 
+    /**** Abstract name (leading '@') needs at least one more character ****/
+    if ((pRESTConfig->pszUnixSocketPath[0] == '@') && (pRESTConfig->pszUnixSocketPath[1] == '\0'))
+    {
+        dwError = REST_ERROR_INVALID_CONFIG;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if ((pRESTConfig->pszShmSocketPath[0] == '@') && (pRESTConfig->pszShmSocketPath[1] == '\0'))
+    {
+        dwError = REST_ERROR_INVALID_CONFIG;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if (!IsNullOrEmptyString(pRESTConfig->pszShmSocketPath) &&
+        (strcmp(pRESTConfig->pszShmSocketPath, pRESTConfig->pszUnixSocketPath) == 0))
+    {
+        dwError = REST_ERROR_INVALID_CONFIG;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if (pRESTConfig->unixSocketMode & ~((uint32_t)07777))
+    {
+        dwError = REST_ERROR_INVALID_CONFIG;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if (pRESTConfig->nListenFds > VMREST_MAX_LISTEN_FDS)
+    {
+        dwError = REST_ERROR_INVALID_CONFIG;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
     if (pRESTConfig->isSecure)
     {
         if (pRESTConfig->pSSLContext != NULL)
@@ -454,6 +496,107 @@ VmRESTValidateConfig(
         pRESTConfig->nClientCnt = VMREST_MAX_CLIENT_COUNT;
     }
 
+    /**** Zero handshake threads keeps SSL handshake inline in the event loop ****/
+    if (pRESTConfig->nHandshakeThr > VMREST_MAX_HANDSHAKE_THR_COUNT)
+    {
+        pRESTConfig->nHandshakeThr = VMREST_MAX_HANDSHAKE_THR_COUNT;
+    }
+
+    if (pRESTConfig->nHandshakeQueueDepth == 0)
+    {
+        pRESTConfig->nHandshakeQueueDepth = VMREST_DEFAULT_HANDSHAKE_QUEUE_DEPTH;
+    }
+    else if (pRESTConfig->nHandshakeQueueDepth > VMREST_MAX_HANDSHAKE_QUEUE_DEPTH)
+    {
+        pRESTConfig->nHandshakeQueueDepth = VMREST_MAX_HANDSHAKE_QUEUE_DEPTH;
+    }
+
+    /**** Small TLS records until this many bytes are sent on connection, 1 means full size records always ****/
+    if (pRESTConfig->nTLSRecordRampBytes == 0)
+    {
+        pRESTConfig->nTLSRecordRampBytes = VMREST_DEFAULT_TLS_RECORD_RAMP_BYTES;
+    }
+
+    if (pRESTConfig->nTLSRecordIdleMs == 0)
+    {
+        pRESTConfig->nTLSRecordIdleMs = VMREST_DEFAULT_TLS_RECORD_IDLE_MS;
+    }
+    else if (pRESTConfig->nTLSRecordIdleMs > VMREST_MAX_TLS_RECORD_IDLE_MS)
+    {
+        pRESTConfig->nTLSRecordIdleMs = VMREST_MAX_TLS_RECORD_IDLE_MS;
+    }
+
+    /**** Ring offsets are masked, size must be a power of two ****/
+    if (pRESTConfig->nShmRingBytes == 0)
+    {
+        pRESTConfig->nShmRingBytes = VMREST_DEFAULT_SHM_RING_BYTES;
+    }
+    else if (pRESTConfig->nShmRingBytes < VMREST_MIN_SHM_RING_BYTES)
+    {
+        pRESTConfig->nShmRingBytes = VMREST_MIN_SHM_RING_BYTES;
+    }
+    else if (pRESTConfig->nShmRingBytes > VMREST_MAX_SHM_RING_BYTES)
+    {
+        pRESTConfig->nShmRingBytes = VMREST_MAX_SHM_RING_BYTES;
+    }
+    else if (pRESTConfig->nShmRingBytes & (pRESTConfig->nShmRingBytes - 1))
+    {
+        dwError = REST_ERROR_INVALID_CONFIG;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Per thread log ring, same masking as shared memory ring ****/
+    if (pRESTConfig->nLogRingBytes == 0)
+    {
+        pRESTConfig->nLogRingBytes = VMREST_DEFAULT_LOG_RING_BYTES;
+    }
+    else if (pRESTConfig->nLogRingBytes < VMREST_MIN_LOG_RING_BYTES)
+    {
+        pRESTConfig->nLogRingBytes = VMREST_MIN_LOG_RING_BYTES;
+    }
+    else if (pRESTConfig->nLogRingBytes > VMREST_MAX_LOG_RING_BYTES)
+    {
+        pRESTConfig->nLogRingBytes = VMREST_MAX_LOG_RING_BYTES;
+    }
+    else if (pRESTConfig->nLogRingBytes & (pRESTConfig->nLogRingBytes - 1))
+    {
+        dwError = REST_ERROR_INVALID_CONFIG;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Per thread access log ring ****/
+    if (pRESTConfig->nAccessLogRingBytes == 0)
+    {
+        pRESTConfig->nAccessLogRingBytes = VMREST_DEFAULT_ACCESS_LOG_RING_BYTES;
+    }
+    else if (pRESTConfig->nAccessLogRingBytes < VMREST_MIN_ACCESS_LOG_RING_BYTES)
+    {
+        pRESTConfig->nAccessLogRingBytes = VMREST_MIN_ACCESS_LOG_RING_BYTES;
+    }
+    else if (pRESTConfig->nAccessLogRingBytes > VMREST_MAX_ACCESS_LOG_RING_BYTES)
+    {
+        pRESTConfig->nAccessLogRingBytes = VMREST_MAX_ACCESS_LOG_RING_BYTES;
+    }
+    else if (pRESTConfig->nAccessLogRingBytes & (pRESTConfig->nAccessLogRingBytes - 1))
+    {
+        dwError = REST_ERROR_INVALID_CONFIG;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Stats segment, 0 keeps it off ****/
+    if ((pRESTConfig->statsShmIntervalMs > 0) &&
+        (pRESTConfig->statsShmIntervalMs < VMREST_MIN_STATS_SHM_INTERVAL_MS))
+    {
+        pRESTConfig->statsShmIntervalMs = VMREST_MIN_STATS_SHM_INTERVAL_MS;
+    }
+
+    if ((pRESTConfig->accessLogFormat != VMREST_ACCESS_LOG_JSON) &&
+        (pRESTConfig->accessLogFormat != VMREST_ACCESS_LOG_BINARY))
+    {
+        dwError = REST_ERROR_INVALID_CONFIG;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
     if ((IsNullOrEmptyString(pRESTConfig->pszDebugLogFile) && !(pRESTConfig->useSysLog)))
     {
         dwError = REST_ENGINE_NO_DEBUG_LOGGING;
@@ -491,6 +634,117 @@ error:
 
 }
 
+static
+uint32_t
+VmRESTCopyConfigExtension(
+    PREST_CONF                       pConfig,
+    PVM_REST_CONFIG                  pRESTConfig
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+
+    if (!(IsNullOrEmptyString(pConfig->pszAccessLogFile)))
+    {
+        /**** Rotation appends a suffix, truncated path would rotate some other file ****/
+        if (strlen(pConfig->pszAccessLogFile) >= (MAX_PATH_LEN - 4))
+        {
+            dwError = REST_ERROR_INVALID_CONFIG;
+        }
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        strcpy(pRESTConfig->pszAccessLogFile, pConfig->pszAccessLogFile);
+    }
+
+    if (!(IsNullOrEmptyString(pConfig->pszUnixSocketPath)))
+    {
+        /**** Truncated path would silently bind somewhere else ****/
+        if (strlen(pConfig->pszUnixSocketPath) >= VMREST_MAX_UNIX_SOCKET_PATH_LEN)
+        {
+            dwError = REST_ERROR_INVALID_CONFIG;
+        }
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        strcpy(pRESTConfig->pszUnixSocketPath, pConfig->pszUnixSocketPath);
+    }
+
+    if (!(IsNullOrEmptyString(pConfig->pszShmSocketPath)))
+    {
+        if (strlen(pConfig->pszShmSocketPath) >= VMREST_MAX_UNIX_SOCKET_PATH_LEN)
+        {
+            dwError = REST_ERROR_INVALID_CONFIG;
+        }
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        strcpy(pRESTConfig->pszShmSocketPath, pConfig->pszShmSocketPath);
+    }
+
+    /**** Truncated filter would trace something else ****/
+    if (!(IsNullOrEmptyString(pConfig->pszTraceClientIP)))
+    {
+        if (strlen(pConfig->pszTraceClientIP) >= VMREST_MAX_TRACE_FILTER_LEN)
+        {
+            dwError = REST_ERROR_INVALID_CONFIG;
+        }
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        strcpy(pRESTConfig->pszTraceClientIP, pConfig->pszTraceClientIP);
+    }
+
+    if (!(IsNullOrEmptyString(pConfig->pszTraceRoute)))
+    {
+        if (strlen(pConfig->pszTraceRoute) >= VMREST_MAX_TRACE_FILTER_LEN)
+        {
+            dwError = REST_ERROR_INVALID_CONFIG;
+        }
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        strcpy(pRESTConfig->pszTraceRoute, pConfig->pszTraceRoute);
+    }
+
+    if (!(IsNullOrEmptyString(pConfig->pszTraceHeader)))
+    {
+        if (strlen(pConfig->pszTraceHeader) >= VMREST_MAX_TRACE_FILTER_LEN)
+        {
+            dwError = REST_ERROR_INVALID_CONFIG;
+        }
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        strcpy(pRESTConfig->pszTraceHeader, pConfig->pszTraceHeader);
+    }
+
+    pRESTConfig->nHandshakeThr = pConfig->nHandshakeThr;
+    pRESTConfig->nHandshakeQueueDepth = pConfig->nHandshakeQueueDepth;
+    pRESTConfig->nTLSRecordRampBytes = pConfig->nTLSRecordRampBytes;
+    pRESTConfig->nTLSRecordIdleMs = pConfig->nTLSRecordIdleMs;
+    pRESTConfig->nShmRingBytes = pConfig->nShmRingBytes;
+    pRESTConfig->nLogRingBytes = pConfig->nLogRingBytes;
+    pRESTConfig->nAccessLogRingBytes = pConfig->nAccessLogRingBytes;
+    pRESTConfig->accessLogMaxMB = pConfig->accessLogMaxMB;
+    pRESTConfig->accessLogFormat = pConfig->accessLogFormat;
+    pRESTConfig->traceSampleRate = pConfig->traceSampleRate;
+    pRESTConfig->statsShmIntervalMs = pConfig->statsShmIntervalMs;
+    pRESTConfig->cpuSampleRate = pConfig->cpuSampleRate;
+    pRESTConfig->nListenFds = pConfig->nListenFds;
+    memcpy(pRESTConfig->listenFds, pConfig->listenFds, sizeof(pRESTConfig->listenFds));
+    pRESTConfig->useKernelTLS = pConfig->useKernelTLS;
+    pRESTConfig->useHugePages = pConfig->useHugePages;
+    pRESTConfig->disableTCP = pConfig->disableTCP;
+    pRESTConfig->useAsyncLog = pConfig->useAsyncLog;
+    pRESTConfig->blockOnLogFull = pConfig->blockOnLogFull;
+    pRESTConfig->enableMetricsEndpoint = pConfig->enableMetricsEndpoint;
+    pRESTConfig->enableLockProfiling = pConfig->enableLockProfiling;
+    pRESTConfig->enableMemoryDebug = pConfig->enableMemoryDebug;
+    pRESTConfig->unixSocketMode = pConfig->unixSocketMode;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
 uint32_t
 VmRESTCopyConfig(
     PREST_CONF                       pConfig,
@@ -544,6 +798,16 @@ VmRESTCopyConfig(
     pRESTConfig->useSysLog = pConfig->useSysLog;
     pRESTConfig->SSLCtxOptionsFlag = pConfig->SSLCtxOptionsFlag;
 
+    /**** Caller not using VmRESTInitConfig() may leave anything past debugLogLevel, keep defaults ****/
+    if (pConfig->initMagic == VMREST_CONF_INIT_MAGIC)
+    {
+        dwError = VmRESTCopyConfigExtension(
+                      pConfig,
+                      pRESTConfig
+                      );
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
 cleanup:
 
     return dwError;
@@ -605,7 +869,8 @@ VmRESTSetHTTPMiscHeader(
     /**** Allocate the node ****/
     dwError = VmRESTAllocateMemory(
                   sizeof(VM_REST_HTTP_HEADER_NODE),
-                  (void**)&node
+                  (void**)&node,
+                  REST_MEM_HEADER
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -633,7 +898,7 @@ cleanup:
 error:
     if (node != NULL)
     {
-        VmRESTFreeMemory(node);
+        VmRESTFreeMemory(node, REST_MEM_HEADER);
         node = NULL;
     }
     goto cleanup;
@@ -655,7 +920,8 @@ VmRESTRemoveAllHTTPMiscHeader(
         temp = temp->next;
         
         VmRESTFreeMemory(
-            node
+            node,
+            REST_MEM_HEADER
             );
     }
     BAIL_ON_VMREST_ERROR(dwError);
@@ -407,7 +407,7 @@ VmRESTValidateHTTPRequestURI(
 cleanup:
     if (host != NULL)
     {
-        VmRESTFreeMemory(host);
+        VmRESTFreeMemory(host, REST_MEM_APP);
         host = NULL;
     }
     return dwError;
@@ -469,7 +469,7 @@ VmRESTValidateHTTPContentType(
 cleanup:
     if (contentType != NULL)
     {
-        VmRESTFreeMemory(contentType);
+        VmRESTFreeMemory(contentType, REST_MEM_APP);
         contentType = NULL;
     }
 
@@ -537,7 +537,7 @@ VmRESTValidateAccept(
 cleanup:
     if (accept != NULL)
     {
-        VmRESTFreeMemory(accept);
+        VmRESTFreeMemory(accept, REST_MEM_APP);
         accept = NULL;
     }
 
@@ -604,7 +604,7 @@ VmRESTValidateAcceptCharSet(
 cleanup:
     if (acceptCharSet != NULL)
     {
-        VmRESTFreeMemory(acceptCharSet);
+        VmRESTFreeMemory(acceptCharSet, REST_MEM_APP);
         acceptCharSet = NULL;
     }
 
@@ -25,10 +25,13 @@ typedef unsigned __int8 uint8_t;
 #include <stdio.h>
 
 #include <vmrestsys.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #include <vmrestdefines.h>
 #include <vmrest.h>
 #include <vmsock.h>
 #include <vmrestcommon.h>
+#include <vmreststats.h>
 #include "defines.h"
 #include "structs.h"
 #include "prototype.h"
@@ -39,6 +39,42 @@ BOOL APIENTRY DllMain(HMODULE hModule,
 #endif
 
 
+uint32_t
+VmRESTInitConfig(
+    PREST_CONF                       pConfig
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+
+    if (!pConfig)
+    {
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    memset(pConfig, 0, sizeof(REST_CONF));
+
+    pConfig->connTimeoutSec = VMREST_DEFAULT_CONN_TIMEOUT_SEC;
+    pConfig->nWorkerThr = VMREST_DEFAULT_WORKER_THR_COUNT;
+    pConfig->nClientCnt = VMREST_DEFAULT_CLIENT_COUNT;
+    pConfig->debugLogLevel = VMREST_LOG_LEVEL_ERROR;
+    pConfig->nHandshakeQueueDepth = VMREST_DEFAULT_HANDSHAKE_QUEUE_DEPTH;
+    pConfig->nTLSRecordRampBytes = VMREST_DEFAULT_TLS_RECORD_RAMP_BYTES;
+    pConfig->nTLSRecordIdleMs = VMREST_DEFAULT_TLS_RECORD_IDLE_MS;
+    pConfig->nShmRingBytes = VMREST_DEFAULT_SHM_RING_BYTES;
+    pConfig->nLogRingBytes = VMREST_DEFAULT_LOG_RING_BYTES;
+    pConfig->nAccessLogRingBytes = VMREST_DEFAULT_ACCESS_LOG_RING_BYTES;
+    pConfig->accessLogFormat = VMREST_ACCESS_LOG_JSON;
+
+    /**** Tells VmRESTInit() fields past debugLogLevel are not stack garbage ****/
+    pConfig->initMagic = VMREST_CONF_INIT_MAGIC;
+
+cleanup:
+    return dwError;
+error:
+    goto cleanup;
+}
+
 uint32_t
 VmRESTInit(
     PREST_CONF                       pConfig,
@@ -98,9 +134,7 @@ VmRESTSetSSLInfo(
      )
 {
      uint32_t                         dwError = REST_ENGINE_SUCCESS;
-     char                             fileName[MAX_PATH_LEN] = {0};
-     FILE*                            fp = NULL;
-     uint32_t                         writtenBytes = 0;
+     char*                            pszCopy = NULL;
 
     if (!pRESTHandle || !pDataBuffer || (bufferSize == 0) || (bufferSize > MAX_SSL_DATA_BUF_LEN) || (sslDataType < SSL_DATA_TYPE_KEY) || (sslDataType > SSL_DATA_TYPE_CERT))
     {
@@ -120,45 +154,29 @@ VmRESTSetSSLInfo(
     }
     BAIL_ON_VMREST_ERROR(dwError);
 
-    if (sslDataType == SSL_DATA_TYPE_KEY)
-    {
-        snprintf(fileName, (MAX_PATH_LEN - 1),"%s%u.pem", "/tmp/key-port-", pRESTHandle->pRESTConfig->serverPort);
-
-    }
-    else if (sslDataType == SSL_DATA_TYPE_CERT)
-    {
-        snprintf(fileName, (MAX_PATH_LEN - 1), "%s%u.pem", "/tmp/cert-port-", pRESTHandle->pRESTConfig->serverPort);
-    }
-
-    fp = fopen(fileName, "w+");
-    if (fp == NULL)
-    {
-        VMREST_LOG_ERROR(pRESTHandle,"Unable to Open SSL file %s", fileName);
-        dwError = REST_ENGINE_FAILURE;
-    }
+    /**** Keep PEM data in memory, it is parsed into SSL context on start ****/
+    dwError = VmRESTAllocateMemory(
+                  bufferSize,
+                  (void**)&pszCopy,
+                  REST_MEM_TLS
+                  );
     BAIL_ON_VMREST_ERROR(dwError);
 
-    writtenBytes = fwrite(pDataBuffer, 1, bufferSize, fp);
-    fclose(fp);
-    
-    if (writtenBytes != bufferSize)
-    {
-        VMREST_LOG_WARNING(pRESTHandle,"Not all buffer bytes written to file, requested %u, written %u", bufferSize, writtenBytes);
-    }
+    memcpy(pszCopy, pDataBuffer, bufferSize);
 
     if (sslDataType == SSL_DATA_TYPE_KEY)
     {
-        memset(pRESTHandle->pRESTConfig->pszSSLKey, '\0', MAX_PATH_LEN);
-        strncpy(pRESTHandle->pRESTConfig->pszSSLKey, fileName,( MAX_PATH_LEN - 1));
+        pRESTHandle->pSSLInfo->pszKeyBuf = pszCopy;
+        pRESTHandle->pSSLInfo->nKeyBufLen = bufferSize;
         pRESTHandle->pSSLInfo->isKeySet = SSL_INFO_FROM_BUFFER_API;
-
     }
     else if (sslDataType == SSL_DATA_TYPE_CERT)
     {
-        memset(pRESTHandle->pRESTConfig->pszSSLCertificate, '\0', MAX_PATH_LEN);
-        strncpy(pRESTHandle->pRESTConfig->pszSSLCertificate, fileName,( MAX_PATH_LEN - 1));
+        pRESTHandle->pSSLInfo->pszCertBuf = pszCopy;
+        pRESTHandle->pSSLInfo->nCertBufLen = bufferSize;
         pRESTHandle->pSSLInfo->isCertSet = SSL_INFO_FROM_BUFFER_API;
     }
+    pszCopy = NULL;
 
 cleanup:
     return dwError;
@@ -177,7 +195,6 @@ VmRESTStart(
     )
 {
     uint32_t                         dwError = REST_ENGINE_SUCCESS;
-    int                              ret = 0;
 
     if (!pRESTHandle || (pRESTHandle->instanceState != VMREST_INSTANCE_INITIALIZED))
     {
@@ -197,28 +214,8 @@ VmRESTStart(
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
-    /**** delete the cert file if created by library ****/
-
-    if (pRESTHandle->pSSLInfo->isCertSet == SSL_INFO_FROM_BUFFER_API)
-    {
-        if ((ret = remove(pRESTHandle->pRESTConfig->pszSSLCertificate)) == -1)
-        {
-            VMREST_LOG_ERROR(pRESTHandle, "remove() syscall failed for temp certificate file (), ret %d", ret);
-            dwError = REST_ENGINE_FAILURE;
-        }
-        BAIL_ON_VMREST_ERROR(dwError);
-    }
-    ret = 0;
-
-    if (pRESTHandle->pSSLInfo->isKeySet == SSL_INFO_FROM_BUFFER_API)
-    {
-        if ((ret = remove(pRESTHandle->pRESTConfig->pszSSLKey)) == -1)
-        {
-            VMREST_LOG_ERROR(pRESTHandle, "remove temp file failed ()");
-            dwError = REST_ENGINE_FAILURE;
-        }
-        BAIL_ON_VMREST_ERROR(dwError);
-    }
+    /**** PEM buffers are parsed into SSL context by now ****/
+    VmRESTFreeSSLBuffers(pRESTHandle->pSSLInfo);
 
     pRESTHandle->instanceState = VMREST_INSTANCE_STARTED;
 
@@ -390,12 +387,14 @@ VmRESTStop(
     }
     BAIL_ON_VMREST_ERROR(dwError);
 
-    pRESTHandle->instanceState = VMREST_INSTANCE_STOPPED;
+    pRESTHandle->instanceState = VMREST_INSTANCE_STOPPING;
 
     dwError = VmHTTPStop(
                   pRESTHandle,
                   waitSeconds
                   );
+
+    pRESTHandle->instanceState = VMREST_INSTANCE_STOPPED;
     BAIL_ON_VMREST_ERROR(dwError);
 
 cleanup:
@@ -412,6 +411,13 @@ VmRESTShutdown(
     if (pRESTHandle && (pRESTHandle->instanceState == VMREST_INSTANCE_STOPPED))
     {
         pRESTHandle->instanceState = VMREST_INSTANCE_SHUTDOWN;
+        if (pRESTHandle->pEngineGroup)
+        {
+            VmRESTLockMutex(pRESTHandle->pEngineGroup->pMutex);
+            pRESTHandle->pEngineGroup->nMembers--;
+            VmRESTUnlockMutex(pRESTHandle->pEngineGroup->pMutex);
+            pRESTHandle->pEngineGroup = NULL;
+        }
         if (pRESTHandle->pInstanceGlobal->useEndPoint == 1)
         {
             VmRestEngineShutdownEndPointRegistration(
@@ -433,7 +439,7 @@ VmRESTGetData(
 {
     uint32_t                         dwError = REST_ENGINE_SUCCESS;
 
-    if (!pRESTHandle || (pRESTHandle->instanceState != VMREST_INSTANCE_STARTED))
+    if (!pRESTHandle || !VMREST_INSTANCE_SERVING(pRESTHandle))
     {
         dwError = REST_ENGINE_ERROR_INVALID_PARAM;
     }
@@ -468,7 +474,7 @@ VmRESTGetDataZC(
 {
     uint32_t                         dwError = REST_ENGINE_SUCCESS;
 
-    if (!pRESTHandle || !pRequest || !ppBuffer  || !nBytes || (pRESTHandle->instanceState != VMREST_INSTANCE_STARTED))
+    if (!pRESTHandle || !pRequest || !ppBuffer  || !nBytes || !VMREST_INSTANCE_SERVING(pRESTHandle))
     {
         VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
         dwError = REST_ENGINE_ERROR_INVALID_PARAM;
@@ -508,7 +514,7 @@ VmRESTSetData(
     uint32_t                         dwError = REST_ENGINE_SUCCESS;
 
 
-    if (!pRESTHandle || !ppResponse || !pcszBuffer || !bytesWritten || (pRESTHandle->instanceState != VMREST_INSTANCE_STARTED))
+    if (!pRESTHandle || !ppResponse || !pcszBuffer || !bytesWritten || !VMREST_INSTANCE_SERVING(pRESTHandle))
     {
         VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
         dwError = REST_ENGINE_ERROR_INVALID_PARAM;
@@ -546,7 +552,7 @@ VmRESTSetDataZC(
     uint32_t                         dwError = REST_ENGINE_SUCCESS;
 
 
-    if (!pRESTHandle || !ppResponse || !pcszBuffer || (pRESTHandle->instanceState != VMREST_INSTANCE_STARTED))
+    if (!pRESTHandle || !ppResponse || !pcszBuffer || !VMREST_INSTANCE_SERVING(pRESTHandle))
     {
         VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
         dwError = REST_ENGINE_ERROR_INVALID_PARAM;
@@ -572,214 +578,900 @@ error:
 
 }
 
+/**** SetData from file, uses sendfile where possible ****/
 uint32_t
-VmRESTSetSuccessResponse(
-    PREST_REQUEST                    pRequest,
-    PREST_RESPONSE*                  ppResponse
+VmRESTSetDataFromFile(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_RESPONSE*                  ppResponse,
+    int                              fd,
+    uint64_t                         offset,
+    uint32_t                         nBytes
     )
 {
     uint32_t                         dwError = REST_ENGINE_SUCCESS;
-    char*                            connection = NULL;
 
-    if (!pRequest || !ppResponse)
+    if (!pRESTHandle || !ppResponse || (fd < 0) || !VMREST_INSTANCE_SERVING(pRESTHandle))
     {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
         dwError = REST_ENGINE_ERROR_INVALID_PARAM;
     }
     BAIL_ON_VMREST_ERROR(dwError);
 
-    dwError = VmRESTSetHttpStatusCode(
+    dwError = VmRESTSetHttpPayloadFromFile(
+                  pRESTHandle,
                   ppResponse,
-                  "200"
+                  fd,
+                  offset,
+                  nBytes
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
-    dwError = VmRESTSetHttpStatusVersion(
-                  ppResponse,
-                  "HTTP/1.1"
-                  );
-    BAIL_ON_VMREST_ERROR(dwError);
+cleanup:
 
-    dwError = VmRESTSetHttpReasonPhrase(
-                  ppResponse,
-                  "OK"
-                  );
-    BAIL_ON_VMREST_ERROR(dwError);
+    return dwError;
 
-    dwError = VmRESTGetHttpHeader(
-                  pRequest,
-                  "Connection",
-                  &connection
-                  );
-    BAIL_ON_VMREST_ERROR(dwError);
+error:
 
-    if ((connection != NULL) && ((strncmp(connection, "keep-alive", strlen("keep-alive")) == 0)))
-    {
-        dwError = VmRESTSetHttpHeader(
-                      ppResponse,
-                      "Connection",
-                      "keep-alive"
-                      );
-    }
-    else
+    goto cleanup;
+
+}
+
+uint32_t
+VmRESTGetHandshakeStats(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_HANDSHAKE_STATS            pStats
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRESTHandle || !pStats || (pRESTHandle->instanceState != VMREST_INSTANCE_STARTED))
     {
-        dwError = VmRESTSetHttpHeader(
-                      ppResponse,
-                      "Connection",
-                      "close"
-                      );
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
     }
     BAIL_ON_VMREST_ERROR(dwError);
 
+    dwError = VmwSockGetHandshakeStats(
+                  pRESTHandle,
+                  pStats
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
 cleanup:
-    if (connection != NULL)
-    {
-        VmRESTFreeMemory(connection);
-        connection = NULL;
-    }
+
     return dwError;
+
 error:
+
     goto cleanup;
 
 }
 
 uint32_t
-VmRESTSetFailureResponse(
-    PREST_RESPONSE*                  ppResponse,
-    char const*                      pcszErrorCode,
-    char const*                      pcszErrorMessage
+VmRESTGetConnections(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_CONNECTION_INFO            pInfo,
+    uint32_t                         nMax,
+    uint32_t*                        pnCount
     )
-{   
+{
     uint32_t                         dwError = REST_ENGINE_SUCCESS;
-    char                             errorCode[MAX_STATUS_LEN] = {0};
-    char                             errorMessage[MAX_REA_PHRASE_LEN] = {0};
-
-    memset(errorCode, '\0', MAX_STATUS_LEN);
-    memset(errorMessage, '\0', MAX_REA_PHRASE_LEN);
-
-    /**** If error code and message is not provided, send internal server error ****/
-
-    if (!pcszErrorCode)
-    {
-        strcpy(errorCode,"500");
-    }
-    else if ((strlen(pcszErrorCode) > 0) && (strlen(pcszErrorCode) <= MAX_STATUS_LEN))
-    {
-        strcpy(errorCode, pcszErrorCode);
-    }
 
-    if (!pcszErrorMessage)
-    {
-        strcpy(errorMessage, "Internal Server Error");
-    }
-    else if ((strlen(pcszErrorMessage) > 0) && (strlen(pcszErrorMessage) <= MAX_REA_PHRASE_LEN))
+    if (!pRESTHandle || !pnCount || (pRESTHandle->instanceState != VMREST_INSTANCE_STARTED))
     {
-        strcpy(errorMessage, pcszErrorMessage);
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
     }
-
-    dwError = VmRESTSetHttpStatusCode(
-                  ppResponse,
-                  errorCode
-                  );
     BAIL_ON_VMREST_ERROR(dwError);
-    
-    dwError = VmRESTSetHttpStatusVersion(
-                  ppResponse,
-                  "HTTP/1.1"
+
+    dwError = VmwSockGetConnections(
+                  pRESTHandle,
+                  pInfo,
+                  nMax,
+                  pnCount
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
-    dwError = VmRESTSetHttpReasonPhrase(
-                  ppResponse,
-                  errorMessage
-                  );
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+
+}
+
+uint32_t
+VmRESTSendListenerFds(
+    PVMREST_HANDLE                   pRESTHandle,
+    char const*                      pszSocketPath
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRESTHandle || IsNullOrEmptyString(pszSocketPath) || (pRESTHandle->instanceState != VMREST_INSTANCE_STARTED))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
     BAIL_ON_VMREST_ERROR(dwError);
 
-    dwError = VmRESTSetHttpHeader(
-                  ppResponse,
-                  "Connection",
-                  "close"
+    dwError = VmwSockSendListenerFds(
+                  pRESTHandle,
+                  pszSocketPath
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
 cleanup:
+
     return dwError;
+
 error:
+
     goto cleanup;
+
 }
 
 uint32_t
-VmRESTSetDataLength(
-    PREST_RESPONSE*                  ppResponse,
-    char*                            dataLen
+VmRESTReceiveListenerFds(
+    PVMREST_HANDLE                   pRESTHandle,
+    char const*                      pszSocketPath,
+    uint32_t                         waitSeconds
     )
 {
     uint32_t                         dwError = REST_ENGINE_SUCCESS;
 
-    if ((dataLen != NULL) && (atoi(dataLen) <= MAX_DATA_BUFFER_LEN))
-    {
-        dwError = VmRESTSetHttpHeader(
-                      ppResponse,
-                      "Content-Length",
-                      dataLen
-                      );
-    }
-    else if (dataLen == NULL)
-    {
-        dwError = VmRESTSetHttpHeader(
-                      ppResponse,
-                      "Transfer-Encoding",
-                      "chunked"
-                      );
-    }
-    else
+    if (!pRESTHandle || IsNullOrEmptyString(pszSocketPath) || (pRESTHandle->instanceState != VMREST_INSTANCE_INITIALIZED))
     {
-        dwError = VMREST_HTTP_INVALID_PARAMS;
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
     }
     BAIL_ON_VMREST_ERROR(dwError);
 
+    dwError = VmwSockReceiveListenerFds(
+                  pRESTHandle,
+                  pszSocketPath,
+                  waitSeconds
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
 cleanup:
+
     return dwError;
+
 error:
+
     goto cleanup;
+
 }
 
 uint32_t
-VmRESTGetConnectionInfo(
-    PREST_REQUEST                    pRequest,
-    char**                           ppszIpAddress,
-    int*                             pPort
+VmRESTDispatchBuffer(
+    PVMREST_HANDLE                   pRESTHandle,
+    char const*                      pszRequest,
+    uint32_t                         nLen,
+    PREST_RESPONSE_SINK              pSink
     )
 {
     uint32_t                         dwError = REST_ENGINE_SUCCESS;
-    char*                            pszIpAddress = NULL;
 
-    if (!pRequest || !ppszIpAddress || !pPort)
+    if (!pRESTHandle || !pszRequest || (nLen == 0) || !pSink || !pSink->pfnWrite || (pRESTHandle->instanceState != VMREST_INSTANCE_STARTED))
     {
-        dwError = VMREST_HTTP_INVALID_PARAMS;
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
     }
     BAIL_ON_VMREST_ERROR(dwError);
 
-    dwError = VmRESTAllocateMemory(
-                  MAX_CLIENT_IP_ADDR_LEN,
-                  (void **)&pszIpAddress
+    dwError = VmRESTDispatchLoopback(
+                  pRESTHandle,
+                  pszRequest,
+                  nLen,
+                  pSink
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
-    strncpy(pszIpAddress, pRequest->clientIP, (MAX_CLIENT_IP_ADDR_LEN - 1));
-
-    *pPort = pRequest->clientPort;
-    *ppszIpAddress = pszIpAddress;
-
 cleanup:
 
     return dwError;
 
 error:
-    if (ppszIpAddress)
-    {
-        *ppszIpAddress = NULL;
-    }
 
     goto cleanup;
 
 }
+
+uint32_t
+VmRESTCreateEngineGroup(
+    uint32_t                         nWorkerThr,
+    PVMREST_ENGINE_GROUP*            ppEngineGroup
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    PVMREST_ENGINE_GROUP             pEngineGroup = NULL;
+    PVMREST_HANDLE                   pRESTHandle = NULL;
+
+    if (!ppEngineGroup)
+    {
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateMemory(
+                  sizeof(VMREST_ENGINE_GROUP),
+                  (void**)&pEngineGroup,
+                  REST_MEM_OTHER
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateNamedMutex(&pEngineGroup->pMutex, "engine_group");
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Group host is a handle of its own, it owns queue and workers ****/
+    dwError = VmRESTAllocateHandle(
+                  &pRESTHandle
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pRESTHandle->pEngineGroup = pEngineGroup;
+    pEngineGroup->pRESTHandle = pRESTHandle;
+
+    dwError = VmHTTPInitEngineGroup(
+                  pRESTHandle,
+                  nWorkerThr
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pRESTHandle->instanceState = VMREST_INSTANCE_INITIALIZED;
+
+    dwError = VmHTTPStart(
+                  pRESTHandle
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pRESTHandle->instanceState = VMREST_INSTANCE_STARTED;
+
+    *ppEngineGroup = pEngineGroup;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    if (pRESTHandle)
+    {
+        VmRESTFreeHandle(pRESTHandle);
+    }
+
+    if (pEngineGroup)
+    {
+        if (pEngineGroup->pMutex)
+        {
+            VmRESTFreeMutex(pEngineGroup->pMutex);
+        }
+        VmRESTFreeMemory(pEngineGroup, REST_MEM_OTHER);
+    }
+
+    if (ppEngineGroup)
+    {
+        *ppEngineGroup = NULL;
+    }
+
+    goto cleanup;
+}
+
+uint32_t
+VmRESTJoinEngineGroup(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVMREST_ENGINE_GROUP             pEngineGroup
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    PVMREST_IOBUF_POOL               pIOBufPool = NULL;
+    BOOLEAN                          bLocked = FALSE;
+
+    if (!pRESTHandle || !pEngineGroup || pRESTHandle->pEngineGroup || (pRESTHandle->instanceState != VMREST_INSTANCE_INITIALIZED))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTLockMutex(pEngineGroup->pMutex);
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    bLocked = TRUE;
+
+    /**** Responses of this instance are now written by group workers, size its buffer pool for them ****/
+    dwError = VmRESTCreateIOBufferPool(
+                  (pEngineGroup->pRESTHandle->pRESTConfig->nWorkerThr +
+                   VMREST_IOBUF_SPARE_SLOTS),
+                  pRESTHandle->pRESTConfig->useHugePages,
+                  &pIOBufPool
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if (pRESTHandle->pIOBufPool)
+    {
+        VmRESTFreeIOBufferPool(pRESTHandle->pIOBufPool);
+    }
+    pRESTHandle->pIOBufPool = pIOBufPool;
+
+    pRESTHandle->pEngineGroup = pEngineGroup;
+    pEngineGroup->nMembers++;
+
+    VMREST_LOG_INFO(pRESTHandle,"C-REST-ENGINE: Joined engine group with %u workers", pEngineGroup->pRESTHandle->pRESTConfig->nWorkerThr);
+
+cleanup:
+
+    if (bLocked)
+    {
+        VmRESTUnlockMutex(pEngineGroup->pMutex);
+    }
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+uint32_t
+VmRESTFreeEngineGroup(
+    PVMREST_ENGINE_GROUP             pEngineGroup,
+    uint32_t                         waitSeconds
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    PVMREST_HANDLE                   pRESTHandle = NULL;
+
+    if (!pEngineGroup || (waitSeconds > MAX_STOP_WAIT_SECONDS))
+    {
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Members still using queue and workers ****/
+    if (__atomic_load_n(&pEngineGroup->nMembers, __ATOMIC_ACQUIRE) > 0)
+    {
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pRESTHandle = pEngineGroup->pRESTHandle;
+
+    pRESTHandle->instanceState = VMREST_INSTANCE_STOPPING;
+
+    dwError = VmHTTPStop(
+                  pRESTHandle,
+                  waitSeconds
+                  );
+
+    pRESTHandle->instanceState = VMREST_INSTANCE_STOPPED;
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pRESTHandle->instanceState = VMREST_INSTANCE_SHUTDOWN;
+    VmHTTPShutdown(pRESTHandle);
+
+    VmRESTFreeMutex(pEngineGroup->pMutex);
+    VmRESTFreeMemory(pEngineGroup, REST_MEM_OTHER);
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+uint32_t
+VmRESTSetAllocator(
+    PREST_ALLOCATOR                  pAllocator
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+
+    dwError = VmRESTMemorySetAllocator(
+                  pAllocator
+                  );
+    if (dwError)
+    {
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+
+}
+
+uint32_t
+VmRESTGetMemoryStats(
+    PREST_MEMORY_STATS               pStats
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+
+    if (!pStats)
+    {
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    VmRESTMemoryGetStats(
+        pStats
+        );
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+
+}
+
+uint32_t
+VmRESTGetLockStats(
+    PREST_LOCK_STATS                 pStats,
+    uint32_t                         nMax,
+    uint32_t*                        pnCount
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+
+    if (!pnCount)
+    {
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTLockGetStats(
+                  pStats,
+                  nMax,
+                  pnCount
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+
+}
+
+uint32_t
+VmRESTReloadSSLContext(
+    PVMREST_HANDLE                   pRESTHandle,
+    char const*                      pszCertBuffer,
+    uint32_t                         certBufferSize,
+    char const*                      pszKeyBuffer,
+    uint32_t                         keyBufferSize
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRESTHandle || (pRESTHandle->instanceState != VMREST_INSTANCE_STARTED) ||
+        (pszCertBuffer && ((certBufferSize == 0) || (certBufferSize > MAX_SSL_DATA_BUF_LEN))) ||
+        (pszKeyBuffer && ((keyBufferSize == 0) || (keyBufferSize > MAX_SSL_DATA_BUF_LEN))))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmwSockReloadSSLContext(
+                  pRESTHandle,
+                  pszCertBuffer,
+                  certBufferSize,
+                  pszKeyBuffer,
+                  keyBufferSize
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+
+}
+
+uint32_t
+VmRESTSetSuccessResponse(
+    PREST_REQUEST                    pRequest,
+    PREST_RESPONSE*                  ppResponse
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    char*                            connection = NULL;
+
+    if (!pRequest || !ppResponse)
+    {
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTSetHttpStatusCode(
+                  ppResponse,
+                  "200"
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTSetHttpStatusVersion(
+                  ppResponse,
+                  "HTTP/1.1"
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTSetHttpReasonPhrase(
+                  ppResponse,
+                  "OK"
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTGetHttpHeader(
+                  pRequest,
+                  "Connection",
+                  &connection
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if ((connection != NULL) && ((strncmp(connection, "keep-alive", strlen("keep-alive")) == 0)))
+    {
+        dwError = VmRESTSetHttpHeader(
+                      ppResponse,
+                      "Connection",
+                      "keep-alive"
+                      );
+    }
+    else
+    {
+        dwError = VmRESTSetHttpHeader(
+                      ppResponse,
+                      "Connection",
+                      "close"
+                      );
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+    if (connection != NULL)
+    {
+        VmRESTFreeMemory(connection, REST_MEM_APP);
+        connection = NULL;
+    }
+    return dwError;
+error:
+    goto cleanup;
+
+}
+
+uint32_t
+VmRESTSetFailureResponse(
+    PREST_RESPONSE*                  ppResponse,
+    char const*                      pcszErrorCode,
+    char const*                      pcszErrorMessage
+    )
+{   
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    char                             errorCode[MAX_STATUS_LEN] = {0};
+    char                             errorMessage[MAX_REA_PHRASE_LEN] = {0};
+
+    memset(errorCode, '\0', MAX_STATUS_LEN);
+    memset(errorMessage, '\0', MAX_REA_PHRASE_LEN);
+
+    /**** If error code and message is not provided, send internal server error ****/
+
+    if (!pcszErrorCode)
+    {
+        strcpy(errorCode,"500");
+    }
+    else if ((strlen(pcszErrorCode) > 0) && (strlen(pcszErrorCode) <= MAX_STATUS_LEN))
+    {
+        strcpy(errorCode, pcszErrorCode);
+    }
+
+    if (!pcszErrorMessage)
+    {
+        strcpy(errorMessage, "Internal Server Error");
+    }
+    else if ((strlen(pcszErrorMessage) > 0) && (strlen(pcszErrorMessage) <= MAX_REA_PHRASE_LEN))
+    {
+        strcpy(errorMessage, pcszErrorMessage);
+    }
+
+    dwError = VmRESTSetHttpStatusCode(
+                  ppResponse,
+                  errorCode
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+    
+    dwError = VmRESTSetHttpStatusVersion(
+                  ppResponse,
+                  "HTTP/1.1"
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTSetHttpReasonPhrase(
+                  ppResponse,
+                  errorMessage
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTSetHttpHeader(
+                  ppResponse,
+                  "Connection",
+                  "close"
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+    return dwError;
+error:
+    goto cleanup;
+}
+
+uint32_t
+VmRESTSetDataLength(
+    PREST_RESPONSE*                  ppResponse,
+    char*                            dataLen
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+
+    if ((dataLen != NULL) && (atoi(dataLen) <= MAX_DATA_BUFFER_LEN))
+    {
+        dwError = VmRESTSetHttpHeader(
+                      ppResponse,
+                      "Content-Length",
+                      dataLen
+                      );
+    }
+    else if (dataLen == NULL)
+    {
+        dwError = VmRESTSetHttpHeader(
+                      ppResponse,
+                      "Transfer-Encoding",
+                      "chunked"
+                      );
+    }
+    else
+    {
+        dwError = VMREST_HTTP_INVALID_PARAMS;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+    return dwError;
+error:
+    goto cleanup;
+}
+
+uint32_t
+VmRESTGetConnectionInfo(
+    PREST_REQUEST                    pRequest,
+    char**                           ppszIpAddress,
+    int*                             pPort
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    char*                            pszIpAddress = NULL;
+
+    if (!pRequest || !ppszIpAddress || !pPort)
+    {
+        dwError = VMREST_HTTP_INVALID_PARAMS;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateMemory(
+                  MAX_CLIENT_IP_ADDR_LEN,
+                  (void **)&pszIpAddress,
+                  REST_MEM_APP
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    strncpy(pszIpAddress, pRequest->clientIP, (MAX_CLIENT_IP_ADDR_LEN - 1));
+
+    *pPort = pRequest->clientPort;
+    *ppszIpAddress = pszIpAddress;
+
+cleanup:
+
+    return dwError;
+
+error:
+    if (ppszIpAddress)
+    {
+        *ppszIpAddress = NULL;
+    }
+
+    goto cleanup;
+
+}
+
+uint32_t
+VmRESTGetConnectionPeerCredentials(
+    PREST_REQUEST                    pRequest,
+    int*                             pPid,
+    uint32_t*                        pUid,
+    uint32_t*                        pGid
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRequest || !pPid || !pUid || !pGid)
+    {
+        dwError = VMREST_HTTP_INVALID_PARAMS;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Only filled for connections on unix domain socket listener ****/
+    if (pRequest->clientPid < 0)
+    {
+        dwError = REST_ENGINE_NO_PEER_CREDENTIALS;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    *pPid = pRequest->clientPid;
+    *pUid = pRequest->clientUid;
+    *pGid = pRequest->clientGid;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+uint32_t
+VmRESTGetRequestTraceId(
+    PREST_REQUEST                    pRequest,
+    uint64_t*                        pTraceId
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRequest || !pTraceId)
+    {
+        dwError = VMREST_HTTP_INVALID_PARAMS;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    *pTraceId = pRequest->traceId;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+uint32_t
+VmRESTGetStats(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_STATS                      pStats
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRESTHandle || !pStats || !pRESTHandle->pMetrics)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmHTTPGetStats(
+                  pRESTHandle,
+                  pStats
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+uint32_t
+VmRESTGetRouteStats(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_ROUTE_STATS                pInfo,
+    uint32_t                         nMax,
+    uint32_t*                        pnCount
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRESTHandle || !pnCount || !pRESTHandle->pMetrics)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
+        dwError = REST_ENGINE_ERROR_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    VmRESTMetricsGetRouteStats(
+        pRESTHandle->pMetrics,
+        pInfo,
+        nMax,
+        pnCount
+        );
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+uint32_t
+VmRESTGetRequestTimings(
+    PREST_REQUEST                    pRequest,
+    PREST_REQUEST_TIMINGS            pTimings
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRequest || !pTimings)
+    {
+        dwError = VMREST_HTTP_INVALID_PARAMS;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    memcpy(pTimings, &pRequest->timings, sizeof(REST_REQUEST_TIMINGS));
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+uint32_t
+VmRESTReopenAccessLog(
+    PVMREST_HANDLE                   pRESTHandle
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRESTHandle || !pRESTHandle->pAccessLog)
+    {
+        dwError = REST_ENGINE_FAILURE;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    VmRESTAccessLogReopen(pRESTHandle->pAccessLog);
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
@@ -124,6 +124,28 @@ VmRESTSetHttpPayloadZeroCopy(
     uint32_t                         nBytes
     );
 
+uint32_t
+VmRESTSetHttpPayloadFromFile(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_RESPONSE*                  ppResponse,
+    int                              fd,
+    uint64_t                         offset,
+    uint32_t                         nBytes
+    );
+
+void
+VmRESTTraceSelectRequest(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_REST_HTTP_REQUEST_PACKET     pRequest,
+    BOOLEAN                          bNewRequest
+    );
+
+REST_CPU_PHASE
+VmRESTCpuSwitch(
+    PVM_REST_HTTP_REQUEST_PACKET     pRequest,
+    REST_CPU_PHASE                   phase
+    );
+
 /***************** httpAllocStruct.c  *************/
 
 uint32_t
@@ -161,6 +183,11 @@ VmRESTFreeHandle(
      PVMREST_HANDLE                  pRESTHandle
      );
 
+void
+VmRESTFreeSSLBuffers(
+     PVM_SOCK_SSL_INFO               pSSLInfo
+     );
+
 /***************** httpUtilsInternal.c ************/
 
 uint32_t
@@ -350,6 +377,12 @@ VmHTTPInit(
     PREST_CONF                       pConfig
     );
 
+uint32_t
+VmHTTPInitEngineGroup(
+    PVMREST_HANDLE                   pRESTHandle,
+    uint32_t                         nWorkerThr
+    );
+
 uint32_t
 VmHTTPStart(
     PVMREST_HANDLE                   pRESTHandle
@@ -377,6 +410,25 @@ VmHTTPShutdown(
     PVMREST_HANDLE                   pRESTHandle
     );
 
+uint32_t
+VmHTTPGetStats(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_STATS                      pStats
+    );
+
+/***************** httpStatsShm.c  ************/
+
+uint32_t
+VmRESTCreateStatsPublisher(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVMREST_STATS_PUBLISHER*         ppPublisher
+    );
+
+void
+VmRESTFreeStatsPublisher(
+    PVMREST_STATS_PUBLISHER          pPublisher
+    );
+
 /********************* httpValidate.c *******************/
 
 uint32_t
@@ -27,20 +27,24 @@ VmRestEngineHandler(
     uint32_t                         dwError = REST_ENGINE_SUCCESS;
     uint32_t                         paramsCount = 0;
     PREST_ENDPOINT                   pEndPoint = NULL;
+    REST_CPU_PHASE                   prevPhase = REST_CPU_PHASE_COUNT;
 
     VMREST_LOG_DEBUG(pRESTHandle,"%s","Internal Handler called");
 
     /**** 1. Allocate the memory of holding URI *****/
 
-    dwError = VmRESTAllocateMemory(
+    /**** Both URI buffers are cleared right before use ****/
+    dwError = VmRESTAllocateMemoryNoZero(
                   MAX_URI_LEN,
-                  (void**)&endPointURI
+                  (void**)&endPointURI,
+                  REST_MEM_REQUEST
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
-    dwError = VmRESTAllocateMemory(
+    dwError = VmRESTAllocateMemoryNoZero(
                   MAX_URI_LEN,
-                  (void**)&httpURI
+                  (void**)&httpURI,
+                  REST_MEM_REQUEST
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -55,7 +59,7 @@ VmRestEngineHandler(
     strncpy(httpMethod,ptr, (MAX_METHOD_LEN - 1));
     if (ptr != NULL)
     {
-        VmRESTFreeMemory(ptr);
+        VmRESTFreeMemory(ptr, REST_MEM_APP);
         ptr = NULL;
     }
     VMREST_LOG_DEBUG(pRESTHandle,"HTTP method %s", httpMethod);
@@ -72,7 +76,7 @@ VmRestEngineHandler(
     strncpy(httpURI,ptr,(MAX_URI_LEN - 1));
     if (ptr != NULL)
     {
-        VmRESTFreeMemory(ptr);
+        VmRESTFreeMemory(ptr, REST_MEM_APP);
         ptr = NULL;
     }
 
@@ -88,7 +92,7 @@ VmRestEngineHandler(
     strncpy(endPointURI,ptr,(MAX_URI_LEN - 1));
     if (ptr != NULL)
     {
-        free(ptr);
+        VmRESTFreeMemory(ptr, REST_MEM_APP);
         ptr = NULL;
     }
 
@@ -103,6 +107,8 @@ VmRestEngineHandler(
 
     VMREST_LOG_DEBUG(pRESTHandle,"EndPoint found for URI %s",endPointURI);
 
+    pRequest->metricsRouteId = pEndPoint->metricsRouteId;
+
     /**** 5. Get Params count ****/
 
     dwError = VmRestGetParamsCountInReqURI(
@@ -129,6 +135,8 @@ VmRestEngineHandler(
 
     /**** 7. Give App CB based on HTTP method and registered endpoint ****/
 
+    prevPhase = VmRESTCpuSwitch(pRequest, REST_CPU_HANDLER);
+
     if (strcmp(httpMethod,"GET") == 0)
     {
         if (pEndPoint && pEndPoint->pHandler && pEndPoint->pHandler->pfnHandleRead)
@@ -196,17 +204,19 @@ VmRestEngineHandler(
         VMREST_LOG_ERROR(pRESTHandle,"CRUD on resource %s not allowed",endPointURI);
         dwError = VMREST_HTTP_INVALID_PARAMS;
     }
+
+    VmRESTCpuSwitch(pRequest, prevPhase);
     BAIL_ON_VMREST_ERROR(dwError);
 
 cleanup:
     if (endPointURI != NULL)
     {
-        VmRESTFreeMemory(endPointURI);
+        VmRESTFreeMemory(endPointURI, REST_MEM_REQUEST);
         endPointURI = NULL;
     }
     if (httpURI != NULL)
     {
-        VmRESTFreeMemory(httpURI);
+        VmRESTFreeMemory(httpURI, REST_MEM_REQUEST);
         httpURI = NULL;
     }
     return dwError;
@@ -361,6 +371,10 @@ VmRestEngineAddEndpoint(
         pEndPoint->pHandler->pfnHandleRead = pHandler->pfnHandleRead;
         pEndPoint->pHandler->pfnHandleOthers = pHandler->pfnHandleOthers;
         pEndPoint->next = NULL;
+        pEndPoint->metricsRouteId = VmRESTMetricsGetRouteId(
+                                        pRESTHandle->pMetrics,
+                                        pEndPointURI
+                                        );
     }
     else
     {
@@ -885,13 +899,15 @@ VmRESTGetParamsByIndex(
 
     dwError = VmRESTAllocateMemory(
                   MAX_KEY_VAL_PARAM_LEN,
-                  (void **)&pszKey
+                  (void **)&pszKey,
+                  REST_MEM_APP
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
     dwError = VmRESTAllocateMemory(
                   MAX_KEY_VAL_PARAM_LEN,
-                  (void **)&pszValue              
+                  (void **)&pszValue,
+                  REST_MEM_APP
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -924,12 +940,12 @@ cleanup:
 error:
     if (pszKey != NULL)
     {
-        VmRESTFreeMemory(pszKey);
+        VmRESTFreeMemory(pszKey, REST_MEM_APP);
         pszKey = NULL;
     }
     if (pszValue != NULL)
     {
-        VmRESTFreeMemory(pszValue);
+        VmRESTFreeMemory(pszValue, REST_MEM_APP);
         pszValue = NULL;
     }
     if (ppszKey != NULL)
@@ -967,13 +983,15 @@ VmRESTGetWildCardCount(
 
     dwError = VmRESTAllocateMemory(
                   MAX_URI_LEN,
-                  (void**)&endPointURI
+                  (void**)&endPointURI,
+                  REST_MEM_REQUEST
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
     dwError = VmRESTAllocateMemory(
                   MAX_URI_LEN,
-                  (void**)&httpURI
+                  (void**)&httpURI,
+                  REST_MEM_REQUEST
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -986,7 +1004,7 @@ VmRESTGetWildCardCount(
     strncpy(httpURI,ptr,(MAX_URI_LEN - 1));
     if (ptr != NULL)
     {
-        VmRESTFreeMemory(ptr);
+        VmRESTFreeMemory(ptr, REST_MEM_APP);
         ptr = NULL;
     }
     
@@ -998,7 +1016,7 @@ VmRESTGetWildCardCount(
     strncpy(endPointURI, ptr, (MAX_URI_LEN - 1));
     if (ptr != NULL)
     {
-        VmRESTFreeMemory(ptr);
+        VmRESTFreeMemory(ptr, REST_MEM_APP);
         ptr = NULL;    
     }
 
@@ -1025,12 +1043,12 @@ VmRESTGetWildCardCount(
 cleanup:
     if (endPointURI != NULL)
     {
-        VmRESTFreeMemory(endPointURI);
+        VmRESTFreeMemory(endPointURI, REST_MEM_REQUEST);
         endPointURI = NULL;
     }
     if (httpURI != NULL)
     {
-        VmRESTFreeMemory(httpURI);
+        VmRESTFreeMemory(httpURI, REST_MEM_REQUEST);
         httpURI = NULL;
     }
 
@@ -1070,13 +1088,15 @@ VmRESTGetWildCardByIndex(
 
     dwError = VmRESTAllocateMemory(
                   MAX_URI_LEN,
-                  (void**)&endPointURI
+                  (void**)&endPointURI,
+                  REST_MEM_REQUEST
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
     dwError = VmRESTAllocateMemory(
                   MAX_URI_LEN,
-                  (void**)&httpURI
+                  (void**)&httpURI,
+                  REST_MEM_REQUEST
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -1096,7 +1116,8 @@ VmRESTGetWildCardByIndex(
 
     dwError = VmRESTAllocateMemory(
                   MAX_URI_LEN,
-                  (void **)&pszWildCard
+                  (void **)&pszWildCard,
+                  REST_MEM_APP
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -1112,7 +1133,7 @@ VmRESTGetWildCardByIndex(
     strncpy(httpURI,ptr,(MAX_URI_LEN - 1));
     if (ptr != NULL)
     {
-        VmRESTFreeMemory(ptr);
+        VmRESTFreeMemory(ptr, REST_MEM_APP);
         ptr = NULL;
     }
 
@@ -1124,7 +1145,7 @@ VmRESTGetWildCardByIndex(
     strncpy(endPointURI,ptr,(MAX_URI_LEN - 1));
     if (ptr != NULL)
     {
-        VmRESTFreeMemory(ptr);
+        VmRESTFreeMemory(ptr, REST_MEM_APP);
         ptr = NULL;
     }
 
@@ -1157,19 +1178,19 @@ VmRESTGetWildCardByIndex(
 cleanup:
     if (endPointURI != NULL)
     {
-        VmRESTFreeMemory(endPointURI);
+        VmRESTFreeMemory(endPointURI, REST_MEM_REQUEST);
         endPointURI = NULL;
     }
     if (httpURI != NULL)
     {
-        VmRESTFreeMemory(httpURI);
+        VmRESTFreeMemory(httpURI, REST_MEM_REQUEST);
         httpURI = NULL;
     }
     return dwError;
 error:
     if (pszWildCard)
     {
-        VmRESTFreeMemory(pszWildCard);
+        VmRESTFreeMemory(pszWildCard, REST_MEM_APP);
         pszWildCard = NULL;
     }
     goto cleanup;
@@ -1202,7 +1223,8 @@ VmRestGetEndPointURIfromRequestURI(
 
     dwError = VmRESTAllocateMemory(
                   MAX_URI_LEN,
-                  (void **)&pszEndPointURI
+                  (void **)&pszEndPointURI,
+                  REST_MEM_APP
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -1234,7 +1256,7 @@ cleanup:
 error:
     if (pszEndPointURI != NULL)
     {
-        VmRESTFreeMemory(pszEndPointURI);
+        VmRESTFreeMemory(pszEndPointURI, REST_MEM_APP);
         pszEndPointURI = NULL;
     }
     if (ppszEndPointURI)
@@ -67,6 +67,16 @@ typedef struct _MISC_HEADER_QUEUE {
 
 }MISC_HEADER_QUEUE, *PMISC_HEADER_QUEUE;
 
+/**** Thread CPU of a sampled request, time since lastNs goes to phase.
+      REST_CPU_PHASE_COUNT as phase means no phase is running ****/
+typedef struct _VMREST_REQUEST_CPU
+{
+    BOOLEAN                          bSampled;
+    REST_CPU_PHASE                   phase;
+    uint64_t                         lastNs;
+    uint64_t                         cpuNs[REST_CPU_PHASE_COUNT];
+} VMREST_REQUEST_CPU, *PVMREST_REQUEST_CPU;
+
 typedef struct _VM_REST_HTTP_REQUEST_PACKET
 {
     PVM_REST_HTTP_REQUEST_LINE       requestLine;
@@ -82,7 +92,17 @@ typedef struct _VM_REST_HTTP_REQUEST_PACKET
     char*                            pszPayload;
     int                              clientPort;
     char                             clientIP[MAX_CLIENT_IP_ADDR_LEN];
+    int                              clientPid;
+    uint32_t                         clientUid;
+    uint32_t                         clientGid;
     uint32_t                         nBytesGetPayload;
+    uint64_t                         traceId;
+    uint32_t                         metricsRouteId;
+    uint32_t                         nConnRequests;
+    uint64_t                         nBytesIn;
+    uint64_t                         nBytesOut;
+    REST_REQUEST_TIMINGS             timings;
+    VMREST_REQUEST_CPU               cpu;
 
 }VM_REST_HTTP_REQUEST_PACKET, *PVM_REST_HTTP_REQUEST_PACKET;
 
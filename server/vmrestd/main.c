@@ -36,6 +36,7 @@ char* configPath1 = "/tmp/restconfig1.txt";
 
 PVMREST_HANDLE  gpRESTHandle = NULL;
 PVMREST_HANDLE  gpRESTHandle1 = NULL;
+PVMREST_ENGINE_GROUP gpEngineGroup = NULL;
 
 REST_PROCESSOR gVmRestHandlers;
 REST_PROCESSOR gVmRestHandlers1;
@@ -53,20 +54,44 @@ void sig_handler(int signo)
   {
       /* Do nothing */
   }
+  else if (signo == SIGHUP)
+  {
+      /* logrotate has moved access logs away */
+      VmRESTReopenAccessLog(gpRESTHandle);
+      VmRESTReopenAccessLog(gpRESTHandle1);
+  }
 }
 #endif
 
-int main()
+int main(int argc, char* argv[])
 {
     uint32_t                         dwError = 0;
     PREST_CONF                       pConfig = NULL;
     PREST_CONF                       pConfig1 = NULL;
     SSL_CTX*                         sslCtx = NULL;
+    char*                            pszAccessLogFile = NULL;
+    int                              opt = 0;
 //    SSL_CTX*                         sslCtx1 = NULL;
 //    uint32_t                         cnt = 0;
 
 #ifndef WIN32
+    /**** Access log stays off unless a file is given ****/
+    while ((opt = getopt(argc, argv, "a:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'a':
+                pszAccessLogFile = optarg;
+                break;
+
+            default:
+                fprintf(stderr, "Usage: %s [-a access-log-file]\n", argv[0]);
+                return 1;
+        }
+    }
+
     signal(SIGPIPE, sig_handler);
+    signal(SIGHUP, sig_handler);
 #endif
 
     gVmRestHandlers.pfnHandleRequest = NULL;
@@ -93,6 +118,7 @@ int main()
 #endif
 
     pConfig = (PREST_CONF)malloc(sizeof(REST_CONF));
+    VmRESTInitConfig(pConfig);
     pConfig->serverPort = 81;
     pConfig->connTimeoutSec = 5;
     pConfig->maxDataPerConnMB = 0;
@@ -108,9 +134,11 @@ int main()
     pConfig->pSSLContext = sslCtx;
     pConfig->pszSSLCipherList = NULL;
     pConfig->SSLCtxOptionsFlag = 0;
+    pConfig->pszAccessLogFile = pszAccessLogFile;
 
 
     pConfig1 = (PREST_CONF)malloc(sizeof(REST_CONF));
+    VmRESTInitConfig(pConfig1);
     pConfig1->serverPort = 82;
     pConfig1->connTimeoutSec = 5;
     pConfig1->maxDataPerConnMB = 10;
@@ -134,6 +162,11 @@ int main()
     dwError = VmRESTInit(pConfig, &gpRESTHandle);
     dwError = VmRESTInit(pConfig1, &gpRESTHandle1);
 
+    /**** Both instances share one set of worker threads, one per CPU ****/
+    dwError = VmRESTCreateEngineGroup(0, &gpEngineGroup);
+    dwError = VmRESTJoinEngineGroup(gpRESTHandle, gpEngineGroup);
+    dwError = VmRESTJoinEngineGroup(gpRESTHandle1, gpEngineGroup);
+
 
 // test set SSL info API
 #if 0 
@@ -173,6 +206,8 @@ int main()
     VmRESTShutdown(gpRESTHandle);
     VmRESTShutdown(gpRESTHandle1);
 
+    dwError = VmRESTFreeEngineGroup(gpEngineGroup, 10);
+
     free(pConfig);
     free(pConfig1);
 
@@ -0,0 +1,80 @@
+# !/bin/bash
+# Server memory held by idle keep-alive connections. Clients open
+# connections, make one request on each and keep them open. The growth of the
+# server VmRSS divided by the number of connections is the cost of one idle
+# connection, plain and TLS. Client limit is kept at 4 times the connections,
+# below half of it idle timeout does not shrink and close any of them.
+TOPDIR=`pwd`
+SRCDIR=${SRCDIR:-$TOPDIR/../..}
+INCDIR=${INCDIR:-$SRCDIR/include/public}
+LIBDIR=${LIBDIR:-$SRCDIR/server/restengine/.libs}
+CLIENTLIBDIR=${CLIENTLIBDIR:-$SRCDIR/client/.libs}
+WORKDIR=$TOPDIR/data/out/benchidlememory
+PORT="8093"
+CONNS=${CONNS:-2000}
+
+rm -rf $WORKDIR
+mkdir -p $WORKDIR
+
+# Compile from source in the same directory
+gcc -O2 -o $TOPDIR/BenchServer $TOPDIR/benchserver.c -I$INCDIR -L$LIBDIR -lrestengine -lssl -lcrypto -lpthread -Wl,-rpath,$LIBDIR
+gcc -O2 -o $TOPDIR/BenchClient $TOPDIR/benchclient.c -I$INCDIR -L$CLIENTLIBDIR -lvmrestclient -lssl -lcrypto -lpthread -Wl,-rpath,$CLIENTLIBDIR
+
+openssl req -x509 -newkey ec -pkeyopt ec_paramgen_curve:prime256v1 -nodes -days 1 -subj "/CN=bench" -keyout $WORKDIR/key.pem -out $WORKDIR/cert.pem 2> /dev/null
+
+rsskb()
+{
+   awk '/VmRSS/ { print $2 }' /proc/$1/status
+}
+
+sockets()
+{
+   ls -l /proc/$1/fd | grep -c socket
+}
+
+# run <test number> <name> <server options> <client options>
+run()
+{
+   $TOPDIR/BenchServer -p $PORT -C `expr $CONNS \* 4` -l $WORKDIR/server.log $3 > $WORKDIR/server.txt &
+   SERVERPID=$!
+   sleep 1
+
+   # Warm up, so that workers and buffers reused by every connection are
+   # already counted in the base
+   timeout 60 $TOPDIR/BenchClient -p $PORT -c 4 -n 200 $4 > /dev/null
+   sleep 1
+   BASE=`rsskb $SERVERPID`
+   BASESOCKETS=`sockets $SERVERPID`
+
+   timeout 300 $TOPDIR/BenchClient -p $PORT -c $CONNS -i 5 $4 > $WORKDIR/client.txt &
+   CLIENTPID=$!
+   i=0
+   while [ $i -lt 240 ] && ! grep -q held $WORKDIR/client.txt
+   do
+      sleep 0.5
+      i=`expr $i + 1`
+   done
+   sleep 1
+   LOADED=`rsskb $SERVERPID`
+   OPEN=`expr \`sockets $SERVERPID\` - $BASESOCKETS`
+   wait $CLIENTPID
+
+   echo "RESULT $2: connections $OPEN base-kb $BASE loaded-kb $LOADED bytes/connection `awk -v b=$BASE -v l=$LOADED -v n=$OPEN 'BEGIN { printf "%d", n ? (l - b) * 1024 / n : 0 }'`"
+
+   if [ $OPEN -eq $CONNS ]
+   then
+      echo "PASSED-TEST $1: $2"
+   else
+      echo "FAILED-TEST $1: $2"
+   fi
+
+   kill $SERVERPID
+   wait $SERVERPID
+}
+
+run 1 "plain idle" "" ""
+run 2 "tls idle" "-c $WORKDIR/cert.pem -k $WORKDIR/key.pem" "-s"
+
+rm -f $TOPDIR/BenchServer
+rm -f $TOPDIR/BenchClient
+rm -rf $WORKDIR
@@ -0,0 +1,15 @@
+# !/bin/bash
+# Cost of taking and releasing library locks with lock profiling off and on,
+# uncontended and with 2 threads on one lock. Built against library internal
+# headers, so it has to run in a configured source tree.
+TOPDIR=`pwd`
+SRCDIR=${SRCDIR:-$TOPDIR/../..}
+LIBDIR=${LIBDIR:-$SRCDIR/server/restengine/.libs}
+LOOPS=${LOOPS:-5000000}
+
+# Compile from source in the same directory
+gcc -O2 -o $TOPDIR/LockCost $TOPDIR/lockcost.c -I$SRCDIR -I$SRCDIR/include -I$SRCDIR/include/public -L$LIBDIR -lrestengine -lssl -lcrypto -lpthread -Wl,-rpath,$LIBDIR
+
+timeout 300 $TOPDIR/LockCost $LOOPS
+
+rm -f $TOPDIR/LockCost
@@ -0,0 +1,22 @@
+# !/bin/bash
+# Latency of the first log call of a new thread, which registers its ring
+# under the logger mutex, while flood threads keep the async log flusher
+# busy, and that every flood record is either written or reported dropped.
+# Built against library internal headers, so it has to run in a configured
+# source tree.
+TOPDIR=`pwd`
+SRCDIR=${SRCDIR:-$TOPDIR/../..}
+LIBDIR=${LIBDIR:-$SRCDIR/server/restengine/.libs}
+WORKDIR=$TOPDIR/data/out/benchlogflusher
+THREADS=${THREADS:-500}
+
+rm -rf $WORKDIR
+mkdir -p $WORKDIR
+
+# Compile from source in the same directory
+gcc -O2 -o $TOPDIR/LogFlusher $TOPDIR/logflusher.c -I$SRCDIR -I$SRCDIR/include -I$SRCDIR/include/public -L$LIBDIR -lrestengine -lssl -lcrypto -lpthread -Wl,-rpath,$LIBDIR
+
+timeout 300 $TOPDIR/LogFlusher $WORKDIR/rest.log $THREADS
+
+rm -f $TOPDIR/LogFlusher
+rm -rf $WORKDIR
@@ -0,0 +1,21 @@
+# !/bin/bash
+# Cost of log calls below the configured level, of a flood of rate limited
+# errors and of errors written, against calling VmRESTLog() directly as all
+# call sites did before the level was checked inline. Built against library
+# internal headers, so it has to run in a configured source tree.
+TOPDIR=`pwd`
+SRCDIR=${SRCDIR:-$TOPDIR/../..}
+LIBDIR=${LIBDIR:-$SRCDIR/server/restengine/.libs}
+WORKDIR=$TOPDIR/data/out/benchloglevel
+CALLS=${CALLS:-10000000}
+
+rm -rf $WORKDIR
+mkdir -p $WORKDIR
+
+# Compile from source in the same directory
+gcc -O2 -o $TOPDIR/LogLevel $TOPDIR/loglevel.c -I$SRCDIR -I$SRCDIR/include -I$SRCDIR/include/public -L$LIBDIR -lrestengine -lssl -lcrypto -lpthread -Wl,-rpath,$LIBDIR
+
+timeout 300 $TOPDIR/LogLevel $WORKDIR/rest.log $CALLS
+
+rm -f $TOPDIR/LogLevel
+rm -rf $WORKDIR
@@ -0,0 +1,62 @@
+# !/bin/bash
+# Throughput of large responses: body from memory (VmRESTSetDataZC) against
+# body from file (VmRESTSetDataFromFile), on plain HTTP and on TLS with and
+# without kernel TLS. kTLS needs the kernel tls module, without it the -K run
+# shows the user space fallback.
+TOPDIR=`pwd`
+SRCDIR=${SRCDIR:-$TOPDIR/../..}
+INCDIR=${INCDIR:-$SRCDIR/include/public}
+LIBDIR=${LIBDIR:-$SRCDIR/server/restengine/.libs}
+CLIENTLIBDIR=${CLIENTLIBDIR:-$SRCDIR/client/.libs}
+WORKDIR=$TOPDIR/data/out/benchsendfile
+PORT="8090"
+SIZE=${SIZE:-8388608}
+REQUESTS=${REQUESTS:-40}
+
+rm -rf $WORKDIR
+mkdir -p $WORKDIR
+
+# Compile from source in the same directory
+gcc -O2 -o $TOPDIR/BenchServer $TOPDIR/benchserver.c -I$INCDIR -L$LIBDIR -lrestengine -lssl -lcrypto -lpthread -Wl,-rpath,$LIBDIR
+gcc -O2 -o $TOPDIR/BenchClient $TOPDIR/benchclient.c -I$INCDIR -L$CLIENTLIBDIR -lvmrestclient -lssl -lcrypto -lpthread -Wl,-rpath,$CLIENTLIBDIR
+
+openssl req -x509 -newkey rsa:2048 -nodes -days 1 -subj "/CN=bench" -keyout $WORKDIR/key.pem -out $WORKDIR/cert.pem 2> /dev/null
+dd if=/dev/urandom of=$WORKDIR/payload.bin bs=$SIZE count=1 2> /dev/null
+
+if [ -e /proc/net/tls_stat ]
+then
+   echo "kernel tls module: loaded"
+else
+   echo "kernel tls module: not loaded"
+fi
+
+# run <test number> <name> <server options> <client options>
+run()
+{
+   $TOPDIR/BenchServer -p $PORT -z $SIZE -f $WORKDIR/payload.bin -l $WORKDIR/server.log $3 > $WORKDIR/server.txt &
+   SERVERPID=$!
+   sleep 1
+
+   RESULT=`timeout 120 $TOPDIR/BenchClient -p $PORT -c 1 -n $REQUESTS $4`
+   echo "RESULT $2: $RESULT"
+
+   if [ -n "$RESULT" ] && [ "`echo $RESULT | awk '{print $4}'`" = "0" ]
+   then
+      echo "PASSED-TEST $1: $2"
+   else
+      echo "FAILED-TEST $1: $2"
+   fi
+
+   kill $SERVERPID
+   wait $SERVERPID
+}
+
+run 1 "plain memory" "" "-P /v1/mem"
+run 2 "plain sendfile" "" "-P /v1/file"
+run 3 "tls memory" "-c $WORKDIR/cert.pem -k $WORKDIR/key.pem" "-s -P /v1/mem"
+run 4 "tls file" "-c $WORKDIR/cert.pem -k $WORKDIR/key.pem" "-s -P /v1/file"
+run 5 "ktls file" "-c $WORKDIR/cert.pem -k $WORKDIR/key.pem -K" "-s -P /v1/file"
+
+rm -f $TOPDIR/BenchServer
+rm -f $TOPDIR/BenchClient
+rm -rf $WORKDIR
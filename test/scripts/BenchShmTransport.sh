@@ -0,0 +1,51 @@
+# !/bin/bash
+# Requests per second and latency of small requests over a shared memory
+# channel, against a Unix domain socket and loopback TCP to the same
+# instance. One client, then 4 clients at once.
+TOPDIR=`pwd`
+SRCDIR=${SRCDIR:-$TOPDIR/../..}
+INCDIR=${INCDIR:-$SRCDIR/include/public}
+LIBDIR=${LIBDIR:-$SRCDIR/server/restengine/.libs}
+CLIENTLIBDIR=${CLIENTLIBDIR:-$SRCDIR/client/.libs}
+WORKDIR=$TOPDIR/data/out/benchshmtransport
+PORT="8095"
+REQUESTS=${REQUESTS:-20000}
+
+rm -rf $WORKDIR
+mkdir -p $WORKDIR
+
+# Compile from source in the same directory
+gcc -O2 -o $TOPDIR/BenchServer $TOPDIR/benchserver.c -I$INCDIR -L$LIBDIR -lrestengine -lssl -lcrypto -lpthread -Wl,-rpath,$LIBDIR
+gcc -O2 -o $TOPDIR/BenchClient $TOPDIR/benchclient.c -I$INCDIR -L$CLIENTLIBDIR -lvmrestclient -lssl -lcrypto -lpthread -Wl,-rpath,$CLIENTLIBDIR
+
+$TOPDIR/BenchServer -p $PORT -u $WORKDIR/rest.sock -m $WORKDIR/shm.sock -l $WORKDIR/server.log > $WORKDIR/server.txt &
+SERVERPID=$!
+sleep 1
+
+# run <test number> <name> <clients> <client options>
+run()
+{
+   RESULT=`timeout 300 $TOPDIR/BenchClient -c $3 -n $REQUESTS -P /v1/small $4`
+   echo "RESULT $2: $RESULT"
+
+   if [ -n "$RESULT" ] && [ "`echo $RESULT | awk '{print $4}'`" = "0" ]
+   then
+      echo "PASSED-TEST $1: $2"
+   else
+      echo "FAILED-TEST $1: $2"
+   fi
+}
+
+run 1 "tcp 1 client" 1 "-p $PORT"
+run 2 "unix 1 client" 1 "-u $WORKDIR/rest.sock"
+run 3 "shm 1 client" 1 "-M $WORKDIR/shm.sock"
+run 4 "tcp 4 clients" 4 "-p $PORT"
+run 5 "unix 4 clients" 4 "-u $WORKDIR/rest.sock"
+run 6 "shm 4 clients" 4 "-M $WORKDIR/shm.sock"
+
+kill $SERVERPID
+wait $SERVERPID
+
+rm -f $TOPDIR/BenchServer
+rm -f $TOPDIR/BenchClient
+rm -rf $WORKDIR
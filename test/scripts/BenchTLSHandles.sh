@@ -0,0 +1,64 @@
+# !/bin/bash
+# Contention of TLS instances in one process. The same number of clients
+# handshake and send one request per connection, against one instance and
+# against 2 and 4 instances sharing a certificate (and so one SSL_CTX).
+# Aggregate handshakes per second should not drop as instances are added.
+TOPDIR=`pwd`
+SRCDIR=${SRCDIR:-$TOPDIR/../..}
+INCDIR=${INCDIR:-$SRCDIR/include/public}
+LIBDIR=${LIBDIR:-$SRCDIR/server/restengine/.libs}
+CLIENTLIBDIR=${CLIENTLIBDIR:-$SRCDIR/client/.libs}
+WORKDIR=$TOPDIR/data/out/benchtlshandles
+PORT="8091"
+CLIENTS=4
+REQUESTS=${REQUESTS:-300}
+
+rm -rf $WORKDIR
+mkdir -p $WORKDIR
+
+# Compile from source in the same directory
+gcc -O2 -o $TOPDIR/BenchServer $TOPDIR/benchserver.c -I$INCDIR -L$LIBDIR -lrestengine -lssl -lcrypto -lpthread -Wl,-rpath,$LIBDIR
+gcc -O2 -o $TOPDIR/BenchClient $TOPDIR/benchclient.c -I$INCDIR -L$CLIENTLIBDIR -lvmrestclient -lssl -lcrypto -lpthread -Wl,-rpath,$CLIENTLIBDIR
+
+openssl req -x509 -newkey ec -pkeyopt ec_paramgen_curve:prime256v1 -nodes -days 1 -subj "/CN=bench" -keyout $WORKDIR/key.pem -out $WORKDIR/cert.pem 2> /dev/null
+
+# run <test number> <instances>
+run()
+{
+   $TOPDIR/BenchServer -p $PORT -H $2 -c $WORKDIR/cert.pem -k $WORKDIR/key.pem -l $WORKDIR/server.log > $WORKDIR/server.txt &
+   SERVERPID=$!
+   sleep 1
+
+   # Clients spread round robin over instances
+   i=0
+   CLIENTPIDS=""
+   while [ $i -lt $CLIENTS ]
+   do
+      timeout 120 $TOPDIR/BenchClient -p `expr $PORT + $i % $2` -s -N -c 1 -n $REQUESTS > $WORKDIR/client$i.txt &
+      CLIENTPIDS="$CLIENTPIDS $!"
+      i=`expr $i + 1`
+   done
+   wait $CLIENTPIDS
+
+   RESULT=`cat $WORKDIR/client*.txt | awk '{ n += $2; e += $4; r += $8; if ($10 > p) p = $10 } END { printf "connections %d errors %d handshakes/s %.0f worst-p50-us %d", n, e, r, p }'`
+   echo "RESULT $2 instances: $RESULT"
+
+   if [ "`echo $RESULT | awk '{print $4}'`" = "0" ]
+   then
+      echo "PASSED-TEST $1: $2 TLS instances"
+   else
+      echo "FAILED-TEST $1: $2 TLS instances"
+   fi
+
+   kill $SERVERPID
+   wait $SERVERPID
+   rm -f $WORKDIR/client*.txt
+}
+
+run 1 1
+run 2 2
+run 3 4
+
+rm -f $TOPDIR/BenchServer
+rm -f $TOPDIR/BenchClient
+rm -rf $WORKDIR
@@ -0,0 +1,66 @@
+# !/bin/bash
+# Time to first body byte over TLS on a slow link, with the default record
+# size ramp against full size records from the start (-R 1). The link is
+# netem on loopback when available, otherwise the client emulates it (-L).
+TOPDIR=`pwd`
+SRCDIR=${SRCDIR:-$TOPDIR/../..}
+INCDIR=${INCDIR:-$SRCDIR/include/public}
+LIBDIR=${LIBDIR:-$SRCDIR/server/restengine/.libs}
+CLIENTLIBDIR=${CLIENTLIBDIR:-$SRCDIR/client/.libs}
+WORKDIR=$TOPDIR/data/out/benchtlsrecordsize
+PORT="8092"
+SIZE=${SIZE:-262144}
+REQUESTS=${REQUESTS:-20}
+KBPS=${KBPS:-2000}
+DELAYMS=${DELAYMS:-40}
+
+rm -rf $WORKDIR
+mkdir -p $WORKDIR
+
+# Compile from source in the same directory
+gcc -O2 -o $TOPDIR/BenchServer $TOPDIR/benchserver.c -I$INCDIR -L$LIBDIR -lrestengine -lssl -lcrypto -lpthread -Wl,-rpath,$LIBDIR
+gcc -O2 -o $TOPDIR/BenchClient $TOPDIR/benchclient.c -I$INCDIR -L$CLIENTLIBDIR -lvmrestclient -lssl -lcrypto -lpthread -Wl,-rpath,$CLIENTLIBDIR
+
+openssl req -x509 -newkey ec -pkeyopt ec_paramgen_curve:prime256v1 -nodes -days 1 -subj "/CN=bench" -keyout $WORKDIR/key.pem -out $WORKDIR/cert.pem 2> /dev/null
+
+if tc qdisc add dev lo root netem delay ${DELAYMS}ms rate ${KBPS}kbit 2> /dev/null
+then
+   echo "link: netem on lo, $KBPS kbit/s, $DELAYMS ms"
+   LINK=""
+else
+   echo "link: netem not available, client emulated, $KBPS kbit/s, $DELAYMS ms"
+   LINK="-L $KBPS:$DELAYMS"
+fi
+
+# run <test number> <name> <server options>
+run()
+{
+   $TOPDIR/BenchServer -p $PORT -z $SIZE -c $WORKDIR/cert.pem -k $WORKDIR/key.pem -l $WORKDIR/server.log $3 > $WORKDIR/server.txt &
+   SERVERPID=$!
+   sleep 1
+
+   RESULT=`timeout 300 $TOPDIR/BenchClient -p $PORT -s -c 1 -n $REQUESTS -P /v1/mem $LINK`
+   echo "RESULT $2: $RESULT"
+
+   if [ -n "$RESULT" ] && [ "`echo $RESULT | awk '{print $4}'`" = "0" ]
+   then
+      echo "PASSED-TEST $1: $2"
+   else
+      echo "FAILED-TEST $1: $2"
+   fi
+
+   kill $SERVERPID
+   wait $SERVERPID
+}
+
+run 1 "full records" "-R 1"
+run 2 "record ramp" ""
+
+if [ -z "$LINK" ]
+then
+   tc qdisc del dev lo root
+fi
+
+rm -f $TOPDIR/BenchServer
+rm -f $TOPDIR/BenchClient
+rm -rf $WORKDIR
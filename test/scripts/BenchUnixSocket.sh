@@ -0,0 +1,49 @@
+# !/bin/bash
+# Latency of small requests from one client over loopback TCP against the
+# Unix domain socket listener of the same instance, on one keep-alive
+# connection and with a new connection per request.
+TOPDIR=`pwd`
+SRCDIR=${SRCDIR:-$TOPDIR/../..}
+INCDIR=${INCDIR:-$SRCDIR/include/public}
+LIBDIR=${LIBDIR:-$SRCDIR/server/restengine/.libs}
+CLIENTLIBDIR=${CLIENTLIBDIR:-$SRCDIR/client/.libs}
+WORKDIR=$TOPDIR/data/out/benchunixsocket
+PORT="8094"
+REQUESTS=${REQUESTS:-20000}
+
+rm -rf $WORKDIR
+mkdir -p $WORKDIR
+
+# Compile from source in the same directory
+gcc -O2 -o $TOPDIR/BenchServer $TOPDIR/benchserver.c -I$INCDIR -L$LIBDIR -lrestengine -lssl -lcrypto -lpthread -Wl,-rpath,$LIBDIR
+gcc -O2 -o $TOPDIR/BenchClient $TOPDIR/benchclient.c -I$INCDIR -L$CLIENTLIBDIR -lvmrestclient -lssl -lcrypto -lpthread -Wl,-rpath,$CLIENTLIBDIR
+
+$TOPDIR/BenchServer -p $PORT -u $WORKDIR/rest.sock -l $WORKDIR/server.log > $WORKDIR/server.txt &
+SERVERPID=$!
+sleep 1
+
+# run <test number> <name> <client options>
+run()
+{
+   RESULT=`timeout 300 $TOPDIR/BenchClient -c 1 -n $REQUESTS -P /v1/small $3`
+   echo "RESULT $2: $RESULT"
+
+   if [ -n "$RESULT" ] && [ "`echo $RESULT | awk '{print $4}'`" = "0" ]
+   then
+      echo "PASSED-TEST $1: $2"
+   else
+      echo "FAILED-TEST $1: $2"
+   fi
+}
+
+run 1 "tcp keep-alive" "-p $PORT"
+run 2 "unix keep-alive" "-u $WORKDIR/rest.sock"
+run 3 "tcp new connection" "-p $PORT -N"
+run 4 "unix new connection" "-u $WORKDIR/rest.sock -N"
+
+kill $SERVERPID
+wait $SERVERPID
+
+rm -f $TOPDIR/BenchServer
+rm -f $TOPDIR/BenchClient
+rm -rf $WORKDIR
@@ -0,0 +1,69 @@
+# !/bin/bash
+# Connection count of an instance goes back to zero whichever way connections
+# came in: TLS over TCP through the handshake pool, TLS over Unix domain
+# socket, shared memory channel, failed handshake, and a connection still open
+# at stop. Stop waits for the count to reach zero, so a leaked count shows as
+# stop running into its 5 second deadline.
+TOPDIR=`pwd`
+SRCDIR=${SRCDIR:-$TOPDIR/../..}
+INCDIR=${INCDIR:-$SRCDIR/include/public}
+LIBDIR=${LIBDIR:-$SRCDIR/server/restengine/.libs}
+CLIENTLIBDIR=${CLIENTLIBDIR:-$SRCDIR/client/.libs}
+WORKDIR=$TOPDIR/data/out/conncount
+INDIR=$TOPDIR/data/input
+PORT="8098"
+
+rm -rf $WORKDIR
+mkdir -p $WORKDIR
+
+# Compile from source in the same directory
+gcc -o $TOPDIR/BenchServer $TOPDIR/benchserver.c -I$INCDIR -L$LIBDIR -lrestengine -lssl -lcrypto -lpthread -Wl,-rpath,$LIBDIR
+gcc -o $TOPDIR/ShmClient $TOPDIR/shmclient.c -I$INCDIR -L$CLIENTLIBDIR -lvmrestclient -Wl,-rpath,$CLIENTLIBDIR
+
+openssl req -x509 -newkey ec -pkeyopt ec_paramgen_curve:prime256v1 -nodes -days 1 -subj "/CN=test" -keyout $WORKDIR/key.pem -out $WORKDIR/cert.pem 2> /dev/null
+
+$TOPDIR/BenchServer -p $PORT -c $WORKDIR/cert.pem -k $WORKDIR/key.pem -t 2 -u $WORKDIR/rest.sock -m $WORKDIR/shm.sock -l $WORKDIR/server.log > $WORKDIR/server.txt &
+SERVERPID=$!
+sleep 1
+
+#=========================== TEST 1 : Requests over every transport ============================
+
+TCP=`curl -sk -m 5 -o /dev/null -w "%{http_code}" https://127.0.0.1:$PORT/v1/count`
+UDS=`curl -sk -m 5 -o /dev/null -w "%{http_code}" --unix-socket $WORKDIR/rest.sock https://localhost/v1/count`
+timeout 60 $TOPDIR/ShmClient $WORKDIR/shm.sock $INDIR/largedata.txt > $WORKDIR/shm.txt
+SHM=`sed -n 3p $WORKDIR/shm.txt`
+
+if [ "$TCP" = "200" ] && [ "$UDS" = "200" ] && [ "$SHM" = "loop 200 of 200" ]
+then
+   echo "PASSED-TEST 1: Requests over every transport"
+else
+   echo "FAILED-TEST 1: Requests over every transport ($TCP $UDS $SHM)"
+fi
+
+# Plain text to TLS listener fails handshake, idle TLS connection is left open for stop
+curl -s -m 5 -o /dev/null http://127.0.0.1:$PORT/v1/count
+sleep 30 | openssl s_client -quiet -connect 127.0.0.1:$PORT > /dev/null 2>&1 &
+HOLDPID=$!
+sleep 1
+
+#=========================== TEST 2 : Stop does not wait for connections gone ==================
+
+START=`date +%s%N`
+kill $SERVERPID
+wait $SERVERPID
+STOPMS=`expr \( \`date +%s%N\` - $START \) / 1000000`
+echo "RESULT stop: ms $STOPMS"
+
+if [ $STOPMS -lt 2000 ]
+then
+   echo "PASSED-TEST 2: Stop does not wait for connections gone"
+else
+   echo "FAILED-TEST 2: Stop does not wait for connections gone"
+fi
+
+kill $HOLDPID 2> /dev/null
+wait $HOLDPID 2> /dev/null
+
+rm -f $TOPDIR/BenchServer
+rm -f $TOPDIR/ShmClient
+rm -rf $WORKDIR
@@ -0,0 +1,20 @@
+# !/bin/bash
+# Runs requests through VmRESTDispatchBuffer() and checks responses handed to
+# the sink. No client connects to the server for these tests.
+TOPDIR=`pwd`
+SRCDIR=${SRCDIR:-$TOPDIR/../..}
+INCDIR=${INCDIR:-$SRCDIR/include/public}
+LIBDIR=${LIBDIR:-$SRCDIR/server/restengine/.libs}
+WORKDIR=$TOPDIR/data/out/dispatch
+PORT="8084"
+
+rm -rf $WORKDIR
+mkdir -p $WORKDIR
+
+# Compile from source in the same directory
+gcc -o $TOPDIR/Dispatch $TOPDIR/dispatch.c -I$INCDIR -L$LIBDIR -lrestengine -lssl -lcrypto -lpthread -Wl,-rpath,$LIBDIR
+
+timeout 60 $TOPDIR/Dispatch $PORT $WORKDIR/server.log
+
+rm -f $TOPDIR/Dispatch
+rm -rf $WORKDIR
@@ -0,0 +1,80 @@
+# !/bin/bash
+# Passes listening sockets from a running server to its successor with
+# VmRESTSendListenerFds() / VmRESTReceiveListenerFds(). Clients keep
+# connecting during the handoff and none of them may be refused.
+TOPDIR=`pwd`
+SRCDIR=${SRCDIR:-$TOPDIR/../..}
+INCDIR=${INCDIR:-$SRCDIR/include/public}
+LIBDIR=${LIBDIR:-$SRCDIR/server/restengine/.libs}
+WORKDIR=$TOPDIR/data/out/handoff
+PORT="8081"
+
+rm -rf $WORKDIR
+mkdir -p $WORKDIR
+
+# Compile from source in the same directory
+gcc -o $TOPDIR/RESTServer $TOPDIR/restserver.c -I$INCDIR -L$LIBDIR -lrestengine -lssl -lcrypto -lpthread -Wl,-rpath,$LIBDIR
+
+$TOPDIR/RESTServer -p $PORT -n old -s $WORKDIR/handoff.sock -l $WORKDIR/old.log > $WORKDIR/old.txt &
+OLDPID=$!
+sleep 1
+
+#=========================== TEST 1 : Old server answers =======================================
+
+if [ "$(curl -s -m 5 http://127.0.0.1:$PORT/v1/pkg)" = "old" ]
+then
+   echo "PASSED-TEST 1: Old server answers"
+else
+   echo "FAILED-TEST 1: Old server answers"
+fi
+
+# Clients keep connecting while listeners move to the successor
+(
+    for i in `seq 1 60`
+    do
+        curl -s -m 5 http://127.0.0.1:$PORT/v1/pkg > /dev/null || echo "request $i failed"
+        sleep 0.05
+    done
+) > $WORKDIR/loop.txt &
+LOOPPID=$!
+
+$TOPDIR/RESTServer -p $PORT -n new -r $WORKDIR/handoff.sock -l $WORKDIR/new.log > $WORKDIR/new.txt &
+NEWPID=$!
+sleep 1
+
+kill $OLDPID
+wait $OLDPID
+wait $LOOPPID
+
+#=========================== TEST 2 : Listeners passed to successor ============================
+
+if grep -q "^send 0$" $WORKDIR/old.txt && grep -q "^receive 0$" $WORKDIR/new.txt
+then
+   echo "PASSED-TEST 2: Listeners passed to successor"
+else
+   echo "FAILED-TEST 2: Listeners passed to successor"
+fi
+
+#=========================== TEST 3 : No connection refused during handoff =====================
+
+if [ ! -s $WORKDIR/loop.txt ]
+then
+   echo "PASSED-TEST 3: No connection refused during handoff"
+else
+   echo "FAILED-TEST 3: No connection refused during handoff"
+fi
+
+#=========================== TEST 4 : Successor answers on same port ===========================
+
+if [ "$(curl -s -m 5 http://127.0.0.1:$PORT/v1/pkg)" = "new" ]
+then
+   echo "PASSED-TEST 4: Successor answers on same port"
+else
+   echo "FAILED-TEST 4: Successor answers on same port"
+fi
+
+kill $NEWPID
+wait $NEWPID
+
+rm -f $TOPDIR/RESTServer
+rm -rf $WORKDIR
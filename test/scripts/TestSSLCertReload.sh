@@ -0,0 +1,72 @@
+# !/bin/bash
+# Rotates server certificate with VmRESTReloadSSLContext() while a client keeps
+# a TLS connection open. Held connection must keep working with the old
+# certificate, a new connection must get the new one.
+TOPDIR=`pwd`
+SRCDIR=${SRCDIR:-$TOPDIR/../..}
+INCDIR=${INCDIR:-$SRCDIR/include/public}
+LIBDIR=${LIBDIR:-$SRCDIR/server/restengine/.libs}
+WORKDIR=$TOPDIR/data/out/certreload
+PORT="8443"
+
+rm -rf $WORKDIR
+mkdir -p $WORKDIR
+
+# Compile from source in the same directory
+gcc -o $TOPDIR/RESTServer $TOPDIR/restserver.c -I$INCDIR -L$LIBDIR -lrestengine -lssl -lcrypto -lpthread -Wl,-rpath,$LIBDIR
+gcc -o $TOPDIR/SSLClient $TOPDIR/sslclient.c -lssl -lcrypto
+
+openssl req -x509 -newkey rsa:2048 -nodes -days 1 -subj "/CN=oldcert" -keyout $WORKDIR/oldkey.pem -out $WORKDIR/oldcert.pem 2> /dev/null
+openssl req -x509 -newkey rsa:2048 -nodes -days 1 -subj "/CN=newcert" -keyout $WORKDIR/newkey.pem -out $WORKDIR/newcert.pem 2> /dev/null
+cp $WORKDIR/oldcert.pem $WORKDIR/cert.pem
+cp $WORKDIR/oldkey.pem $WORKDIR/key.pem
+
+$TOPDIR/RESTServer -p $PORT -c $WORKDIR/cert.pem -k $WORKDIR/key.pem -l $WORKDIR/server.log > $WORKDIR/server.txt &
+SERVERPID=$!
+sleep 1
+
+$TOPDIR/SSLClient 127.0.0.1 $PORT $WORKDIR/rotated > $WORKDIR/client.txt &
+CLIENTPID=$!
+sleep 1
+
+#=========================== TEST 1 : Reload certificate from files ============================
+
+cp $WORKDIR/newcert.pem $WORKDIR/cert.pem
+cp $WORKDIR/newkey.pem $WORKDIR/key.pem
+kill -USR1 $SERVERPID
+sleep 1
+
+if grep -q "^reload 0$" $WORKDIR/server.txt
+then
+   echo "PASSED-TEST 1: Reload certificate from files"
+else
+   echo "FAILED-TEST 1: Reload certificate from files"
+fi
+
+touch $WORKDIR/rotated
+wait $CLIENTPID
+
+#=========================== TEST 2 : Held connection survives reload ==========================
+
+if [ "$(sed -n 1p $WORKDIR/client.txt)" = "held 200 oldcert" ] && [ "$(sed -n 2p $WORKDIR/client.txt)" = "held 200 oldcert" ]
+then
+   echo "PASSED-TEST 2: Held connection survives reload"
+else
+   echo "FAILED-TEST 2: Held connection survives reload"
+fi
+
+#=========================== TEST 3 : New connection gets new certificate ======================
+
+if [ "$(sed -n 3p $WORKDIR/client.txt)" = "new 200 newcert" ]
+then
+   echo "PASSED-TEST 3: New connection gets new certificate"
+else
+   echo "FAILED-TEST 3: New connection gets new certificate"
+fi
+
+kill $SERVERPID
+wait $SERVERPID
+
+rm -f $TOPDIR/RESTServer
+rm -f $TOPDIR/SSLClient
+rm -rf $WORKDIR
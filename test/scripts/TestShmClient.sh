@@ -0,0 +1,68 @@
+# !/bin/bash
+# Round trips over the shared memory channel configured by REST_CONF
+# pszShmSocketPath, driven by a client built on libvmrestclient.
+TOPDIR=`pwd`
+SRCDIR=${SRCDIR:-$TOPDIR/../..}
+INCDIR=${INCDIR:-$SRCDIR/include/public}
+LIBDIR=${LIBDIR:-$SRCDIR/server/restengine/.libs}
+CLIENTLIBDIR=${CLIENTLIBDIR:-$SRCDIR/client/.libs}
+WORKDIR=$TOPDIR/data/out/shm
+INDIR=$TOPDIR/data/input
+PORT="8083"
+
+rm -rf $WORKDIR
+mkdir -p $WORKDIR
+
+# Compile from source in the same directory
+gcc -o $TOPDIR/RESTServer $TOPDIR/restserver.c -I$INCDIR -L$LIBDIR -lrestengine -lssl -lcrypto -lpthread -Wl,-rpath,$LIBDIR
+gcc -o $TOPDIR/ShmClient $TOPDIR/shmclient.c -I$INCDIR -L$CLIENTLIBDIR -lvmrestclient -Wl,-rpath,$CLIENTLIBDIR
+
+# Small ring, so large payload wraps it several times
+$TOPDIR/RESTServer -p $PORT -n shm -m $WORKDIR/shm.sock -b 4096 -l $WORKDIR/server.log > $WORKDIR/server.txt &
+SERVERPID=$!
+sleep 1
+
+timeout 60 $TOPDIR/ShmClient $WORKDIR/shm.sock $INDIR/largedata.txt > $WORKDIR/client.txt
+
+#=========================== TEST 1 : GET over shared memory ===================================
+
+if [ "$(sed -n 1p $WORKDIR/client.txt)" = "get 200 shm" ]
+then
+   echo "PASSED-TEST 1: GET over shared memory"
+else
+   echo "FAILED-TEST 1: GET over shared memory"
+fi
+
+#=========================== TEST 2 : POST larger than ring ====================================
+
+if [ "$(sed -n 2p $WORKDIR/client.txt)" = "post 200 shm" ]
+then
+   echo "PASSED-TEST 2: POST larger than ring"
+else
+   echo "FAILED-TEST 2: POST larger than ring"
+fi
+
+#=========================== TEST 3 : Many requests on one channel =============================
+
+if [ "$(sed -n 3p $WORKDIR/client.txt)" = "loop 200 of 200" ]
+then
+   echo "PASSED-TEST 3: Many requests on one channel"
+else
+   echo "FAILED-TEST 3: Many requests on one channel"
+fi
+
+#=========================== TEST 4 : TCP listener still answers ===============================
+
+if [ "$(curl -s -m 5 http://127.0.0.1:$PORT/v1/pkg)" = "shm" ]
+then
+   echo "PASSED-TEST 4: TCP listener still answers"
+else
+   echo "FAILED-TEST 4: TCP listener still answers"
+fi
+
+kill $SERVERPID
+wait $SERVERPID
+
+rm -f $TOPDIR/RESTServer
+rm -f $TOPDIR/ShmClient
+rm -rf $WORKDIR
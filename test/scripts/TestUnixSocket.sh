@@ -0,0 +1,71 @@
+# !/bin/bash
+# Round trip over the Unix domain socket listener configured by REST_CONF
+# pszUnixSocketPath, next to the TCP listener of the same instance.
+TOPDIR=`pwd`
+SRCDIR=${SRCDIR:-$TOPDIR/../..}
+INCDIR=${INCDIR:-$SRCDIR/include/public}
+LIBDIR=${LIBDIR:-$SRCDIR/server/restengine/.libs}
+WORKDIR=$TOPDIR/data/out/uds
+INDIR=$TOPDIR/data/input
+PORT="8082"
+
+rm -rf $WORKDIR
+mkdir -p $WORKDIR
+
+# Compile from source in the same directory
+gcc -o $TOPDIR/RESTServer $TOPDIR/restserver.c -I$INCDIR -L$LIBDIR -lrestengine -lssl -lcrypto -lpthread -Wl,-rpath,$LIBDIR
+
+$TOPDIR/RESTServer -p $PORT -n uds -u $WORKDIR/rest.sock -M 600 -l $WORKDIR/server.log > $WORKDIR/server.txt &
+SERVERPID=$!
+sleep 1
+
+#=========================== TEST 1 : GET over Unix socket =====================================
+
+if [ "$(curl -s -m 5 --unix-socket $WORKDIR/rest.sock http://localhost/v1/pkg)" = "uds" ]
+then
+   echo "PASSED-TEST 1: GET over Unix socket"
+else
+   echo "FAILED-TEST 1: GET over Unix socket"
+fi
+
+#=========================== TEST 2 : POST with payload over Unix socket =======================
+
+if [ "$(curl -s -m 5 --unix-socket $WORKDIR/rest.sock -X POST -d @$INDIR/smalldata.txt http://localhost/v1/pkg)" = "uds" ]
+then
+   echo "PASSED-TEST 2: POST with payload over Unix socket"
+else
+   echo "FAILED-TEST 2: POST with payload over Unix socket"
+fi
+
+#=========================== TEST 3 : Socket file mode applied =================================
+
+if [ "$(stat -c %a $WORKDIR/rest.sock)" = "600" ]
+then
+   echo "PASSED-TEST 3: Socket file mode applied"
+else
+   echo "FAILED-TEST 3: Socket file mode applied"
+fi
+
+#=========================== TEST 4 : TCP listener still answers ===============================
+
+if [ "$(curl -s -m 5 http://127.0.0.1:$PORT/v1/pkg)" = "uds" ]
+then
+   echo "PASSED-TEST 4: TCP listener still answers"
+else
+   echo "FAILED-TEST 4: TCP listener still answers"
+fi
+
+kill $SERVERPID
+wait $SERVERPID
+
+#=========================== TEST 5 : Socket file removed on stop ==============================
+
+if [ ! -e $WORKDIR/rest.sock ]
+then
+   echo "PASSED-TEST 5: Socket file removed on stop"
+else
+   echo "FAILED-TEST 5: Socket file removed on stop"
+fi
+
+rm -f $TOPDIR/RESTServer
+rm -rf $WORKDIR
@@ -0,0 +1,740 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <stddef.h>
+#include <time.h>
+#include <poll.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include <vmrestclient.h>
+
+/**** Load generator of the benchmark scripts. Each of -c threads sends -n
+      keep-alive GETs on its own connection and times them. Prints one line:
+        requests <n> errors <n> seconds <s> rps <r> p50 <us> p99 <us> ttfb50 <us> ttfb99 <us> MBps <m>
+      ttfb is time to first body byte the client can use, after decryption on TLS.
+      -L emulates a slow link on the receive side, bytes of server are handed
+      to the client at that rate and after that delay. Used where netem is not available.
+      -i opens -c connections, one request on each, holds them idle and prints
+        held <n> ****/
+
+#define MAXHEADERSIZE 8192
+#define READCHUNK     65536
+
+typedef struct _BENCH_LINK_CHUNK
+{
+    uint32_t                         nBytes;
+    uint32_t                         nReleased;
+    uint64_t                         startUs;
+} BENCH_LINK_CHUNK;
+
+typedef struct _BENCH_LINK
+{
+    char*                            pData;
+    uint32_t                         nHead;
+    uint32_t                         nLen;
+    uint32_t                         nCap;
+    BENCH_LINK_CHUNK*                pChunks;
+    uint32_t                         nChunkHead;
+    uint32_t                         nChunks;
+    uint32_t                         nChunkCap;
+    uint64_t                         lastEndUs;
+} BENCH_LINK;
+
+typedef struct _BENCH_CONN
+{
+    int                              fd;
+    SSL*                             ssl;
+    BIO*                             pLinkBio;
+    BENCH_LINK                       link;
+    PVMREST_SHM_CLIENT               pShm;
+} BENCH_CONN;
+
+typedef struct _BENCH_THREAD
+{
+    pthread_t                        thread;
+    int                              index;
+    uint32_t                         nErrors;
+    uint64_t                         nBytes;
+} BENCH_THREAD;
+
+static char*                         gpszHost = "127.0.0.1";
+static char*                         gpszPort = NULL;
+static char*                         gpszUnixPath = NULL;
+static char*                         gpszShmPath = NULL;
+static char*                         gpszPath = "/v1/small";
+static int                           gbTLS = 0;
+static int                           gbNewConn = 0;
+static int                           gnConns = 1;
+static int                           gnRequests = 1000;
+static double                        gLinkBytesPerUs = 0;
+static uint64_t                      gLinkDelayUs = 0;
+static SSL_CTX*                      gpCtx = NULL;
+static uint64_t*                     gpLatency = NULL;
+static uint64_t*                     gpTTFB = NULL;
+
+static
+uint64_t
+nowUs(
+    void
+    )
+{
+    struct timespec                  ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+static
+int
+cmpU64(
+    const void*                      a,
+    const void*                      b
+    )
+{
+    uint64_t                         x = *(const uint64_t*)a;
+    uint64_t                         y = *(const uint64_t*)b;
+
+    return (x > y) - (x < y);
+}
+
+static
+int
+connectServer(
+    void
+    )
+{
+    struct addrinfo                  hints;
+    struct addrinfo*                 servinfo = NULL;
+    struct addrinfo*                 p = NULL;
+    struct sockaddr_un               addr;
+    socklen_t                        addrLen = 0;
+    int                              sockfd = -1;
+    int                              one = 1;
+
+    if (gpszUnixPath)
+    {
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, gpszUnixPath, sizeof(addr.sun_path) - 1);
+        addrLen = sizeof(addr);
+        if (gpszUnixPath[0] == '@')
+        {
+            addr.sun_path[0] = '\0';
+            addrLen = offsetof(struct sockaddr_un, sun_path) + strlen(gpszUnixPath);
+        }
+
+        sockfd = socket(AF_UNIX, SOCK_STREAM, 0);
+        if ((sockfd >= 0) && (connect(sockfd, (struct sockaddr*)&addr, addrLen) != 0))
+        {
+            close(sockfd);
+            sockfd = -1;
+        }
+        return sockfd;
+    }
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    if (getaddrinfo(gpszHost, gpszPort, &hints, &servinfo) != 0)
+    {
+        return -1;
+    }
+
+    for (p = servinfo; p != NULL; p = p->ai_next)
+    {
+        sockfd = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+        if (sockfd == -1)
+        {
+            continue;
+        }
+        if (connect(sockfd, p->ai_addr, p->ai_addrlen) == 0)
+        {
+            setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+            break;
+        }
+        close(sockfd);
+        sockfd = -1;
+    }
+
+    freeaddrinfo(servinfo);
+
+    return sockfd;
+}
+
+/**** Emulated link: bytes read from socket are serialized at link rate in
+      arrival order, each is released to the client delay after its turn ****/
+static
+int
+linkPump(
+    BENCH_CONN*                      pConn
+    )
+{
+    BENCH_LINK*                      pLink = &pConn->link;
+    BENCH_LINK_CHUNK*                pChunk = NULL;
+    struct pollfd                    pfd;
+    uint64_t                         now = 0;
+    uint64_t                         allowed = 0;
+    uint64_t                         waitUs = 0;
+    uint32_t                         nRelease = 0;
+    int                              n = 0;
+
+    for (;;)
+    {
+        now = nowUs();
+
+        /**** Take what arrived ****/
+        if (pLink->nCap - (pLink->nHead + pLink->nLen) < READCHUNK)
+        {
+            memmove(pLink->pData, pLink->pData + pLink->nHead, pLink->nLen);
+            pLink->nHead = 0;
+            if (pLink->nCap - pLink->nLen < READCHUNK)
+            {
+                pLink->nCap = (pLink->nCap * 2) + READCHUNK;
+                pLink->pData = realloc(pLink->pData, pLink->nCap);
+            }
+        }
+        n = recv(pConn->fd, pLink->pData + pLink->nHead + pLink->nLen, READCHUNK, MSG_DONTWAIT);
+        if (n == 0)
+        {
+            return -1;
+        }
+        if (n > 0)
+        {
+            if (pLink->nChunkHead + pLink->nChunks == pLink->nChunkCap)
+            {
+                memmove(pLink->pChunks, pLink->pChunks + pLink->nChunkHead, pLink->nChunks * sizeof(BENCH_LINK_CHUNK));
+                pLink->nChunkHead = 0;
+                if (pLink->nChunks == pLink->nChunkCap)
+                {
+                    pLink->nChunkCap = (pLink->nChunkCap * 2) + 64;
+                    pLink->pChunks = realloc(pLink->pChunks, pLink->nChunkCap * sizeof(BENCH_LINK_CHUNK));
+                }
+            }
+            pChunk = &pLink->pChunks[pLink->nChunkHead + pLink->nChunks];
+            pChunk->nBytes = n;
+            pChunk->nReleased = 0;
+            pChunk->startUs = (pLink->lastEndUs > now) ? pLink->lastEndUs : now;
+            pLink->lastEndUs = pChunk->startUs + (uint64_t)(n / gLinkBytesPerUs);
+            pLink->nChunks++;
+            pLink->nLen += n;
+            continue;
+        }
+
+        /**** Hand over what crossed the link by now ****/
+        nRelease = 0;
+        waitUs = 0;
+        while (pLink->nChunks > 0)
+        {
+            pChunk = &pLink->pChunks[pLink->nChunkHead];
+            allowed = 0;
+            if (now > pChunk->startUs + gLinkDelayUs)
+            {
+                allowed = (uint64_t)((now - pChunk->startUs - gLinkDelayUs) * gLinkBytesPerUs);
+            }
+            if (allowed > pChunk->nBytes)
+            {
+                allowed = pChunk->nBytes;
+            }
+            if (allowed > pChunk->nReleased)
+            {
+                nRelease += (uint32_t)allowed - pChunk->nReleased;
+                pChunk->nReleased = (uint32_t)allowed;
+            }
+            if (pChunk->nReleased < pChunk->nBytes)
+            {
+                waitUs = pChunk->startUs + gLinkDelayUs + (uint64_t)((pChunk->nReleased + 1) / gLinkBytesPerUs) - now;
+                break;
+            }
+            pLink->nChunkHead++;
+            pLink->nChunks--;
+        }
+
+        if (nRelease > 0)
+        {
+            BIO_write(pConn->pLinkBio, pLink->pData + pLink->nHead, nRelease);
+            pLink->nHead += nRelease;
+            pLink->nLen -= nRelease;
+            return 0;
+        }
+
+        /**** Nothing due, sleep until next byte is due or more data arrives ****/
+        pfd.fd = pConn->fd;
+        pfd.events = POLLIN;
+        poll(&pfd, 1, (pLink->nChunks > 0) ? (int)((waitUs / 1000) + 1) : 5000);
+    }
+}
+
+static
+int
+connRead(
+    BENCH_CONN*                      pConn,
+    char*                            pBuf,
+    int                              nLen
+    )
+{
+    int                              n = 0;
+
+    if (!pConn->ssl)
+    {
+        return recv(pConn->fd, pBuf, nLen, 0);
+    }
+
+    for (;;)
+    {
+        n = SSL_read(pConn->ssl, pBuf, nLen);
+        if (n > 0)
+        {
+            return n;
+        }
+        if (!pConn->pLinkBio || (SSL_get_error(pConn->ssl, n) != SSL_ERROR_WANT_READ))
+        {
+            return -1;
+        }
+        if (linkPump(pConn) < 0)
+        {
+            return -1;
+        }
+    }
+}
+
+static
+int
+connWrite(
+    BENCH_CONN*                      pConn,
+    char*                            pBuf,
+    int                              nLen
+    )
+{
+    if (pConn->ssl)
+    {
+        return SSL_write(pConn->ssl, pBuf, nLen);
+    }
+
+    return send(pConn->fd, pBuf, nLen, MSG_NOSIGNAL);
+}
+
+static
+void
+connClose(
+    BENCH_CONN*                      pConn
+    )
+{
+    if (pConn->pShm)
+    {
+        VmRESTShmClientClose(pConn->pShm);
+    }
+    if (pConn->ssl)
+    {
+        SSL_free(pConn->ssl);
+    }
+    if (pConn->fd >= 0)
+    {
+        close(pConn->fd);
+    }
+    free(pConn->link.pData);
+    free(pConn->link.pChunks);
+    memset(pConn, 0, sizeof(*pConn));
+    pConn->fd = -1;
+}
+
+static
+int
+connOpen(
+    BENCH_CONN*                      pConn
+    )
+{
+    int                              n = 0;
+
+    memset(pConn, 0, sizeof(*pConn));
+    pConn->fd = -1;
+
+    if (gpszShmPath)
+    {
+        return VmRESTShmClientConnect(gpszShmPath, &pConn->pShm) ? -1 : 0;
+    }
+
+    pConn->fd = connectServer();
+    if (pConn->fd < 0)
+    {
+        return -1;
+    }
+
+    if (!gbTLS)
+    {
+        return 0;
+    }
+
+    pConn->ssl = SSL_new(gpCtx);
+    if (gLinkBytesPerUs > 0)
+    {
+        /**** Reads come through emulated link, writes go straight out ****/
+        pConn->pLinkBio = BIO_new(BIO_s_mem());
+        SSL_set_bio(pConn->ssl, pConn->pLinkBio, BIO_new_socket(pConn->fd, BIO_NOCLOSE));
+    }
+    else
+    {
+        SSL_set_fd(pConn->ssl, pConn->fd);
+    }
+
+    while ((n = SSL_connect(pConn->ssl)) != 1)
+    {
+        if (!pConn->pLinkBio || (SSL_get_error(pConn->ssl, n) != SSL_ERROR_WANT_READ) || (linkPump(pConn) < 0))
+        {
+            connClose(pConn);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+/**** One keep-alive GET, body framed by Content-Length is read and dropped ****/
+static
+int
+doRequest(
+    BENCH_CONN*                      pConn,
+    uint64_t*                        pLatency,
+    uint64_t*                        pTTFB,
+    uint64_t*                        pBytes
+    )
+{
+    char                             req[512];
+    char                             hdr[MAXHEADERSIZE + 1];
+    char                             body[READCHUNK];
+    char*                            hdrEnd = NULL;
+    char*                            lenHdr = NULL;
+    char*                            response = NULL;
+    uint32_t                         responseLen = 0;
+    uint64_t                         start = 0;
+    uint64_t                         bodyLeft = 0;
+    int                              total = 0;
+    int                              reqLen = 0;
+    int                              status = 0;
+    int                              n = 0;
+
+    reqLen = snprintf(req, sizeof(req), "GET %s HTTP/1.1\r\nHost: bench\r\nConnection: keep-alive\r\n\r\n", gpszPath);
+
+    start = nowUs();
+
+    if (pConn->pShm)
+    {
+        if (VmRESTShmClientRequest(pConn->pShm, req, reqLen, &response, &responseLen, 5000))
+        {
+            return -1;
+        }
+        sscanf(response, "HTTP/1.1 %d", &status);
+        VmRESTShmClientFreeResponse(response);
+        *pLatency = *pTTFB = nowUs() - start;
+        *pBytes += responseLen;
+        return (status == 200) ? 0 : -1;
+    }
+
+    if (connWrite(pConn, req, reqLen) != reqLen)
+    {
+        return -1;
+    }
+
+    while (!hdrEnd)
+    {
+        if (total >= MAXHEADERSIZE)
+        {
+            return -1;
+        }
+        n = connRead(pConn, hdr + total, MAXHEADERSIZE - total);
+        if (n <= 0)
+        {
+            return -1;
+        }
+        total += n;
+        hdr[total] = '\0';
+        hdrEnd = strstr(hdr, "\r\n\r\n");
+    }
+
+    sscanf(hdr, "HTTP/1.1 %d", &status);
+    lenHdr = strstr(hdr, "Content-Length:");
+    bodyLeft = lenHdr ? strtoull(lenHdr + strlen("Content-Length:"), NULL, 10) : 0;
+
+    n = total - (int)(hdrEnd + 4 - hdr);
+    *pTTFB = nowUs() - start;
+    if ((n == 0) && (bodyLeft > 0))
+    {
+        n = connRead(pConn, body, sizeof(body));
+        if (n <= 0)
+        {
+            return -1;
+        }
+        *pTTFB = nowUs() - start;
+    }
+    bodyLeft -= ((uint64_t)n > bodyLeft) ? bodyLeft : (uint64_t)n;
+
+    while (bodyLeft > 0)
+    {
+        n = connRead(pConn, body, (bodyLeft < sizeof(body)) ? (int)bodyLeft : (int)sizeof(body));
+        if (n <= 0)
+        {
+            return -1;
+        }
+        bodyLeft -= n;
+        *pBytes += n;
+    }
+
+    *pLatency = nowUs() - start;
+    *pBytes += total;
+
+    return (status == 200) ? 0 : -1;
+}
+
+static
+void*
+benchThread(
+    void*                            pData
+    )
+{
+    BENCH_THREAD*                    pThr = (BENCH_THREAD*)pData;
+    BENCH_CONN                       conn;
+    uint64_t                         start = 0;
+    uint64_t*                        pLatency = &gpLatency[pThr->index * gnRequests];
+    uint64_t*                        pTTFB = &gpTTFB[pThr->index * gnRequests];
+    int                              i = 0;
+
+    conn.fd = -1;
+
+    for (i = 0; i < gnRequests; i++)
+    {
+        start = nowUs();
+
+        if ((conn.fd < 0) && !conn.pShm && connOpen(&conn))
+        {
+            pThr->nErrors++;
+            pLatency[i] = pTTFB[i] = UINT64_MAX;
+            continue;
+        }
+
+        if (doRequest(&conn, &pLatency[i], &pTTFB[i], &pThr->nBytes))
+        {
+            pThr->nErrors++;
+            pLatency[i] = pTTFB[i] = UINT64_MAX;
+            connClose(&conn);
+            continue;
+        }
+
+        /**** Handshake rate: connection setup is part of the request ****/
+        if (gbNewConn)
+        {
+            pLatency[i] = nowUs() - start;
+            connClose(&conn);
+        }
+    }
+
+    connClose(&conn);
+
+    return NULL;
+}
+
+static
+int
+holdIdle(
+    int                              holdSec
+    )
+{
+    BENCH_CONN*                      pConns = calloc(gnConns, sizeof(BENCH_CONN));
+    uint64_t                         latency = 0;
+    uint64_t                         ttfb = 0;
+    uint64_t                         bytes = 0;
+    int                              nHeld = 0;
+    int                              i = 0;
+
+    if (!pConns)
+    {
+        return 1;
+    }
+
+    for (i = 0; i < gnConns; i++)
+    {
+        if (!connOpen(&pConns[i]) && !doRequest(&pConns[i], &latency, &ttfb, &bytes))
+        {
+            nHeld++;
+        }
+    }
+
+    printf("held %d\n", nHeld);
+    fflush(stdout);
+
+    sleep(holdSec);
+
+    for (i = 0; i < gnConns; i++)
+    {
+        connClose(&pConns[i]);
+    }
+    free(pConns);
+
+    return 0;
+}
+
+static
+void
+usage(
+    void
+    )
+{
+    printf("Usage: benchclient (-p port [-h host] | -u udspath | -M shmpath) [-s] [-P path]\n");
+    printf("                   [-c conns] [-n requests] [-N] [-L kbps:delayms] [-i holdsec]\n");
+    printf("  -s         TLS\n");
+    printf("  -N         new connection for every request\n");
+    printf("  -L         emulated receive link for TLS, rate in kbit/s and one way delay\n");
+    printf("  -i         hold -c idle connections for this many seconds\n");
+}
+
+int main(int argc, char *argv[])
+{
+    BENCH_THREAD*                    pThreads = NULL;
+    uint64_t                         start = 0;
+    uint64_t                         elapsed = 0;
+    uint64_t                         nBytes = 0;
+    uint32_t                         nErrors = 0;
+    uint32_t                         nTotal = 0;
+    uint32_t                         nOk = 0;
+    int                              holdSec = -1;
+    int                              kbps = 0;
+    int                              delayMs = 0;
+    int                              opt = 0;
+    int                              i = 0;
+
+    while ((opt = getopt(argc, argv, "h:p:u:M:sP:c:n:NL:i:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'h':
+                gpszHost = optarg;
+                break;
+            case 'p':
+                gpszPort = optarg;
+                break;
+            case 'u':
+                gpszUnixPath = optarg;
+                break;
+            case 'M':
+                gpszShmPath = optarg;
+                break;
+            case 's':
+                gbTLS = 1;
+                break;
+            case 'P':
+                gpszPath = optarg;
+                break;
+            case 'c':
+                gnConns = atoi(optarg);
+                break;
+            case 'n':
+                gnRequests = atoi(optarg);
+                break;
+            case 'N':
+                gbNewConn = 1;
+                break;
+            case 'L':
+                if (sscanf(optarg, "%d:%d", &kbps, &delayMs) != 2 || (kbps <= 0))
+                {
+                    usage();
+                    return 1;
+                }
+                gLinkBytesPerUs = kbps / 8000.0;
+                gLinkDelayUs = (uint64_t)delayMs * 1000;
+                break;
+            case 'i':
+                holdSec = atoi(optarg);
+                break;
+            default:
+                usage();
+                return 1;
+        }
+    }
+
+    if ((!gpszPort && !gpszUnixPath && !gpszShmPath) || (gnConns < 1) || (gnRequests < 1))
+    {
+        usage();
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+
+    if (gbTLS)
+    {
+        SSL_library_init();
+        SSL_load_error_strings();
+        gpCtx = SSL_CTX_new(SSLv23_client_method());
+        if (!gpCtx)
+        {
+            return 1;
+        }
+    }
+
+    if (holdSec >= 0)
+    {
+        return holdIdle(holdSec);
+    }
+
+    nTotal = gnConns * gnRequests;
+    gpLatency = calloc(nTotal, sizeof(uint64_t));
+    gpTTFB = calloc(nTotal, sizeof(uint64_t));
+    pThreads = calloc(gnConns, sizeof(BENCH_THREAD));
+    if (!gpLatency || !gpTTFB || !pThreads)
+    {
+        return 1;
+    }
+
+    start = nowUs();
+    for (i = 0; i < gnConns; i++)
+    {
+        pThreads[i].index = i;
+        pthread_create(&pThreads[i].thread, NULL, &benchThread, &pThreads[i]);
+    }
+    for (i = 0; i < gnConns; i++)
+    {
+        pthread_join(pThreads[i].thread, NULL);
+        nErrors += pThreads[i].nErrors;
+        nBytes += pThreads[i].nBytes;
+    }
+    elapsed = nowUs() - start;
+
+    /**** Failed requests sort to the end ****/
+    qsort(gpLatency, nTotal, sizeof(uint64_t), &cmpU64);
+    qsort(gpTTFB, nTotal, sizeof(uint64_t), &cmpU64);
+    nOk = nTotal - nErrors;
+    if (nOk == 0)
+    {
+        nOk = 1;
+    }
+
+    printf("requests %u errors %u seconds %.3f rps %.0f p50 %llu p99 %llu ttfb50 %llu ttfb99 %llu MBps %.1f\n",
+           nTotal,
+           nErrors,
+           elapsed / 1e6,
+           (nTotal - nErrors) / (elapsed / 1e6),
+           (unsigned long long)gpLatency[nOk / 2],
+           (unsigned long long)gpLatency[(nOk * 99) / 100],
+           (unsigned long long)gpTTFB[nOk / 2],
+           (unsigned long long)gpTTFB[(nOk * 99) / 100],
+           nBytes / (elapsed / 1e6) / (1024 * 1024));
+
+    free(gpLatency);
+    free(gpTTFB);
+    free(pThreads);
+    if (gpCtx)
+    {
+        SSL_CTX_free(gpCtx);
+    }
+
+    return 0;
+}
@@ -0,0 +1,264 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <stdbool.h>
+#include <vmrest.h>
+
+/**** REST engine instance driven by the benchmark scripts.
+        /v1/small                     2 byte body
+        /v1/mem                       -z bytes from memory, VmRESTSetDataZC()
+        /v1/file                      -z bytes of -f file, VmRESTSetDataFromFile()
+      With -H, that many instances run in one process on consecutive ports ****/
+
+#define MAXHANDLES 4
+
+static volatile sig_atomic_t         gbStop = 0;
+static char*                         gpPayload = NULL;
+static uint32_t                      gnPayload = 0;
+static int                           gFileFd = -1;
+
+static
+void
+sig_handler(
+    int                              signo
+    )
+{
+    gbStop = 1;
+}
+
+static
+uint32_t
+VmHandleBench(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_REQUEST                    pRequest,
+    PREST_RESPONSE*                  ppResponse,
+    uint32_t                         paramsCount
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_MORE_IO_REQUIRED;
+    char                             buffer[4097] = {0};
+    char*                            pszURI = NULL;
+    uint32_t                         bytesRW = 0;
+    int                              route = 0;
+
+    while (dwError == REST_ENGINE_MORE_IO_REQUIRED)
+    {
+        dwError = VmRESTGetData(pRESTHandle, pRequest, buffer, &bytesRW);
+    }
+    if (dwError)
+    {
+        return dwError;
+    }
+
+    VmRESTGetHttpURI(pRequest, false, &pszURI);
+    if (pszURI && strstr(pszURI, "/v1/mem"))
+    {
+        route = 1;
+    }
+    else if (pszURI && strstr(pszURI, "/v1/file"))
+    {
+        route = 2;
+    }
+    free(pszURI);
+
+    dwError = VmRESTSetSuccessResponse(pRequest, ppResponse);
+    if (dwError)
+    {
+        return dwError;
+    }
+
+    if ((route == 1) && gpPayload)
+    {
+        return VmRESTSetDataZC(pRESTHandle, ppResponse, gpPayload, gnPayload);
+    }
+    if ((route == 2) && (gFileFd >= 0))
+    {
+        return VmRESTSetDataFromFile(pRESTHandle, ppResponse, gFileFd, 0, gnPayload);
+    }
+
+    dwError = VmRESTSetDataLength(ppResponse, "2");
+    if (dwError)
+    {
+        return dwError;
+    }
+
+    return VmRESTSetData(pRESTHandle, ppResponse, "ok", 2, &bytesRW);
+}
+
+static
+void
+usage(
+    void
+    )
+{
+    printf("Usage: benchserver -p port [-H handles] [-w workers] [-C clients] [-l logfile]\n");
+    printf("                   [-c cert -k key [-K] [-t handshakethreads] [-R rampbytes]]\n");
+    printf("                   [-z bytes [-f file]] [-u udspath] [-m shmpath]\n");
+    printf("  -H         instances in this process, on port .. port+handles-1, sharing certificate\n");
+    printf("  -K         ask for kernel TLS\n");
+    printf("  -R         TLS record ramp bytes, 1 sends full size records from start\n");
+    printf("  -z, -f     size of /v1/mem and /v1/file bodies, file served by /v1/file\n");
+    printf("  -u, -m     also listen on Unix domain socket, serve shared memory clients (first instance)\n");
+    printf("  Prints pid and 'started' once listening, SIGTERM or SIGINT stops\n");
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t                         dwError = 0;
+    PVMREST_HANDLE                   pRESTHandle[MAXHANDLES] = {0};
+    REST_CONF                        config;
+    REST_PROCESSOR                   handlers;
+    int                              nHandles = 1;
+    int                              port = 0;
+    char*                            pszFile = NULL;
+    int                              opt = 0;
+    int                              i = 0;
+
+    VmRESTInitConfig(&config);
+    memset(&handlers, 0, sizeof(handlers));
+
+    config.nWorkerThr = 4;
+    config.nClientCnt = 1000;
+    config.connTimeoutSec = 60;
+
+    while ((opt = getopt(argc, argv, "p:H:w:C:l:c:k:Kt:R:z:f:u:m:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'p':
+                port = atoi(optarg);
+                break;
+            case 'H':
+                nHandles = atoi(optarg);
+                break;
+            case 'w':
+                config.nWorkerThr = atoi(optarg);
+                break;
+            case 'C':
+                config.nClientCnt = atoi(optarg);
+                break;
+            case 'l':
+                config.pszDebugLogFile = optarg;
+                break;
+            case 'c':
+                config.pszSSLCertificate = optarg;
+                config.isSecure = true;
+                break;
+            case 'k':
+                config.pszSSLKey = optarg;
+                break;
+            case 'K':
+                config.useKernelTLS = true;
+                break;
+            case 't':
+                config.nHandshakeThr = atoi(optarg);
+                break;
+            case 'R':
+                config.nTLSRecordRampBytes = atoi(optarg);
+                break;
+            case 'z':
+                gnPayload = atoi(optarg);
+                break;
+            case 'f':
+                pszFile = optarg;
+                break;
+            case 'u':
+                config.pszUnixSocketPath = optarg;
+                break;
+            case 'm':
+                config.pszShmSocketPath = optarg;
+                break;
+            default:
+                usage();
+                return 1;
+        }
+    }
+
+    if (!port || (nHandles < 1) || (nHandles > MAXHANDLES) || !config.pszDebugLogFile)
+    {
+        usage();
+        return 1;
+    }
+
+    if (gnPayload)
+    {
+        gpPayload = malloc(gnPayload);
+        if (!gpPayload)
+        {
+            return 1;
+        }
+        memset(gpPayload, 'x', gnPayload);
+    }
+    if (pszFile)
+    {
+        gFileFd = open(pszFile, O_RDONLY);
+        if (gFileFd < 0)
+        {
+            printf("open %s failed\n", pszFile);
+            return 1;
+        }
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGTERM, sig_handler);
+    signal(SIGINT, sig_handler);
+
+    handlers.pfnHandleCreate = &VmHandleBench;
+    handlers.pfnHandleRead = &VmHandleBench;
+    handlers.pfnHandleUpdate = &VmHandleBench;
+    handlers.pfnHandleDelete = &VmHandleBench;
+    handlers.pfnHandleOthers = &VmHandleBench;
+
+    for (i = 0; i < nHandles; i++)
+    {
+        config.serverPort = port + i;
+
+        dwError = VmRESTInit(&config, &pRESTHandle[i]);
+        if (!dwError)
+        {
+            dwError = VmRESTRegisterHandler(pRESTHandle[i], "/v1/*", &handlers, NULL);
+        }
+        if (!dwError)
+        {
+            dwError = VmRESTStart(pRESTHandle[i]);
+        }
+        if (dwError)
+        {
+            printf("instance %d start failed %u\n", i, dwError);
+            return 1;
+        }
+
+        /**** Local listeners only on first instance ****/
+        config.pszUnixSocketPath = NULL;
+        config.pszShmSocketPath = NULL;
+    }
+
+    printf("pid %d\n", (int)getpid());
+    printf("started\n");
+    fflush(stdout);
+
+    while (!gbStop)
+    {
+        usleep(50000);
+    }
+
+    for (i = 0; i < nHandles; i++)
+    {
+        VmRESTStop(pRESTHandle[i], 5);
+        VmRESTUnRegisterHandler(pRESTHandle[i], "/v1/*");
+        VmRESTShutdown(pRESTHandle[i]);
+    }
+
+    if (gFileFd >= 0)
+    {
+        close(gFileFd);
+    }
+    free(gpPayload);
+
+    printf("stopped\n");
+
+    return 0;
+}
@@ -0,0 +1,239 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <stdbool.h>
+#include <vmrest.h>
+
+/**** Runs requests through VmRESTDispatchBuffer(), no client socket involved.
+      Handler echoes request payload, /v1/peer answers with peer address ****/
+
+#define MAXDATASIZE 65536
+
+typedef struct _TEST_SINK_BUFFER
+{
+    char                             data[MAXDATASIZE];
+    uint32_t                         nLen;
+    uint32_t                         nWrites;
+    int                              bFail;
+} TEST_SINK_BUFFER;
+
+static
+uint32_t
+VmTestSinkWrite(
+    void*                            pContext,
+    const char*                      pData,
+    uint32_t                         nLen
+    )
+{
+    TEST_SINK_BUFFER*                pOut = (TEST_SINK_BUFFER*)pContext;
+
+    pOut->nWrites++;
+
+    if (pOut->bFail || (pOut->nLen + nLen >= MAXDATASIZE))
+    {
+        return 1;
+    }
+
+    memcpy(pOut->data + pOut->nLen, pData, nLen);
+    pOut->nLen += nLen;
+    pOut->data[pOut->nLen] = '\0';
+
+    return 0;
+}
+
+static
+uint32_t
+VmHandleEcho(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_REQUEST                    pRequest,
+    PREST_RESPONSE*                  ppResponse,
+    uint32_t                         paramsCount
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_MORE_IO_REQUIRED;
+    static __thread char             payload[MAXDATASIZE];
+    char                             buffer[4097] = {0};
+    char                             size[16] = {0};
+    char*                            pszURI = NULL;
+    char*                            pszPeer = NULL;
+    int                              peerPort = -1;
+    uint32_t                         bytesRW = 0;
+    uint32_t                         index = 0;
+
+    while (dwError == REST_ENGINE_MORE_IO_REQUIRED)
+    {
+        dwError = VmRESTGetData(pRESTHandle, pRequest, buffer, &bytesRW);
+        if ((index + bytesRW) < MAXDATASIZE)
+        {
+            memcpy(payload + index, buffer, bytesRW);
+            index += bytesRW;
+        }
+    }
+    if (dwError)
+    {
+        return dwError;
+    }
+
+    VmRESTGetHttpURI(pRequest, false, &pszURI);
+    if (pszURI && strstr(pszURI, "/v1/peer"))
+    {
+        VmRESTGetConnectionInfo(pRequest, &pszPeer, &peerPort);
+        index = snprintf(payload, sizeof(payload), "%s %d", pszPeer ? pszPeer : "none", peerPort);
+        free(pszPeer);
+    }
+    free(pszURI);
+
+    dwError = VmRESTSetSuccessResponse(pRequest, ppResponse);
+    if (dwError)
+    {
+        return dwError;
+    }
+
+    snprintf(size, sizeof(size), "%u", index);
+    dwError = VmRESTSetDataLength(ppResponse, size);
+    if (dwError)
+    {
+        return dwError;
+    }
+
+    return VmRESTSetData(pRESTHandle, ppResponse, payload, index, &bytesRW);
+}
+
+static
+uint32_t
+dispatch(
+    PVMREST_HANDLE                   pRESTHandle,
+    char*                            request,
+    TEST_SINK_BUFFER*                pOut
+    )
+{
+    REST_RESPONSE_SINK               sink = { &VmTestSinkWrite, pOut };
+
+    pOut->nLen = 0;
+    pOut->nWrites = 0;
+    pOut->data[0] = '\0';
+
+    return VmRESTDispatchBuffer(pRESTHandle, request, strlen(request), &sink);
+}
+
+static
+void
+report(
+    int                              testNum,
+    char*                            testName,
+    int                              bPassed,
+    TEST_SINK_BUFFER*                pOut
+    )
+{
+    if (bPassed)
+    {
+        printf("PASSED-TEST %d: %s\n", testNum, testName);
+    }
+    else
+    {
+        printf("FAILED-TEST %d: %s\n", testNum, testName);
+        printf("%s\n", pOut->data);
+    }
+}
+
+static
+char*
+body(
+    TEST_SINK_BUFFER*                pOut
+    )
+{
+    char*                            p = strstr(pOut->data, "\r\n\r\n");
+
+    return p ? p + 4 : "";
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t                         dwError = 0;
+    PVMREST_HANDLE                   pRESTHandle = NULL;
+    REST_CONF                        config;
+    REST_PROCESSOR                   handlers;
+    static TEST_SINK_BUFFER          out;
+
+    if (argc != 3)
+    {
+        printf("Usage: dispatch port logfile\n");
+        return 1;
+    }
+
+    VmRESTInitConfig(&config);
+    memset(&handlers, 0, sizeof(handlers));
+
+    config.serverPort = atoi(argv[1]);
+    config.pszDebugLogFile = argv[2];
+    config.debugLogLevel = VMREST_LOG_LEVEL_ERROR;
+    config.nWorkerThr = 2;
+    config.nClientCnt = 16;
+
+    handlers.pfnHandleCreate = &VmHandleEcho;
+    handlers.pfnHandleRead = &VmHandleEcho;
+    handlers.pfnHandleUpdate = &VmHandleEcho;
+    handlers.pfnHandleDelete = &VmHandleEcho;
+    handlers.pfnHandleOthers = &VmHandleEcho;
+
+    dwError = VmRESTInit(&config, &pRESTHandle);
+    if (!dwError)
+    {
+        dwError = VmRESTRegisterHandler(pRESTHandle, "/v1/*", &handlers, NULL);
+    }
+    if (!dwError)
+    {
+        dwError = VmRESTStart(pRESTHandle);
+    }
+    if (dwError)
+    {
+        printf("Server start failed %u\n", dwError);
+        return 1;
+    }
+
+    /**** TEST 1 : GET without payload ****/
+    dwError = dispatch(pRESTHandle, "GET /v1/pkg HTTP/1.1\r\nHost: SITE\r\n\r\n", &out);
+    report(1, "Dispatch GET", !dwError && !strncmp(out.data, "HTTP/1.1 200 OK\r\n", 17) && !strcmp(body(&out), ""), &out);
+
+    /**** TEST 2 : Payload framed by Content-Length ****/
+    dwError = dispatch(pRESTHandle, "PUT /v1/pkg?x=y HTTP/1.1\r\nHost: SITE\r\nContent-Length: 15\r\n\r\nThis is payload", &out);
+    report(2, "Dispatch Content-Length payload", !dwError && !strcmp(body(&out), "This is payload"), &out);
+
+    /**** TEST 3 : Chunked payload ****/
+    dwError = dispatch(pRESTHandle, "POST /v1/pkg HTTP/1.1\r\nHost: SITE\r\nTransfer-Encoding: chunked\r\n\r\n6\r\nThis i\r\n9\r\ns payload\r\n0\r\n\r\n", &out);
+    report(3, "Dispatch chunked payload", !dwError && !strcmp(body(&out), "This is payload"), &out);
+
+    /**** TEST 4 : Incomplete request produces no response ****/
+    dwError = dispatch(pRESTHandle, "POST /v1/pkg HTTP/1.1\r\nHost: SITE\r\nContent-Length: 15\r\n\r\nThis", &out);
+    report(4, "Dispatch incomplete request", (dwError == REST_ENGINE_MORE_IO_REQUIRED) && (out.nLen == 0), &out);
+
+    /**** TEST 5 : Junk gets an error response ****/
+    dwError = dispatch(pRESTHandle, "Non HTTP Junk Data which should be discarded totally\r\n\r\n", &out);
+    report(5, "Dispatch junk request", !strncmp(out.data, "HTTP/1.1 4", 10), &out);
+
+    /**** TEST 6 : Handler sees loopback peer ****/
+    dwError = dispatch(pRESTHandle, "GET /v1/peer HTTP/1.1\r\nHost: SITE\r\n\r\n", &out);
+    report(6, "Dispatch peer address", !dwError && !strcmp(body(&out), VMREST_LOOPBACK_PEER_ADDRESS " 0"), &out);
+
+    /**** TEST 7 : Sink error aborts response and is reported ****/
+    out.bFail = 1;
+    dwError = dispatch(pRESTHandle, "GET /v1/pkg HTTP/1.1\r\nHost: SITE\r\n\r\n", &out);
+    out.bFail = 0;
+    report(7, "Dispatch sink failure", (dwError == REST_ENGINE_CONNECTION_CLOSED) && (out.nWrites == 1), &out);
+
+    /**** TEST 8 : Engine keeps serving after sink error ****/
+    dwError = dispatch(pRESTHandle, "GET /v1/pkg HTTP/1.1\r\nHost: SITE\r\nContent-Length: 2\r\n\r\nok", &out);
+    report(8, "Dispatch after sink failure", !dwError && !strcmp(body(&out), "ok"), &out);
+
+    VmRESTStop(pRESTHandle, 5);
+
+    /**** TEST 9 : Refused once stopped ****/
+    dwError = dispatch(pRESTHandle, "GET /v1/pkg HTTP/1.1\r\nHost: SITE\r\n\r\n", &out);
+    report(9, "Dispatch after stop", (dwError != 0) && (out.nLen == 0), &out);
+
+    VmRESTUnRegisterHandler(pRESTHandle, "/v1/*");
+    VmRESTShutdown(pRESTHandle);
+
+    return 0;
+}
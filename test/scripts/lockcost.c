@@ -0,0 +1,155 @@
+#include <config.h>
+#include <vmrestsys.h>
+#include <vmrestdefines.h>
+#include <vmrest.h>
+#include <vmsock.h>
+#include <vmrestcommon.h>
+
+/**** Cost of library locks with lock profiling off and on, built against
+      library internal headers.
+        uncontended                   one thread takes and releases lock
+        contended                     2 threads share lock, short critical section
+      Profiling can not be turned off again, so all off runs come first ****/
+
+#define THREADS 2
+
+typedef struct _LOCK_BENCH
+{
+    PVMREST_MUTEX                    pMutex;
+    PVMREST_RWLOCK                   pRWLock;
+    uint32_t                         nLoops;
+    volatile uint64_t                counter;
+} LOCK_BENCH;
+
+static
+uint64_t
+nowNs(
+    void
+    )
+{
+    struct timespec                  ts = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static
+void*
+mutexLoop(
+    void*                            pArg
+    )
+{
+    LOCK_BENCH*                      pBench = (LOCK_BENCH*)pArg;
+    uint32_t                         i = 0;
+
+    for (i = 0; i < pBench->nLoops; i++)
+    {
+        VmRESTLockMutex(pBench->pMutex);
+        pBench->counter++;
+        VmRESTUnlockMutex(pBench->pMutex);
+    }
+
+    return NULL;
+}
+
+static
+void*
+writeLoop(
+    void*                            pArg
+    )
+{
+    LOCK_BENCH*                      pBench = (LOCK_BENCH*)pArg;
+    uint32_t                         i = 0;
+
+    for (i = 0; i < pBench->nLoops; i++)
+    {
+        VmRESTLockWrite(pBench->pRWLock);
+        pBench->counter++;
+        VmRESTUnlockWrite(pBench->pRWLock);
+    }
+
+    return NULL;
+}
+
+static
+void
+run(
+    char*                            pszName,
+    void*                            (*pfnLoop)(void*),
+    LOCK_BENCH*                      pBench,
+    uint32_t                         nThreads
+    )
+{
+    pthread_t                        thread[THREADS];
+    uint64_t                         startNs = nowNs();
+    uint32_t                         i = 0;
+
+    for (i = 0; i < nThreads; i++)
+    {
+        pthread_create(&thread[i], NULL, pfnLoop, pBench);
+    }
+    for (i = 0; i < nThreads; i++)
+    {
+        pthread_join(thread[i], NULL);
+    }
+
+    printf("RESULT %s: pairs %u ns/pair %.1f\n",
+           pszName,
+           pBench->nLoops * nThreads,
+           (double)(nowNs() - startNs) / (pBench->nLoops * nThreads));
+}
+
+int main(int argc, char *argv[])
+{
+    LOCK_BENCH                       bench;
+    REST_LOCK_STATS                  stats[VMREST_LOCK_MAX_CLASSES];
+    uint32_t                         nStats = 0;
+    uint32_t                         i = 0;
+    int                              bFound = 0;
+
+    if (argc != 2)
+    {
+        printf("Usage: lockcost loops\n");
+        return 1;
+    }
+
+    memset(&bench, 0, sizeof(bench));
+    bench.nLoops = atoi(argv[1]);
+
+    if (VmRESTAllocateNamedMutex(&bench.pMutex, "bench-mutex") ||
+        VmRESTAllocateNamedRWLock(&bench.pRWLock, "bench-rwlock"))
+    {
+        printf("Lock allocation failed\n");
+        return 1;
+    }
+
+    run("mutex uncontended, profiling off", &mutexLoop, &bench, 1);
+    run("write lock uncontended, profiling off", &writeLoop, &bench, 1);
+    run("mutex contended, profiling off", &mutexLoop, &bench, THREADS);
+
+    VmRESTLockProfilingEnable();
+
+    run("mutex uncontended, profiling on", &mutexLoop, &bench, 1);
+    run("write lock uncontended, profiling on", &writeLoop, &bench, 1);
+    run("mutex contended, profiling on", &mutexLoop, &bench, THREADS);
+
+    VmRESTLockGetStats(stats, VMREST_LOCK_MAX_CLASSES, &nStats);
+    for (i = 0; i < nStats; i++)
+    {
+        if (!strcmp(stats[i].szName, "bench-mutex"))
+        {
+            printf("RESULT mutex profile: acquired %llu contended %llu timed-holds %llu\n",
+                   (unsigned long long)stats[i].nAcquired,
+                   (unsigned long long)stats[i].nContended,
+                   (unsigned long long)stats[i].nHeld);
+            bFound = (stats[i].nAcquired == (uint64_t)bench.nLoops * (1 + THREADS));
+        }
+    }
+    printf("%s-TEST 1: Profiled mutex counts every acquisition\n", bFound ? "PASSED" : "FAILED");
+
+    VmRESTFreeRWLock(bench.pRWLock);
+    VmRESTFreeMutex(bench.pMutex);
+
+    return 0;
+}
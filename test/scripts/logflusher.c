@@ -0,0 +1,174 @@
+#include <config.h>
+#include <vmrestsys.h>
+#include <vmrestdefines.h>
+#include <vmrest.h>
+#include <vmsock.h>
+#include <vmrestcommon.h>
+
+/**** Async log flusher, built against library internal headers.
+        first log call                new thread registers its ring while flood
+                                      threads keep flusher busy
+        records accounted             every flood record is written or reported
+                                      dropped once logger is gone ****/
+
+#define FLOOD_THREADS 2
+
+static PVMREST_HANDLE                gpRESTHandle = NULL;
+static volatile uint32_t             gbStop = 0;
+static uint64_t                      gnFlood[FLOOD_THREADS];
+
+static
+uint64_t
+nowNs(
+    void
+    )
+{
+    struct timespec                  ts = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static
+void*
+floodLoop(
+    void*                            pArg
+    )
+{
+    uint64_t*                        pnCalls = (uint64_t*)pArg;
+
+    while (!gbStop)
+    {
+        VMREST_LOG_ERROR(gpRESTHandle, "flood record %llu, padded to a usual log line length", (unsigned long long)*pnCalls);
+        (*pnCalls)++;
+    }
+
+    return NULL;
+}
+
+static
+void*
+firstLog(
+    void*                            pArg
+    )
+{
+    uint64_t*                        pLatency = (uint64_t*)pArg;
+    uint64_t                         startNs = nowNs();
+
+    VMREST_LOG_ERROR(gpRESTHandle, "first record of new thread");
+    *pLatency = nowNs() - startNs;
+
+    return NULL;
+}
+
+static
+int
+compareLatency(
+    const void*                      pLeft,
+    const void*                      pRight
+    )
+{
+    uint64_t                         left = *(const uint64_t*)pLeft;
+    uint64_t                         right = *(const uint64_t*)pRight;
+
+    return (left < right) ? -1 : (left > right);
+}
+
+int main(int argc, char *argv[])
+{
+    REST_CONF                        config;
+    pthread_t                        flood[FLOOD_THREADS];
+    pthread_t                        thread;
+    uint64_t*                        pLatency = NULL;
+    uint64_t                         nCalls = 0;
+    uint64_t                         nWritten = 0;
+    uint64_t                         nDropped = 0;
+    uint32_t                         nThreads = 0;
+    uint32_t                         i = 0;
+    FILE*                            fp = NULL;
+    char                             szLine[512];
+    char*                            pszDropped = NULL;
+
+    if (argc != 3)
+    {
+        printf("Usage: logflusher logfile threads\n");
+        return 1;
+    }
+
+    nThreads = atoi(argv[2]);
+    pLatency = calloc(nThreads, sizeof(uint64_t));
+
+    VmRESTInitConfig(&config);
+
+    config.serverPort = 8096;
+    config.pszDebugLogFile = argv[1];
+    config.debugLogLevel = VMREST_LOG_LEVEL_ERROR;
+    config.useAsyncLog = true;
+    config.nLogRingBytes = 1024 * 1024;
+
+    if (!pLatency || VmRESTInit(&config, &gpRESTHandle))
+    {
+        printf("Init failed\n");
+        return 1;
+    }
+
+    for (i = 0; i < FLOOD_THREADS; i++)
+    {
+        pthread_create(&flood[i], NULL, &floodLoop, &gnFlood[i]);
+    }
+    usleep(100000);
+
+    for (i = 0; i < nThreads; i++)
+    {
+        pthread_create(&thread, NULL, &firstLog, &pLatency[i]);
+        pthread_join(thread, NULL);
+        usleep(1000);
+    }
+
+    gbStop = 1;
+    for (i = 0; i < FLOOD_THREADS; i++)
+    {
+        pthread_join(flood[i], NULL);
+        nCalls += gnFlood[i];
+    }
+
+    /**** Shutdown of a handle never started leaves logger alone ****/
+    VmRESTLogTerminate(gpRESTHandle);
+
+    qsort(pLatency, nThreads, sizeof(uint64_t), &compareLatency);
+    printf("RESULT first log call: threads %u p50 %.1f us p99 %.1f us max %.1f us\n",
+           nThreads,
+           pLatency[nThreads / 2] / 1000.0,
+           pLatency[nThreads * 99 / 100] / 1000.0,
+           pLatency[nThreads - 1] / 1000.0);
+
+    fp = fopen(argv[1], "r");
+    while (fp && fgets(szLine, sizeof(szLine), fp))
+    {
+        if (strstr(szLine, "flood record"))
+        {
+            nWritten++;
+        }
+        else if ((pszDropped = strstr(szLine, "C-REST-ENGINE: ")) != NULL)
+        {
+            nDropped += strtoull(pszDropped + strlen("C-REST-ENGINE: "), NULL, 10);
+        }
+    }
+    if (fp)
+    {
+        fclose(fp);
+    }
+
+    printf("RESULT flood: calls %llu written %llu dropped %llu\n",
+           (unsigned long long)nCalls,
+           (unsigned long long)nWritten,
+           (unsigned long long)nDropped);
+    printf("%s-TEST 1: Every flood record written or reported dropped\n",
+           (nWritten + nDropped == nCalls) ? "PASSED" : "FAILED");
+
+    VmRESTShutdown(gpRESTHandle);
+    free(pLatency);
+
+    return 0;
+}
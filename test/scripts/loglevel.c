@@ -0,0 +1,151 @@
+#include <config.h>
+#include <vmrestsys.h>
+#include <vmrestdefines.h>
+#include <vmrest.h>
+#include <vmsock.h>
+#include <vmrestcommon.h>
+
+/**** Cost of log calls at ERROR level, built against library internal headers.
+        disabled debug                VMREST_LOG_DEBUG, level checked inline
+        direct call                   VmRESTLog() as every call site did before
+        rate limited flood            VMREST_LOG_ERROR_RATELIMITED from one site
+        error written                 VMREST_LOG_ERROR, message reaches log file ****/
+
+static volatile uint32_t             gnEvaluated = 0;
+
+static
+__attribute__((noinline))
+const char*
+argument(
+    void
+    )
+{
+    gnEvaluated++;
+    return "value";
+}
+
+static
+uint64_t
+nowNs(
+    void
+    )
+{
+    struct timespec                  ts = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static
+uint32_t
+lines(
+    char*                            pszFile
+    )
+{
+    FILE*                            fp = fopen(pszFile, "r");
+    uint32_t                         n = 0;
+    int                              c = 0;
+
+    if (fp)
+    {
+        while ((c = fgetc(fp)) != EOF)
+        {
+            n += (c == '\n');
+        }
+        fclose(fp);
+    }
+
+    return n;
+}
+
+static
+void
+report(
+    char*                            pszName,
+    uint64_t                         startNs,
+    uint32_t                         nCalls,
+    uint32_t                         nLines
+    )
+{
+    printf("RESULT %s: calls %u ns/call %.1f arguments-evaluated %u lines %u\n",
+           pszName,
+           nCalls,
+           (double)(nowNs() - startNs) / nCalls,
+           gnEvaluated,
+           nLines);
+    gnEvaluated = 0;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t                         dwError = 0;
+    PVMREST_HANDLE                   pRESTHandle = NULL;
+    REST_CONF                        config;
+    uint32_t                         nCalls = 0;
+    uint32_t                         nBase = 0;
+    uint32_t                         nWritten = 0;
+    uint64_t                         nSeconds = 0;
+    uint32_t                         i = 0;
+    uint64_t                         startNs = 0;
+
+    if (argc != 3)
+    {
+        printf("Usage: loglevel logfile calls\n");
+        return 1;
+    }
+
+    nCalls = atoi(argv[2]);
+
+    VmRESTInitConfig(&config);
+
+    config.serverPort = 8096;
+    config.pszDebugLogFile = argv[1];
+    config.debugLogLevel = VMREST_LOG_LEVEL_ERROR;
+
+    dwError = VmRESTInit(&config, &pRESTHandle);
+    if (dwError)
+    {
+        printf("Init failed %u\n", dwError);
+        return 1;
+    }
+
+    startNs = nowNs();
+    for (i = 0; i < nCalls; i++)
+    {
+        VMREST_LOG_DEBUG(pRESTHandle, "request %s number %u", argument(), i);
+    }
+    report("disabled debug", startNs, nCalls, 0);
+    printf("%s-TEST 1: Disabled debug does not evaluate arguments\n", (gnEvaluated == 0) ? "PASSED" : "FAILED");
+
+    startNs = nowNs();
+    for (i = 0; i < nCalls; i++)
+    {
+        VmRESTLog(pRESTHandle, VMREST_LOG_LEVEL_DEBUG, "request %s number %u [file: %s][line: %d]", argument(), i, __FILE__, __LINE__);
+    }
+    report("direct call", startNs, nCalls, 0);
+
+    nBase = lines(argv[1]);
+    startNs = nowNs();
+    for (i = 0; i < nCalls; i++)
+    {
+        VMREST_LOG_ERROR_RATELIMITED(pRESTHandle, "request %s number %u", argument(), i);
+    }
+    nSeconds = (nowNs() - startNs) / 1000000000ULL + 1;
+    nWritten = lines(argv[1]) - nBase;
+    report("rate limited flood", startNs, nCalls, nWritten);
+    printf("%s-TEST 2: Rate limited flood writes at most burst per second\n",
+           (nWritten <= (nSeconds + 1) * VMREST_LOG_RATE_BURST) ? "PASSED" : "FAILED");
+
+    nBase = lines(argv[1]);
+    startNs = nowNs();
+    for (i = 0; i < nCalls / 100; i++)
+    {
+        VMREST_LOG_ERROR(pRESTHandle, "request %s number %u", argument(), i);
+    }
+    report("error written", startNs, nCalls / 100, lines(argv[1]) - nBase);
+
+    VmRESTShutdown(pRESTHandle);
+
+    return 0;
+}
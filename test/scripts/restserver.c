@@ -0,0 +1,220 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <vmrest.h>
+
+/**** Small REST engine instance driven by the test scripts.
+      Every request is answered with 200 and the name given by -n ****/
+
+static volatile sig_atomic_t         gbStop = 0;
+static volatile sig_atomic_t         gbReload = 0;
+static char*                         gpszName = "restserver";
+static char*                         gpszSendPath = NULL;
+static char*                         gpszReceivePath = NULL;
+
+static
+void
+sig_handler(
+    int                              signo
+    )
+{
+    if (signo == SIGUSR1)
+    {
+        gbReload = 1;
+    }
+    else
+    {
+        gbStop = 1;
+    }
+}
+
+static
+uint32_t
+VmHandleName(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_REQUEST                    pRequest,
+    PREST_RESPONSE*                  ppResponse,
+    uint32_t                         paramsCount
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_MORE_IO_REQUIRED;
+    char                             buffer[4097] = {0};
+    char                             size[16] = {0};
+    uint32_t                         bytesRW = 0;
+
+    while (dwError == REST_ENGINE_MORE_IO_REQUIRED)
+    {
+        dwError = VmRESTGetData(pRESTHandle, pRequest, buffer, &bytesRW);
+    }
+    if (dwError)
+    {
+        return dwError;
+    }
+
+    dwError = VmRESTSetSuccessResponse(pRequest, ppResponse);
+    if (dwError)
+    {
+        return dwError;
+    }
+
+    snprintf(size, sizeof(size), "%zu", strlen(gpszName));
+    dwError = VmRESTSetDataLength(ppResponse, size);
+    if (dwError)
+    {
+        return dwError;
+    }
+
+    return VmRESTSetData(pRESTHandle, ppResponse, gpszName, strlen(gpszName), &bytesRW);
+}
+
+static
+void
+usage(
+    void
+    )
+{
+    printf("Usage: restserver -p port [-n name] [-c cert -k key] [-l logfile]\n");
+    printf("                  [-s sendpath] [-r receivepath] [-u udspath [-M mode]]\n");
+    printf("                  [-m shmpath [-b ringbytes]]\n");
+    printf("  -c, -k     serve HTTPS, SIGUSR1 reloads certificate and key from these files\n");
+    printf("  -s         on stop, pass listeners to successor waiting on this socket path\n");
+    printf("  -r         take listeners from predecessor on this socket path instead of binding\n");
+    printf("  -u, -M     also listen on this Unix domain socket path, with octal file mode\n");
+    printf("  -m, -b     also serve shared memory clients rendezvousing on this path, ring size\n");
+    printf("  SIGTERM or SIGINT stops the server\n");
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t                         dwError = 0;
+    PVMREST_HANDLE                   pRESTHandle = NULL;
+    REST_CONF                        config;
+    REST_PROCESSOR                   handlers;
+    int                              opt = 0;
+
+    VmRESTInitConfig(&config);
+    memset(&handlers, 0, sizeof(handlers));
+
+    config.nWorkerThr = 4;
+    config.nClientCnt = 64;
+    config.connTimeoutSec = 30;
+    config.debugLogLevel = VMREST_LOG_LEVEL_ERROR;
+
+    while ((opt = getopt(argc, argv, "p:n:c:k:l:s:r:u:M:m:b:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'p':
+                config.serverPort = atoi(optarg);
+                break;
+            case 'n':
+                gpszName = optarg;
+                break;
+            case 'c':
+                config.pszSSLCertificate = optarg;
+                config.isSecure = true;
+                break;
+            case 'k':
+                config.pszSSLKey = optarg;
+                break;
+            case 'l':
+                config.pszDebugLogFile = optarg;
+                break;
+            case 's':
+                gpszSendPath = optarg;
+                break;
+            case 'r':
+                gpszReceivePath = optarg;
+                break;
+            case 'u':
+                config.pszUnixSocketPath = optarg;
+                break;
+            case 'M':
+                config.unixSocketMode = strtoul(optarg, NULL, 8);
+                break;
+            case 'm':
+                config.pszShmSocketPath = optarg;
+                break;
+            case 'b':
+                config.nShmRingBytes = atoi(optarg);
+                break;
+            default:
+                usage();
+                return 1;
+        }
+    }
+
+    if (!config.serverPort)
+    {
+        usage();
+        return 1;
+    }
+
+    signal(SIGPIPE, SIG_IGN);
+    signal(SIGUSR1, sig_handler);
+    signal(SIGTERM, sig_handler);
+    signal(SIGINT, sig_handler);
+
+    handlers.pfnHandleCreate = &VmHandleName;
+    handlers.pfnHandleRead = &VmHandleName;
+    handlers.pfnHandleUpdate = &VmHandleName;
+    handlers.pfnHandleDelete = &VmHandleName;
+    handlers.pfnHandleOthers = &VmHandleName;
+
+    dwError = VmRESTInit(&config, &pRESTHandle);
+    if (dwError)
+    {
+        printf("VmRESTInit failed %u\n", dwError);
+        return 1;
+    }
+
+    dwError = VmRESTRegisterHandler(pRESTHandle, "/v1/*", &handlers, NULL);
+    if (!dwError && gpszReceivePath)
+    {
+        dwError = VmRESTReceiveListenerFds(pRESTHandle, gpszReceivePath, 20);
+        printf("receive %u\n", dwError);
+    }
+    if (!dwError)
+    {
+        dwError = VmRESTStart(pRESTHandle);
+    }
+    if (dwError)
+    {
+        printf("VmRESTStart failed %u\n", dwError);
+        VmRESTShutdown(pRESTHandle);
+        return 1;
+    }
+
+    printf("started\n");
+    fflush(stdout);
+
+    while (!gbStop)
+    {
+        if (gbReload)
+        {
+            gbReload = 0;
+            dwError = VmRESTReloadSSLContext(pRESTHandle, NULL, 0, NULL, 0);
+            printf("reload %u\n", dwError);
+            fflush(stdout);
+        }
+        usleep(50000);
+    }
+
+    if (gpszSendPath)
+    {
+        dwError = VmRESTSendListenerFds(pRESTHandle, gpszSendPath);
+        printf("send %u\n", dwError);
+        fflush(stdout);
+    }
+
+    VmRESTStop(pRESTHandle, 5);
+    VmRESTUnRegisterHandler(pRESTHandle, "/v1/*");
+    VmRESTShutdown(pRESTHandle);
+
+    printf("stopped\n");
+
+    return 0;
+}
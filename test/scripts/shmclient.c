@@ -0,0 +1,107 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <vmrestclient.h>
+
+/**** Round trips over shared memory channel of libvmrestclient.
+      Prints one line per step:
+        get <status> <body>           GET request
+        post <status> <body>          POST of payload file
+        loop <ok> of <count>          repeated GETs on same channel ****/
+
+#define MAXDATASIZE 65536
+#define LOOPCOUNT   200
+
+static
+int
+doRequest(
+    PVMREST_SHM_CLIENT               pClient,
+    char*                            tag,
+    char*                            request,
+    uint32_t                         requestLen,
+    int                              bPrint
+    )
+{
+    uint32_t                         dwError = 0;
+    char*                            response = NULL;
+    char*                            body = NULL;
+    uint32_t                         responseLen = 0;
+    int                              status = 0;
+
+    dwError = VmRESTShmClientRequest(pClient, request, requestLen, &response, &responseLen, 5000);
+    if (dwError)
+    {
+        printf("%s failed %u\n", tag, dwError);
+        return 0;
+    }
+
+    sscanf(response, "HTTP/1.1 %d", &status);
+    body = strstr(response, "\r\n\r\n");
+    body = body ? body + 4 : "";
+
+    if (bPrint)
+    {
+        printf("%s %d %s\n", tag, status, body);
+    }
+
+    VmRESTShmClientFreeResponse(response);
+
+    return status;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t                         dwError = 0;
+    PVMREST_SHM_CLIENT               pClient = NULL;
+    char*                            request = NULL;
+    char*                            get = "GET /v1/pkg HTTP/1.1\r\nHost: SITE\r\nConnection: keep-alive\r\n\r\n";
+    FILE*                            fp = NULL;
+    size_t                           payloadLen = 0;
+    int                              headerLen = 0;
+    int                              ok = 0;
+    int                              i = 0;
+
+    if (argc != 3)
+    {
+        printf("Usage: shmclient socket-path payload-file\n");
+        return 1;
+    }
+
+    dwError = VmRESTShmClientConnect(argv[1], &pClient);
+    if (dwError)
+    {
+        printf("connect failed %u\n", dwError);
+        return 1;
+    }
+
+    doRequest(pClient, "get", get, strlen(get), 1);
+
+    request = malloc(MAXDATASIZE);
+    fp = fopen(argv[2], "r");
+    if (request && fp)
+    {
+        payloadLen = fread(request + 512, 1, MAXDATASIZE - 512, fp);
+        headerLen = snprintf(request, 512, "POST /v1/pkg HTTP/1.1\r\nHost: SITE\r\nConnection: keep-alive\r\nContent-Length: %zu\r\n\r\n", payloadLen);
+        memmove(request + headerLen, request + 512, payloadLen);
+        doRequest(pClient, "post", request, headerLen + payloadLen, 1);
+    }
+    if (fp)
+    {
+        fclose(fp);
+    }
+    free(request);
+
+    for (i = 0; i < LOOPCOUNT; i++)
+    {
+        if (doRequest(pClient, "loop", get, strlen(get), 0) == 200)
+        {
+            ok++;
+        }
+    }
+    printf("loop %d of %d\n", ok, LOOPCOUNT);
+
+    VmRESTShmClientClose(pClient);
+
+    return 0;
+}
@@ -0,0 +1,231 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <string.h>
+#include <netdb.h>
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <openssl/ssl.h>
+#include <openssl/err.h>
+#include <openssl/x509.h>
+
+/**** Holds one TLS connection open across a certificate reload.
+      Prints status and certificate subject CN of each request:
+        held <status> <CN>     first request on held connection
+        held <status> <CN>     second request on it, after trigger file appears
+        new <status> <CN>      request on a fresh connection ****/
+
+#define MAXDATASIZE 4096
+
+static
+int
+connectServer(
+    char*                            host,
+    char*                            port
+    )
+{
+    struct addrinfo                  hints;
+    struct addrinfo*                 servinfo = NULL;
+    struct addrinfo*                 p = NULL;
+    int                              sockfd = -1;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+
+    if (getaddrinfo(host, port, &hints, &servinfo) != 0)
+    {
+        return -1;
+    }
+
+    for (p = servinfo; p != NULL; p = p->ai_next)
+    {
+        sockfd = socket(p->ai_family, p->ai_socktype, p->ai_protocol);
+        if (sockfd == -1)
+        {
+            continue;
+        }
+        if (connect(sockfd, p->ai_addr, p->ai_addrlen) == 0)
+        {
+            break;
+        }
+        close(sockfd);
+        sockfd = -1;
+    }
+
+    freeaddrinfo(servinfo);
+
+    return sockfd;
+}
+
+/**** Sends one keep-alive GET and reads response framed by Content-Length ****/
+static
+int
+doRequest(
+    SSL*                             ssl,
+    char*                            tag
+    )
+{
+    char                             buf[MAXDATASIZE] = {0};
+    char                             cn[256] = "none";
+    char*                            req = "GET /v1/pkg HTTP/1.1\r\nHost: SITE\r\nConnection: keep-alive\r\n\r\n";
+    char*                            hdrEnd = NULL;
+    char*                            lenHdr = NULL;
+    int                              total = 0;
+    int                              n = 0;
+    int                              status = 0;
+    int                              contentLength = 0;
+    X509*                            cert = NULL;
+
+    if (SSL_write(ssl, req, strlen(req)) <= 0)
+    {
+        printf("%s write failed\n", tag);
+        return 1;
+    }
+
+    while (total < MAXDATASIZE - 1)
+    {
+        n = SSL_read(ssl, buf + total, MAXDATASIZE - 1 - total);
+        if (n <= 0)
+        {
+            printf("%s read failed\n", tag);
+            return 1;
+        }
+        total += n;
+        buf[total] = '\0';
+
+        hdrEnd = strstr(buf, "\r\n\r\n");
+        if (!hdrEnd)
+        {
+            continue;
+        }
+        lenHdr = strstr(buf, "Content-Length:");
+        contentLength = lenHdr ? atoi(lenHdr + strlen("Content-Length:")) : 0;
+        if (total >= (hdrEnd + 4 - buf) + contentLength)
+        {
+            break;
+        }
+    }
+
+    sscanf(buf, "HTTP/1.1 %d", &status);
+
+    cert = SSL_get_peer_certificate(ssl);
+    if (cert)
+    {
+        X509_NAME_get_text_by_NID(X509_get_subject_name(cert), NID_commonName, cn, sizeof(cn));
+        X509_free(cert);
+    }
+
+    printf("%s %d %s\n", tag, status, cn);
+    fflush(stdout);
+
+    return 0;
+}
+
+static
+SSL*
+openSSLConn(
+    SSL_CTX*                         ctx,
+    char*                            host,
+    char*                            port,
+    int*                             pSockfd
+    )
+{
+    SSL*                             ssl = NULL;
+    int                              sockfd = connectServer(host, port);
+
+    if (sockfd < 0)
+    {
+        printf("client: failed to connect\n");
+        return NULL;
+    }
+
+    ssl = SSL_new(ctx);
+    SSL_set_fd(ssl, sockfd);
+    if (SSL_connect(ssl) != 1)
+    {
+        printf("client: handshake failed\n");
+        SSL_free(ssl);
+        close(sockfd);
+        return NULL;
+    }
+
+    *pSockfd = sockfd;
+
+    return ssl;
+}
+
+int main(int argc, char *argv[])
+{
+    SSL_CTX*                         ctx = NULL;
+    SSL*                             held = NULL;
+    SSL*                             fresh = NULL;
+    int                              heldfd = -1;
+    int                              freshfd = -1;
+    int                              waited = 0;
+    int                              ret = 1;
+    struct stat                      st;
+
+    if (argc != 4)
+    {
+        printf("Usage: sslclient host port trigger-file\n");
+        return 1;
+    }
+
+    SSL_library_init();
+    SSL_load_error_strings();
+
+    ctx = SSL_CTX_new(SSLv23_client_method());
+    if (!ctx)
+    {
+        return 1;
+    }
+
+    held = openSSLConn(ctx, argv[1], argv[2], &heldfd);
+    if (!held || doRequest(held, "held"))
+    {
+        goto cleanup;
+    }
+
+    /**** Script rotates certificate and creates trigger file meanwhile ****/
+    while (stat(argv[3], &st) != 0)
+    {
+        if (++waited > 300)
+        {
+            printf("client: no trigger file\n");
+            goto cleanup;
+        }
+        usleep(100000);
+    }
+
+    if (doRequest(held, "held"))
+    {
+        goto cleanup;
+    }
+
+    fresh = openSSLConn(ctx, argv[1], argv[2], &freshfd);
+    if (!fresh || doRequest(fresh, "new"))
+    {
+        goto cleanup;
+    }
+
+    ret = 0;
+
+cleanup:
+    if (fresh)
+    {
+        SSL_shutdown(fresh);
+        SSL_free(fresh);
+        close(freshfd);
+    }
+    if (held)
+    {
+        SSL_shutdown(held);
+        SSL_free(held);
+        close(heldfd);
+    }
+    SSL_CTX_free(ctx);
+
+    return ret;
+}
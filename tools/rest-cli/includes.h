@@ -19,5 +19,12 @@
 
 
 #include <vmrestsys.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <time.h>
+#include <sched.h>
 #include <vmrestdefines.h>
+#include <vmrest.h>
+#include <vmreststats.h>
 
@@ -13,7 +13,743 @@
 
 #include "includes.h"
 
-int main(int argc, char *argv[])
+#define REST_CLI_DEFAULT_INTERVAL_SECS                  2
+#define REST_CLI_DEFAULT_ROUTES                         20
+#define REST_CLI_SNAPSHOT_RETRIES                       1000
+
+typedef struct _REST_CLI_TOP_ARGS
+{
+    char                             szName[VMREST_STATS_SHM_NAME_LEN];
+    const char*                      pszDaemon;
+    uint32_t                         port;
+    uint32_t                         intervalSecs;
+    uint32_t                         nCount;
+    uint32_t                         nRoutes;
+    int                              bBatch;
+} REST_CLI_TOP_ARGS, *PREST_CLI_TOP_ARGS;
+
+/**** Route row of one interval, matched to previous snapshot by route and method ****/
+typedef struct _REST_CLI_ROUTE_ROW
+{
+    PREST_ROUTE_STATS                pRoute;
+    uint64_t                         nDelta;
+} REST_CLI_ROUTE_ROW, *PREST_CLI_ROUTE_ROW;
+
+static
+void
+RestCliUsage(
+    void
+    )
+{
+    fprintf(stderr,
+        "Usage: rest-cli list\n"
+        "       rest-cli top [-n name | -d daemon -p port] [-i seconds] [-c count] [-r routes] [-b]\n"
+        "\n"
+        "  list         stats segments published under %s\n"
+        "  top          live view of one instance, it is picked by segment name\n"
+        "               or by daemon and port, any single one is used otherwise\n"
+        "  -i seconds   refresh interval, default %u\n"
+        "  -c count     exit after count refreshes\n"
+        "  -r routes    routes shown, default %u\n"
+        "  -b           batch mode, no screen clearing\n",
+        VMREST_STATS_SHM_DIR,
+        REST_CLI_DEFAULT_INTERVAL_SECS,
+        REST_CLI_DEFAULT_ROUTES
+        );
+}
+
+static
+uint64_t
+RestCliNowMs(
+    void
+    )
+{
+    struct timespec                  ts = {0};
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000) + ((uint64_t)ts.tv_nsec / 1000000);
+}
+
+/**** Maps segment read only, anything of other layout is refused ****/
+static
+uint32_t
+RestCliAttach(
+    const char*                      pszName,
+    PVMREST_STATS_SHM*               ppShm
+    )
+{
+    uint32_t                         dwError = 0;
+    PVMREST_STATS_SHM                pShm = NULL;
+    struct stat                      st = {0};
+    int                              fd = -1;
+
+    fd = shm_open(pszName, O_RDONLY, 0);
+    if (fd < 0)
+    {
+        dwError = errno;
+        goto error;
+    }
+
+    if ((fstat(fd, &st) != 0) || (st.st_size != sizeof(VMREST_STATS_SHM)))
+    {
+        dwError = EPROTO;
+        goto error;
+    }
+
+    pShm = mmap(NULL, sizeof(VMREST_STATS_SHM), PROT_READ, MAP_SHARED, fd, 0);
+    if (pShm == MAP_FAILED)
+    {
+        pShm = NULL;
+        dwError = errno;
+        goto error;
+    }
+
+    if ((__atomic_load_n(&pShm->magic, __ATOMIC_ACQUIRE) != VMREST_STATS_SHM_MAGIC) ||
+        (pShm->version != VMREST_STATS_SHM_VERSION) ||
+        (pShm->nBytes != sizeof(VMREST_STATS_SHM)))
+    {
+        dwError = EPROTO;
+        goto error;
+    }
+
+    *ppShm = pShm;
+
+cleanup:
+
+    if (fd >= 0)
+    {
+        close(fd);
+    }
+
+    return dwError;
+
+error:
+
+    if (pShm)
+    {
+        munmap(pShm, sizeof(VMREST_STATS_SHM));
+    }
+
+    goto cleanup;
+}
+
+static
+void
+RestCliDetach(
+    PVMREST_STATS_SHM                pShm
+    )
+{
+    if (pShm)
+    {
+        munmap(pShm, sizeof(VMREST_STATS_SHM));
+    }
+}
+
+/**** Seqlock reader, copy is retried while publisher is in the middle of a snapshot ****/
+static
+uint32_t
+RestCliSnapshot(
+    PVMREST_STATS_SHM                pShm,
+    PVMREST_STATS_SHM                pSnap
+    )
+{
+    size_t                           offset = offsetof(VMREST_STATS_SHM, nRoutes);
+    uint32_t                         seq1 = 0;
+    uint32_t                         seq2 = 0;
+    uint32_t                         nTry = 0;
+
+    memcpy(pSnap, pShm, offset);
+
+    for (nTry = 0; nTry < REST_CLI_SNAPSHOT_RETRIES; nTry++)
+    {
+        seq1 = __atomic_load_n(&pShm->seq, __ATOMIC_ACQUIRE);
+        if (seq1 & 1)
+        {
+            sched_yield();
+            continue;
+        }
+
+        memcpy((char*)pSnap + offset, (char*)pShm + offset, sizeof(VMREST_STATS_SHM) - offset);
+
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        seq2 = __atomic_load_n(&pShm->seq, __ATOMIC_RELAXED);
+        if (seq1 == seq2)
+        {
+            if (pSnap->nRoutes > VMREST_STATS_SHM_MAX_ROUTES)
+            {
+                pSnap->nRoutes = VMREST_STATS_SHM_MAX_ROUTES;
+            }
+            return 0;
+        }
+    }
+
+    return EAGAIN;
+}
+
+static
+int
+RestCliIsSegmentName(
+    const char*                      pszEntry
+    )
 {
+    return strncmp(pszEntry, VMREST_STATS_SHM_PREFIX + 1, strlen(VMREST_STATS_SHM_PREFIX) - 1) == 0;
+}
+
+static
+uint32_t
+RestCliList(
+    void
+    )
+{
+    DIR*                             pDir = NULL;
+    struct dirent*                   pEntry = NULL;
+    PVMREST_STATS_SHM                pShm = NULL;
+    char                             szName[VMREST_STATS_SHM_NAME_LEN] = {0};
+    uint64_t                         nowMs = RestCliNowMs();
+    uint32_t                         nFound = 0;
+
+    pDir = opendir(VMREST_STATS_SHM_DIR);
+    if (!pDir)
+    {
+        fprintf(stderr, "rest-cli: cannot open %s: %s\n", VMREST_STATS_SHM_DIR, strerror(errno));
+        return errno;
+    }
+
+    printf("%-32s %-20s %8s %6s %10s %s\n", "NAME", "DAEMON", "PID", "PORT", "UPTIME", "STATE");
+
+    while ((pEntry = readdir(pDir)) != NULL)
+    {
+        if (!RestCliIsSegmentName(pEntry->d_name) ||
+            (strlen(pEntry->d_name) + 2 > sizeof(szName)))
+        {
+            continue;
+        }
+
+        snprintf(szName, sizeof(szName), "/%.*s", (int)sizeof(szName) - 2, pEntry->d_name);
+
+        if (RestCliAttach(szName, &pShm) != 0)
+        {
+            continue;
+        }
+
+        printf("%-32s %-20.19s %8d %6u %9llus %s\n",
+            szName,
+            pShm->szDaemonName,
+            pShm->pid,
+            pShm->serverPort,
+            (unsigned long long)((nowMs - pShm->startTimeMs) / 1000),
+            pShm->bStopped ? "stopped" : "running"
+            );
+
+        RestCliDetach(pShm);
+        pShm = NULL;
+        nFound++;
+    }
+
+    closedir(pDir);
+
+    if (!nFound)
+    {
+        printf("no stats segments, set statsShmIntervalMs to publish one\n");
+    }
+
+    return 0;
+}
+
+/**** Without name or daemon and port, the only segment there is gets picked ****/
+static
+uint32_t
+RestCliResolveName(
+    PREST_CLI_TOP_ARGS               pArgs
+    )
+{
+    DIR*                             pDir = NULL;
+    struct dirent*                   pEntry = NULL;
+    uint32_t                         nFound = 0;
+    size_t                           idx = 0;
+
+    if (pArgs->szName[0])
+    {
+        return 0;
+    }
+
+    if (pArgs->pszDaemon && pArgs->port)
+    {
+        snprintf(pArgs->szName, sizeof(pArgs->szName), "%s%s-%u",
+            VMREST_STATS_SHM_PREFIX, pArgs->pszDaemon, pArgs->port);
+
+        /**** Same mapping engine applies to daemon name ****/
+        for (idx = 1; pArgs->szName[idx] != '\0'; idx++)
+        {
+            if (!isalnum((unsigned char)pArgs->szName[idx]) && (pArgs->szName[idx] != '-') &&
+                (pArgs->szName[idx] != '_') && (pArgs->szName[idx] != '.'))
+            {
+                pArgs->szName[idx] = '_';
+            }
+        }
+        return 0;
+    }
+
+    pDir = opendir(VMREST_STATS_SHM_DIR);
+    if (!pDir)
+    {
+        return errno;
+    }
+
+    while ((pEntry = readdir(pDir)) != NULL)
+    {
+        if (RestCliIsSegmentName(pEntry->d_name) &&
+            (strlen(pEntry->d_name) + 2 <= sizeof(pArgs->szName)))
+        {
+            snprintf(pArgs->szName, sizeof(pArgs->szName), "/%.*s", (int)sizeof(pArgs->szName) - 2, pEntry->d_name);
+            nFound++;
+        }
+    }
+
+    closedir(pDir);
+
+    if (nFound != 1)
+    {
+        fprintf(stderr, "rest-cli: %s stats segment, pick one with -n or -d and -p\n",
+            nFound ? "more than one" : "no");
+        return ENOENT;
+    }
+
     return 0;
 }
+
+/**** Bucket upper bound holding given share of count, same rule engine uses ****/
+static
+uint64_t
+RestCliPercentile(
+    const uint64_t*                  pBucket,
+    const uint64_t*                  pUpper,
+    uint64_t                         nTotal,
+    uint32_t                         permille
+    )
+{
+    uint64_t                         nRank = 0;
+    uint64_t                         nSeen = 0;
+    uint32_t                         idx = 0;
+
+    if (!nTotal)
+    {
+        return 0;
+    }
+
+    nRank = ((nTotal * permille) + 999) / 1000;
+
+    for (idx = 0; idx < VMREST_METRICS_HIST_BUCKETS; idx++)
+    {
+        nSeen += pBucket[idx];
+        if (nSeen >= nRank)
+        {
+            return pUpper[idx];
+        }
+    }
+
+    return pUpper[VMREST_METRICS_HIST_BUCKETS - 1];
+}
+
+static
+const char*
+RestCliFormatUs(
+    uint64_t                         us,
+    char*                            pszBuf,
+    size_t                           nLen
+    )
+{
+    if (us < 1000)
+    {
+        snprintf(pszBuf, nLen, "%lluus", (unsigned long long)us);
+    }
+    else if (us < 1000000)
+    {
+        snprintf(pszBuf, nLen, "%.1fms", us / 1000.0);
+    }
+    else
+    {
+        snprintf(pszBuf, nLen, "%.2fs", us / 1000000.0);
+    }
+
+    return pszBuf;
+}
+
+/**** Mean CPU of one phase per sampled request, 0 without samples ****/
+static
+uint64_t
+RestCliCpuPerRequestUs(
+    PREST_CPU_STATS                  pCpu,
+    PREST_CPU_STATS                  pOld,
+    uint32_t                         phase
+    )
+{
+    uint64_t                         nSamples = pCpu->nSamples - (pOld ? pOld->nSamples : 0);
+    uint64_t                         cpuNs = pCpu->cpuNs[phase] - (pOld ? pOld->cpuNs[phase] : 0);
+
+    return nSamples ? (cpuNs / nSamples / 1000) : 0;
+}
+
+static
+int
+RestCliCompareRows(
+    const void*                      pLeft,
+    const void*                      pRight
+    )
+{
+    const REST_CLI_ROUTE_ROW*        pA = pLeft;
+    const REST_CLI_ROUTE_ROW*        pB = pRight;
+
+    if (pA->nDelta != pB->nDelta)
+    {
+        return (pA->nDelta < pB->nDelta) ? 1 : -1;
+    }
+
+    return (pA->pRoute->latency.nCount < pB->pRoute->latency.nCount) ? 1 :
+           (pA->pRoute->latency.nCount > pB->pRoute->latency.nCount) ? -1 : 0;
+}
+
+static
+uint64_t
+RestCliPreviousRouteCount(
+    PVMREST_STATS_SHM                pPrev,
+    PREST_ROUTE_STATS                pRoute
+    )
+{
+    uint32_t                         idx = 0;
+
+    for (idx = 0; pPrev && (idx < pPrev->nRoutes); idx++)
+    {
+        if (!strcmp(pPrev->route[idx].szRoute, pRoute->szRoute) &&
+            !strcmp(pPrev->route[idx].szMethod, pRoute->szMethod))
+        {
+            return pPrev->route[idx].latency.nCount;
+        }
+    }
+
+    return 0;
+}
+
+/**** Rates and interval percentiles come from difference to previous snapshot,
+      first screen has none and shows totals only ****/
+static
+void
+RestCliPrintTop(
+    PREST_CLI_TOP_ARGS               pArgs,
+    PVMREST_STATS_SHM                pCur,
+    PVMREST_STATS_SHM                pPrev
+    )
+{
+    REST_CLI_ROUTE_ROW               row[VMREST_STATS_SHM_MAX_ROUTES];
+    uint64_t                         delta[VMREST_METRICS_HIST_BUCKETS];
+    PREST_STATS                      pStats = &pCur->stats;
+    PREST_STATS                      pOld = pPrev ? &pPrev->stats : NULL;
+    uint64_t                         nTotal = 0;
+    uint64_t                         nDelta = 0;
+    uint64_t                         nowMs = RestCliNowMs();
+    double                           secs = 0;
+    char                             sz1[32];
+    char                             sz2[32];
+    char                             sz3[32];
+    char                             sz4[32];
+    char                             sz5[32];
+    PREST_CPU_STATS                  pCpuFrom = NULL;
+    uint32_t                         idx = 0;
+
+    if (pOld && (pCur->snapshotNs > pPrev->snapshotNs))
+    {
+        secs = (pCur->snapshotNs - pPrev->snapshotNs) / 1e9;
+    }
+    else
+    {
+        pOld = NULL;
+    }
+
+#define REST_CLI_RATE(FIELD) \
+    (pOld ? (double)(pStats->FIELD - pOld->FIELD) / secs : 0.0)
+
+    if (!pArgs->bBatch)
+    {
+        printf("\033[H\033[2J");
+    }
+
+    printf("rest-top - %s pid %d port %u up %llus, snapshot %llu%s\n",
+        pCur->szDaemonName,
+        pCur->pid,
+        pCur->serverPort,
+        (unsigned long long)((pCur->snapshotTimeMs - pCur->startTimeMs) / 1000),
+        (unsigned long long)pCur->nUpdates,
+        pCur->bStopped ? " [stopped]" :
+            ((nowMs > pCur->snapshotTimeMs + (3 * pCur->intervalMs) + 1000) ? " [stale]" : "")
+        );
+
+    for (idx = 0; idx < VMREST_STATS_STATUS_CLASSES; idx++)
+    {
+        nTotal += pStats->nResponses[idx];
+        nDelta += pOld ? (pStats->nResponses[idx] - pOld->nResponses[idx]) : 0;
+    }
+
+    printf("Requests: %10.1f/s  2xx %.1f/s  3xx %.1f/s  4xx %.1f/s  5xx %.1f/s  total %llu\n",
+        pOld ? nDelta / secs : 0.0,
+        REST_CLI_RATE(nResponses[2]),
+        REST_CLI_RATE(nResponses[3]),
+        REST_CLI_RATE(nResponses[4]),
+        REST_CLI_RATE(nResponses[5]),
+        (unsigned long long)nTotal
+        );
+
+    nDelta = 0;
+    for (idx = 0; idx < VMREST_METRICS_HIST_BUCKETS; idx++)
+    {
+        delta[idx] = pOld ? (pCur->latencyBucket[idx] - pPrev->latencyBucket[idx]) : 0;
+        nDelta += delta[idx];
+    }
+
+    printf("Latency:  interval p50 %s p90 %s p99 %s (%llu)\n",
+        RestCliFormatUs(RestCliPercentile(delta, pCur->latencyUpperUs, nDelta, 500), sz1, sizeof(sz1)),
+        RestCliFormatUs(RestCliPercentile(delta, pCur->latencyUpperUs, nDelta, 900), sz2, sizeof(sz2)),
+        RestCliFormatUs(RestCliPercentile(delta, pCur->latencyUpperUs, nDelta, 990), sz3, sizeof(sz3)),
+        (unsigned long long)nDelta
+        );
+
+    printf("          total    p50 %s p90 %s p99 %s max %s\n",
+        RestCliFormatUs(pStats->latency.p50Us, sz1, sizeof(sz1)),
+        RestCliFormatUs(pStats->latency.p90Us, sz2, sizeof(sz2)),
+        RestCliFormatUs(pStats->latency.p99Us, sz3, sizeof(sz3)),
+        RestCliFormatUs(pStats->latency.maxUs, sz4, sizeof(sz4))
+        );
+
+    printf("Conns:    active %u idle %u  accepts %.1f/s  timeouts %.1f/s\n",
+        pStats->nActiveConnections,
+        pStats->nIdleConnections,
+        REST_CLI_RATE(nAccepts),
+        REST_CLI_RATE(nTimeouts)
+        );
+
+    printf("Traffic:  in %.1f KB/s  out %.1f KB/s  handshakes %.1f/s  failed %.1f/s\n",
+        REST_CLI_RATE(nBytesIn) / 1024.0,
+        REST_CLI_RATE(nBytesOut) / 1024.0,
+        REST_CLI_RATE(nHandshakes),
+        REST_CLI_RATE(nHandshakeFailures)
+        );
+
+    /**** Over interval when it had samples, else since start ****/
+    if (pOld && (pStats->cpu.nSamples > pOld->cpu.nSamples))
+    {
+        pCpuFrom = &pOld->cpu;
+    }
+
+    printf("CPU/req:  parse %s handler %s serialize %s (%llu sampled)\n",
+        RestCliFormatUs(RestCliCpuPerRequestUs(&pStats->cpu, pCpuFrom, REST_CPU_PARSE), sz1, sizeof(sz1)),
+        RestCliFormatUs(RestCliCpuPerRequestUs(&pStats->cpu, pCpuFrom, REST_CPU_HANDLER), sz2, sizeof(sz2)),
+        RestCliFormatUs(RestCliCpuPerRequestUs(&pStats->cpu, pCpuFrom, REST_CPU_SERIALIZE), sz3, sizeof(sz3)),
+        (unsigned long long)pStats->cpu.nSamples
+        );
+
+#undef REST_CLI_RATE
+
+    for (idx = 0; idx < pCur->nRoutes; idx++)
+    {
+        row[idx].pRoute = &pCur->route[idx];
+        row[idx].nDelta = pOld ? (pCur->route[idx].latency.nCount -
+                                  RestCliPreviousRouteCount(pPrev, &pCur->route[idx])) : 0;
+    }
+
+    qsort(row, pCur->nRoutes, sizeof(row[0]), &RestCliCompareRows);
+
+    printf("\n%-7s %10s %12s %9s %9s %9s %9s %9s  %s\n",
+        "METHOD", "REQ/S", "TOTAL", "P50", "P90", "P99", "MAX", "CPU/REQ", "ROUTE");
+
+    for (idx = 0; (idx < pCur->nRoutes) && (idx < pArgs->nRoutes); idx++)
+    {
+        printf("%-7s %10.1f %12llu %9s %9s %9s %9s %9s  %s\n",
+            row[idx].pRoute->szMethod,
+            pOld ? row[idx].nDelta / secs : 0.0,
+            (unsigned long long)row[idx].pRoute->latency.nCount,
+            RestCliFormatUs(row[idx].pRoute->latency.p50Us, sz1, sizeof(sz1)),
+            RestCliFormatUs(row[idx].pRoute->latency.p90Us, sz2, sizeof(sz2)),
+            RestCliFormatUs(row[idx].pRoute->latency.p99Us, sz3, sizeof(sz3)),
+            RestCliFormatUs(row[idx].pRoute->latency.maxUs, sz4, sizeof(sz4)),
+            row[idx].pRoute->cpu.nSamples ?
+                RestCliFormatUs(RestCliCpuPerRequestUs(&row[idx].pRoute->cpu, NULL, REST_CPU_PARSE) +
+                                RestCliCpuPerRequestUs(&row[idx].pRoute->cpu, NULL, REST_CPU_HANDLER) +
+                                RestCliCpuPerRequestUs(&row[idx].pRoute->cpu, NULL, REST_CPU_SERIALIZE),
+                                sz5, sizeof(sz5)) : "-",
+            row[idx].pRoute->szRoute
+            );
+    }
+
+    if (pArgs->bBatch)
+    {
+        printf("\n");
+    }
+
+    fflush(stdout);
+}
+
+static
+uint32_t
+RestCliTop(
+    PREST_CLI_TOP_ARGS               pArgs
+    )
+{
+    uint32_t                         dwError = 0;
+    PVMREST_STATS_SHM                pShm = NULL;
+    PVMREST_STATS_SHM                pCur = NULL;
+    PVMREST_STATS_SHM                pPrev = NULL;
+    PVMREST_STATS_SHM                pSwap = NULL;
+    uint32_t                         nShown = 0;
+    int                              bHavePrev = 0;
+
+    dwError = RestCliResolveName(pArgs);
+    if (dwError)
+    {
+        goto error;
+    }
+
+    dwError = RestCliAttach(pArgs->szName, &pShm);
+    if (dwError)
+    {
+        fprintf(stderr, "rest-cli: cannot attach %s: %s\n", pArgs->szName,
+            (dwError == EPROTO) ? "not a stats segment of this version" : strerror(dwError));
+        goto error;
+    }
+
+    pCur = calloc(1, sizeof(VMREST_STATS_SHM));
+    pPrev = calloc(1, sizeof(VMREST_STATS_SHM));
+    if (!pCur || !pPrev)
+    {
+        dwError = ENOMEM;
+        goto error;
+    }
+
+    for (;;)
+    {
+        dwError = RestCliSnapshot(pShm, pCur);
+        if (dwError)
+        {
+            fprintf(stderr, "rest-cli: no consistent snapshot of %s\n", pArgs->szName);
+            goto error;
+        }
+
+        RestCliPrintTop(pArgs, pCur, bHavePrev ? pPrev : NULL);
+
+        if (pCur->bStopped || (pArgs->nCount && (++nShown >= pArgs->nCount)))
+        {
+            break;
+        }
+
+        pSwap = pPrev;
+        pPrev = pCur;
+        pCur = pSwap;
+        bHavePrev = 1;
+
+        sleep(pArgs->intervalSecs);
+    }
+
+cleanup:
+
+    free(pCur);
+    free(pPrev);
+    RestCliDetach(pShm);
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+static
+uint32_t
+RestCliParseTopArgs(
+    int                              argc,
+    char*                            argv[],
+    PREST_CLI_TOP_ARGS               pArgs
+    )
+{
+    int                              opt = 0;
+
+    pArgs->intervalSecs = REST_CLI_DEFAULT_INTERVAL_SECS;
+    pArgs->nRoutes = REST_CLI_DEFAULT_ROUTES;
+
+    while ((opt = getopt(argc, argv, "n:d:p:i:c:r:b")) != -1)
+    {
+        switch (opt)
+        {
+            case 'n':
+                snprintf(pArgs->szName, sizeof(pArgs->szName), "%s%s",
+                    (optarg[0] == '/') ? "" : "/", optarg);
+                break;
+
+            case 'd':
+                pArgs->pszDaemon = optarg;
+                break;
+
+            case 'p':
+                pArgs->port = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+
+            case 'i':
+                pArgs->intervalSecs = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+
+            case 'c':
+                pArgs->nCount = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+
+            case 'r':
+                pArgs->nRoutes = (uint32_t)strtoul(optarg, NULL, 10);
+                break;
+
+            case 'b':
+                pArgs->bBatch = 1;
+                break;
+
+            default:
+                return EINVAL;
+        }
+    }
+
+    if ((optind != argc) || !pArgs->intervalSecs || (!pArgs->pszDaemon != !pArgs->port))
+    {
+        return EINVAL;
+    }
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t                         dwError = 0;
+    REST_CLI_TOP_ARGS                args = {{0}};
+
+    if (argc < 2)
+    {
+        RestCliUsage();
+        return 1;
+    }
+
+    if (!strcmp(argv[1], "list") && (argc == 2))
+    {
+        dwError = RestCliList();
+    }
+    else if (!strcmp(argv[1], "top"))
+    {
+        dwError = RestCliParseTopArgs(argc - 1, argv + 1, &args);
+        if (dwError)
+        {
+            RestCliUsage();
+            return 1;
+        }
+        dwError = RestCliTop(&args);
+    }
+    else
+    {
+        RestCliUsage();
+        return 1;
+    }
+
+    return dwError ? 1 : 0;
+}
@@ -165,6 +165,56 @@ error:
 
 }
 
+DWORD
+VmwSockAttachEventQueue(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_EVENT_QUEUE             pQueue
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRESTHandle || !pQueue)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+        BAIL_ON_VMSOCK_ERROR(dwError);
+    }
+
+    dwError = pRESTHandle->pPackage->pfnAttachEventQueue(
+                            pRESTHandle,
+                            pQueue);
+    BAIL_ON_VMSOCK_ERROR(dwError);
+
+error:
+
+    return dwError;
+}
+
+DWORD
+VmwSockDetachEventQueue(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_EVENT_QUEUE             pQueue,
+    uint32_t                         waitSecond
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRESTHandle || !pQueue)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+        BAIL_ON_VMSOCK_ERROR(dwError);
+    }
+
+    dwError = pRESTHandle->pPackage->pfnDetachEventQueue(
+                            pRESTHandle,
+                            pQueue,
+                            waitSecond);
+    BAIL_ON_VMSOCK_ERROR(dwError);
+
+error:
+
+    return dwError;
+}
+
 DWORD
 VmwSockRead(
     PVMREST_HANDLE                   pRESTHandle,
@@ -220,6 +270,168 @@ error:
     return dwError;
 }
 
+DWORD
+VmwSockSendFile(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    int                              fd,
+    uint64_t                         offset,
+    uint32_t                         nBytes
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+
+    if (!pSocket || (fd < 0) || !pRESTHandle)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+        BAIL_ON_VMSOCK_ERROR(dwError);
+    }
+
+    dwError = pRESTHandle->pPackage->pfnSendFile(
+                            pRESTHandle,
+                            pSocket,
+                            fd,
+                            offset,
+                            nBytes);
+    BAIL_ON_VMSOCK_ERROR(dwError);
+
+error:
+
+    return dwError;
+}
+
+DWORD
+VmwSockGetHandshakeStats(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_HANDSHAKE_STATS            pStats
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRESTHandle || !pStats)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+        BAIL_ON_VMSOCK_ERROR(dwError);
+    }
+
+    dwError = pRESTHandle->pPackage->pfnGetHandshakeStats(
+                            pRESTHandle,
+                            pStats);
+    BAIL_ON_VMSOCK_ERROR(dwError);
+
+error:
+
+    return dwError;
+}
+
+DWORD
+VmwSockGetConnections(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_CONNECTION_INFO            pInfo,
+    uint32_t                         nMax,
+    uint32_t*                        pnCount
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRESTHandle || !pnCount)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+        BAIL_ON_VMSOCK_ERROR(dwError);
+    }
+
+    dwError = pRESTHandle->pPackage->pfnGetConnections(
+                            pRESTHandle,
+                            pInfo,
+                            nMax,
+                            pnCount);
+    BAIL_ON_VMSOCK_ERROR(dwError);
+
+error:
+
+    return dwError;
+}
+
+DWORD
+VmwSockSendListenerFds(
+    PVMREST_HANDLE                   pRESTHandle,
+    const char*                      pszSocketPath
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRESTHandle || !pszSocketPath)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+        BAIL_ON_VMSOCK_ERROR(dwError);
+    }
+
+    dwError = pRESTHandle->pPackage->pfnSendListenerFds(
+                            pRESTHandle,
+                            pszSocketPath);
+    BAIL_ON_VMSOCK_ERROR(dwError);
+
+error:
+
+    return dwError;
+}
+
+DWORD
+VmwSockReceiveListenerFds(
+    PVMREST_HANDLE                   pRESTHandle,
+    const char*                      pszSocketPath,
+    uint32_t                         waitSeconds
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRESTHandle || !pszSocketPath)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+        BAIL_ON_VMSOCK_ERROR(dwError);
+    }
+
+    dwError = pRESTHandle->pPackage->pfnReceiveListenerFds(
+                            pRESTHandle,
+                            pszSocketPath,
+                            waitSeconds);
+    BAIL_ON_VMSOCK_ERROR(dwError);
+
+error:
+
+    return dwError;
+}
+
+DWORD
+VmwSockReloadSSLContext(
+    PVMREST_HANDLE                   pRESTHandle,
+    const char*                      pszCertBuf,
+    uint32_t                         nCertBufLen,
+    const char*                      pszKeyBuf,
+    uint32_t                         nKeyBufLen
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRESTHandle || (pszCertBuf && !nCertBufLen) || (pszKeyBuf && !nKeyBufLen))
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+        BAIL_ON_VMSOCK_ERROR(dwError);
+    }
+
+    dwError = pRESTHandle->pPackage->pfnReloadSSLContext(
+                            pRESTHandle,
+                            pszCertBuf,
+                            nCertBufLen,
+                            pszKeyBuf,
+                            nKeyBufLen);
+    BAIL_ON_VMSOCK_ERROR(dwError);
+
+error:
+
+    return dwError;
+}
+
 VOID
 VmwSockRelease(
     PVMREST_HANDLE                   pRESTHandle,
@@ -262,6 +474,20 @@ VmwSockGetRequestHandle(
     return dwError;
 }
 
+DWORD
+VmwSockGetSocketHandle(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    PVMREST_HANDLE*                  ppSockHandle
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+
+    dwError =  pRESTHandle->pPackage->pfnGetSocketHandle(pRESTHandle, pSocket, ppSockHandle);
+
+    return dwError;
+}
+
 DWORD
 VmwSockSetRequestHandle(
     PVMREST_HANDLE                   pRESTHandle,
@@ -294,4 +520,50 @@ VmwSockGetPeerInfo(
      return dwError;
 }
 
+DWORD
+VmwSockGetPeerCredentials(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    int*                             pPid,
+    uint32_t*                        pUid,
+    uint32_t*                        pGid
+    )
+{
+     DWORD                            dwError = REST_ENGINE_SUCCESS;
+
+     dwError = pRESTHandle->pPackage->pfnGetPeerCredentials(pRESTHandle, pSocket, pPid, pUid, pGid);
+
+     return dwError;
+}
+
+DWORD
+VmwSockCreateLoopback(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_RESPONSE_SINK              pSink,
+    PVM_SOCKET*                      ppSocket
+    )
+{
+     DWORD                            dwError = REST_ENGINE_SUCCESS;
+
+     dwError = pRESTHandle->pPackage->pfnCreateLoopback(pRESTHandle, pSink, ppSocket);
+
+     return dwError;
+}
+
+DWORD
+VmwSockGetConnectionState(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    uint64_t*                        pAcceptNs,
+    uint64_t*                        pTlsDoneNs,
+    uint32_t*                        pnRequests
+    )
+{
+     DWORD                            dwError = REST_ENGINE_SUCCESS;
+
+     dwError = pRESTHandle->pPackage->pfnGetConnectionState(pRESTHandle, pSocket, pAcceptNs, pTlsDoneNs, pnRequests);
+
+     return dwError;
+}
+
 
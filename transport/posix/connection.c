@@ -0,0 +1,610 @@
+/* C-REST-Engine
+*
+* Copyright (c) 2017 VMware, Inc. All Rights Reserved.
+*
+* This product is licensed to you under the Apache 2.0 license (the "License").
+* You may not use this product except in compliance with the Apache 2.0 License.
+*
+* This product may include a number of subcomponents with separate copyright
+* notices and license terms. Your use of these subcomponents is subject to the
+* terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+*
+*/
+
+#include "includes.h"
+
+static
+PVM_SOCK_CONN_TABLE
+VmSockPosixGetConnTable(
+    PVMREST_HANDLE                   pRESTHandle
+    )
+{
+    if (!pRESTHandle || !pRESTHandle->pSockContext || !pRESTHandle->pSockContext->pEventQueue)
+    {
+        return NULL;
+    }
+
+    return pRESTHandle->pSockContext->pEventQueue->pConnTable;
+}
+
+/**** Member of an engine group sees only its own entries of the shared table ****/
+static
+BOOLEAN
+VmSockPosixIsGroupMember(
+    PVMREST_HANDLE                   pRESTHandle
+    )
+{
+    return (pRESTHandle->pSockContext->pEventQueue->pRESTHandle != pRESTHandle);
+}
+
+/**** Entry of this socket, NULL if fd slot belongs to no or other socket ****/
+static
+PVM_SOCK_CONN_ENTRY
+VmSockPosixGetConnEntry(
+    PVM_SOCK_CONN_TABLE              pTable,
+    PVM_SOCKET                       pSocket
+    )
+{
+    PVM_SOCK_CONN_ENTRY              pChunk = NULL;
+    PVM_SOCK_CONN_ENTRY              pEntry = NULL;
+
+    if (!pTable || !pSocket || (pSocket->fd < 0) || ((uint32_t)pSocket->fd >= pTable->maxFd))
+    {
+        return NULL;
+    }
+
+    pChunk = __atomic_load_n(&pTable->ppChunks[pSocket->fd / VM_SOCK_POSIX_CONN_CHUNK_SIZE], __ATOMIC_ACQUIRE);
+    if (!pChunk)
+    {
+        return NULL;
+    }
+
+    pEntry = &pChunk[pSocket->fd % VM_SOCK_POSIX_CONN_CHUNK_SIZE];
+
+    return (pEntry->pSocket == pSocket) ? pEntry : NULL;
+}
+
+DWORD
+VmSockPosixCreateConnTable(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_CONN_TABLE*             ppTable
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    PVM_SOCK_CONN_TABLE              pTable = NULL;
+    struct rlimit                    fdLimit = {0};
+
+    if (!pRESTHandle || !ppTable)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateMemory(
+                  sizeof(VM_SOCK_CONN_TABLE),
+                  (PVOID*)&pTable,
+                  REST_MEM_OTHER
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateNamedMutex(&pTable->pMutex, "conn_table");
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** No fd of this process can be above its open file limit ****/
+    pTable->maxFd = VM_SOCK_POSIX_CONN_MAX_FD;
+    if ((getrlimit(RLIMIT_NOFILE, &fdLimit) == 0) &&
+        (fdLimit.rlim_cur != RLIM_INFINITY) &&
+        (fdLimit.rlim_cur < VM_SOCK_POSIX_CONN_MAX_FD))
+    {
+        pTable->maxFd = (uint32_t)fdLimit.rlim_cur;
+    }
+    pTable->nChunks = (pTable->maxFd + VM_SOCK_POSIX_CONN_CHUNK_SIZE - 1) / VM_SOCK_POSIX_CONN_CHUNK_SIZE;
+
+    dwError = VmRESTAllocateMemory(
+                  pTable->nChunks * sizeof(PVM_SOCK_CONN_ENTRY),
+                  (PVOID*)&pTable->ppChunks,
+                  REST_MEM_OTHER
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    VMREST_LOG_DEBUG(pRESTHandle,"Connection table created for fd limit %u", pTable->maxFd);
+
+    *ppTable = pTable;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    if (ppTable)
+    {
+        *ppTable = NULL;
+    }
+
+    VmSockPosixFreeConnTable(pTable);
+    pTable = NULL;
+
+    goto cleanup;
+}
+
+VOID
+VmSockPosixFreeConnTable(
+    PVM_SOCK_CONN_TABLE              pTable
+    )
+{
+    uint32_t                         iChunk = 0;
+
+    if (!pTable)
+    {
+        return;
+    }
+
+    if (pTable->ppChunks)
+    {
+        for (iChunk = 0; iChunk < pTable->nChunks; iChunk++)
+        {
+            VmRESTFreeMemory(pTable->ppChunks[iChunk], REST_MEM_OTHER);
+        }
+        VmRESTFreeMemory(pTable->ppChunks, REST_MEM_OTHER);
+        pTable->ppChunks = NULL;
+    }
+
+    if (pTable->pMutex)
+    {
+        VmRESTFreeMutex(pTable->pMutex);
+        pTable->pMutex = NULL;
+    }
+
+    VmRESTFreeMemory(pTable, REST_MEM_OTHER);
+}
+
+DWORD
+VmSockPosixRegisterConnection(
+    PVM_SOCK_CONN_TABLE              pTable,
+    PVM_SOCKET                       pSocket,
+    VMREST_CONN_PHASE                phase
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    BOOLEAN                          bLocked = FALSE;
+    PVM_SOCK_CONN_ENTRY              pChunk = NULL;
+    PVM_SOCK_CONN_ENTRY              pEntry = NULL;
+    uint32_t                         iChunk = 0;
+
+    if (!pTable || !pSocket || (pSocket->fd < 0) || ((uint32_t)pSocket->fd >= pTable->maxFd))
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    iChunk = pSocket->fd / VM_SOCK_POSIX_CONN_CHUNK_SIZE;
+
+    /**** Chunks are only added, readers look them up without lock ****/
+    pChunk = __atomic_load_n(&pTable->ppChunks[iChunk], __ATOMIC_ACQUIRE);
+    if (!pChunk)
+    {
+        dwError = VmRESTLockMutex(pTable->pMutex);
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        bLocked = TRUE;
+
+        pChunk = pTable->ppChunks[iChunk];
+        if (!pChunk)
+        {
+            dwError = VmRESTAllocateMemory(
+                          VM_SOCK_POSIX_CONN_CHUNK_SIZE * sizeof(VM_SOCK_CONN_ENTRY),
+                          (PVOID*)&pChunk,
+                          REST_MEM_OTHER
+                          );
+            BAIL_ON_VMREST_ERROR(dwError);
+
+            __atomic_store_n(&pTable->ppChunks[iChunk], pChunk, __ATOMIC_RELEASE);
+        }
+    }
+
+    pEntry = &pChunk[pSocket->fd % VM_SOCK_POSIX_CONN_CHUNK_SIZE];
+
+    pEntry->nBytesIn = 0;
+    pEntry->nBytesOut = 0;
+    pEntry->nAllocBytes = 0;
+    pEntry->nRequests = 0;
+    pEntry->phase = (uint8_t)phase;
+    pEntry->lastActivityMs = VmSockPosixGetMonotonicMs();
+    pEntry->pRESTHandle = pSocket->pRESTHandle;
+    __atomic_store_n(&pEntry->pSocket, pSocket, __ATOMIC_RELEASE);
+
+    /**** Only place connections are counted. TCP, Unix domain and shared memory
+          accepts all come here, handshake pool keeps the entry. Unregister drops
+          count only for an entry it finds, sockets never registered (dispatch
+          sink, failed accept) are never uncounted. ****/
+    __sync_fetch_and_add(&pTable->nConnections, 1);
+    if (pSocket->pRESTHandle)
+    {
+        __sync_fetch_and_add(&pSocket->pRESTHandle->pSockContext->nConnections, 1);
+    }
+
+cleanup:
+
+    if (bLocked)
+    {
+        VmRESTUnlockMutex(pTable->pMutex);
+    }
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+VOID
+VmSockPosixUnregisterConnection(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket
+    )
+{
+    PVM_SOCK_CONN_TABLE              pTable = VmSockPosixGetConnTable(pRESTHandle);
+    PVM_SOCK_CONN_ENTRY              pEntry = NULL;
+    PVMREST_HANDLE                   pOwner = NULL;
+    PVMREST_SOCK_CONTEXT             pQueueContext = NULL;
+    uint32_t                         nLeft = 1;
+
+    if (!pTable)
+    {
+        return;
+    }
+
+    /**** Under lock, so a socket found in table by drain stays alive while it is used ****/
+    VmRESTLockMutex(pTable->pMutex);
+
+    pEntry = VmSockPosixGetConnEntry(pTable, pSocket);
+    if (pEntry)
+    {
+        pOwner = pEntry->pRESTHandle;
+        __atomic_store_n(&pEntry->pSocket, NULL, __ATOMIC_RELEASE);
+        nLeft = __sync_sub_and_fetch(&pTable->nConnections, 1);
+    }
+
+    VmRESTUnlockMutex(pTable->pMutex);
+
+    /**** Count of owning instance drops under its lock, its stop may free it right after ****/
+    if (pOwner)
+    {
+        VmRESTLockMutex(pOwner->pSockContext->pMutex);
+        if ((__sync_sub_and_fetch(&pOwner->pSockContext->nConnections, 1) == 0) &&
+            pOwner->pSockContext->bDraining)
+        {
+            VmRESTConditionBroadcast(pOwner->pSockContext->pStopCond);
+        }
+        VmRESTUnlockMutex(pOwner->pSockContext->pMutex);
+    }
+
+    /**** Stop is waiting for last connection to go ****/
+    if ((nLeft == 0) && pRESTHandle->pSockContext->pEventQueue->bDraining)
+    {
+        pQueueContext = pRESTHandle->pSockContext->pEventQueue->pRESTHandle->pSockContext;
+
+        VmRESTLockMutex(pQueueContext->pMutex);
+        VmRESTConditionBroadcast(pQueueContext->pStopCond);
+        VmRESTUnlockMutex(pQueueContext->pMutex);
+    }
+}
+
+VOID
+VmSockPosixSetConnPhase(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    VMREST_CONN_PHASE                phase
+    )
+{
+    PVM_SOCK_CONN_ENTRY              pEntry = VmSockPosixGetConnEntry(VmSockPosixGetConnTable(pRESTHandle), pSocket);
+
+    if (pEntry)
+    {
+        /**** A request is complete when connection goes idle or is closed after response ****/
+        if ((pEntry->phase == VMREST_CONN_PHASE_ACTIVE) &&
+            ((phase == VMREST_CONN_PHASE_IDLE) || (phase == VMREST_CONN_PHASE_CLOSING)))
+        {
+            pEntry->nRequests++;
+        }
+        pEntry->phase = (uint8_t)phase;
+        pEntry->lastActivityMs = VmSockPosixGetMonotonicMs();
+    }
+}
+
+VOID
+VmSockPosixAddConnBytes(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    uint64_t                         nBytesIn,
+    uint64_t                         nBytesOut
+    )
+{
+    PVM_SOCK_CONN_ENTRY              pEntry = VmSockPosixGetConnEntry(VmSockPosixGetConnTable(pRESTHandle), pSocket);
+
+    if (pEntry)
+    {
+        __atomic_fetch_add(&pEntry->nBytesIn, nBytesIn, __ATOMIC_RELAXED);
+        __atomic_fetch_add(&pEntry->nBytesOut, nBytesOut, __ATOMIC_RELAXED);
+        pEntry->lastActivityMs = VmSockPosixGetMonotonicMs();
+    }
+
+    /**** Instance totals, connection owner is member handle within an engine group ****/
+    if (pSocket->pRESTHandle)
+    {
+        if (nBytesIn)
+        {
+            VmRESTMetricsAdd(pSocket->pRESTHandle->pMetrics, VMREST_METRIC_BYTES_IN, nBytesIn);
+        }
+        if (nBytesOut)
+        {
+            VmRESTMetricsAdd(pSocket->pRESTHandle->pMetrics, VMREST_METRIC_BYTES_OUT, nBytesOut);
+        }
+    }
+}
+
+/**** Chunks live as long as table, a stale entry only misattributes bytes ****/
+VOID
+VmSockPosixSetMemoryConnection(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket
+    )
+{
+    PVM_SOCK_CONN_ENTRY              pEntry = NULL;
+
+    if (pSocket)
+    {
+        pEntry = VmSockPosixGetConnEntry(VmSockPosixGetConnTable(pRESTHandle), pSocket);
+    }
+
+    VmRESTMemorySetConnection(pEntry ? &pEntry->nAllocBytes : NULL);
+}
+
+uint32_t
+VmSockPosixGetConnectionCount(
+    PVMREST_HANDLE                   pRESTHandle
+    )
+{
+    PVM_SOCK_CONN_TABLE              pTable = VmSockPosixGetConnTable(pRESTHandle);
+
+    if (pTable && VmSockPosixIsGroupMember(pRESTHandle))
+    {
+        return __atomic_load_n(&pRESTHandle->pSockContext->nConnections, __ATOMIC_RELAXED);
+    }
+
+    return pTable ? __atomic_load_n(&pTable->nConnections, __ATOMIC_RELAXED) : 0;
+}
+
+/**** Whole queue is stopping or just this instance, when it is a group member ****/
+BOOLEAN
+VmSockPosixIsDraining(
+    PVMREST_HANDLE                   pRESTHandle
+    )
+{
+    PVM_SOCK_EVENT_QUEUE             pQueue = pRESTHandle->pSockContext->pEventQueue;
+
+    return (__atomic_load_n(&pRESTHandle->pSockContext->bDraining, __ATOMIC_ACQUIRE) ||
+            (pQueue && __atomic_load_n(&pQueue->bDraining, __ATOMIC_ACQUIRE)));
+}
+
+/**** Drain for stop, called with event queue locked so no worker is between an event and its timer stop.
+      Idle connections get their timer fired now, timeout handling closes them without response.
+      On a group member stop only connections of that member are expired. ****/
+VOID
+VmSockPosixExpireIdleConnections(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_EVENT_QUEUE             pQueue
+    )
+{
+    PVM_SOCK_CONN_TABLE              pTable = NULL;
+    PVM_SOCK_CONN_ENTRY              pEntry = NULL;
+    uint32_t                         iChunk = 0;
+    uint32_t                         iEntry = 0;
+    uint32_t                         nExpired = 0;
+    BOOLEAN                          bAll = FALSE;
+
+    if (!pQueue || !pQueue->pConnTable)
+    {
+        return;
+    }
+
+    pTable = pQueue->pConnTable;
+    bAll = __atomic_load_n(&pQueue->bDraining, __ATOMIC_ACQUIRE);
+
+    VmRESTLockMutex(pTable->pMutex);
+
+    for (iChunk = 0; iChunk < pTable->nChunks; iChunk++)
+    {
+        if (!pTable->ppChunks[iChunk])
+        {
+            continue;
+        }
+
+        for (iEntry = 0; iEntry < VM_SOCK_POSIX_CONN_CHUNK_SIZE; iEntry++)
+        {
+            pEntry = &pTable->ppChunks[iChunk][iEntry];
+            if (pEntry->pSocket && pEntry->pSocket->pTimerSocket &&
+                ((pEntry->phase == VMREST_CONN_PHASE_IDLE) || (pEntry->phase == VMREST_CONN_PHASE_NEW)) &&
+                (bAll || (pEntry->pRESTHandle && __atomic_load_n(&pEntry->pRESTHandle->pSockContext->bDraining, __ATOMIC_ACQUIRE))))
+            {
+                if (VmSockPosixReArmTimer(pRESTHandle, pEntry->pSocket->pTimerSocket, VM_SOCK_POSIX_DRAIN_IDLE_TIMEOUT_MS) == REST_ENGINE_SUCCESS)
+                {
+                    nExpired++;
+                }
+            }
+        }
+    }
+
+    VmRESTUnlockMutex(pTable->pMutex);
+
+    VMREST_LOG_INFO(pRESTHandle,"C-REST-ENGINE: Draining, closing %u idle of %u connections", nExpired, VmSockPosixGetConnectionCount(pRESTHandle));
+}
+
+/**** Group member stop past its deadline. Workers see hangup and close the sockets,
+      they cannot be closed here as a worker may be using them. ****/
+VOID
+VmSockPosixShutdownConnections(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_CONN_TABLE              pTable
+    )
+{
+    PVM_SOCK_CONN_ENTRY              pEntry = NULL;
+    uint32_t                         iChunk = 0;
+    uint32_t                         iEntry = 0;
+    uint32_t                         nShut = 0;
+
+    if (!pTable)
+    {
+        return;
+    }
+
+    VmRESTLockMutex(pTable->pMutex);
+
+    for (iChunk = 0; iChunk < pTable->nChunks; iChunk++)
+    {
+        if (!pTable->ppChunks[iChunk])
+        {
+            continue;
+        }
+
+        for (iEntry = 0; iEntry < VM_SOCK_POSIX_CONN_CHUNK_SIZE; iEntry++)
+        {
+            pEntry = &pTable->ppChunks[iChunk][iEntry];
+            if (pEntry->pSocket && (pEntry->pRESTHandle == pRESTHandle))
+            {
+                if (pEntry->pSocket->pShm)
+                {
+                    VmSockPosixShmShutdown(pEntry->pSocket);
+                }
+                else
+                {
+                    shutdown(pEntry->pSocket->fd, SHUT_RDWR);
+                }
+                nShut++;
+            }
+        }
+    }
+
+    VmRESTUnlockMutex(pTable->pMutex);
+
+    VMREST_LOG_INFO(pRESTHandle,"C-REST-ENGINE: Shut down %u connections left open at stop", nShut);
+}
+
+/**** Called once no worker or handshake thread is left, so nobody else touches these sockets ****/
+VOID
+VmSockPosixCloseAllConnections(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_CONN_TABLE              pTable
+    )
+{
+    PVM_SOCKET                       pSocket = NULL;
+    uint32_t                         iChunk = 0;
+    uint32_t                         iEntry = 0;
+    uint32_t                         nClosed = 0;
+
+    if (!pTable)
+    {
+        return;
+    }
+
+    for (iChunk = 0; iChunk < pTable->nChunks; iChunk++)
+    {
+        if (!pTable->ppChunks[iChunk])
+        {
+            continue;
+        }
+
+        for (iEntry = 0; iEntry < VM_SOCK_POSIX_CONN_CHUNK_SIZE; iEntry++)
+        {
+            pSocket = pTable->ppChunks[iChunk][iEntry].pSocket;
+            if (pSocket)
+            {
+                VmSockPosixCloseSocket(pRESTHandle, pSocket);
+                VmSockPosixReleaseSocket(pRESTHandle, pSocket);
+                nClosed++;
+            }
+        }
+    }
+
+    if (nClosed > 0)
+    {
+        VMREST_LOG_INFO(pRESTHandle,"C-REST-ENGINE: Closed %u connections left open at shutdown", nClosed);
+    }
+}
+
+DWORD
+VmSockPosixGetConnections(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_CONNECTION_INFO            pInfo,
+    uint32_t                         nMax,
+    uint32_t*                        pnCount
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    PVM_SOCK_CONN_TABLE              pTable = NULL;
+    PVM_SOCK_CONN_ENTRY              pChunk = NULL;
+    PVM_SOCK_CONN_ENTRY              pEntry = NULL;
+    uint64_t                         nowMs = 0;
+    uint32_t                         iChunk = 0;
+    uint32_t                         iEntry = 0;
+    uint32_t                         nCount = 0;
+    BOOLEAN                          bMember = FALSE;
+
+    if (!pRESTHandle || !pnCount)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pTable = VmSockPosixGetConnTable(pRESTHandle);
+
+    if (!pTable || !pInfo || !nMax)
+    {
+        *pnCount = VmSockPosixGetConnectionCount(pRESTHandle);
+        goto cleanup;
+    }
+
+    nowMs = VmSockPosixGetMonotonicMs();
+
+    bMember = VmSockPosixIsGroupMember(pRESTHandle);
+
+    /**** Snapshot only, entries may change while copied. Socket objects are not touched. ****/
+    for (iChunk = 0; (iChunk < pTable->nChunks) && (nCount < nMax); iChunk++)
+    {
+        pChunk = __atomic_load_n(&pTable->ppChunks[iChunk], __ATOMIC_ACQUIRE);
+        if (!pChunk)
+        {
+            continue;
+        }
+
+        for (iEntry = 0; (iEntry < VM_SOCK_POSIX_CONN_CHUNK_SIZE) && (nCount < nMax); iEntry++)
+        {
+            pEntry = &pChunk[iEntry];
+            if (!__atomic_load_n(&pEntry->pSocket, __ATOMIC_ACQUIRE) ||
+                (bMember && (pEntry->pRESTHandle != pRESTHandle)))
+            {
+                continue;
+            }
+
+            pInfo[nCount].fd = (int)((iChunk * VM_SOCK_POSIX_CONN_CHUNK_SIZE) + iEntry);
+            pInfo[nCount].phase = (VMREST_CONN_PHASE)pEntry->phase;
+            pInfo[nCount].nRequests = pEntry->nRequests;
+            pInfo[nCount].nBytesIn = pEntry->nBytesIn;
+            pInfo[nCount].nBytesOut = pEntry->nBytesOut;
+            pInfo[nCount].nAllocBytes = pEntry->nAllocBytes;
+            pInfo[nCount].idleMs = (nowMs > pEntry->lastActivityMs) ? (nowMs - pEntry->lastActivityMs) : 0;
+            nCount++;
+        }
+    }
+
+    *pnCount = nCount;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
@@ -16,6 +16,45 @@
 #define VM_SOCK_POSIX_DEFAULT_QUEUE_SIZE        (256)
 #define VM_SOCK_POSIX_DEFAULT_WORKER_THR_COUNT   5
 
+/**** Chunk size used when file payload has to go through user space TLS ****/
+#define VM_SOCK_POSIX_SENDFILE_CHUNK_SIZE       (64 * 1024)
+
+/**** Write that would block is retried after 1 ms for this many tries, then ten times
+      longer and ten times fewer per step, for about this many seconds in all ****/
+#define VM_SOCK_POSIX_WRITE_RETRY_TRIES         1000
+#define VM_SOCK_POSIX_WRITE_RETRY_SEC           5
+
+/**** Plaintext per TLS record while connection is cold, record plus TCP/IP headers fit one packet ****/
+#define VM_SOCK_POSIX_TLS_SMALL_RECORD_SIZE     1400
+
+/**** Keep-alive idle timeout is cut down to this once connection count nears nClientCnt ****/
+#define VM_SOCK_POSIX_MIN_IDLE_TIMEOUT_MS       1000
+
+/**** Connection table is indexed by fd, chunks of entries are allocated on first use ****/
+#define VM_SOCK_POSIX_CONN_CHUNK_SIZE           1024
+#define VM_SOCK_POSIX_CONN_MAX_FD               (1024 * 1024)
+
+/**** First fd passed by systemd socket activation (SD_LISTEN_FDS_START) ****/
+#define VM_SOCK_POSIX_LISTEN_FDS_START          3
+
+/**** Tags listener handoff message, "VRLF" ****/
+#define VM_SOCK_POSIX_LISTENER_HANDOFF_MAGIC    0x56524C46
+
+/**** While draining for stop, idle connections are timed out right away and closed without response ****/
+#define VM_SOCK_POSIX_DRAIN_IDLE_TIMEOUT_MS     1
+
+/**** Worker threads get at least this long to leave once shutdown is signalled ****/
+#define VM_SOCK_POSIX_STOP_MIN_WAIT_MS          1000
+
+/**** Group member stop checks this often that a worker took its drain byte ****/
+#define VM_SOCK_POSIX_DETACH_POLL_MS            5
+
+/**** Writer yields this many times for space in a full shared memory ring before backing off ****/
+#define VM_SOCK_POSIX_SHM_FULL_SPINS            1000
+
+/**** SHA-256 over SSL settings, identifies a shareable SSL context ****/
+#define VM_SOCK_POSIX_SSL_CTX_DIGEST_LEN        32
+
 #ifndef PopEntryList
 #define PopEntryList(ListHead) \
     (ListHead)->Next;\
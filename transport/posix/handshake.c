@@ -0,0 +1,351 @@
+/* C-REST-Engine
+*
+* Copyright (c) 2017 VMware, Inc. All Rights Reserved.
+*
+* This product is licensed to you under the Apache 2.0 license (the "License").
+* You may not use this product except in compliance with the Apache 2.0 License.
+*
+* This product may include a number of subcomponents with separate copyright
+* notices and license terms. Your use of these subcomponents is subject to the
+* terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+*
+*/
+
+#include "includes.h"
+
+static
+DWORD
+VmSockPosixHandshakeThreadProc(
+    PVOID                            pData
+    );
+
+DWORD
+VmSockPosixCreateHandshakePool(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_HANDSHAKE_POOL*         ppPool
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    PVM_SOCK_HANDSHAKE_POOL          pPool = NULL;
+    uint32_t                         iThr = 0;
+
+    if (!pRESTHandle || !pRESTHandle->pRESTConfig || !ppPool)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateMemory(
+                  sizeof(VM_SOCK_HANDSHAKE_POOL),
+                  (PVOID*)&pPool,
+                  REST_MEM_TLS
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pPool->pRESTHandle = pRESTHandle;
+    pPool->nCapacity = pRESTHandle->pRESTConfig->nHandshakeQueueDepth;
+
+    dwError = VmRESTAllocateNamedMutex(&pPool->pMutex, "handshake_pool");
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateCondition(&pPool->pCond);
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateMemory(
+                  pPool->nCapacity * sizeof(PVM_SOCKET),
+                  (PVOID*)&pPool->ppSockets,
+                  REST_MEM_TLS
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateMemory(
+                  pRESTHandle->pRESTConfig->nHandshakeThr * sizeof(VMREST_THREAD),
+                  (PVOID*)&pPool->pThreads,
+                  REST_MEM_TLS
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    for (iThr = 0; iThr < pRESTHandle->pRESTConfig->nHandshakeThr; iThr++)
+    {
+        dwError = VmRESTCreateThread(
+                      &pPool->pThreads[iThr],
+                      FALSE,
+                      (PVMREST_START_ROUTINE)&VmSockPosixHandshakeThreadProc,
+                      pPool
+                      );
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        pPool->nThreads++;
+    }
+
+    VMREST_LOG_DEBUG(pRESTHandle,"SSL handshake pool started with %u threads, queue depth %u", pPool->nThreads, pPool->nCapacity);
+
+    *ppPool = pPool;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    if (ppPool)
+    {
+        *ppPool = NULL;
+    }
+
+    if (pPool)
+    {
+        VmSockPosixFreeHandshakePool(pPool);
+        pPool = NULL;
+    }
+
+    goto cleanup;
+}
+
+DWORD
+VmSockPosixQueueHandshake(
+    PVM_SOCK_HANDSHAKE_POOL          pPool,
+    PVM_SOCKET                       pSocket
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    BOOLEAN                          bLocked = FALSE;
+    uint32_t                         nTail = 0;
+
+    if (!pPool || !pSocket)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTLockMutex(pPool->pMutex);
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    bLocked = TRUE;
+
+    /**** Bounded queue, shed load instead of letting handshakes pile up ****/
+    if (pPool->bShutdown || (pPool->nCount >= pPool->nCapacity))
+    {
+        pPool->stats.nRejected++;
+        VMREST_LOG_WARNING(pPool->pRESTHandle,"SSL handshake queue full (%u), rejecting socket fd %d", pPool->nCount, pSocket->fd);
+        dwError = VMREST_TRANSPORT_HANDSHAKE_QUEUE_FULL;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    nTail = (pPool->nHead + pPool->nCount) % pPool->nCapacity;
+    pPool->ppSockets[nTail] = pSocket;
+    pPool->nCount++;
+
+    pPool->stats.nQueued++;
+    pPool->stats.nQueueDepth = pPool->nCount;
+    if (pPool->nCount > pPool->stats.nMaxQueueDepth)
+    {
+        pPool->stats.nMaxQueueDepth = pPool->nCount;
+    }
+
+    dwError = VmRESTConditionSignal(pPool->pCond);
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+
+    if (bLocked)
+    {
+        VmRESTUnlockMutex(pPool->pMutex);
+        bLocked = FALSE;
+    }
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+VOID
+VmSockPosixFreeHandshakePool(
+    PVM_SOCK_HANDSHAKE_POOL          pPool
+    )
+{
+    uint32_t                         iThr = 0;
+    PVM_SOCKET                       pSocket = NULL;
+
+    if (!pPool)
+    {
+        return;
+    }
+
+    if (pPool->pMutex && pPool->pCond)
+    {
+        VmRESTLockMutex(pPool->pMutex);
+        pPool->bShutdown = TRUE;
+        VmRESTConditionBroadcast(pPool->pCond);
+        VmRESTUnlockMutex(pPool->pMutex);
+    }
+
+    for (iThr = 0; iThr < pPool->nThreads; iThr++)
+    {
+        VmRESTThreadJoin(&pPool->pThreads[iThr], NULL);
+    }
+
+    /**** Connections still waiting for handshake will never be served ****/
+    while (pPool->nCount > 0)
+    {
+        pSocket = pPool->ppSockets[pPool->nHead];
+        pPool->ppSockets[pPool->nHead] = NULL;
+        pPool->nHead = (pPool->nHead + 1) % pPool->nCapacity;
+        pPool->nCount--;
+
+        if (pSocket)
+        {
+            VmSockPosixCloseSocket(pPool->pRESTHandle, pSocket);
+            VmSockPosixReleaseSocket(pPool->pRESTHandle, pSocket);
+        }
+        pSocket = NULL;
+    }
+
+    if (pPool->pThreads)
+    {
+        VmRESTFreeMemory(pPool->pThreads, REST_MEM_TLS);
+        pPool->pThreads = NULL;
+    }
+    if (pPool->ppSockets)
+    {
+        VmRESTFreeMemory(pPool->ppSockets, REST_MEM_TLS);
+        pPool->ppSockets = NULL;
+    }
+    if (pPool->pCond)
+    {
+        VmRESTFreeCondition(pPool->pCond);
+        pPool->pCond = NULL;
+    }
+    if (pPool->pMutex)
+    {
+        VmRESTFreeMutex(pPool->pMutex);
+        pPool->pMutex = NULL;
+    }
+
+    VmRESTFreeMemory(pPool, REST_MEM_TLS);
+}
+
+DWORD
+VmSockPosixGetHandshakeStats(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_HANDSHAKE_STATS            pStats
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    PVM_SOCK_HANDSHAKE_POOL          pPool = NULL;
+
+    if (!pRESTHandle || !pStats || !pRESTHandle->pSockContext)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    memset(pStats, 0, sizeof(REST_HANDSHAKE_STATS));
+
+    pPool = pRESTHandle->pSockContext->pHandshakePool;
+
+    if (pPool)
+    {
+        dwError = VmRESTLockMutex(pPool->pMutex);
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        *pStats = pPool->stats;
+
+        VmRESTUnlockMutex(pPool->pMutex);
+    }
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+static
+DWORD
+VmSockPosixHandshakeThreadProc(
+    PVOID                            pData
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    PVM_SOCK_HANDSHAKE_POOL          pPool = (PVM_SOCK_HANDSHAKE_POOL)pData;
+    PVMREST_HANDLE                   pRESTHandle = NULL;
+    PVM_SOCKET                       pSocket = NULL;
+    BOOLEAN                          bCompleted = FALSE;
+
+    if (!pPool)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pRESTHandle = pPool->pRESTHandle;
+
+    while (TRUE)
+    {
+        dwError = VmRESTLockMutex(pPool->pMutex);
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        while (!pPool->bShutdown && (pPool->nCount == 0))
+        {
+            VmRESTConditionWait(pPool->pCond, pPool->pMutex);
+        }
+
+        if (pPool->bShutdown)
+        {
+            VmRESTUnlockMutex(pPool->pMutex);
+            break;
+        }
+
+        pSocket = pPool->ppSockets[pPool->nHead];
+        pPool->ppSockets[pPool->nHead] = NULL;
+        pPool->nHead = (pPool->nHead + 1) % pPool->nCapacity;
+        pPool->nCount--;
+        pPool->stats.nQueueDepth = pPool->nCount;
+
+        VmRESTUnlockMutex(pPool->pMutex);
+
+        /**** Key exchange runs here without holding the event queue lock.
+              Socket is re-armed in reactor once this step is done. ****/
+        bCompleted = FALSE;
+        dwError = VmRESTAcceptSSLContext(
+                      pRESTHandle,
+                      pSocket,
+                      TRUE,
+                      &bCompleted
+                      );
+
+        VmRESTLockMutex(pPool->pMutex);
+        if (dwError)
+        {
+            pPool->stats.nFailed++;
+        }
+        else if (bCompleted)
+        {
+            pPool->stats.nCompleted++;
+        }
+        VmRESTUnlockMutex(pPool->pMutex);
+
+        if (dwError)
+        {
+            VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"SSL handshake on socket fd %d failed in handshake pool, dwError %u", pSocket->fd, dwError);
+            VmSockPosixCloseSocket(pRESTHandle, pSocket);
+            VmSockPosixReleaseSocket(pRESTHandle, pSocket);
+            dwError = REST_ENGINE_SUCCESS;
+        }
+        pSocket = NULL;
+    }
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
@@ -15,20 +15,30 @@
 #include <vmrestsys.h>
 #include <sys/epoll.h>
 #include <sys/timerfd.h>
+#include <sys/sendfile.h>
+#include <sys/resource.h>
+#include <sys/un.h>
+#include <sys/mman.h>
+#include <sys/eventfd.h>
+#include <sched.h>
+#include <poll.h>
 #include <vmrestdefines.h>
 #include <vmsock.h>
 #include <vmrestcommon.h>
 #include <vmsockposix.h>
+#include <vmrestshm.h>
 #include "defines.h"
 #include "structs.h"
 #include "prototypes.h"
 #include <openssl/ssl.h>
 #include <openssl/err.h>
 #include <openssl/crypto.h>
+#include <openssl/pem.h>
 #include <vmrestcommon.h>
 #include <vmrest.h>
 #include <fcntl.h>
 #include <arpa/inet.h>
+#include <netinet/tcp.h>
 #include <sys/epoll.h>
 #include "extern.h"
 
@@ -60,6 +60,18 @@ VmRESTGetSockPackagePosix(
     pSockPackagePosix->pfnGetRequestHandle = &VmSockPosixGetRequestHandle;
     pSockPackagePosix->pfnSetRequestHandle = &VmSockPosixSetRequestHandle;
     pSockPackagePosix->pfnGetPeerInfo = &VmSockPosixGetPeerInfo;
+    pSockPackagePosix->pfnSendFile = &VmSockPosixSendFile;
+    pSockPackagePosix->pfnGetHandshakeStats = &VmSockPosixGetHandshakeStats;
+    pSockPackagePosix->pfnReloadSSLContext = &VmSockPosixReloadSSLContext;
+    pSockPackagePosix->pfnGetConnections = &VmSockPosixGetConnections;
+    pSockPackagePosix->pfnSendListenerFds = &VmSockPosixSendListenerFds;
+    pSockPackagePosix->pfnReceiveListenerFds = &VmSockPosixReceiveListenerFds;
+    pSockPackagePosix->pfnAttachEventQueue = &VmSockPosixAttachEventQueue;
+    pSockPackagePosix->pfnDetachEventQueue = &VmSockPosixDetachEventQueue;
+    pSockPackagePosix->pfnGetSocketHandle = &VmSockPosixGetSocketHandle;
+    pSockPackagePosix->pfnGetPeerCredentials = &VmSockPosixGetPeerCredentials;
+    pSockPackagePosix->pfnCreateLoopback = &VmSockPosixCreateLoopback;
+    pSockPackagePosix->pfnGetConnectionState = &VmSockPosixGetConnectionState;
 
 cleanup:
 
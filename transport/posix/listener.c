@@ -0,0 +1,645 @@
+/* C-REST-Engine
+*
+* Copyright (c) 2017 VMware, Inc. All Rights Reserved.
+*
+* This product is licensed to you under the Apache 2.0 license (the "License").
+* You may not use this product except in compliance with the Apache 2.0 License.
+*
+* This product may include a number of subcomponents with separate copyright
+* notices and license terms. Your use of these subcomponents is subject to the
+* terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+*
+*/
+
+#include "includes.h"
+
+/**** Family of fd if it is a listening TCP socket bound to configured port or a listening
+      unix domain socket bound to pszUnixPath, AF_UNSPEC otherwise ****/
+static
+int
+VmSockPosixGetListenerFamily(
+    int                              fd,
+    PVM_REST_CONFIG                  pRESTConfig,
+    const char*                      pszUnixPath
+    )
+{
+    struct sockaddr_storage          addr = {0};
+    socklen_t                        addrLen = sizeof(addr);
+    struct sockaddr_un               unixAddr = {0};
+    socklen_t                        unixAddrLen = 0;
+    uint32_t                         port = pRESTConfig->serverPort;
+    int                              type = 0;
+    int                              bAccepting = 0;
+    socklen_t                        optLen = 0;
+
+    optLen = sizeof(type);
+    if ((getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &optLen) < 0) || (type != SOCK_STREAM))
+    {
+        return AF_UNSPEC;
+    }
+
+    optLen = sizeof(bAccepting);
+    if ((getsockopt(fd, SOL_SOCKET, SO_ACCEPTCONN, &bAccepting, &optLen) < 0) || !bAccepting)
+    {
+        return AF_UNSPEC;
+    }
+
+    if (getsockname(fd, (struct sockaddr*)&addr, &addrLen) < 0)
+    {
+        return AF_UNSPEC;
+    }
+
+    if ((addr.ss_family == AF_INET) &&
+        (ntohs(((struct sockaddr_in*)&addr)->sin_port) == port))
+    {
+        return AF_INET;
+    }
+#ifdef AF_INET6
+    if ((addr.ss_family == AF_INET6) &&
+        (ntohs(((struct sockaddr_in6*)&addr)->sin6_port) == port))
+    {
+        return AF_INET6;
+    }
+#endif
+    if ((addr.ss_family == AF_UNIX) &&
+        !IsNullOrEmptyString(pszUnixPath) &&
+        (VmSockPosixGetUnixListenerAddress(pszUnixPath, &unixAddr, &unixAddrLen) == REST_ENGINE_SUCCESS) &&
+        (addrLen == unixAddrLen) &&
+        (memcmp(&addr, &unixAddr, unixAddrLen) == 0))
+    {
+        return AF_UNIX;
+    }
+
+    return AF_UNSPEC;
+}
+
+#ifdef AF_INET6
+static
+BOOLEAN
+VmSockPosixIsDualStack(
+    int                              fd
+    )
+{
+    int                              bV6Only = 1;
+    socklen_t                        optLen = sizeof(bV6Only);
+
+    if (getsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &bV6Only, &optLen) < 0)
+    {
+        return FALSE;
+    }
+
+    return !bV6Only;
+}
+#endif
+
+/**** Fds from systemd socket activation, only when they were meant for this process ****/
+static
+uint32_t
+VmSockPosixGetActivationFdCount(
+    void
+    )
+{
+    const char*                      pszPid = getenv("LISTEN_PID");
+    const char*                      pszFds = getenv("LISTEN_FDS");
+    long                             nFds = 0;
+
+    if (IsNullOrEmptyString(pszPid) || IsNullOrEmptyString(pszFds) ||
+        (strtol(pszPid, NULL, 10) != (long)getpid()))
+    {
+        return 0;
+    }
+
+    nFds = strtol(pszFds, NULL, 10);
+
+    return (nFds > 0) ? (uint32_t)nFds : 0;
+}
+
+/**** Pick an already bound listening socket for this family and port (or unix path), from REST_CONF
+      listenFds (also filled by VmSockPosixReceiveListenerFds) or from socket activation.
+      *pFd is -1 when there is none and caller has to create its own. ****/
+DWORD
+VmSockPosixAdoptListener(
+    PVMREST_HANDLE                   pRESTHandle,
+    int                              domain,
+    const char*                      pszUnixPath,
+    int*                             pFd
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    PVM_REST_CONFIG                  pRESTConfig = NULL;
+    uint32_t                         nActivationFds = 0;
+    uint32_t                         iPass = 0;
+    uint32_t                         iFd = 0;
+    int                              fd = -1;
+    int                              usedFd = -1;
+    int                              family = AF_UNSPEC;
+
+    if (!pRESTHandle || !pRESTHandle->pRESTConfig || !pFd)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    *pFd = -1;
+    pRESTConfig = pRESTHandle->pRESTConfig;
+    nActivationFds = VmSockPosixGetActivationFdCount();
+
+    /**** IPv6 listener is started after IPv4 one, do not hand out same fd twice ****/
+    if (pRESTHandle->pSockContext && pRESTHandle->pSockContext->pListenerTCP)
+    {
+        usedFd = pRESTHandle->pSockContext->pListenerTCP->fd;
+    }
+
+    /**** Exact family first. A dual stack IPv6 socket also serves IPv4 if nothing else does. ****/
+    for (iPass = 0; iPass < 2; iPass++)
+    {
+        for (iFd = 0; iFd < pRESTConfig->nListenFds + nActivationFds; iFd++)
+        {
+            fd = (iFd < pRESTConfig->nListenFds) ?
+                     pRESTConfig->listenFds[iFd] :
+                     (int)(VM_SOCK_POSIX_LISTEN_FDS_START + iFd - pRESTConfig->nListenFds);
+
+            if ((fd < 0) || (fd == usedFd))
+            {
+                continue;
+            }
+
+            family = VmSockPosixGetListenerFamily(fd, pRESTConfig, pszUnixPath);
+
+            if ((iPass == 0) && (family == domain))
+            {
+                break;
+            }
+#ifdef AF_INET6
+            if ((iPass == 1) && (domain == AF_INET) && (family == AF_INET6) && VmSockPosixIsDualStack(fd))
+            {
+                break;
+            }
+#endif
+        }
+
+        if (iFd < pRESTConfig->nListenFds + nActivationFds)
+        {
+            /**** Closed at stop, must not be picked up again on next start ****/
+            if (iFd < pRESTConfig->nListenFds)
+            {
+                pRESTConfig->listenFds[iFd] = -1;
+            }
+
+            if (domain == AF_UNIX)
+            {
+                VMREST_LOG_INFO(pRESTHandle,"C-REST-ENGINE: Using inherited listening socket fd %d for %s", fd, pszUnixPath);
+            }
+            else
+            {
+                VMREST_LOG_INFO(pRESTHandle,"C-REST-ENGINE: Using inherited listening socket fd %d for port %u", fd, pRESTConfig->serverPort);
+            }
+            *pFd = fd;
+            break;
+        }
+
+        if (domain != AF_INET)
+        {
+            break;
+        }
+    }
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+/**** Address of unix domain listener. Leading '@' selects the abstract namespace,
+      name is then not NUL terminated and only addrLen bytes are significant. ****/
+DWORD
+VmSockPosixGetUnixListenerAddress(
+    const char*                      pszSocketPath,
+    struct sockaddr_un*              pAddr,
+    socklen_t*                       pAddrLen
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    size_t                           len = 0;
+
+    if (IsNullOrEmptyString(pszSocketPath) || !pAddr || !pAddrLen)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    len = strlen(pszSocketPath);
+    if (len >= sizeof(pAddr->sun_path))
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    memset(pAddr, 0, sizeof(*pAddr));
+    pAddr->sun_family = AF_UNIX;
+
+    if (pszSocketPath[0] == '@')
+    {
+        memcpy(pAddr->sun_path + 1, pszSocketPath + 1, len - 1);
+        *pAddrLen = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + len);
+    }
+    else
+    {
+        memcpy(pAddr->sun_path, pszSocketPath, len);
+        *pAddrLen = (socklen_t)(offsetof(struct sockaddr_un, sun_path) + len + 1);
+    }
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+/**** Socket file left behind by a crashed instance would make bind fail. Only remove it
+      if it is a socket nobody accepts on, never a regular file or a live listener. ****/
+DWORD
+VmSockPosixRemoveStaleUnixSocket(
+    PVMREST_HANDLE                   pRESTHandle,
+    const char*                      pszSocketPath
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    struct stat                      st = {0};
+    struct sockaddr_un               addr = {0};
+    socklen_t                        addrLen = 0;
+    int                              sock = -1;
+
+    if (lstat(pszSocketPath, &st) < 0)
+    {
+        goto cleanup;
+    }
+
+    if (!S_ISSOCK(st.st_mode))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s exists and is not a socket", pszSocketPath);
+        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmSockPosixGetUnixListenerAddress(pszSocketPath, &addr, &addrLen);
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0)
+    {
+        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if (connect(sock, (struct sockaddr*)&addr, addrLen) == 0)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s is in use by another listener", pszSocketPath);
+        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    VMREST_LOG_INFO(pRESTHandle,"C-REST-ENGINE: Removing stale socket %s", pszSocketPath);
+    unlink(pszSocketPath);
+
+cleanup:
+
+    if (sock >= 0)
+    {
+        close(sock);
+    }
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+static
+DWORD
+VmSockPosixSetUnixAddress(
+    const char*                      pszSocketPath,
+    struct sockaddr_un*              pAddr
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+
+    if (strlen(pszSocketPath) >= sizeof(pAddr->sun_path))
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    memset(pAddr, 0, sizeof(*pAddr));
+    pAddr->sun_family = AF_UNIX;
+    strcpy(pAddr->sun_path, pszSocketPath);
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+DWORD
+VmSockPosixSendListenerFds(
+    PVMREST_HANDLE                   pRESTHandle,
+    const char*                      pszSocketPath
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    PVMREST_SOCK_CONTEXT             pSockContext = NULL;
+    struct sockaddr_un               addr = {0};
+    VM_SOCK_LISTENER_HANDOFF         handoff = {0};
+    int                              fds[VMREST_MAX_LISTEN_FDS] = {0};
+    union
+    {
+        struct cmsghdr               align;
+        char                         buf[CMSG_SPACE(sizeof(int) * VMREST_MAX_LISTEN_FDS)];
+    } control;
+    struct iovec                     iov = {0};
+    struct msghdr                    msg = {0};
+    struct cmsghdr*                  pCmsg = NULL;
+    int                              sock = -1;
+
+    if (!pRESTHandle || !pszSocketPath || !pRESTHandle->pSockContext)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pSockContext = pRESTHandle->pSockContext;
+
+    if (pSockContext->pListenerTCP && (pSockContext->pListenerTCP->fd >= 0))
+    {
+        fds[handoff.nFds++] = pSockContext->pListenerTCP->fd;
+    }
+    if (pSockContext->pListenerTCP6 && (pSockContext->pListenerTCP6->fd >= 0))
+    {
+        fds[handoff.nFds++] = pSockContext->pListenerTCP6->fd;
+    }
+    if (pSockContext->pListenerUnix && (pSockContext->pListenerUnix->fd >= 0))
+    {
+        fds[handoff.nFds++] = pSockContext->pListenerUnix->fd;
+    }
+    if (pSockContext->pListenerShm && (pSockContext->pListenerShm->fd >= 0))
+    {
+        fds[handoff.nFds++] = pSockContext->pListenerShm->fd;
+    }
+
+    if (handoff.nFds == 0)
+    {
+        dwError = ERROR_INVALID_STATE;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmSockPosixSetUnixAddress(pszSocketPath, &addr);
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    sock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sock < 0)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Socket call for listener handoff failed with Error code %d", errno);
+        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if (connect(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Connect to %s for listener handoff failed with Error code %d", pszSocketPath, errno);
+        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    handoff.magic = VM_SOCK_POSIX_LISTENER_HANDOFF_MAGIC;
+
+    iov.iov_base = &handoff;
+    iov.iov_len = sizeof(handoff);
+
+    memset(&control, 0, sizeof(control));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = CMSG_SPACE(sizeof(int) * handoff.nFds);
+
+    pCmsg = CMSG_FIRSTHDR(&msg);
+    pCmsg->cmsg_level = SOL_SOCKET;
+    pCmsg->cmsg_type = SCM_RIGHTS;
+    pCmsg->cmsg_len = CMSG_LEN(sizeof(int) * handoff.nFds);
+    memcpy(CMSG_DATA(pCmsg), fds, sizeof(int) * handoff.nFds);
+
+    if (sendmsg(sock, &msg, MSG_NOSIGNAL) != (ssize_t)sizeof(handoff))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Sending listeners to %s failed with Error code %d", pszSocketPath, errno);
+        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Socket file now belongs to successor, do not remove it when we stop ****/
+    if (pSockContext->pListenerUnix)
+    {
+        pSockContext->pListenerUnix->bUnlinkPath = FALSE;
+    }
+    if (pSockContext->pListenerShm)
+    {
+        pSockContext->pListenerShm->bUnlinkPath = FALSE;
+    }
+
+    VMREST_LOG_INFO(pRESTHandle,"C-REST-ENGINE: Handed over %u listening sockets to %s", handoff.nFds, pszSocketPath);
+
+cleanup:
+
+    if (sock >= 0)
+    {
+        close(sock);
+    }
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+DWORD
+VmSockPosixReceiveListenerFds(
+    PVMREST_HANDLE                   pRESTHandle,
+    const char*                      pszSocketPath,
+    uint32_t                         waitSeconds
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    PVM_REST_CONFIG                  pRESTConfig = NULL;
+    struct sockaddr_un               addr = {0};
+    VM_SOCK_LISTENER_HANDOFF         handoff = {0};
+    union
+    {
+        struct cmsghdr               align;
+        char                         buf[CMSG_SPACE(sizeof(int) * VMREST_MAX_LISTEN_FDS)];
+    } control;
+    struct iovec                     iov = {0};
+    struct msghdr                    msg = {0};
+    struct cmsghdr*                  pCmsg = NULL;
+    struct ucred                     peer = {0};
+    socklen_t                        peerLen = sizeof(peer);
+    struct pollfd                    pfd = {0};
+    int                              fds[VMREST_MAX_LISTEN_FDS] = {0};
+    uint32_t                         nFds = 0;
+    uint32_t                         iFd = 0;
+    int                              listenSock = -1;
+    int                              sock = -1;
+    BOOLEAN                          bBound = FALSE;
+    int                              ret = 0;
+
+    if (!pRESTHandle || !pRESTHandle->pRESTConfig || !pszSocketPath)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pRESTConfig = pRESTHandle->pRESTConfig;
+
+    dwError = VmSockPosixSetUnixAddress(pszSocketPath, &addr);
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    listenSock = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenSock < 0)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Socket call for listener handoff failed with Error code %d", errno);
+        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Stale path of an earlier attempt would make bind fail ****/
+    unlink(pszSocketPath);
+
+    if ((bind(listenSock, (struct sockaddr*)&addr, sizeof(addr)) < 0) || (listen(listenSock, 1) < 0))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Listen on %s for listener handoff failed with Error code %d", pszSocketPath, errno);
+        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    bBound = TRUE;
+
+    pfd.fd = listenSock;
+    pfd.events = POLLIN;
+
+    do
+    {
+        ret = poll(&pfd, 1, (int)(waitSeconds * 1000));
+    } while ((ret < 0) && (errno == EINTR));
+
+    if (ret <= 0)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"No listener handoff on %s within %u seconds", pszSocketPath, waitSeconds);
+        dwError = ERROR_CONNECTION_UNAVAIL;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    sock = accept(listenSock, NULL, NULL);
+    if (sock < 0)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Accept for listener handoff failed with Error code %d", errno);
+        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Only take sockets from our own user or root ****/
+    if ((getsockopt(sock, SOL_SOCKET, SO_PEERCRED, &peer, &peerLen) < 0) ||
+        ((peer.uid != geteuid()) && (peer.uid != 0)))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Listener handoff from pid %d uid %u rejected", peer.pid, peer.uid);
+        dwError = ERROR_INVALID_STATE;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    iov.iov_base = &handoff;
+    iov.iov_len = sizeof(handoff);
+
+    memset(&control, 0, sizeof(control));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    do
+    {
+        ret = recvmsg(sock, &msg, MSG_CMSG_CLOEXEC);
+    } while ((ret < 0) && (errno == EINTR));
+
+    /**** Collect whatever fds arrived so none leaks on a bad message ****/
+    for (pCmsg = CMSG_FIRSTHDR(&msg); (ret > 0) && pCmsg; pCmsg = CMSG_NXTHDR(&msg, pCmsg))
+    {
+        if ((pCmsg->cmsg_level == SOL_SOCKET) && (pCmsg->cmsg_type == SCM_RIGHTS))
+        {
+            nFds = (pCmsg->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+            if (nFds > VMREST_MAX_LISTEN_FDS)
+            {
+                nFds = VMREST_MAX_LISTEN_FDS;
+            }
+            memcpy(fds, CMSG_DATA(pCmsg), sizeof(int) * nFds);
+            break;
+        }
+    }
+
+    if ((ret != (int)sizeof(handoff)) || (msg.msg_flags & MSG_CTRUNC) ||
+        (handoff.magic != VM_SOCK_POSIX_LISTENER_HANDOFF_MAGIC) || (handoff.nFds != nFds) || (nFds == 0))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Bad listener handoff message on %s", pszSocketPath);
+        dwError = ERROR_INVALID_STATE;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Picked up by VmSockPosixAdoptListener at start ****/
+    for (iFd = 0; iFd < nFds; iFd++)
+    {
+        if (pRESTConfig->nListenFds < VMREST_MAX_LISTEN_FDS)
+        {
+            pRESTConfig->listenFds[pRESTConfig->nListenFds++] = fds[iFd];
+        }
+        else
+        {
+            close(fds[iFd]);
+        }
+        fds[iFd] = -1;
+    }
+
+    VMREST_LOG_INFO(pRESTHandle,"C-REST-ENGINE: Took over %u listening sockets from pid %d", nFds, peer.pid);
+
+cleanup:
+
+    for (iFd = 0; iFd < nFds; iFd++)
+    {
+        if (fds[iFd] >= 0)
+        {
+            close(fds[iFd]);
+        }
+    }
+    if (sock >= 0)
+    {
+        close(sock);
+    }
+    if (listenSock >= 0)
+    {
+        close(listenSock);
+    }
+    if (bBound)
+    {
+        unlink(pszSocketPath);
+    }
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
@@ -54,6 +54,19 @@ VmSockPosixCloseEventQueue(
     uint32_t                        waitSecond
     );
 
+DWORD
+VmSockPosixAttachEventQueue(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_EVENT_QUEUE             pQueue
+    );
+
+DWORD
+VmSockPosixDetachEventQueue(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_EVENT_QUEUE             pQueue,
+    uint32_t                         waitSecond
+    );
+
 DWORD
 VmSockPosixSetNonBlocking(
     PVMREST_HANDLE                   pRESTHandle,
@@ -76,6 +89,15 @@ VmSockPosixWrite(
     uint32_t                         nBufLen
     );
 
+DWORD
+VmSockPosixSendFile(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    int                              fd,
+    uint64_t                         offset,
+    uint32_t                         nBytes
+    );
+
 VOID
 VmSockPosixReleaseSocket(
     PVMREST_HANDLE                   pRESTHandle,
@@ -95,6 +117,13 @@ VmSockPosixGetRequestHandle(
     PREST_REQUEST*                   ppRequest
     );
 
+DWORD
+VmSockPosixGetSocketHandle(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    PVMREST_HANDLE*                  ppSockHandle
+    );
+
 DWORD
 VmSockPosixSetRequestHandle(
     PVMREST_HANDLE                   pRESTHandle,
@@ -113,6 +142,237 @@ VmSockPosixGetPeerInfo(
     int*                             pPortNo
     );
 
+DWORD
+VmSockPosixGetPeerCredentials(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    int*                             pPid,
+    uint32_t*                        pUid,
+    uint32_t*                        pGid
+    );
+
+DWORD
+VmSockPosixCreateLoopback(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_RESPONSE_SINK              pSink,
+    PVM_SOCKET*                      ppSocket
+    );
+
+DWORD
+VmSockPosixGetConnectionState(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    uint64_t*                        pAcceptNs,
+    uint64_t*                        pTlsDoneNs,
+    uint32_t*                        pnRequests
+    );
+
+DWORD
+VmSockPosixGetHandshakeStats(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_HANDSHAKE_STATS            pStats
+    );
+
+DWORD
+VmSockPosixReloadSSLContext(
+    PVMREST_HANDLE                   pRESTHandle,
+    const char*                      pszCertBuf,
+    uint32_t                         nCertBufLen,
+    const char*                      pszKeyBuf,
+    uint32_t                         nKeyBufLen
+    );
+
+uint32_t
+VmRESTAcceptSSLContext(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    BOOLEAN                          bWatched,
+    BOOLEAN*                         pbCompleted
+    );
+
+uint64_t
+VmSockPosixGetMonotonicMs(
+    void
+    );
+
+uint32_t
+VmSockPosixReArmTimer(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pTimerSocket,
+    int                              milliSec
+    );
+
+/**** handshake.c ****/
+
+DWORD
+VmSockPosixCreateHandshakePool(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_HANDSHAKE_POOL*         ppPool
+    );
+
+DWORD
+VmSockPosixQueueHandshake(
+    PVM_SOCK_HANDSHAKE_POOL          pPool,
+    PVM_SOCKET                       pSocket
+    );
+
+VOID
+VmSockPosixFreeHandshakePool(
+    PVM_SOCK_HANDSHAKE_POOL          pPool
+    );
+
+/**** listener.c ****/
+
+DWORD
+VmSockPosixAdoptListener(
+    PVMREST_HANDLE                   pRESTHandle,
+    int                              domain,
+    const char*                      pszUnixPath,
+    int*                             pFd
+    );
+
+DWORD
+VmSockPosixGetUnixListenerAddress(
+    const char*                      pszSocketPath,
+    struct sockaddr_un*              pAddr,
+    socklen_t*                       pAddrLen
+    );
+
+DWORD
+VmSockPosixRemoveStaleUnixSocket(
+    PVMREST_HANDLE                   pRESTHandle,
+    const char*                      pszSocketPath
+    );
+
+DWORD
+VmSockPosixSendListenerFds(
+    PVMREST_HANDLE                   pRESTHandle,
+    const char*                      pszSocketPath
+    );
+
+DWORD
+VmSockPosixReceiveListenerFds(
+    PVMREST_HANDLE                   pRESTHandle,
+    const char*                      pszSocketPath,
+    uint32_t                         waitSeconds
+    );
+
+/**** shm.c ****/
+
+DWORD
+VmSockPosixAcceptShmChannel(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pListener,
+    PVM_SOCKET*                      ppSocket
+    );
+
+ssize_t
+VmSockPosixShmRead(
+    PVM_SOCKET                       pSocket,
+    char*                            pBuf,
+    uint32_t                         nLen
+    );
+
+ssize_t
+VmSockPosixShmWrite(
+    PVM_SOCKET                       pSocket,
+    const char*                      pBuf,
+    uint32_t                         nLen
+    );
+
+VOID
+VmSockPosixShmShutdown(
+    PVM_SOCKET                       pSocket
+    );
+
+VOID
+VmSockPosixFreeShmChannel(
+    PVM_SOCK_SHM_CHANNEL             pShm
+    );
+
+/**** connection.c ****/
+
+DWORD
+VmSockPosixCreateConnTable(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_CONN_TABLE*             ppTable
+    );
+
+VOID
+VmSockPosixFreeConnTable(
+    PVM_SOCK_CONN_TABLE              pTable
+    );
+
+DWORD
+VmSockPosixRegisterConnection(
+    PVM_SOCK_CONN_TABLE              pTable,
+    PVM_SOCKET                       pSocket,
+    VMREST_CONN_PHASE                phase
+    );
+
+VOID
+VmSockPosixUnregisterConnection(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket
+    );
+
+VOID
+VmSockPosixSetConnPhase(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    VMREST_CONN_PHASE                phase
+    );
+
+VOID
+VmSockPosixAddConnBytes(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    uint64_t                         nBytesIn,
+    uint64_t                         nBytesOut
+    );
+
+VOID
+VmSockPosixSetMemoryConnection(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket
+    );
+
+uint32_t
+VmSockPosixGetConnectionCount(
+    PVMREST_HANDLE                   pRESTHandle
+    );
+
+BOOLEAN
+VmSockPosixIsDraining(
+    PVMREST_HANDLE                   pRESTHandle
+    );
+
+VOID
+VmSockPosixExpireIdleConnections(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_EVENT_QUEUE             pQueue
+    );
+
+VOID
+VmSockPosixShutdownConnections(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_CONN_TABLE              pTable
+    );
+
+VOID
+VmSockPosixCloseAllConnections(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_CONN_TABLE              pTable
+    );
+
+DWORD
+VmSockPosixGetConnections(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_CONNECTION_INFO            pInfo,
+    uint32_t                         nMax,
+    uint32_t*                        pnCount
+    );
+
 uint32_t
 VmRESTGetSockPackagePosix(
      PVM_SOCK_PACKAGE*               ppSockPackagePosix
@@ -140,7 +400,36 @@ VmRESTSecureSocket(
     char*                            key
     );
 
+uint32_t
+VmRESTSecureSocketReload(
+    PVMREST_HANDLE                   pRESTHandle,
+    const char*                      pszCertBuf,
+    uint32_t                         nCertBufLen,
+    const char*                      pszKeyBuf,
+    uint32_t                         nKeyBufLen
+    );
+
+SSL*
+VmRESTSecureSocketNewSSL(
+    PVMREST_HANDLE                   pRESTHandle
+    );
+
+void
+VmRESTSecureSocketAddRef(
+    SSL_CTX*                         context
+    );
+
+uint32_t
+VmRESTSecureSocketAcquireContext(
+    PVMREST_HANDLE                   pRESTHandle
+    );
+
 void
 VmRESTSecureSocketShutdown(
     PVMREST_HANDLE                   pRESTHandle
     );
+
+BOOLEAN
+VmRESTSecureSocketIsKTLSSend(
+    SSL*                             ssl
+    );
@@ -13,6 +13,8 @@
 
 #include "includes.h"
 
+/**** OpenSSL 1.1.0 onwards does its own locking, callbacks are only needed for 1.0.x ****/
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
 static
 void
 VmRESTSSLThreadLockCallback(
@@ -60,12 +62,14 @@ VmRESTSSLThreadId(
     ret = (unsigned long)pthread_self();
     return ret;
 }
+#endif
 
 uint32_t
 VmRESTSSLThreadLockInit(
     void
     )
 {
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
     uint32_t                         dwError = REST_ENGINE_SUCCESS;
     int                              i = 0;
 
@@ -91,6 +95,9 @@ cleanup:
 error:
     dwError = VMREST_TRANSPORT_SSL_ERROR;
     goto cleanup;
+#else
+    return REST_ENGINE_SUCCESS;
+#endif
 }
 
 void
@@ -98,6 +105,7 @@ VmRESTSSLThreadLockShutdown(
     void
     )
 {
+#if OPENSSL_VERSION_NUMBER < 0x10100000L
     int                              i = 0;
 
     CRYPTO_set_locking_callback(NULL);
@@ -107,13 +115,143 @@ VmRESTSSLThreadLockShutdown(
         pthread_mutex_destroy(&(gSSLThreadLock[i]));
     }
     OPENSSL_free(gSSLThreadLock);
+#endif
+    gSSLThreadLock = NULL;
 }
 
+static
 uint32_t
-VmRESTSecureSocket(
+VmRESTSSLUseCertificateBuffer(
     PVMREST_HANDLE                   pRESTHandle,
-    char*                            certificate,
-    char*                            key
+    SSL_CTX*                         context,
+    const char*                      pszBuffer,
+    uint32_t                         nBufLen
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    BIO*                             bio = NULL;
+    X509*                            cert = NULL;
+    X509*                            chainCert = NULL;
+
+    bio = BIO_new_mem_buf((void*)pszBuffer, (int)nBufLen);
+    if (bio == NULL)
+    {
+        dwError = VMREST_TRANSPORT_SSL_CERTIFICATE_ERROR;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    cert = PEM_read_bio_X509_AUX(bio, NULL, NULL, NULL);
+    if ((cert == NULL) || (SSL_CTX_use_certificate(context, cert) <= 0))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Cannot use SSL certificate from buffer");
+        dwError = VMREST_TRANSPORT_SSL_CERTIFICATE_ERROR;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Any further certificate in buffer is part of chain ****/
+    while ((chainCert = PEM_read_bio_X509(bio, NULL, NULL, NULL)) != NULL)
+    {
+        if (!SSL_CTX_add_extra_chain_cert(context, chainCert))
+        {
+            VMREST_LOG_ERROR(pRESTHandle,"%s","Cannot add chain certificate from buffer");
+            X509_free(chainCert);
+            dwError = VMREST_TRANSPORT_SSL_CERTIFICATE_ERROR;
+        }
+        BAIL_ON_VMREST_ERROR(dwError);
+        chainCert = NULL;
+    }
+
+    /**** End of PEM data leaves an error in queue ****/
+    ERR_clear_error();
+
+cleanup:
+
+    if (cert)
+    {
+        X509_free(cert);
+    }
+    if (bio)
+    {
+        BIO_free(bio);
+    }
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+static
+uint32_t
+VmRESTSSLUsePrivateKeyBuffer(
+    PVMREST_HANDLE                   pRESTHandle,
+    SSL_CTX*                         context,
+    const char*                      pszBuffer,
+    uint32_t                         nBufLen
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    BIO*                             bio = NULL;
+    EVP_PKEY*                        pkey = NULL;
+
+    bio = BIO_new_mem_buf((void*)pszBuffer, (int)nBufLen);
+    if (bio == NULL)
+    {
+        dwError = VMREST_TRANSPORT_SSL_PRIVATEKEY_ERROR;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pkey = PEM_read_bio_PrivateKey(bio, NULL, NULL, NULL);
+    if ((pkey == NULL) || (SSL_CTX_use_PrivateKey(context, pkey) <= 0))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Cannot use private key from buffer");
+        dwError = VMREST_TRANSPORT_SSL_PRIVATEKEY_ERROR;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+
+    if (pkey)
+    {
+        EVP_PKEY_free(pkey);
+    }
+    if (bio)
+    {
+        BIO_free(bio);
+    }
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+void
+VmRESTSecureSocketAddRef(
+    SSL_CTX*                         context
+    )
+{
+#if OPENSSL_VERSION_NUMBER >= 0x10100000L
+    SSL_CTX_up_ref(context);
+#else
+    CRYPTO_add(&context->references, 1, CRYPTO_LOCK_SSL_CTX);
+#endif
+}
+
+/**** Build a new server context. Certificate and key are taken from PEM buffer when given, else from file ****/
+static
+uint32_t
+VmRESTSSLCreateContext(
+    PVMREST_HANDLE                   pRESTHandle,
+    const char*                      certificate,
+    const char*                      key,
+    const char*                      pszCertBuf,
+    uint32_t                         nCertBufLen,
+    const char*                      pszKeyBuf,
+    uint32_t                         nKeyBufLen,
+    SSL_CTX**                        ppContext
     )
 {
     uint32_t                         dwError = REST_ENGINE_SUCCESS;
@@ -122,15 +260,13 @@ VmRESTSecureSocket(
     const SSL_METHOD*                method = NULL;
     SSL_CTX*                         context = NULL;
 
-    if (!key || !certificate || !pRESTHandle || !(pRESTHandle->pRESTConfig))
+    if ((!pszCertBuf && IsNullOrEmptyString(certificate)) || (!pszKeyBuf && IsNullOrEmptyString(key)))
     {
-        VMREST_LOG_ERROR(pRESTHandle,"Invalid params");
+        VMREST_LOG_ERROR(pRESTHandle,"%s","No SSL certificate or key");
         dwError = VMREST_TRANSPORT_INVALID_PARAM;
     }
     BAIL_ON_VMREST_ERROR(dwError);
 
-    OpenSSL_add_all_algorithms();
-    SSL_load_error_strings();
     method = SSLv23_server_method();
     context = SSL_CTX_new(method);
     if ( context == NULL )
@@ -144,6 +280,17 @@ VmRESTSecureSocket(
 
     options = options | pRESTHandle->pRESTConfig->SSLCtxOptionsFlag;
 
+    /**** Opt-in kernel TLS, record layer moves to kernel after handshake if cipher and kernel support it ****/
+    if (pRESTHandle->pRESTConfig->useKernelTLS)
+    {
+#ifdef SSL_OP_ENABLE_KTLS
+        options = options | SSL_OP_ENABLE_KTLS;
+        VMREST_LOG_INFO(pRESTHandle,"%s","Kernel TLS offload requested");
+#else
+        VMREST_LOG_WARNING(pRESTHandle,"%s","Kernel TLS not supported by OpenSSL library, using user space TLS");
+#endif
+    }
+
     options = SSL_CTX_set_options(context, options);
 
     ret = SSL_CTX_set_cipher_list(context, pRESTHandle->pRESTConfig->pszSSLCipherList);
@@ -153,22 +300,49 @@ VmRESTSecureSocket(
         dwError = VMREST_TRANSPORT_SSL_INVALID_CIPHER_SUITES;
     }
     BAIL_ON_VMREST_ERROR(dwError);
- 
-    ret = SSL_CTX_use_certificate_file(context, certificate, SSL_FILETYPE_PEM);
-    if (ret <= 0)
+
+    if (pszCertBuf)
     {
-        VMREST_LOG_ERROR(pRESTHandle,"Cannot Use SSL certificate");
-        dwError = VMREST_TRANSPORT_SSL_CERTIFICATE_ERROR;
+        dwError = VmRESTSSLUseCertificateBuffer(
+                      pRESTHandle,
+                      context,
+                      pszCertBuf,
+                      nCertBufLen
+                      );
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+    else
+    {
+        ret = SSL_CTX_use_certificate_file(context, certificate, SSL_FILETYPE_PEM);
+        if (ret <= 0)
+        {
+            VMREST_LOG_ERROR(pRESTHandle,"Cannot Use SSL certificate");
+            dwError = VMREST_TRANSPORT_SSL_CERTIFICATE_ERROR;
+        }
+        BAIL_ON_VMREST_ERROR(dwError);
     }
-    BAIL_ON_VMREST_ERROR(dwError);
 
-    ret = SSL_CTX_use_PrivateKey_file(context, key, SSL_FILETYPE_PEM);
-    if (ret <= 0)
+    if (pszKeyBuf)
     {
-        VMREST_LOG_ERROR(pRESTHandle,"Cannot use private key file");
-        dwError = VMREST_TRANSPORT_SSL_PRIVATEKEY_ERROR;
+        dwError = VmRESTSSLUsePrivateKeyBuffer(
+                      pRESTHandle,
+                      context,
+                      pszKeyBuf,
+                      nKeyBufLen
+                      );
         BAIL_ON_VMREST_ERROR(dwError);
     }
+    else
+    {
+        ret = SSL_CTX_use_PrivateKey_file(context, key, SSL_FILETYPE_PEM);
+        if (ret <= 0)
+        {
+            VMREST_LOG_ERROR(pRESTHandle,"Cannot use private key file");
+            dwError = VMREST_TRANSPORT_SSL_PRIVATEKEY_ERROR;
+            BAIL_ON_VMREST_ERROR(dwError);
+        }
+    }
+
     if (!SSL_CTX_check_private_key(context))
     {
         VMREST_LOG_ERROR(pRESTHandle,"Error in Private Key");
@@ -176,7 +350,58 @@ VmRESTSecureSocket(
         BAIL_ON_VMREST_ERROR(dwError);
     }
 
-    pRESTHandle->pSSLInfo->sslContext = context;
+    *ppContext = context;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    if (context)
+    {
+        SSL_CTX_free(context);
+    }
+    *ppContext = NULL;
+    goto cleanup;
+}
+
+uint32_t
+VmRESTSecureSocket(
+    PVMREST_HANDLE                   pRESTHandle,
+    char*                            certificate,
+    char*                            key
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    SSL_CTX*                         context = NULL;
+    PVM_SOCK_SSL_INFO                pSSLInfo = NULL;
+
+    if (!pRESTHandle || !(pRESTHandle->pRESTConfig) || !(pRESTHandle->pSSLInfo))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Invalid params");
+        dwError = VMREST_TRANSPORT_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pSSLInfo = pRESTHandle->pSSLInfo;
+
+    OpenSSL_add_all_algorithms();
+    SSL_load_error_strings();
+
+    dwError = VmRESTSSLCreateContext(
+                  pRESTHandle,
+                  certificate,
+                  key,
+                  (pSSLInfo->isCertSet == SSL_INFO_FROM_BUFFER_API) ? pSSLInfo->pszCertBuf : NULL,
+                  pSSLInfo->nCertBufLen,
+                  (pSSLInfo->isKeySet == SSL_INFO_FROM_BUFFER_API) ? pSSLInfo->pszKeyBuf : NULL,
+                  pSSLInfo->nKeyBufLen,
+                  &context
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pSSLInfo->sslContext = context;
 
 cleanup:
     return dwError;
@@ -186,13 +411,282 @@ error:
     goto cleanup;
 }
 
+/**** Digest over everything that goes into a server context, equal digest means context can be shared ****/
+static
+uint32_t
+VmRESTSSLContextDigest(
+    PVMREST_HANDLE                   pRESTHandle,
+    unsigned char*                   pDigest
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    EVP_MD_CTX*                      mdCtx = NULL;
+    PVM_SOCK_SSL_INFO                pSSLInfo = pRESTHandle->pSSLInfo;
+    PVM_REST_CONFIG                  pConfig = pRESTHandle->pRESTConfig;
+    unsigned int                     nDigestLen = 0;
+    int                              ret = 1;
+
+    mdCtx = EVP_MD_CTX_create();
+    if (!mdCtx)
+    {
+        dwError = REST_ERROR_NO_MEMORY;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    ret &= EVP_DigestInit_ex(mdCtx, EVP_sha256(), NULL);
+
+    ret &= EVP_DigestUpdate(mdCtx, &pSSLInfo->isCertSet, sizeof(pSSLInfo->isCertSet));
+    if (pSSLInfo->isCertSet == SSL_INFO_FROM_BUFFER_API)
+    {
+        ret &= EVP_DigestUpdate(mdCtx, pSSLInfo->pszCertBuf, pSSLInfo->nCertBufLen);
+    }
+    else
+    {
+        ret &= EVP_DigestUpdate(mdCtx, pConfig->pszSSLCertificate, strlen(pConfig->pszSSLCertificate) + 1);
+    }
+
+    ret &= EVP_DigestUpdate(mdCtx, &pSSLInfo->isKeySet, sizeof(pSSLInfo->isKeySet));
+    if (pSSLInfo->isKeySet == SSL_INFO_FROM_BUFFER_API)
+    {
+        ret &= EVP_DigestUpdate(mdCtx, pSSLInfo->pszKeyBuf, pSSLInfo->nKeyBufLen);
+    }
+    else
+    {
+        ret &= EVP_DigestUpdate(mdCtx, pConfig->pszSSLKey, strlen(pConfig->pszSSLKey) + 1);
+    }
+
+    ret &= EVP_DigestUpdate(mdCtx, pConfig->pszSSLCipherList, strlen(pConfig->pszSSLCipherList) + 1);
+    ret &= EVP_DigestUpdate(mdCtx, &pConfig->SSLCtxOptionsFlag, sizeof(pConfig->SSLCtxOptionsFlag));
+    ret &= EVP_DigestUpdate(mdCtx, &pConfig->useKernelTLS, sizeof(pConfig->useKernelTLS));
+
+    ret &= EVP_DigestFinal_ex(mdCtx, pDigest, &nDigestLen);
+
+    if (!ret || (nDigestLen != VM_SOCK_POSIX_SSL_CTX_DIGEST_LEN))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Failed to compute SSL context digest");
+        dwError = VMREST_TRANSPORT_SSL_ERROR;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+
+    if (mdCtx)
+    {
+        EVP_MD_CTX_destroy(mdCtx);
+    }
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+/**** Caller holds gGlobalMutex ****/
+static
 void
-VmRESTSecureSocketShutdown(
+VmRESTSSLReleaseSharedContext(
+    SSL_CTX*                         context
+    )
+{
+    PVM_SOCK_SSL_CTX_ENTRY*          ppEntry = &gpSSLCtxList;
+    PVM_SOCK_SSL_CTX_ENTRY           pEntry = NULL;
+
+    while (*ppEntry)
+    {
+        pEntry = *ppEntry;
+        if (pEntry->sslContext == context)
+        {
+            pEntry->nRef--;
+            if (pEntry->nRef == 0)
+            {
+                *ppEntry = pEntry->pNext;
+                SSL_CTX_free(pEntry->sslContext);
+                VmRESTFreeMemory(pEntry, REST_MEM_TLS);
+            }
+            break;
+        }
+        ppEntry = &pEntry->pNext;
+    }
+}
+
+/**** Caller holds gGlobalMutex. Handles with same certificate, key and SSL settings share one context ****/
+uint32_t
+VmRESTSecureSocketAcquireContext(
+    PVMREST_HANDLE                   pRESTHandle
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    unsigned char                    digest[VM_SOCK_POSIX_SSL_CTX_DIGEST_LEN] = {0};
+    PVM_SOCK_SSL_CTX_ENTRY           pEntry = NULL;
+
+    if (!pRESTHandle || !(pRESTHandle->pRESTConfig) || !(pRESTHandle->pSSLInfo))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
+        dwError = VMREST_TRANSPORT_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTSSLContextDigest(
+                  pRESTHandle,
+                  digest
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    for (pEntry = gpSSLCtxList; pEntry; pEntry = pEntry->pNext)
+    {
+        if (!memcmp(pEntry->digest, digest, sizeof(digest)))
+        {
+            break;
+        }
+    }
+
+    if (pEntry)
+    {
+        VmRESTSecureSocketAddRef(pEntry->sslContext);
+        pEntry->nRef++;
+        pRESTHandle->pSSLInfo->sslContext = pEntry->sslContext;
+        VMREST_LOG_DEBUG(pRESTHandle,"Sharing SSL context with %u other instance(s)", pEntry->nRef - 1);
+    }
+    else
+    {
+        dwError = VmRESTAllocateMemory(
+                      sizeof(VM_SOCK_SSL_CTX_ENTRY),
+                      (void**)&pEntry,
+                      REST_MEM_TLS
+                      );
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        dwError = VmRESTSecureSocket(
+                      pRESTHandle,
+                      pRESTHandle->pRESTConfig->pszSSLCertificate,
+                      pRESTHandle->pRESTConfig->pszSSLKey
+                      );
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        /**** Context is not modified after this point, list and instance each hold a reference ****/
+        VmRESTSecureSocketAddRef(pRESTHandle->pSSLInfo->sslContext);
+        pEntry->sslContext = pRESTHandle->pSSLInfo->sslContext;
+        memcpy(pEntry->digest, digest, sizeof(digest));
+        pEntry->nRef = 1;
+        pEntry->pNext = gpSSLCtxList;
+        gpSSLCtxList = pEntry;
+        pEntry = NULL;
+    }
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    if (pEntry)
+    {
+        VmRESTFreeMemory(pEntry, REST_MEM_TLS);
+    }
+    goto cleanup;
+}
+
+uint32_t
+VmRESTSecureSocketReload(
+    PVMREST_HANDLE                   pRESTHandle,
+    const char*                      pszCertBuf,
+    uint32_t                         nCertBufLen,
+    const char*                      pszKeyBuf,
+    uint32_t                         nKeyBufLen
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+    SSL_CTX*                         context = NULL;
+    SSL_CTX*                         oldContext = NULL;
+    PVM_SOCK_SSL_INFO                pSSLInfo = NULL;
+
+    if (!pRESTHandle || !(pRESTHandle->pRESTConfig) || !(pRESTHandle->pSSLInfo) || !(pRESTHandle->pSSLInfo->isSecure))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
+        dwError = VMREST_TRANSPORT_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pSSLInfo = pRESTHandle->pSSLInfo;
+
+    /**** Context owned by application is never replaced by library ****/
+    if (pSSLInfo->isCertSet == SSL_INFO_USE_APP_CONTEXT)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","SSL context provided by application, cannot reload");
+        dwError = VMREST_TRANSPORT_INVALID_PARAM;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Built outside lock, accept path is not blocked while keys are parsed ****/
+    dwError = VmRESTSSLCreateContext(
+                  pRESTHandle,
+                  pRESTHandle->pRESTConfig->pszSSLCertificate,
+                  pRESTHandle->pRESTConfig->pszSSLKey,
+                  pszCertBuf,
+                  nCertBufLen,
+                  pszKeyBuf,
+                  nKeyBufLen,
+                  &context
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTLockMutex(pSSLInfo->pCtxMutex);
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    oldContext = pSSLInfo->sslContext;
+    pSSLInfo->sslContext = context;
+    context = NULL;
+
+    VmRESTUnlockMutex(pSSLInfo->pCtxMutex);
+
+    /**** Reloaded context is private to this instance, stop sharing old one ****/
+    pthread_mutex_lock(&gGlobalMutex);
+    VmRESTSSLReleaseSharedContext(oldContext);
+    pthread_mutex_unlock(&gGlobalMutex);
+
+    /**** Live connections hold their own reference on old context ****/
+    if (oldContext)
+    {
+        SSL_CTX_free(oldContext);
+    }
+
+    VMREST_LOG_INFO(pRESTHandle,"%s","SSL context reloaded, new connections use new certificate");
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    if (context)
+    {
+        SSL_CTX_free(context);
+    }
+    goto cleanup;
+}
+
+SSL*
+VmRESTSecureSocketNewSSL(
     PVMREST_HANDLE                   pRESTHandle
     )
 {
-    BOOLEAN                          bDestroyGlobalMutex = FALSE;
+    SSL*                             pSSL = NULL;
+    PVM_SOCK_SSL_INFO                pSSLInfo = pRESTHandle->pSSLInfo;
 
+    /**** SSL_new takes its own reference on context, safe against concurrent reload ****/
+    VmRESTLockMutex(pSSLInfo->pCtxMutex);
+    pSSL = SSL_new(pSSLInfo->sslContext);
+    VmRESTUnlockMutex(pSSLInfo->pCtxMutex);
+
+    return pSSL;
+}
+
+void
+VmRESTSecureSocketShutdown(
+    PVMREST_HANDLE                   pRESTHandle
+    )
+{
     if (!pRESTHandle || !pRESTHandle->pSSLInfo)
     {
         VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
@@ -203,29 +697,21 @@ VmRESTSecureSocketShutdown(
     if((pRESTHandle->pSSLInfo->isCertSet == SSL_INFO_FROM_CONFIG_FILE) || (pRESTHandle->pSSLInfo->isCertSet == SSL_INFO_FROM_BUFFER_API))
     {
         pthread_mutex_lock(&gGlobalMutex);
+
+        if (pRESTHandle->pSSLInfo->sslContext)
+        {
+            VmRESTSSLReleaseSharedContext(pRESTHandle->pSSLInfo->sslContext);
+            SSL_CTX_free(pRESTHandle->pSSLInfo->sslContext);
+            pRESTHandle->pSSLInfo->sslContext = NULL;
+        }
+
         gSSLisedInstaceCount--;
         if (gSSLisedInstaceCount == 0)
         {
-            if (pRESTHandle->pSSLInfo->sslContext)
-            {
-                VmRESTFreeMemory(pRESTHandle->pSSLInfo->sslContext);
-                pRESTHandle->pSSLInfo->sslContext = NULL;
-            }
             VmRESTSSLThreadLockShutdown();
-            gSSLThreadLock = NULL;
-            bDestroyGlobalMutex = TRUE;
             gSSLisedInstaceCount = INVALID;
         }
-        else
-        {
-            pRESTHandle->pSSLInfo->sslContext = NULL;
-        }
         pthread_mutex_unlock(&gGlobalMutex);
-
-        if (bDestroyGlobalMutex)
-        {
-            pthread_mutex_destroy(&gGlobalMutex);
-        }
     }
     else
     {
@@ -233,3 +719,22 @@ VmRESTSecureSocketShutdown(
         pRESTHandle->pSSLInfo->sslContext = NULL;
     }
 }
+
+BOOLEAN
+VmRESTSecureSocketIsKTLSSend(
+    SSL*                             ssl
+    )
+{
+    BOOLEAN                          bKTLSSend = FALSE;
+
+#if defined(SSL_OP_ENABLE_KTLS) && defined(BIO_get_ktls_send)
+    if (ssl && SSL_get_wbio(ssl) && (BIO_get_ktls_send(SSL_get_wbio(ssl)) > 0))
+    {
+        bKTLSSend = TRUE;
+    }
+#else
+    (void)ssl;
+#endif
+
+    return bKTLSSend;
+}
@@ -0,0 +1,370 @@
+/* C-REST-Engine
+*
+* Copyright (c) 2017 VMware, Inc. All Rights Reserved.
+*
+* This product is licensed to you under the Apache 2.0 license (the "License").
+* You may not use this product except in compliance with the Apache 2.0 License.
+*
+* This product may include a number of subcomponents with separate copyright
+* notices and license terms. Your use of these subcomponents is subject to the
+* terms and conditions of the subcomponent's license, as noted in the LICENSE file.
+*
+*/
+
+#include "includes.h"
+
+static
+VOID
+VmSockPosixWakeEventFd(
+    int                              fd
+    )
+{
+    uint64_t                         one = 1;
+
+    if (write(fd, &one, sizeof(one)) < 0)
+    {
+        /**** Counter cannot overflow with one increment per wakeup, peer end may be gone ****/
+    }
+}
+
+static
+DWORD
+VmSockPosixSendShmHello(
+    PVMREST_HANDLE                   pRESTHandle,
+    int                              sock,
+    uint32_t                         nRingBytes,
+    int*                             pFds
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    VMREST_SHM_HELLO                 hello = {0};
+    union
+    {
+        struct cmsghdr               align;
+        char                         buf[CMSG_SPACE(sizeof(int) * VMREST_SHM_FD_COUNT)];
+    } control;
+    struct iovec                     iov = {0};
+    struct msghdr                    msg = {0};
+    struct cmsghdr*                  pCmsg = NULL;
+
+    hello.magic = VMREST_SHM_MAGIC;
+    hello.version = VMREST_SHM_VERSION;
+    hello.nRingBytes = nRingBytes;
+    hello.nFds = VMREST_SHM_FD_COUNT;
+
+    iov.iov_base = &hello;
+    iov.iov_len = sizeof(hello);
+
+    memset(&control, 0, sizeof(control));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control.buf;
+    msg.msg_controllen = sizeof(control.buf);
+
+    pCmsg = CMSG_FIRSTHDR(&msg);
+    pCmsg->cmsg_level = SOL_SOCKET;
+    pCmsg->cmsg_type = SCM_RIGHTS;
+    pCmsg->cmsg_len = CMSG_LEN(sizeof(int) * VMREST_SHM_FD_COUNT);
+    memcpy(CMSG_DATA(pCmsg), pFds, sizeof(int) * VMREST_SHM_FD_COUNT);
+
+    if (sendmsg(sock, &msg, MSG_NOSIGNAL) != (ssize_t)sizeof(hello))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Sending shared memory channel on fd %d failed with Error code %d", sock, errno);
+        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+/**** Client connected to rendezvous socket. Set up rings in a memfd, hand memfd and both
+      eventfds to client and drop the unix socket. From here on the channel looks like any
+      other connection to event queue, its fd is the eventfd client writes to wake us. ****/
+DWORD
+VmSockPosixAcceptShmChannel(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pListener,
+    PVM_SOCKET*                      ppSocket
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    PVM_SOCKET                       pSocket = NULL;
+    PVM_SOCK_SHM_CHANNEL             pShm = NULL;
+    struct ucred                     peer = {0};
+    socklen_t                        peerLen = sizeof(peer);
+    int                              fds[VMREST_SHM_FD_COUNT] = { -1, -1, -1 };
+    uint32_t                         nRingBytes = 0;
+    void*                            pMap = MAP_FAILED;
+    int                              sock = -1;
+    uint32_t                         iFd = 0;
+
+    if (!pRESTHandle || !pListener || !ppSocket)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    nRingBytes = pRESTHandle->pRESTConfig->nShmRingBytes;
+
+    sock = accept4(pListener->fd, NULL, NULL, SOCK_CLOEXEC);
+    if (sock < 0)
+    {
+        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if (getsockopt(sock, SOL_SOCKET, SO_PEERCRED, &peer, &peerLen) < 0)
+    {
+        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateMemory(
+                  sizeof(*pShm),
+                  (PVOID*)&pShm,
+                  REST_MEM_SOCKET
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pShm->wakeClientFd = -1;
+    pShm->nMapBytes = VMREST_SHM_MAP_BYTES(nRingBytes);
+    pShm->peerPid = (int)peer.pid;
+    pShm->peerUid = (uint32_t)peer.uid;
+    pShm->peerGid = (uint32_t)peer.gid;
+
+    fds[VMREST_SHM_FD_MEMORY] = memfd_create("vmrest-shm", MFD_CLOEXEC);
+    fds[VMREST_SHM_FD_WAKE_SERVER] = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    fds[VMREST_SHM_FD_WAKE_CLIENT] = eventfd(0, EFD_CLOEXEC);
+    if ((fds[VMREST_SHM_FD_MEMORY] < 0) || (fds[VMREST_SHM_FD_WAKE_SERVER] < 0) || (fds[VMREST_SHM_FD_WAKE_CLIENT] < 0))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Creating shared memory channel failed with Error code %d", errno);
+        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    if (ftruncate(fds[VMREST_SHM_FD_MEMORY], (off_t)pShm->nMapBytes) < 0)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Sizing shared memory channel to %zu bytes failed with Error code %d", pShm->nMapBytes, errno);
+        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pMap = mmap(NULL, pShm->nMapBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fds[VMREST_SHM_FD_MEMORY], 0);
+    if (pMap == MAP_FAILED)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Mapping shared memory channel failed with Error code %d", errno);
+        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pShm->pHeader = (PVMREST_SHM_HEADER)pMap;
+    pShm->pHeader->magic = VMREST_SHM_MAGIC;
+    pShm->pHeader->version = VMREST_SHM_VERSION;
+    pShm->pHeader->nRingBytes = nRingBytes;
+    /**** Server sleeps in event queue until first request ****/
+    pShm->pHeader->request.bConsumerWaiting = 1;
+    pMap = MAP_FAILED;
+
+    dwError = VmSockPosixSendShmHello(
+                  pRESTHandle,
+                  sock,
+                  nRingBytes,
+                  fds
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateMemory(
+                  sizeof(*pSocket),
+                  (PVOID*)&pSocket,
+                  REST_MEM_SOCKET
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateNamedMutex(&pSocket->pMutex, "shm_socket");
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pShm->wakeClientFd = fds[VMREST_SHM_FD_WAKE_CLIENT];
+    fds[VMREST_SHM_FD_WAKE_CLIENT] = -1;
+
+    pSocket->type = VM_SOCK_TYPE_SERVER;
+    pSocket->fd = fds[VMREST_SHM_FD_WAKE_SERVER];
+    fds[VMREST_SHM_FD_WAKE_SERVER] = -1;
+    pSocket->ssl = NULL;
+    /**** Never encrypted, peer is on this host and authenticated by kernel ****/
+    pSocket->bSSLHandShakeCompleted = TRUE;
+    pSocket->pRESTHandle = pListener->pRESTHandle;
+    pSocket->pShm = pShm;
+    pShm = NULL;
+
+    VMREST_LOG_DEBUG(pRESTHandle,"Shared memory channel fd %d for pid %d, %u byte rings", pSocket->fd, peer.pid, nRingBytes);
+
+    *ppSocket = pSocket;
+
+cleanup:
+
+    /**** Client holds its own references now, mapping keeps memory alive for us ****/
+    for (iFd = 0; iFd < VMREST_SHM_FD_COUNT; iFd++)
+    {
+        if (fds[iFd] >= 0)
+        {
+            close(fds[iFd]);
+        }
+    }
+    if (sock >= 0)
+    {
+        close(sock);
+    }
+
+    return dwError;
+
+error:
+
+    if (ppSocket)
+    {
+        *ppSocket = NULL;
+    }
+    if (pSocket)
+    {
+        VmRESTFreeMutex(pSocket->pMutex);
+        VmRESTFreeMemory(pSocket, REST_MEM_SOCKET);
+    }
+    if (pShm)
+    {
+        VmSockPosixFreeShmChannel(pShm);
+    }
+
+    goto cleanup;
+}
+
+/**** Same contract as read() on a non blocking socket: bytes copied, 0 once client is gone,
+      -1 with EAGAIN when there is nothing. Before saying EAGAIN we flag that we sleep, client
+      then wakes us through eventfd on its next write. ****/
+ssize_t
+VmSockPosixShmRead(
+    PVM_SOCKET                       pSocket,
+    char*                            pBuf,
+    uint32_t                         nLen
+    )
+{
+    PVM_SOCK_SHM_CHANNEL             pShm = pSocket->pShm;
+    PVMREST_SHM_RING                 pRing = &pShm->pHeader->request;
+    char*                            pData = VMREST_SHM_REQUEST_DATA(pShm->pHeader);
+    uint32_t                         nRingBytes = pShm->pHeader->nRingBytes;
+    uint32_t                         nRead = 0;
+    uint64_t                         count = 0;
+
+    if (__atomic_load_n(&pShm->bShutdown, __ATOMIC_ACQUIRE))
+    {
+        return 0;
+    }
+
+    nRead = VmRESTShmRingRead(pRing, pData, nRingBytes, pBuf, nLen);
+    if (nRead > 0)
+    {
+        return nRead;
+    }
+
+    /**** Consume wakeups before last look, a write after this re-arms the eventfd ****/
+    if (read(pSocket->fd, &count, sizeof(count)) < 0)
+    {
+        count = 0;
+    }
+
+    if (VmRESTShmRingPrepareWait(pRing) > 0)
+    {
+        return VmRESTShmRingRead(pRing, pData, nRingBytes, pBuf, nLen);
+    }
+
+    if (__atomic_load_n(&pRing->bProducerClosed, __ATOMIC_ACQUIRE))
+    {
+        return 0;
+    }
+
+    errno = EAGAIN;
+    return -1;
+}
+
+/**** Same contract as write() on a non blocking socket. A full ring is retried for a while,
+      client is usually busy polling and frees space within microseconds. ****/
+ssize_t
+VmSockPosixShmWrite(
+    PVM_SOCKET                       pSocket,
+    const char*                      pBuf,
+    uint32_t                         nLen
+    )
+{
+    PVM_SOCK_SHM_CHANNEL             pShm = pSocket->pShm;
+    PVMREST_SHM_RING                 pRing = &pShm->pHeader->response;
+    char*                            pData = VMREST_SHM_RESPONSE_DATA(pShm->pHeader);
+    uint32_t                         nRingBytes = pShm->pHeader->nRingBytes;
+    uint32_t                         nWritten = 0;
+    uint32_t                         iSpin = 0;
+
+    for (;;)
+    {
+        if (__atomic_load_n(&pShm->pHeader->request.bProducerClosed, __ATOMIC_ACQUIRE) ||
+            __atomic_load_n(&pShm->bShutdown, __ATOMIC_ACQUIRE))
+        {
+            errno = EPIPE;
+            return -1;
+        }
+
+        nWritten = VmRESTShmRingWrite(pRing, pData, nRingBytes, pBuf, nLen);
+        if (nWritten > 0)
+        {
+            if (VmRESTShmRingNeedsWakeup(pRing))
+            {
+                VmSockPosixWakeEventFd(pShm->wakeClientFd);
+            }
+            return nWritten;
+        }
+
+        if (++iSpin >= VM_SOCK_POSIX_SHM_FULL_SPINS)
+        {
+            errno = EAGAIN;
+            return -1;
+        }
+        sched_yield();
+    }
+}
+
+/**** Make a worker see the channel as closed by remote, like shutdown() on a socket ****/
+VOID
+VmSockPosixShmShutdown(
+    PVM_SOCKET                       pSocket
+    )
+{
+    __atomic_store_n(&pSocket->pShm->bShutdown, TRUE, __ATOMIC_RELEASE);
+    VmSockPosixWakeEventFd(pSocket->fd);
+}
+
+VOID
+VmSockPosixFreeShmChannel(
+    PVM_SOCK_SHM_CHANNEL             pShm
+    )
+{
+    if (pShm->pHeader)
+    {
+        /**** Client reads what is left in ring, then sees close ****/
+        __atomic_store_n(&pShm->pHeader->response.bProducerClosed, 1, __ATOMIC_RELEASE);
+        if ((pShm->wakeClientFd >= 0) && VmRESTShmRingNeedsWakeup(&pShm->pHeader->response))
+        {
+            VmSockPosixWakeEventFd(pShm->wakeClientFd);
+        }
+        munmap(pShm->pHeader, pShm->nMapBytes);
+        pShm->pHeader = NULL;
+    }
+    if (pShm->wakeClientFd >= 0)
+    {
+        close(pShm->wakeClientFd);
+        pShm->wakeClientFd = -1;
+    }
+
+    VmRESTFreeMemory(pShm, REST_MEM_SOCKET);
+}
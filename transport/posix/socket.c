@@ -68,32 +68,47 @@ VmSockPosixCreateTimer(
 
 static
 uint32_t
-VmSockPosixReArmTimer(
+VmRESTCreateSSLObject(
     PVMREST_HANDLE                   pRESTHandle,
-    PVM_SOCKET                       pTimerSocket,
-    int                              milliSec
+    PVM_SOCKET                       pSocket
     );
 
 static
-uint32_t
-VmRESTAcceptSSLContext(
+void
+VmSockPosixPreProcessTimeouts(
     PVMREST_HANDLE                   pRESTHandle,
-    PVM_SOCKET                       pSocket,
-    BOOLEAN                          bWatched
+    PVM_SOCK_EVENT_QUEUE             pQueue
     );
 
 static
 uint32_t
-VmRESTCreateSSLObject(
+VmSockPosixTLSRecordSize(
     PVMREST_HANDLE                   pRESTHandle,
-    PVM_SOCKET                       pSocket
+    PVM_SOCKET                       pSocket,
+    uint32_t                         nRemaining
     );
 
 static
-void
-VmSockPosixPreProcessTimeouts(
+int
+VmSockPosixIdleTimeoutMs(
+    PVMREST_HANDLE                   pRESTHandle
+    );
+
+static
+VOID
+VmSockPosixWriteRetryReset(
+    PVM_SOCK_WRITE_RETRY             pRetry
+    );
+
+static
+DWORD
+VmSockPosixWriteRetry(
     PVMREST_HANDLE                   pRESTHandle,
-    PVM_SOCK_EVENT_QUEUE             pQueue
+    PVM_SOCK_WRITE_RETRY             pRetry,
+    const char*                      pszOp,
+    ssize_t                          nWritten,
+    int                              sslError,
+    int                              sysError
     );
 
 
@@ -111,6 +126,7 @@ VmSockPosixStartServer(
         struct sockaddr_in6          servaddr_ipv6;
 #endif
         struct sockaddr_in           servaddr_ipv4;
+        struct sockaddr_un           servaddr_unix;
     } servaddr;
     struct
     {
@@ -124,6 +140,8 @@ VmSockPosixStartServer(
     PVM_SOCKET                       pSocket = NULL;
     PVM_SOCK_SSL_INFO                pSSLInfo = NULL;
     BOOLEAN                          bLocked = FALSE;
+    BOOLEAN                          bUnlinkPath = FALSE;
+    const char*                      pszUnixPath = NULL;
 
     if (!pRESTHandle || !pRESTHandle->pSSLInfo || !pRESTHandle->pRESTConfig)
     {
@@ -131,7 +149,16 @@ VmSockPosixStartServer(
     }
     BAIL_ON_VMREST_ERROR(dwError);
 
-    if (dwFlags & VM_SOCK_CREATE_FLAGS_IPV6)
+    /**** Shared memory channels rendezvous on their own unix domain socket ****/
+    pszUnixPath = (dwFlags & VM_SOCK_CREATE_FLAGS_SHM) ?
+                      pRESTHandle->pRESTConfig->pszShmSocketPath :
+                      pRESTHandle->pRESTConfig->pszUnixSocketPath;
+
+    if (dwFlags & VM_SOCK_CREATE_FLAGS_UNIX)
+    {
+        socketParams.domain = AF_UNIX;
+    }
+    else if (dwFlags & VM_SOCK_CREATE_FLAGS_IPV6)
     {
 #ifdef AF_INET6
         socketParams.domain = AF_INET6;
@@ -168,9 +195,15 @@ VmSockPosixStartServer(
             VMREST_LOG_INFO(pRESTHandle,"%s","Using Application provided SSL Context");
             pRESTHandle->pSSLInfo->sslContext = pRESTHandle->pRESTConfig->pSSLContext;
         }
+        else if (pSSLInfo->sslContext != NULL)
+        {
+            /**** Context already acquired by other listener of this instance ****/
+            VMREST_LOG_DEBUG(pRESTHandle,"%s","Using REST Engine Generated SSL Context");
+        }
         else
         {
-            if ((IsNullOrEmptyString(pRESTHandle->pRESTConfig->pszSSLCertificate)) || (IsNullOrEmptyString(pRESTHandle->pRESTConfig->pszSSLKey)))
+            if (((pSSLInfo->isCertSet != SSL_INFO_FROM_BUFFER_API) && IsNullOrEmptyString(pRESTHandle->pRESTConfig->pszSSLCertificate)) ||
+                ((pSSLInfo->isKeySet != SSL_INFO_FROM_BUFFER_API) && IsNullOrEmptyString(pRESTHandle->pRESTConfig->pszSSLKey)))
             {
                 VMREST_LOG_ERROR(pRESTHandle,"%s", "Invalid SSL params");
                 dwError =  REST_ERROR_INVALID_CONFIG;
@@ -183,22 +216,17 @@ VmSockPosixStartServer(
             if (gSSLisedInstaceCount == INVALID)
             {
                 SSL_library_init();
-                dwError = VmRESTSecureSocket(
-                              pRESTHandle,
-                              pRESTHandle->pRESTConfig->pszSSLCertificate,
-                              pRESTHandle->pRESTConfig->pszSSLKey
-                              );
+                dwError = VmRESTSSLThreadLockInit();
                 BAIL_ON_VMREST_ERROR(dwError);
 
                 gSSLisedInstaceCount = 0;
-                dwError = VmRESTSSLThreadLockInit();
-                BAIL_ON_VMREST_ERROR(dwError);
-                gpSSLCTX = pRESTHandle->pSSLInfo->sslContext;
-            }
-            else
-            {
-                pRESTHandle->pSSLInfo->sslContext = gpSSLCTX;
             }
+
+            dwError = VmRESTSecureSocketAcquireContext(
+                          pRESTHandle
+                          );
+            BAIL_ON_VMREST_ERROR(dwError);
+
             gSSLisedInstaceCount++;
             pthread_mutex_unlock(&gGlobalMutex);
             bLocked = FALSE;
@@ -213,64 +241,111 @@ VmSockPosixStartServer(
         pSSLInfo->isSecure = 0;
     }
 
-    fd = socket(socketParams.domain, socketParams.type, socketParams.protocol);
-    if (fd < 0)
+    /**** Listener handed over by previous process or by socket activation is already bound ****/
+    if (socketParams.type == SOCK_STREAM)
     {
-        VMREST_LOG_ERROR(pRESTHandle,"Socket call failed with Error code %d", errno);
-        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+        dwError = VmSockPosixAdoptListener(
+                      pRESTHandle,
+                      socketParams.domain,
+                      pszUnixPath,
+                      &fd
+                      );
+        BAIL_ON_VMREST_ERROR(dwError);
     }
-    BAIL_ON_VMREST_ERROR(dwError);
 
-    if (dwFlags & VM_SOCK_CREATE_FLAGS_REUSE_ADDR)
+    if (fd < 0)
     {
-        dwError = VmSockPosixSetReuseAddress(fd);
+        fd = socket(socketParams.domain, socketParams.type, socketParams.protocol);
+        if (fd < 0)
+        {
+            VMREST_LOG_ERROR(pRESTHandle,"Socket call failed with Error code %d", errno);
+            dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+        }
         BAIL_ON_VMREST_ERROR(dwError);
-    }
 
-    memset(&servaddr, 0, sizeof(servaddr));
+        if ((dwFlags & VM_SOCK_CREATE_FLAGS_REUSE_ADDR) && (socketParams.domain != AF_UNIX))
+        {
+            dwError = VmSockPosixSetReuseAddress(fd);
+            BAIL_ON_VMREST_ERROR(dwError);
+        }
 
-    if (dwFlags & VM_SOCK_CREATE_FLAGS_IPV6)
-    {
+        memset(&servaddr, 0, sizeof(servaddr));
+
+        if (socketParams.domain == AF_UNIX)
+        {
+            dwError = VmSockPosixGetUnixListenerAddress(
+                          pszUnixPath,
+                          &servaddr.servaddr_unix,
+                          &addrLen
+                          );
+            BAIL_ON_VMREST_ERROR(dwError);
+
+            pSockAddr = (struct sockaddr*) &servaddr.servaddr_unix;
+
+            if (pszUnixPath[0] != '@')
+            {
+                dwError = VmSockPosixRemoveStaleUnixSocket(pRESTHandle, pszUnixPath);
+                BAIL_ON_VMREST_ERROR(dwError);
+            }
+        }
+        else if (dwFlags & VM_SOCK_CREATE_FLAGS_IPV6)
+        {
 #ifdef AF_INET6
-        servaddr.servaddr_ipv6.sin6_family = AF_INET6;
-        servaddr.servaddr_ipv6.sin6_addr = in6addr_any;
-        servaddr.servaddr_ipv6.sin6_port = htons((unsigned short)pRESTHandle->pRESTConfig->serverPort);
+            servaddr.servaddr_ipv6.sin6_family = AF_INET6;
+            servaddr.servaddr_ipv6.sin6_addr = in6addr_any;
+            servaddr.servaddr_ipv6.sin6_port = htons((unsigned short)pRESTHandle->pRESTConfig->serverPort);
 
-        pSockAddr = (struct sockaddr*) &servaddr.servaddr_ipv6;
-        addrLen = sizeof(servaddr.servaddr_ipv6);
+            pSockAddr = (struct sockaddr*) &servaddr.servaddr_ipv6;
+            addrLen = sizeof(servaddr.servaddr_ipv6);
 
 #if defined(SOL_IPV6) && defined(IPV6_V6ONLY)
-        int one = 1;
-        int ret = 0;
-        ret = setsockopt(fd, SOL_IPV6, IPV6_V6ONLY, (void *) &one, sizeof(one));
-        if (ret != 0)
-        {
+            int one = 1;
+            int ret = 0;
+            ret = setsockopt(fd, SOL_IPV6, IPV6_V6ONLY, (void *) &one, sizeof(one));
+            if (ret != 0)
+            {
+                dwError = ERROR_NOT_SUPPORTED;
+                BAIL_ON_VMREST_ERROR(dwError);
+            }
+#endif
+
+#else
             dwError = ERROR_NOT_SUPPORTED;
             BAIL_ON_VMREST_ERROR(dwError);
-        }
 #endif
+        }
+        else
+        {
+            servaddr.servaddr_ipv4.sin_family = AF_INET;
+            servaddr.servaddr_ipv4.sin_addr.s_addr = htonl(INADDR_ANY);
+            servaddr.servaddr_ipv4.sin_port = htons((unsigned short)pRESTHandle->pRESTConfig->serverPort);
 
-#else
-        dwError = ERROR_NOT_SUPPORTED;
+            pSockAddr = (struct sockaddr*) &servaddr.servaddr_ipv4;
+            addrLen = sizeof(servaddr.servaddr_ipv4);
+        }
+
+        if (bind(fd, pSockAddr, addrLen) < 0)
+        {
+            VMREST_LOG_ERROR(pRESTHandle,"bind() call failed with Error code %d", errno);
+            dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+        }
         BAIL_ON_VMREST_ERROR(dwError);
-#endif
-    }
-    else
-    {
-        servaddr.servaddr_ipv4.sin_family = AF_INET;
-        servaddr.servaddr_ipv4.sin_addr.s_addr = htonl(INADDR_ANY);
-        servaddr.servaddr_ipv4.sin_port = htons((unsigned short)pRESTHandle->pRESTConfig->serverPort);
 
-        pSockAddr = (struct sockaddr*) &servaddr.servaddr_ipv4;
-        addrLen = sizeof(servaddr.servaddr_ipv4);
-    }
+        /**** Abstract names have no file, access to them is not controlled by mode ****/
+        if ((socketParams.domain == AF_UNIX) && (pszUnixPath[0] != '@'))
+        {
+            bUnlinkPath = TRUE;
 
-    if (bind(fd, pSockAddr, addrLen) < 0)
-    {
-        VMREST_LOG_ERROR(pRESTHandle,"bind() call failed with Error code %d", errno);
-        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+            /**** Not yet listening, nobody can connect before mode is applied ****/
+            if (pRESTHandle->pRESTConfig->unixSocketMode &&
+                (chmod(pszUnixPath, (mode_t)pRESTHandle->pRESTConfig->unixSocketMode) < 0))
+            {
+                VMREST_LOG_ERROR(pRESTHandle,"chmod() on %s failed with Error code %d", pszUnixPath, errno);
+                dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+            }
+            BAIL_ON_VMREST_ERROR(dwError);
+        }
     }
-    BAIL_ON_VMREST_ERROR(dwError);
 
     if (dwFlags & VM_SOCK_CREATE_FLAGS_NON_BLOCK)
     {
@@ -289,11 +364,12 @@ VmSockPosixStartServer(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(*pSocket),
-                  (PVOID*)&pSocket
+                  (PVOID*)&pSocket,
+                  REST_MEM_SOCKET
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
-    dwError = VmRESTAllocateMutex(&pSocket->pMutex);
+    dwError = VmRESTAllocateNamedMutex(&pSocket->pMutex, "socket");
     BAIL_ON_VMREST_ERROR(dwError);
 
     pSocket->type = VM_SOCK_TYPE_LISTENER;
@@ -301,6 +377,10 @@ VmSockPosixStartServer(
     pSocket->ssl = NULL;
     pSocket->pTimerSocket = NULL;
     pSocket->pIoSocket = NULL;
+    pSocket->pRESTHandle = pRESTHandle;
+    pSocket->bUnlinkPath = bUnlinkPath;
+    pSocket->bShmListener = (dwFlags & VM_SOCK_CREATE_FLAGS_SHM) ? TRUE : FALSE;
+    bUnlinkPath = FALSE;
 
     *ppSocket = pSocket;
 
@@ -329,6 +409,10 @@ error:
     {
         close(fd);
     }
+    if (bUnlinkPath)
+    {
+        unlink(pszUnixPath);
+    }
 
     goto cleanup;
 }
@@ -352,7 +436,8 @@ VmSockPosixCreateEventQueue(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(*pQueue),
-                  (PVOID*)&pQueue
+                  (PVOID*)&pQueue,
+                  REST_MEM_SOCKET
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -362,12 +447,19 @@ VmSockPosixCreateEventQueue(
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
-    dwError = VmRESTAllocateMutex(&pQueue->pMutex);
+    dwError = VmRESTAllocateNamedMutex(&pQueue->pMutex, "event_queue");
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmSockPosixCreateConnTable(
+                  pRESTHandle,
+                  &pQueue->pConnTable
+                  );
     BAIL_ON_VMREST_ERROR(dwError);
 
     dwError = VmRESTAllocateMemory(
                   iEventQueueSize * sizeof(*pQueue->pEventArray),
-                  (PVOID*)&pQueue->pEventArray
+                  (PVOID*)&pQueue->pEventArray,
+                  REST_MEM_SOCKET
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -386,6 +478,7 @@ VmSockPosixCreateEventQueue(
     pQueue->iReady = 0;
     pQueue->bShutdown = 0;
     pQueue->thrCnt = pRESTHandle->pRESTConfig->nWorkerThr;
+    pQueue->pRESTHandle = pRESTHandle;
 
     dwError = VmSockPosixAddEventToQueue(
                   pQueue,
@@ -394,6 +487,12 @@ VmSockPosixCreateEventQueue(
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
+    dwError = VmSockPosixAttachEventQueue(
+                  pRESTHandle,
+                  pQueue
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
     *ppQueue = pQueue;
     pRESTHandle->pSSLInfo->bQueueInUse = TRUE;
 
@@ -435,10 +534,15 @@ VmSockPosixAddEventToQueueInLock(
         BAIL_ON_VMREST_ERROR(dwError);
     }
 
-    dwError = VmRESTLockMutex(pQueue->pMutex);
-    BAIL_ON_VMREST_ERROR(dwError);
+    /**** Queue of an engine group is already served when a member adds its listener,
+          a worker holds the lock in epoll_wait. epoll_ctl itself needs no lock. ****/
+    if (pSocket->pRESTHandle == pQueue->pRESTHandle)
+    {
+        dwError = VmRESTLockMutex(pQueue->pMutex);
+        BAIL_ON_VMREST_ERROR(dwError);
 
-    bLocked = TRUE;
+        bLocked = TRUE;
+    }
 
     dwError = VmSockPosixAddEventToQueue(
                   pQueue,
@@ -516,6 +620,9 @@ VmSockPosixWaitForEvent(
         BAIL_ON_VMREST_ERROR(dwError);
     }
 
+    /**** Worker is between connections, table may go away at shutdown ****/
+    VmRESTMemorySetConnection(NULL);
+
     dwError = VmRESTLockMutex(pQueue->pMutex);
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -573,6 +680,12 @@ VmSockPosixWaitForEvent(
                 BAIL_ON_VMREST_ERROR(dwError);
             }
 
+            /**** Queue may be shared by an engine group, work for the instance owning the socket ****/
+            if (pEventSocket->pRESTHandle)
+            {
+                pRESTHandle = pEventSocket->pRESTHandle;
+            }
+
             VMREST_LOG_DEBUG(pRESTHandle,"Notification on socket fd %d", pEventSocket->fd);
 
             if (pEvent->events & (EPOLLERR | EPOLLHUP))
@@ -582,17 +695,37 @@ VmSockPosixWaitForEvent(
             }
             else if (pEventSocket->type == VM_SOCK_TYPE_LISTENER)    // New connection request
             {
-                dwError = VmSockPosixAcceptConnection(
-                              pEventSocket,
-                              &pSocket);
+                if (pEventSocket->bShmListener)
+                {
+                    dwError = VmSockPosixAcceptShmChannel(
+                                  pRESTHandle,
+                                  pEventSocket,
+                                  &pSocket);
+                }
+                else
+                {
+                    dwError = VmSockPosixAcceptConnection(
+                                  pEventSocket,
+                                  &pSocket);
+                }
+                BAIL_ON_VMREST_ERROR(dwError);
+
+                pSocket->acceptNs = VmRESTMetricsNowNs();
+
+                dwError = VmSockPosixRegisterConnection(
+                              pQueue->pConnTable,
+                              pSocket,
+                              ((pRESTHandle->pSSLInfo->isSecure && !pSocket->pShm) ? VMREST_CONN_PHASE_HANDSHAKE : VMREST_CONN_PHASE_NEW)
+                              );
                 BAIL_ON_VMREST_ERROR(dwError);
                 VMREST_LOG_INFO(pRESTHandle,"C-REST-ENGINE: ( NEW REQUEST ) Accepted new connection with socket fd %d", pSocket->fd);
+                VmRESTMetricsAdd(pSocket->pRESTHandle->pMetrics, VMREST_METRIC_ACCEPTS, 1);
 
                 dwError = VmSockPosixSetNonBlocking(pRESTHandle,pSocket);
                 BAIL_ON_VMREST_ERROR(dwError);
 
-                /**** If conn is over SSL, do the needful ****/
-                if (pRESTHandle->pSSLInfo->isSecure)
+                /**** If conn is over SSL, do the needful. Shared memory channel never leaves host. ****/
+                if (pRESTHandle->pSSLInfo->isSecure && !pSocket->pShm)
                 {
                     dwError = VmRESTCreateSSLObject(
                                    pRESTHandle,
@@ -600,13 +733,17 @@ VmSockPosixWaitForEvent(
                                    );
                     BAIL_ON_VMREST_ERROR(dwError);
 
-                    /**** Try SSL Handshake ****/
-                    dwError  = VmRESTAcceptSSLContext(
-                                   pRESTHandle,
-                                   pSocket,
-                                   FALSE
-                                   );
-                    BAIL_ON_VMREST_ERROR(dwError);
+                    /**** Try SSL Handshake inline, with handshake pool it starts on first data from client ****/
+                    if (!pRESTHandle->pSockContext->pHandshakePool)
+                    {
+                        dwError  = VmRESTAcceptSSLContext(
+                                       pRESTHandle,
+                                       pSocket,
+                                       FALSE,
+                                       NULL
+                                       );
+                        BAIL_ON_VMREST_ERROR(dwError);
+                    }
                 }
 
                 /**** Start watching new connection ****/
@@ -643,8 +780,18 @@ VmSockPosixWaitForEvent(
                 }
                 else
                 {
-                    pSocket = pEventSocket;
-                    eventType = VM_SOCK_EVENT_TYPE_DATA_AVAILABLE;
+                    char szBuf[1] = {0};
+
+                    /**** Drain byte of stop or of a group member stop. Consume it,
+                          shutdown byte that follows must stay for all workers ****/
+                    read(pEventSocket->fd, szBuf, sizeof(szBuf));
+
+                    VmSockPosixExpireIdleConnections(
+                        pRESTHandle,
+                        pQueue
+                        );
+
+                    __sync_fetch_and_add(&pQueue->nDrainsHandled, 1);
                 }
             }
             else if (pEventSocket->type == VM_SOCK_TYPE_TIMER) // Time out event
@@ -669,9 +816,18 @@ VmSockPosixWaitForEvent(
                         VmSockPosixReleaseSocket(pRESTHandle,pSocket->pIoSocket);
                         pSocket = NULL;
                     }
+                    else if (VmSockPosixIsDraining(pRESTHandle) && !pSocket->pIoSocket->pRequest && (pSocket->pIoSocket->nBufData == 0))
+                    {
+                        /**** Stopping, connection has no request in progress, close it quietly ****/
+                        VMREST_LOG_DEBUG(pRESTHandle,"Closing idle connection fd %d for stop", pSocket->pIoSocket->fd);
+                        VmSockPosixCloseSocket(pRESTHandle,pSocket->pIoSocket);
+                        VmSockPosixReleaseSocket(pRESTHandle,pSocket->pIoSocket);
+                        pSocket = NULL;
+                    }
                     else
                     {
                         pSocket = pSocket->pIoSocket;
+                        VmSockPosixSetConnPhase(pRESTHandle, pSocket, VMREST_CONN_PHASE_CLOSING);
                         eventType = VM_SOCK_EVENT_TYPE_CONNECTION_TIMEOUT;
                     }
                 }
@@ -692,16 +848,30 @@ VmSockPosixWaitForEvent(
                  /**** If SSL handshake is not yet complete, do the needful ****/
                  if ((pRESTHandle->pSSLInfo->isSecure) && (!(pSocket->bSSLHandShakeCompleted)))
                  {
-                      dwError = VmRESTAcceptSSLContext(
-                                    pRESTHandle,
-                                    pSocket,
-                                    TRUE
-                                    );
-                      BAIL_ON_VMREST_ERROR(dwError); 
+                      if (pRESTHandle->pSockContext->pHandshakePool)
+                      {
+                          /**** Hand over to handshake pool of owning instance, it re-arms the socket when done ****/
+                          dwError = VmSockPosixQueueHandshake(
+                                        pRESTHandle->pSockContext->pHandshakePool,
+                                        pSocket
+                                        );
+                          BAIL_ON_VMREST_ERROR(dwError);
+                      }
+                      else
+                      {
+                          dwError = VmRESTAcceptSSLContext(
+                                        pRESTHandle,
+                                        pSocket,
+                                        TRUE,
+                                        NULL
+                                        );
+                          BAIL_ON_VMREST_ERROR(dwError);
+                      }
                       pSocket = NULL;
                  }
                  else
                  {
+                      VmSockPosixSetConnPhase(pRESTHandle, pSocket, VMREST_CONN_PHASE_ACTIVE);
                       eventType = VM_SOCK_EVENT_TYPE_DATA_AVAILABLE;
                  }
             }
@@ -709,6 +879,9 @@ VmSockPosixWaitForEvent(
         pQueue->iReady++;
     }
 
+    /**** Blocks the worker allocates for this event count to its connection ****/
+    VmSockPosixSetMemoryConnection(pRESTHandle, pSocket);
+
     *ppSocket = pSocket;
     *pEventType = eventType;
 
@@ -721,13 +894,27 @@ cleanup:
 
     if (dwError == ERROR_SHUTDOWN_IN_PROGRESS && bFreeEventQueue)
     {
+        /**** Handshake threads release sockets they hold, then close what is left in table ****/
+        if (pRESTHandle->pSockContext->pHandshakePool)
+        {
+            VmSockPosixFreeHandshakePool(pRESTHandle->pSockContext->pHandshakePool);
+            pRESTHandle->pSockContext->pHandshakePool = NULL;
+        }
+        VmSockPosixCloseAllConnections(pRESTHandle, pQueue->pConnTable);
+
         VmSockPosixFreeEventQueue(pQueue);
-        pRESTHandle->pSSLInfo->bQueueInUse = FALSE;
+        pRESTHandle->pSockContext->pEventQueue = NULL;
 
         if (pRESTHandle->pSSLInfo->isSecure == 1)
         {
             VmRESTSecureSocketShutdown(pRESTHandle);
         }
+
+        /**** Wake up stop ****/
+        VmRESTLockMutex(pRESTHandle->pSockContext->pMutex);
+        pRESTHandle->pSSLInfo->bQueueInUse = FALSE;
+        VmRESTConditionBroadcast(pRESTHandle->pSockContext->pStopCond);
+        VmRESTUnlockMutex(pRESTHandle->pSockContext->pMutex);
     }
 
     return dwError;
@@ -744,7 +931,7 @@ error:
     }
     else
     {
-        VMREST_LOG_ERROR(pRESTHandle,"Error while processing socket event, dwError = %u", dwError);
+        VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"Error while processing socket event, dwError = %u", dwError);
     }
     if (ppSocket)
     {
@@ -777,31 +964,62 @@ VmSockPosixCloseEventQueue(
     uint32_t                         waitSecond
     )
 {
- 
     DWORD                            dwError = REST_ENGINE_SUCCESS;
-    uint32_t                         retry = 0;
+    PVMREST_SOCK_CONTEXT             pSockContext = pRESTHandle->pSockContext;
+    uint64_t                         deadlineMs = VmSockPosixGetMonotonicMs() + ((uint64_t)waitSecond * 1000);
+    uint64_t                         nowMs = 0;
+    char                             szBuf[1] = {0};
 
-    if (pQueue)
+    if (!pQueue || !pQueue->pSignalWriter)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
+    /**** Listeners are gone. Let in-flight requests finish, idle connections are closed by workers.
+          Queue lock is held by a worker in epoll_wait, flag is picked up on the signal event. ****/
+    __atomic_store_n(&pQueue->bDraining, TRUE, __ATOMIC_RELEASE);
+
+    write(pQueue->pSignalWriter->fd, szBuf, sizeof(szBuf));
+
+    VmRESTLockMutex(pSockContext->pMutex);
+    while (VmSockPosixGetConnectionCount(pRESTHandle) > 0)
     {
-        if (pQueue->pSignalWriter)
+        nowMs = VmSockPosixGetMonotonicMs();
+        if (nowMs >= deadlineMs)
         {
-            char szBuf[] = {0};
-            pQueue->bShutdown = 1;
-            write(pQueue->pSignalWriter->fd, szBuf, sizeof(szBuf));
+            break;
         }
+        VmRESTConditionTimedWait(pSockContext->pStopCond, pSockContext->pMutex, (DWORD)(deadlineMs - nowMs));
     }
+    VmRESTUnlockMutex(pSockContext->pMutex);
 
-    /**** Worker threads are detached threads, give them some time for cleanup. Block upto 10 seconds *****/
+    if (VmSockPosixGetConnectionCount(pRESTHandle) > 0)
+    {
+        VMREST_LOG_WARNING(pRESTHandle,"C-REST-ENGINE: Stop deadline reached with %u connections still open", VmSockPosixGetConnectionCount(pRESTHandle));
+    }
+
+    /**** Now tell the workers to leave, last one frees the queue and closes what is left ****/
+    pQueue->bShutdown = 1;
+    write(pQueue->pSignalWriter->fd, szBuf, sizeof(szBuf));
+
+    nowMs = VmSockPosixGetMonotonicMs();
+    if (deadlineMs < nowMs + VM_SOCK_POSIX_STOP_MIN_WAIT_MS)
+    {
+        deadlineMs = nowMs + VM_SOCK_POSIX_STOP_MIN_WAIT_MS;
+    }
 
-    while(retry <= waitSecond)
+    VmRESTLockMutex(pSockContext->pMutex);
+    while (pRESTHandle->pSSLInfo->bQueueInUse)
     {
-        if (pRESTHandle->pSSLInfo->bQueueInUse == FALSE)
+        nowMs = VmSockPosixGetMonotonicMs();
+        if (nowMs >= deadlineMs)
         {
-           break;
+            break;
         }
-        sleep(1);
-        retry++;
+        VmRESTConditionTimedWait(pSockContext->pStopCond, pSockContext->pMutex, (DWORD)(deadlineMs - nowMs));
     }
+    VmRESTUnlockMutex(pSockContext->pMutex);
 
     if (pRESTHandle->pSSLInfo->bQueueInUse == TRUE)
     {
@@ -809,7 +1027,149 @@ VmSockPosixCloseEventQueue(
         dwError = REST_ENGINE_FAILURE;
     }
 
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+/**** Every instance serving on queue, owner or group member, runs its own handshake threads.
+      They use SSL context of that instance. ****/
+DWORD
+VmSockPosixAttachEventQueue(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_EVENT_QUEUE             pQueue
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRESTHandle || !pRESTHandle->pSockContext || !pQueue)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
+    if (pRESTHandle->pSSLInfo->isSecure && (pRESTHandle->pRESTConfig->nHandshakeThr > 0) &&
+        !pRESTHandle->pSockContext->pHandshakePool)
+    {
+        dwError = VmSockPosixCreateHandshakePool(
+                      pRESTHandle,
+                      &pRESTHandle->pSockContext->pHandshakePool
+                      );
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+/**** Until deadline, for connections of this instance to go and for a worker to take its drain byte.
+      After that no event of its removed listeners is left in a worker's batch. ****/
+static
+BOOLEAN
+VmSockPosixWaitForDetach(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_EVENT_QUEUE             pQueue,
+    uint32_t                         drainSeq,
+    uint64_t                         deadlineMs
+    )
+{
+    PVMREST_SOCK_CONTEXT             pSockContext = pRESTHandle->pSockContext;
+    uint64_t                         nowMs = 0;
+    uint64_t                         waitMs = 0;
+    BOOLEAN                          bDone = FALSE;
+
+    VmRESTLockMutex(pSockContext->pMutex);
+    for (;;)
+    {
+        bDone = (VmSockPosixGetConnectionCount(pRESTHandle) == 0) &&
+                (__atomic_load_n(&pQueue->nDrainsHandled, __ATOMIC_ACQUIRE) >= drainSeq);
+
+        nowMs = VmSockPosixGetMonotonicMs();
+        if (bDone || (nowMs >= deadlineMs))
+        {
+            break;
+        }
+
+        /**** Nobody signals drain byte taken, poll for it once connections are gone ****/
+        waitMs = deadlineMs - nowMs;
+        if ((VmSockPosixGetConnectionCount(pRESTHandle) == 0) && (waitMs > VM_SOCK_POSIX_DETACH_POLL_MS))
+        {
+            waitMs = VM_SOCK_POSIX_DETACH_POLL_MS;
+        }
+        VmRESTConditionTimedWait(pSockContext->pStopCond, pSockContext->pMutex, (DWORD)waitMs);
+    }
+    VmRESTUnlockMutex(pSockContext->pMutex);
+
+    return bDone;
+}
+
+DWORD
+VmSockPosixDetachEventQueue(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_EVENT_QUEUE             pQueue,
+    uint32_t                         waitSecond
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    uint64_t                         deadlineMs = VmSockPosixGetMonotonicMs() + ((uint64_t)waitSecond * 1000);
+    uint32_t                         drainSeq = 0;
+    char                             szBuf[1] = {0};
+
+    if (!pRESTHandle || !pRESTHandle->pSockContext || !pQueue || !pQueue->pSignalWriter)
+    {
+        dwError = ERROR_INVALID_PARAMETER;
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
+    /**** Listeners of this member are gone. Same drain as stop, limited to its own connections,
+          other members and the workers carry on. ****/
+    __atomic_store_n(&pRESTHandle->pSockContext->bDraining, TRUE, __ATOMIC_RELEASE);
+    drainSeq = __sync_add_and_fetch(&pQueue->nDrainSignals, 1);
+
+    write(pQueue->pSignalWriter->fd, szBuf, sizeof(szBuf));
+
+    if (!VmSockPosixWaitForDetach(pRESTHandle, pQueue, drainSeq, deadlineMs))
+    {
+        VMREST_LOG_WARNING(pRESTHandle,"C-REST-ENGINE: Stop deadline reached with %u connections still open", VmSockPosixGetConnectionCount(pRESTHandle));
+
+        VmSockPosixShutdownConnections(pRESTHandle, pQueue->pConnTable);
+
+        if (!VmSockPosixWaitForDetach(pRESTHandle, pQueue, drainSeq, VmSockPosixGetMonotonicMs() + VM_SOCK_POSIX_STOP_MIN_WAIT_MS))
+        {
+            /**** This is not a clean stop, instance must not be shut down ****/
+            dwError = REST_ENGINE_FAILURE;
+            BAIL_ON_VMREST_ERROR(dwError);
+        }
+    }
+
+    /**** Connections are gone, handshake threads are idle ****/
+    if (pRESTHandle->pSockContext->pHandshakePool)
+    {
+        VmSockPosixFreeHandshakePool(pRESTHandle->pSockContext->pHandshakePool);
+        pRESTHandle->pSockContext->pHandshakePool = NULL;
+    }
+
+    if (pRESTHandle->pSSLInfo->isSecure == 1)
+    {
+        VmRESTSecureSocketShutdown(pRESTHandle);
+    }
+
+cleanup:
+
     return dwError;
+
+error:
+
+    goto cleanup;
 }
 
 DWORD
@@ -858,6 +1218,7 @@ VmSockPosixRead(
     uint32_t                         errorCode = 0;
     char*                            pszBufPrev = NULL;
     uint32_t                         nPrevBuf = 0;
+    uint32_t                         nReadTotal = 0;
 
     if (!pSocket || !ppszBuffer || !nBufLen || !pRESTHandle)
     {
@@ -878,15 +1239,16 @@ VmSockPosixRead(
 
         if (nPrevBuf > 0)
         {
-            dwError = VmRESTAllocateMemory(
+            dwError = VmRESTAllocateMemoryNoZero(
                           nPrevBuf,
-                          (void **)&pszBufPrev
+                          (void **)&pszBufPrev,
+                          REST_MEM_SOCKET
                           );
             BAIL_ON_VMREST_ERROR(dwError);
 
             memcpy(pszBufPrev, (pSocket->pszBuffer + pSocket->nProcessed), nPrevBuf);
         }
-        VmRESTFreeMemory(pSocket->pszBuffer);
+        VmRESTFreeMemory(pSocket->pszBuffer, REST_MEM_SOCKET);
         pSocket->pszBuffer = NULL;
         pSocket->nBufData = 0;
         pSocket->nProcessed = 0;
@@ -895,7 +1257,8 @@ VmSockPosixRead(
     dwError = VmRESTReallocateMemory(
                   (void*)pszBufPrev,
                   (void **)&pszBufPrev,
-                  (nPrevBuf + MAX_DATA_BUFFER_LEN)
+                  (nPrevBuf + MAX_DATA_BUFFER_LEN),
+                  REST_MEM_SOCKET
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -911,6 +1274,11 @@ VmSockPosixRead(
             nRead = SSL_read(pSocket->ssl, (pszBufPrev + nPrevBuf), MAX_DATA_BUFFER_LEN);
             errorCode = SSL_get_error(pSocket->ssl, nRead);
         }
+        else if (pSocket->pShm)
+        {
+            nRead = VmSockPosixShmRead(pSocket, (pszBufPrev + nPrevBuf), MAX_DATA_BUFFER_LEN);
+            errorCode = errno;
+        }
         else if (pSocket->fd > 0)
         {
             nRead = read(pSocket->fd, (void*)(pszBufPrev + nPrevBuf), MAX_DATA_BUFFER_LEN);
@@ -920,20 +1288,24 @@ VmSockPosixRead(
         if (nRead > 0)
         {
             nPrevBuf += nRead;
+            nReadTotal += nRead;
             dwError = VmRESTReallocateMemory(
                   (void*)pszBufPrev,
                   (void **)&pszBufPrev,
-                  (nPrevBuf + MAX_DATA_BUFFER_LEN)
+                  (nPrevBuf + MAX_DATA_BUFFER_LEN),
+                  REST_MEM_SOCKET
                   );
             BAIL_ON_VMREST_ERROR(dwError);
             memset((pszBufPrev + nPrevBuf), '\0', MAX_DATA_BUFFER_LEN);
         }
     }while((nRead > 0) && (nPrevBuf < pRESTHandle->pRESTConfig->maxDataPerConnMB));
 
+    VmSockPosixAddConnBytes(pRESTHandle, pSocket, nReadTotal, 0);
+
     if (nPrevBuf >= pRESTHandle->pRESTConfig->maxDataPerConnMB)
     {
         /**** Discard the request here itself. This might be the first read IO cycle ****/
-        VMREST_LOG_ERROR(pRESTHandle,"Total Data in request %u bytes is over allowed limit of %u bytes, closing connection with fd %d", nPrevBuf, pRESTHandle->pRESTConfig->maxDataPerConnMB, pSocket->fd);
+        VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"Total Data in request %u bytes is over allowed limit of %u bytes, closing connection with fd %d", nPrevBuf, pRESTHandle->pRESTConfig->maxDataPerConnMB, pSocket->fd);
         dwError = VMREST_TRANSPORT_SOCK_DATA_OVER_LIMIT;
     }
     BAIL_ON_VMREST_ERROR(dwError);
@@ -948,7 +1320,7 @@ VmSockPosixRead(
         }
         else
         {
-            VMREST_LOG_ERROR(pRESTHandle,"Socket read error: errno %u, errorCode %u, nRead %d", errno, errorCode, nRead);
+            VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"Socket read error: errno %u, errorCode %u, nRead %d", errno, errorCode, nRead);
             dwError = VMREST_TRANSPORT_SOCK_READ_FAILED;
         }
     }
@@ -956,12 +1328,12 @@ VmSockPosixRead(
     {
         if (nRead == 0)
         {
-            VMREST_LOG_ERROR(pRESTHandle,"%s","Socket Read Failed: Remote has closed the connection");
+            VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"%s","Socket Read Failed: Remote has closed the connection");
             dwError = VMREST_TRANSPORT_SOCK_READ_FAILED;
         }
         else
         {
-            VMREST_LOG_ERROR(pRESTHandle, "Socket read failed with error code %u", errorCode);
+            VMREST_LOG_ERROR_RATELIMITED(pRESTHandle, "Socket read failed with error code %u", errorCode);
             dwError = VMREST_TRANSPORT_SOCK_READ_FAILED;
         }
     }
@@ -996,7 +1368,7 @@ error:
 
     if (pszBufPrev)
     {   
-        VmRESTFreeMemory(pszBufPrev);
+        VmRESTFreeMemory(pszBufPrev, REST_MEM_SOCKET);
         pszBufPrev = NULL;
     }
 
@@ -1023,14 +1395,15 @@ VmSockPosixWrite(
 {
     DWORD                            dwError = REST_ENGINE_SUCCESS;
     BOOLEAN                          bLocked  = FALSE;
+    BOOLEAN                          bSecure = FALSE;
     ssize_t                          nWritten = 0;
     uint32_t                         nRemaining = 0;
     uint32_t                         nWrittenTotal = 0;
-    uint32_t                         errorCode = 0;
-    uint32_t                         cntRty = 0;
-    int                              maxTry = 1000;
-    uint32_t                         timerMs = 1;
-    int                              timeOutSec = 5;
+    uint32_t                         nRecord = 0;
+    uint64_t                         nowMs = 0;
+    int                              sslError = 0;
+    int                              sysError = 0;
+    VM_SOCK_WRITE_RETRY              retry = {0};
 
     if (!pRESTHandle || !pSocket || !pszBuffer)
     {
@@ -1040,104 +1413,394 @@ VmSockPosixWrite(
     BAIL_ON_VMREST_ERROR(dwError);
 
     nRemaining = nBufLen;
+    VmSockPosixWriteRetryReset(&retry);
 
     dwError = VmRESTLockMutex(pSocket->pMutex);
     BAIL_ON_VMREST_ERROR(dwError);
 
     bLocked = TRUE;
 
+    bSecure = (pRESTHandle->pSSLInfo->isSecure && (pSocket->ssl != NULL));
+    if (bSecure)
+    {
+        /**** Connection idle for long, congestion window is small again, restart with small records ****/
+        nowMs = VmSockPosixGetMonotonicMs();
+        if ((nowMs - pSocket->lastTLSWriteMs) > pRESTHandle->pRESTConfig->nTLSRecordIdleMs)
+        {
+            pSocket->nTLSBytesSent = 0;
+        }
+    }
+
     while(nWrittenTotal < nBufLen )
     {
          nWritten = 0;
-         errorCode = 0;
+         sslError = 0;
+         sysError = 0;
          errno = 0;
-         if (pRESTHandle->pSSLInfo->isSecure && (pSocket->ssl != NULL))
+         if (bSecure)
          {
-             nWritten = SSL_write(pSocket->ssl,(pszBuffer + nWrittenTotal),nRemaining);
-             errorCode = SSL_get_error(pSocket->ssl, nWritten);
+             /**** Record size depends only on bytes already sent, retry after WANT_WRITE uses same length ****/
+             nRecord = VmSockPosixTLSRecordSize(pRESTHandle, pSocket, nRemaining);
+             nWritten = SSL_write(pSocket->ssl,(pszBuffer + nWrittenTotal),nRecord);
+             sslError = SSL_get_error(pSocket->ssl, nWritten);
+             sysError = errno;
+             if (nWritten > 0)
+             {
+                 pSocket->nTLSBytesSent += nWritten;
+             }
+         }
+         else if (pSocket->pShm)
+         {
+             nWritten = VmSockPosixShmWrite(pSocket, (pszBuffer + nWrittenTotal), nRemaining);
+             sysError = errno;
+         }
+         else if (pSocket->pSink)
+         {
+             /**** Sink takes everything or fails, nothing to retry ****/
+             nWritten = -1;
+             sysError = EPIPE;
+             if (!pSocket->pSink->pfnWrite(pSocket->pSink->pContext, (pszBuffer + nWrittenTotal), nRemaining))
+             {
+                 nWritten = nRemaining;
+                 sysError = 0;
+             }
          }
          else if (pSocket->fd > 0)
          {
              nWritten = write(pSocket->fd, (pszBuffer + nWrittenTotal) ,nRemaining);
-             errorCode = errno;
+             sysError = errno;
          }
+
+         dwError = VmSockPosixWriteRetry(pRESTHandle, &retry, "write", nWritten, sslError, sysError);
+         BAIL_ON_VMREST_ERROR(dwError);
+
          if (nWritten > 0)
          {
              nWrittenTotal += nWritten;
              nRemaining -= nWritten;
              VMREST_LOG_DEBUG(pRESTHandle,"\nBytes written this write %d, Total bytes written %u", nWritten, nWrittenTotal);
-             nWritten = 0;
-             /**** reset to original values ****/
-             maxTry = 1000;
-             timerMs = 1;
-             timeOutSec = 5;
          }
-         else
-         {
-             if ((nWritten < 0) && (errorCode == EAGAIN || errorCode == EWOULDBLOCK || errorCode == SSL_ERROR_WANT_WRITE))
-             {
-                 if (timeOutSec >= 0)
-                 {
-                     cntRty++;
-                     usleep((timerMs * 1000));
-                     if (cntRty >= maxTry)
-                     {
-                         timerMs = ((timerMs >= 1000) ? 1000 : (timerMs*10));
-                         maxTry = ((maxTry <= 1) ? 1 : (maxTry/10));
-                         timeOutSec--;
-                         cntRty = 0;
-                     }
-                     VMREST_LOG_DEBUG(pRESTHandle,"retry write");
-                     nWritten = 0;
-                     continue;
-                 }
-                 else
-                 {
-                     VMREST_LOG_ERROR(pRESTHandle,"%s", "Exhausted maximum time to write data");
-                     dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
-                     BAIL_ON_VMREST_ERROR(dwError);
-                 }
-             }
-             else
-             {
-                 dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
-                 VMREST_LOG_ERROR(pRESTHandle,"Socket write failed with error code %u, dwError %u, nWritten %d", errorCode, dwError, nWritten);
-                 BAIL_ON_VMREST_ERROR(dwError);
-             }
-        }
     }
     VMREST_LOG_DEBUG(pRESTHandle,"\nWrite Status on Socket with fd = %d\nRequested: %d nBufLen\nWritten %d bytes\n", pSocket->fd, nBufLen, nWrittenTotal);
 
-cleanup:
+    if (bSecure)
+    {
+        pSocket->lastTLSWriteMs = VmSockPosixGetMonotonicMs();
+    }
+
+cleanup:
+
+    if (nWrittenTotal > 0)
+    {
+        VmSockPosixAddConnBytes(pRESTHandle, pSocket, 0, nWrittenTotal);
+    }
+
+    if (bLocked)
+    {
+        VmRESTUnlockMutex(pSocket->pMutex);
+    }
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+
+}
+
+DWORD
+VmSockPosixSendFile(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    int                              fd,
+    uint64_t                         offset,
+    uint32_t                         nBytes
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    BOOLEAN                          bLocked  = FALSE;
+    BOOLEAN                          bSecure = FALSE;
+    off_t                            fileOffset = 0;
+    ssize_t                          nSent = 0;
+    ssize_t                          nRead = 0;
+    uint32_t                         nChunk = 0;
+    uint32_t                         nSentTotal = 0;
+    int                              sslError = 0;
+    int                              sysError = 0;
+    VM_SOCK_WRITE_RETRY              retry = {0};
+    char*                            pszBuffer = NULL;
+
+    if (!pRESTHandle || !pSocket || (fd < 0))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"Invalid params");
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    fileOffset = (off_t)offset;
+    bSecure = (pRESTHandle->pSSLInfo->isSecure && (pSocket->ssl != NULL));
+
+    if ((bSecure && !pSocket->bKTLSSend) || pSocket->pShm || pSocket->pSink)
+    {
+        /**** Record layer, shared memory ring or loopback sink is in user space, no sendfile possible. Read file in chunks and write ****/
+        dwError = VmRESTGetIOBuffer(
+                      pRESTHandle->pIOBufPool,
+                      VM_SOCK_POSIX_SENDFILE_CHUNK_SIZE,
+                      (void**)&pszBuffer
+                      );
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        while (nSentTotal < nBytes)
+        {
+            nChunk = nBytes - nSentTotal;
+            if (nChunk > VM_SOCK_POSIX_SENDFILE_CHUNK_SIZE)
+            {
+                nChunk = VM_SOCK_POSIX_SENDFILE_CHUNK_SIZE;
+            }
+
+            nRead = pread(fd, pszBuffer, nChunk, fileOffset);
+            if (nRead <= 0)
+            {
+                VMREST_LOG_ERROR(pRESTHandle,"Reading file fd %d at offset %lld failed, errno %d", fd, (long long)fileOffset, errno);
+                dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+            }
+            BAIL_ON_VMREST_ERROR(dwError);
+
+            dwError = VmSockPosixWrite(
+                          pRESTHandle,
+                          pSocket,
+                          pszBuffer,
+                          (uint32_t)nRead
+                          );
+            BAIL_ON_VMREST_ERROR(dwError);
+
+            fileOffset += nRead;
+            nSentTotal += (uint32_t)nRead;
+        }
+    }
+    else
+    {
+        dwError = VmRESTLockMutex(pSocket->pMutex);
+        BAIL_ON_VMREST_ERROR(dwError);
+
+        bLocked = TRUE;
+
+        VmSockPosixWriteRetryReset(&retry);
+
+        while (nSentTotal < nBytes)
+        {
+            nSent = 0;
+            sslError = 0;
+            sysError = 0;
+            errno = 0;
+            if (bSecure)
+            {
+#ifdef SSL_OP_ENABLE_KTLS
+                nSent = SSL_sendfile(pSocket->ssl, fd, fileOffset, (nBytes - nSentTotal), 0);
+                sslError = SSL_get_error(pSocket->ssl, nSent);
+                sysError = errno;
+                if (nSent > 0)
+                {
+                    fileOffset += nSent;
+                }
+#endif
+            }
+            else if (pSocket->fd > 0)
+            {
+                /**** sendfile advances fileOffset ****/
+                nSent = sendfile(pSocket->fd, fd, &fileOffset, (nBytes - nSentTotal));
+                sysError = errno;
+            }
+
+            /**** Zero byte send means file is shorter than requested ****/
+            dwError = VmSockPosixWriteRetry(pRESTHandle, &retry, "sendfile", nSent, sslError, sysError);
+            BAIL_ON_VMREST_ERROR(dwError);
+
+            if (nSent > 0)
+            {
+                nSentTotal += nSent;
+                VMREST_LOG_DEBUG(pRESTHandle,"Bytes sent from file this call %d, Total bytes sent %u", nSent, nSentTotal);
+            }
+        }
+    }
+    VMREST_LOG_DEBUG(pRESTHandle,"Sendfile Status on Socket with fd = %d, Requested: %u, Sent %u bytes", pSocket->fd, nBytes, nSentTotal);
+
+cleanup:
+
+    if (bLocked)
+    {
+        /**** Bounce buffer path is counted by VmSockPosixWrite ****/
+        VmSockPosixAddConnBytes(pRESTHandle, pSocket, 0, nSentTotal);
+        VmRESTUnlockMutex(pSocket->pMutex);
+    }
+
+    if (pszBuffer)
+    {
+        VmRESTReleaseIOBuffer(pRESTHandle->pIOBufPool, pszBuffer);
+        pszBuffer = NULL;
+    }
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+
+}
+
+/**** Restarts backoff, also after every write which made progress ****/
+static
+VOID
+VmSockPosixWriteRetryReset(
+    PVM_SOCK_WRITE_RETRY             pRetry
+    )
+{
+    pRetry->cntRty = 0;
+    pRetry->maxTry = VM_SOCK_POSIX_WRITE_RETRY_TRIES;
+    pRetry->timerMs = 1;
+    pRetry->timeOutSec = VM_SOCK_POSIX_WRITE_RETRY_SEC;
+}
+
+/**** Called with socket lock held after each write or sendfile attempt. sslError
+      is SSL_get_error() of a TLS write and 0 otherwise, sysError is errno. Waits
+      and returns success when attempt would have blocked and time is left. ****/
+static
+DWORD
+VmSockPosixWriteRetry(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCK_WRITE_RETRY             pRetry,
+    const char*                      pszOp,
+    ssize_t                          nWritten,
+    int                              sslError,
+    int                              sysError
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    BOOLEAN                          bWouldBlock = FALSE;
+
+    if (nWritten > 0)
+    {
+        VmSockPosixWriteRetryReset(pRetry);
+        goto cleanup;
+    }
+
+    if (nWritten < 0)
+    {
+        bWouldBlock = sslError ? (sslError == SSL_ERROR_WANT_WRITE) :
+                                 ((sysError == EAGAIN) || (sysError == EWOULDBLOCK));
+    }
+
+    if (!bWouldBlock)
+    {
+        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+        VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"Socket %s failed with SSL error %d, errno %d, dwError %u, nWritten %d", pszOp, sslError, sysError, dwError, (int)nWritten);
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
+    if (pRetry->timeOutSec < 0)
+    {
+        VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"Exhausted maximum time to %s data", pszOp);
+        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+        BAIL_ON_VMREST_ERROR(dwError);
+    }
+
+    pRetry->cntRty++;
+    usleep((pRetry->timerMs * 1000));
+    if (pRetry->cntRty >= (uint32_t)pRetry->maxTry)
+    {
+        pRetry->timerMs = ((pRetry->timerMs >= 1000) ? 1000 : (pRetry->timerMs*10));
+        pRetry->maxTry = ((pRetry->maxTry <= 1) ? 1 : (pRetry->maxTry/10));
+        pRetry->timeOutSec--;
+        pRetry->cntRty = 0;
+    }
+    VMREST_LOG_DEBUG(pRESTHandle,"retry %s", pszOp);
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+VOID
+VmSockPosixReleaseSocket(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket
+    )
+{
+    if (pSocket)
+    {
+        if (pSocket->pTimerSocket)
+        {
+            VmSockPosixFreeSocket(pSocket->pTimerSocket);
+            pSocket->pTimerSocket = NULL;
+        }
+        /**** Normally done by close, covers sockets released without close. Count
+              drops only when socket is found in connection table. ****/
+        if (pSocket->type == VM_SOCK_TYPE_SERVER)
+        {
+            VmSockPosixUnregisterConnection(pRESTHandle, pSocket);
+        }
+        VmSockPosixFreeSocket(pSocket);
+    }
+}
+
+DWORD
+VmSockPosixCreateLoopback(
+    PVMREST_HANDLE                   pRESTHandle,
+    PREST_RESPONSE_SINK              pSink,
+    PVM_SOCKET*                      ppSocket
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    PVM_SOCKET                       pSocket = NULL;
+
+    if (!pRESTHandle || !pSink || !pSink->pfnWrite || !ppSocket)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTAllocateMemory(
+                  sizeof(*pSocket),
+                  (PVOID*)&pSocket,
+                  REST_MEM_SOCKET
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
 
-    if (bLocked)
-    {
-        VmRESTUnlockMutex(pSocket->pMutex);
-    }
+    dwError = VmRESTAllocateNamedMutex(&pSocket->pMutex, "socket");
+    BAIL_ON_VMREST_ERROR(dwError);
 
-    return dwError;
+    /**** No descriptor, never added to event queue or connection table ****/
+    pSocket->type = VM_SOCK_TYPE_LOOPBACK;
+    pSocket->fd = -1;
+    pSocket->ssl = NULL;
+    pSocket->bSSLHandShakeCompleted = TRUE;
+    pSocket->pRESTHandle = pRESTHandle;
+    pSocket->pSink = pSink;
+    pSocket->acceptNs = VmRESTMetricsNowNs();
 
-error:
+    *ppSocket = pSocket;
 
-    goto cleanup;
+cleanup:
 
-}
+    return dwError;
 
-VOID
-VmSockPosixReleaseSocket(
-    PVMREST_HANDLE                   pRESTHandle,
-    PVM_SOCKET                       pSocket
-    )
-{
+error:
+
+    if (ppSocket)
+    {
+        *ppSocket = NULL;
+    }
     if (pSocket)
     {
-        if (pSocket->pTimerSocket)
-        {
-            VmSockPosixFreeSocket(pSocket->pTimerSocket);
-            pSocket->pTimerSocket = NULL;
-        }
         VmSockPosixFreeSocket(pSocket);
     }
+
+    goto cleanup;
 }
 
 DWORD
@@ -1150,7 +1813,6 @@ VmSockPosixCloseSocket(
     int                              ret = 0;
     uint32_t                         errorCode = 0;
     BOOLEAN                          bLockedIO = FALSE;
-    BOOLEAN                          bLockedTimer = FALSE;
     PVM_SOCKET                       pTimerSocket = NULL;
 
     if (!pRESTHandle || !pSocket || !(pRESTHandle->pSockContext))
@@ -1162,14 +1824,20 @@ VmSockPosixCloseSocket(
 
     pTimerSocket = pSocket->pTimerSocket;
 
-    /**** Close the timer socket ****/
-    if (pTimerSocket)
-    {
-        dwError = VmRESTLockMutex(pTimerSocket->pMutex);
-        BAIL_ON_VMREST_ERROR(dwError);
+    dwError = VmRESTLockMutex(pSocket->pMutex);
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    bLockedIO = TRUE;
 
-        bLockedTimer = TRUE;
+    /**** Leave connection table while fd and timer are still ours, fd can be reused once closed ****/
+    if (pSocket->type == VM_SOCK_TYPE_SERVER)
+    {
+        VmSockPosixUnregisterConnection(pRESTHandle, pSocket);
+    }
 
+    /**** Close the timer socket, a concurrent re-arm sees fd gone under timer lock ****/
+    if (pTimerSocket)
+    {
         dwError = VmSockPosixDeleteEventFromQueue(
                       pRESTHandle,
                       pRESTHandle->pSockContext->pEventQueue,
@@ -1177,20 +1845,15 @@ VmSockPosixCloseSocket(
                       );
         BAIL_ON_VMREST_ERROR(dwError);
 
+        VmRESTLockMutex(pTimerSocket->pMutex);
         if (pTimerSocket->fd > 0)
         {
             close(pTimerSocket->fd);
             pTimerSocket->fd = INVALID;
         }
         VmRESTUnlockMutex(pTimerSocket->pMutex);
-        bLockedTimer = FALSE;
     }
 
-    dwError = VmRESTLockMutex(pSocket->pMutex);
-    BAIL_ON_VMREST_ERROR(dwError);
-
-    bLockedIO = TRUE;
-
     /**** Delete from queue if this is NOT timeout ****/
     if ((pSocket->type == VM_SOCK_TYPE_SERVER) && (!(pSocket->bTimerExpired)))
     {
@@ -1216,7 +1879,7 @@ VmSockPosixCloseSocket(
             if (ret < 0)
             {
                 errorCode = SSL_get_error(pSocket->ssl, ret);
-                VMREST_LOG_ERROR(pRESTHandle,"Error on SSL_shutdown on socket %d, return value %d, errorCode %u, errno %d", pSocket->fd, ret, errorCode, errno);
+                VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"Error on SSL_shutdown on socket %d, return value %d, errorCode %u, errno %d", pSocket->fd, ret, errorCode, errno);
             }
         }
         SSL_free(pSocket->ssl);
@@ -1233,6 +1896,22 @@ cleanup:
         pSocket->fd = -1;
     }
 
+    /**** Unix domain listener bound by us leaves its socket file behind ****/
+    if (pSocket && pSocket->bUnlinkPath && pRESTHandle && pRESTHandle->pRESTConfig)
+    {
+        unlink(pSocket->bShmListener ?
+                   pRESTHandle->pRESTConfig->pszShmSocketPath :
+                   pRESTHandle->pRESTConfig->pszUnixSocketPath);
+        pSocket->bUnlinkPath = FALSE;
+    }
+
+    /**** Client sees close once it drained response ring ****/
+    if (pSocket && pSocket->pShm)
+    {
+        VmSockPosixFreeShmChannel(pSocket->pShm);
+        pSocket->pShm = NULL;
+    }
+
     if (bLockedIO)
     {
         VmRESTUnlockMutex(pSocket->pMutex);
@@ -1244,12 +1923,6 @@ cleanup:
 error:
     VMREST_LOG_ERROR(pRESTHandle,"Error while closing socket..dwError = %u", dwError);
 
-    if (bLockedTimer)
-    {
-        VmRESTUnlockMutex(pTimerSocket->pMutex);
-        bLockedTimer = FALSE;
-    }
-
     goto cleanup;
 }
 
@@ -1285,13 +1958,14 @@ VmSockPosixCreateSignalSockets(
 
         dwError = VmRESTAllocateMemory(
                       sizeof(VM_SOCKET),
-                      (PVOID*)sockets[iSock]
+                      (PVOID*)sockets[iSock],
+                      REST_MEM_SOCKET
                       );
         BAIL_ON_VMREST_ERROR(dwError);
 
         pSocket = *sockets[iSock];
 
-        dwError = VmRESTAllocateMutex(&pSocket->pMutex);
+        dwError = VmRESTAllocateNamedMutex(&pSocket->pMutex, "socket");
         BAIL_ON_VMREST_ERROR(dwError);
 
         pSocket->type = VM_SOCK_TYPE_SIGNAL;
@@ -1383,14 +2057,16 @@ VmSockPosixAcceptConnection(
     DWORD                            dwError = REST_ENGINE_SUCCESS;
     PVM_SOCKET                       pSocket = NULL;
     int                              fd = 0;
+    int                              one = 1;
 
     dwError = VmRESTAllocateMemory(
                   sizeof(*pSocket),
-                  (PVOID*)&pSocket
+                  (PVOID*)&pSocket,
+                  REST_MEM_SOCKET
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
-    dwError = VmRESTAllocateMutex(&pSocket->pMutex);
+    dwError = VmRESTAllocateNamedMutex(&pSocket->pMutex, "socket");
     BAIL_ON_VMREST_ERROR(dwError);
 
     pSocket->type = VM_SOCK_TYPE_SERVER;
@@ -1402,6 +2078,12 @@ VmSockPosixAcceptConnection(
         BAIL_ON_VMREST_ERROR(dwError);
     }
 
+    /**** Response header and body, and TLS 1.3 session tickets before the
+          first response, go out in separate writes. With Nagle the later one
+          waits for the delayed ACK of the peer. Not supported on Unix domain
+          sockets, error is ignored ****/
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
     pSocket->fd = fd;
     pSocket->ssl = NULL;
     pSocket->pRequest = NULL;
@@ -1410,6 +2092,7 @@ VmSockPosixAcceptConnection(
     pSocket->pIoSocket = NULL;
     pSocket->bSSLHandShakeCompleted = FALSE;
     pSocket->bTimerExpired = FALSE;
+    pSocket->pRESTHandle = pListener->pRESTHandle;
 
     *ppSocket = pSocket;
 
@@ -1491,7 +2174,13 @@ VmSockPosixFreeEventQueue(
     {
         return;
     }
-    
+
+    if (pQueue->pConnTable)
+    {
+        VmSockPosixFreeConnTable(pQueue->pConnTable);
+        pQueue->pConnTable = NULL;
+    }
+
     if (pQueue->pSignalReader)
     {   
         VmSockPosixFreeSocket(pQueue->pSignalReader);
@@ -1514,12 +2203,12 @@ VmSockPosixFreeEventQueue(
     }
     if (pQueue->pEventArray)
     {
-        VmRESTFreeMemory(pQueue->pEventArray);
+        VmRESTFreeMemory(pQueue->pEventArray, REST_MEM_SOCKET);
         pQueue->pEventArray = NULL;
     }
     if(pQueue)
     {
-        VmRESTFreeMemory(pQueue);
+        VmRESTFreeMemory(pQueue, REST_MEM_SOCKET);
         pQueue = NULL;
     }
 }
@@ -1537,11 +2226,17 @@ VmSockPosixFreeSocket(
 
     if (pSocket->pszBuffer)
     {
-        VmRESTFreeMemory(pSocket->pszBuffer);
+        VmRESTFreeMemory(pSocket->pszBuffer, REST_MEM_SOCKET);
         pSocket->pszBuffer = NULL;
     }
 
-    VmRESTFreeMemory(pSocket);
+    if (pSocket->pShm)
+    {
+        VmSockPosixFreeShmChannel(pSocket->pShm);
+        pSocket->pShm = NULL;
+    }
+
+    VmRESTFreeMemory(pSocket, REST_MEM_SOCKET);
 }
 
 DWORD
@@ -1591,6 +2286,34 @@ error:
 
 }
 
+DWORD
+VmSockPosixGetSocketHandle(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    PVMREST_HANDLE*                  ppSockHandle
+    )
+{
+    uint32_t                         dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRESTHandle || !pSocket || !ppSockHandle)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid Params..");
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Set when socket is created and never changed, no lock needed ****/
+    *ppSockHandle = pSocket->pRESTHandle ? pSocket->pRESTHandle : pRESTHandle;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
 DWORD
 VmSockPosixSetRequestHandle(
     PVMREST_HANDLE                   pRESTHandle,
@@ -1603,6 +2326,7 @@ VmSockPosixSetRequestHandle(
     uint32_t                         dwError = REST_ENGINE_SUCCESS;
     BOOLEAN                          bLocked = FALSE;
     BOOLEAN                          bCompleted = FALSE;
+    int                              timeoutMs = 0;
     struct                           epoll_event event = {0};
 
     if (!pSocket || !pRESTHandle || !pRESTHandle->pSockContext || !pRESTHandle->pSockContext->pEventQueue)
@@ -1617,6 +2341,8 @@ VmSockPosixSetRequestHandle(
 
     bLocked = TRUE;
 
+    timeoutMs = (pRESTHandle->pRESTConfig->connTimeoutSec) * 1000;
+
     if (pRequest)
     {
         pSocket->pRequest = pRequest;
@@ -1625,20 +2351,27 @@ VmSockPosixSetRequestHandle(
     else
     {
         pSocket->pRequest = NULL;
+        pSocket->nRequests++;
 
         if (bPersistentConn)
         {
-            /**** reset the socket object for new request *****/
+            /**** Connection goes idle - keep only socket record, read buffer is
+                  allocated again on next EPOLLIN. TLS buffers are released by
+                  OpenSSL itself (SSL_MODE_RELEASE_BUFFERS). *****/
             if (pSocket->pszBuffer)
             {
-                VmRESTFreeMemory(pSocket->pszBuffer);
+                VmRESTFreeMemory(pSocket->pszBuffer, REST_MEM_SOCKET);
                 pSocket->pszBuffer = NULL;
             }
             pSocket->nProcessed = 0;
             pSocket->nBufData = 0;
+
+            VmSockPosixSetConnPhase(pRESTHandle, pSocket, VMREST_CONN_PHASE_IDLE);
+            timeoutMs = VmSockPosixIdleTimeoutMs(pRESTHandle);
         }
         else
         {
+            VmSockPosixSetConnPhase(pRESTHandle, pSocket, VMREST_CONN_PHASE_CLOSING);
             bCompleted = TRUE;
         }
     }
@@ -1649,7 +2382,7 @@ VmSockPosixSetRequestHandle(
         dwError = VmSockPosixReArmTimer(
                       pRESTHandle,
                       pSocket->pTimerSocket,
-                      ((pRESTHandle->pRESTConfig->connTimeoutSec) * 1000)
+                      timeoutMs
                       );
         BAIL_ON_VMREST_ERROR(dwError);
 
@@ -1704,6 +2437,21 @@ VmSockPosixGetPeerInfo(
     }
     BAIL_ON_VMREST_ERROR(dwError);
 
+    /**** Shared memory channel fd is an eventfd, peer came in over rendezvous unix socket ****/
+    if (pSocket->pShm)
+    {
+        *pPortNo = 0;
+        strcpy(pIpAddress, VMREST_UNIX_PEER_ADDRESS);
+        goto cleanup;
+    }
+
+    if (pSocket->type == VM_SOCK_TYPE_LOOPBACK)
+    {
+        *pPortNo = 0;
+        strcpy(pIpAddress, VMREST_LOOPBACK_PEER_ADDRESS);
+        goto cleanup;
+    }
+
     len = sizeof(addr);
 
     ret = getpeername(pSocket->fd, (struct sockaddr*)&addr, &len);
@@ -1721,6 +2469,12 @@ VmSockPosixGetPeerInfo(
         *pPortNo = ntohs(pIpV4->sin_port);
         inet_ntop(AF_INET, &pIpV4->sin_addr, pIpAddress, INET6_ADDRSTRLEN);
     } 
+    else if (addr.ss_family == AF_UNIX)
+    {
+        /**** Clients of unix domain socket are usually unnamed, identify them by credentials ****/
+        *pPortNo = 0;
+        strcpy(pIpAddress, VMREST_UNIX_PEER_ADDRESS);
+    }
     else 
     {
         pIpV6 = (struct sockaddr_in6 *)&addr;
@@ -1747,7 +2501,144 @@ error:
 
 }
 
-static
+DWORD
+VmSockPosixGetPeerCredentials(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    int*                             pPid,
+    uint32_t*                        pUid,
+    uint32_t*                        pGid
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    struct ucred                     peer = {0};
+    socklen_t                        len = 0;
+    int                              domain = AF_UNSPEC;
+
+    if (!pRESTHandle || !pSocket || !pPid || !pUid || !pGid)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    /**** Taken from rendezvous socket when channel was set up ****/
+    if (pSocket->pShm)
+    {
+        *pPid = pSocket->pShm->peerPid;
+        *pUid = pSocket->pShm->peerUid;
+        *pGid = pSocket->pShm->peerGid;
+        goto cleanup;
+    }
+
+    len = sizeof(domain);
+    if ((getsockopt(pSocket->fd, SOL_SOCKET, SO_DOMAIN, &domain, &len) < 0) || (domain != AF_UNIX))
+    {
+        dwError = ERROR_NOT_SUPPORTED;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    len = sizeof(peer);
+    if (getsockopt(pSocket->fd, SOL_SOCKET, SO_PEERCRED, &peer, &len) < 0)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"SO_PEERCRED on fd %d failed with Error code %d", pSocket->fd, errno);
+        dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    *pPid = (int)peer.pid;
+    *pUid = (uint32_t)peer.uid;
+    *pGid = (uint32_t)peer.gid;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+DWORD
+VmSockPosixGetConnectionState(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    uint64_t*                        pAcceptNs,
+    uint64_t*                        pTlsDoneNs,
+    uint32_t*                        pnRequests
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+
+    if (!pRESTHandle || !pSocket || !pAcceptNs || !pTlsDoneNs || !pnRequests)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    *pAcceptNs = pSocket->acceptNs;
+    *pTlsDoneNs = pSocket->tlsDoneNs;
+    *pnRequests = pSocket->nRequests;
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+}
+
+DWORD
+VmSockPosixReloadSSLContext(
+    PVMREST_HANDLE                   pRESTHandle,
+    const char*                      pszCertBuf,
+    uint32_t                         nCertBufLen,
+    const char*                      pszKeyBuf,
+    uint32_t                         nKeyBufLen
+    )
+{
+    DWORD                            dwError = REST_ENGINE_SUCCESS;
+    PVM_SOCK_SSL_INFO                pSSLInfo = NULL;
+
+    if (!pRESTHandle || !pRESTHandle->pSSLInfo)
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","Invalid params");
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    pSSLInfo = pRESTHandle->pSSLInfo;
+
+    /**** Buffer given at start is not kept, no file to reload from ****/
+    if ((!pszCertBuf && (pSSLInfo->isCertSet == SSL_INFO_FROM_BUFFER_API)) ||
+        (!pszKeyBuf && (pSSLInfo->isKeySet == SSL_INFO_FROM_BUFFER_API)))
+    {
+        VMREST_LOG_ERROR(pRESTHandle,"%s","SSL data was set from buffer, new buffer required for reload");
+        dwError = ERROR_INVALID_PARAMETER;
+    }
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    dwError = VmRESTSecureSocketReload(
+                  pRESTHandle,
+                  pszCertBuf,
+                  nCertBufLen,
+                  pszKeyBuf,
+                  nKeyBufLen
+                  );
+    BAIL_ON_VMREST_ERROR(dwError);
+
+cleanup:
+
+    return dwError;
+
+error:
+
+    goto cleanup;
+
+}
+
 uint32_t
 VmSockPosixReArmTimer(
     PVMREST_HANDLE                   pRESTHandle,
@@ -1757,7 +2648,7 @@ VmSockPosixReArmTimer(
 {
     uint32_t                         dwError = REST_ENGINE_SUCCESS;
     struct                           itimerspec ts = {0};
-    int                              timerFd = -1;
+    BOOLEAN                          bLocked = FALSE;
     int                              nSec = 0;
     int                              nNanoSec = 0;
 
@@ -1774,23 +2665,31 @@ VmSockPosixReArmTimer(
         nNanoSec = (milliSec % 1000) * 1000000;
     }
 
-    timerFd =pTimerSocket->fd;
-
     ts.it_interval.tv_sec = 0;
     ts.it_interval.tv_nsec = 0;
     ts.it_value.tv_sec = nSec;
     ts.it_value.tv_nsec = nNanoSec;
-    
-    if (timerfd_settime(timerFd, 0, &ts, NULL) < 0)
+
+    dwError = VmRESTLockMutex(pTimerSocket->pMutex);
+    BAIL_ON_VMREST_ERROR(dwError);
+
+    bLocked = TRUE;
+
+    /**** Timer fd is closed only by VmSockPosixCloseSocket, under this lock ****/
+    if ((pTimerSocket->fd < 0) || (timerfd_settime(pTimerSocket->fd, 0, &ts, NULL) < 0))
     {
-        VMREST_LOG_ERROR(pRESTHandle,"%s","Set time failed");
-        close(timerFd);
+        VMREST_LOG_ERROR(pRESTHandle,"Set time failed on timer fd %d, errno %d", pTimerSocket->fd, errno);
         dwError = VM_SOCK_POSIX_ERROR_SYS_CALL_FAILED;
     }
     BAIL_ON_VMREST_ERROR(dwError);
 
 cleanup:
 
+    if (bLocked)
+    {
+        VmRESTUnlockMutex(pTimerSocket->pMutex);
+    }
+
     return dwError;
 
 error:
@@ -1827,11 +2726,15 @@ VmSockPosixCreateTimer(
 
     dwError = VmRESTAllocateMemory(
                   sizeof(*pTimerSocket),
-                  (PVOID*)&pTimerSocket
+                  (PVOID*)&pTimerSocket,
+                  REST_MEM_SOCKET
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
-    dwError = VmRESTAllocateMutex(&pTimerSocket->pMutex);
+    /**** Re-armed by reactor, by request and handshake paths holding IO socket
+          lock and by drain under connection table mutex, so timer fd has its
+          own lock against close ****/
+    dwError = VmRESTAllocateNamedMutex(&pTimerSocket->pMutex, "timer");
     BAIL_ON_VMREST_ERROR(dwError);
 
     pTimerSocket->type = VM_SOCK_TYPE_TIMER;
@@ -1843,6 +2746,7 @@ VmSockPosixCreateTimer(
     pTimerSocket->nProcessed = 0;
     pTimerSocket->pTimerSocket = NULL;
     pTimerSocket->bTimerExpired = FALSE;
+    pTimerSocket->pRESTHandle = pSocket->pRESTHandle;
 
     pSocket->pTimerSocket = pTimerSocket;
 
@@ -1887,12 +2791,12 @@ error:
     
 }
 
-static
 uint32_t
 VmRESTAcceptSSLContext(
     PVMREST_HANDLE                   pRESTHandle,
     PVM_SOCKET                       pSocket,
-    BOOLEAN                          bWatched
+    BOOLEAN                          bWatched,
+    BOOLEAN*                         pbCompleted
     )
 {
     uint32_t                         dwError = REST_ENGINE_SUCCESS;
@@ -1915,6 +2819,19 @@ VmRESTAcceptSSLContext(
     {
         VMREST_LOG_DEBUG(pRESTHandle,"SSL accept successful on socket %d, ret %d, errorCode %u", pSocket->fd, ret, errorCode);
         pSocket->bSSLHandShakeCompleted = TRUE;
+        VmSockPosixSetConnPhase(pRESTHandle, pSocket, VMREST_CONN_PHASE_NEW);
+        VmRESTMetricsAdd(pSocket->pRESTHandle->pMetrics, VMREST_METRIC_HANDSHAKES, 1);
+        pSocket->tlsDoneNs = VmRESTMetricsNowNs();
+        VmRESTMetricsRecordPhase(
+            pSocket->pRESTHandle->pMetrics,
+            REST_PHASE_TLS_DONE,
+            pSocket->tlsDoneNs - pSocket->acceptNs
+            );
+        pSocket->bKTLSSend = VmRESTSecureSocketIsKTLSSend(pSocket->ssl);
+        if (pSocket->bKTLSSend)
+        {
+            VMREST_LOG_DEBUG(pRESTHandle,"Kernel TLS send offload active on socket %d", pSocket->fd);
+        }
         bReArm = TRUE;
     }
     else if ((ret == -1) && ((errorCode == SSL_ERROR_WANT_READ) || (errorCode == SSL_ERROR_WANT_WRITE)))
@@ -1925,11 +2842,18 @@ VmRESTAcceptSSLContext(
     }
     else
     {
-         VMREST_LOG_ERROR(pRESTHandle,"SSL handshake failed on socket fd %d, ret %d, errorCode %u, errno %d", pSocket->fd, ret, errorCode, errno);
+         VMREST_LOG_ERROR_RATELIMITED(pRESTHandle,"SSL handshake failed on socket fd %d, ret %d, errorCode %u, errno %d", pSocket->fd, ret, errorCode, errno);
+         VmRESTMetricsAdd(pSocket->pRESTHandle->pMetrics, VMREST_METRIC_HANDSHAKE_FAILURES, 1);
          dwError = VMREST_TRANSPORT_SSL_ACCEPT_FAILED;
          BAIL_ON_VMREST_ERROR(dwError);
     }
 
+    /**** Socket may be picked up by another thread once re-armed, report state before that ****/
+    if (pbCompleted)
+    {
+        *pbCompleted = pSocket->bSSLHandShakeCompleted;
+    }
+
     if (bReArm && bWatched)
     {
         /**** Rearm and add the socket ****/
@@ -1979,7 +2903,7 @@ VmRESTCreateSSLObject(
     }
     BAIL_ON_VMREST_ERROR(dwError);
 
-    pSSL = SSL_new(pRESTHandle->pSSLInfo->sslContext);
+    pSSL = VmRESTSecureSocketNewSSL(pRESTHandle);
     if (!pSSL)
     {
         VMREST_LOG_ERROR(pRESTHandle, "SSL Context creation failed for socket fd %d", pSocket->fd);
@@ -1994,8 +2918,14 @@ VmRESTCreateSSLObject(
     }
     BAIL_ON_VMREST_ERROR(dwError);
 
+    /**** Read/write buffers (~34KB) are freed by OpenSSL whenever they are empty ****/
+    SSL_set_mode(pSSL, SSL_MODE_RELEASE_BUFFERS);
+
     pSocket->ssl = pSSL;
     pSocket->bSSLHandShakeCompleted = FALSE;
+    pSocket->bKTLSSend = FALSE;
+    pSocket->nTLSBytesSent = 0;
+    pSocket->lastTLSWriteMs = VmSockPosixGetMonotonicMs();
 
 cleanup:
 
@@ -2084,3 +3014,68 @@ VmSockPosixPreProcessTimeouts(
     return;
 }
 
+static
+uint32_t
+VmSockPosixTLSRecordSize(
+    PVMREST_HANDLE                   pRESTHandle,
+    PVM_SOCKET                       pSocket,
+    uint32_t                         nRemaining
+    )
+{
+    uint32_t                         nRecord = nRemaining;
+
+    /**** Cold connection - one record per packet so client can decrypt first bytes at once.
+          After ramp up bytes hand whole buffer to SSL_write, it cuts full size records. ****/
+    if ((pSocket->nTLSBytesSent < pRESTHandle->pRESTConfig->nTLSRecordRampBytes) &&
+        (nRecord > VM_SOCK_POSIX_TLS_SMALL_RECORD_SIZE))
+    {
+        nRecord = VM_SOCK_POSIX_TLS_SMALL_RECORD_SIZE;
+    }
+
+    return nRecord;
+}
+
+uint64_t
+VmSockPosixGetMonotonicMs(
+    void
+    )
+{
+    struct timespec                  ts = {0};
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+
+    return ((uint64_t)ts.tv_sec * 1000) + (ts.tv_nsec / 1000000);
+}
+
+static
+int
+VmSockPosixIdleTimeoutMs(
+    PVMREST_HANDLE                   pRESTHandle
+    )
+{
+    int                              timeoutMs = (pRESTHandle->pRESTConfig->connTimeoutSec) * 1000;
+    uint32_t                         nConn = VmSockPosixGetConnectionCount(pRESTHandle);
+    uint32_t                         nMax = pRESTHandle->pRESTConfig->nClientCnt;
+    uint32_t                         nHalf = nMax / 2;
+
+    if (VmSockPosixIsDraining(pRESTHandle))
+    {
+        return VM_SOCK_POSIX_DRAIN_IDLE_TIMEOUT_MS;
+    }
+
+    /**** Full timeout up to half of nClientCnt, then shrink linearly down to
+          minimum so idle keep-alive connections make room for new clients ****/
+    if ((timeoutMs > VM_SOCK_POSIX_MIN_IDLE_TIMEOUT_MS) && (nConn > nHalf))
+    {
+        if (nConn >= nMax)
+        {
+            timeoutMs = VM_SOCK_POSIX_MIN_IDLE_TIMEOUT_MS;
+        }
+        else
+        {
+            timeoutMs -= (int)(((uint64_t)(timeoutMs - VM_SOCK_POSIX_MIN_IDLE_TIMEOUT_MS) * (nConn - nHalf)) / (nMax - nHalf));
+        }
+    }
+
+    return timeoutMs;
+}
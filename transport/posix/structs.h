@@ -11,6 +11,18 @@
 *
 */
 
+/**** Server end of a shared memory channel. Socket fd is the eventfd client uses to wake us. ****/
+typedef struct _VM_SOCK_SHM_CHANNEL
+{
+    PVMREST_SHM_HEADER               pHeader;
+    size_t                           nMapBytes;
+    int                              wakeClientFd;
+    BOOLEAN                          bShutdown;
+    int                              peerPid;
+    uint32_t                         peerUid;
+    uint32_t                         peerGid;
+} VM_SOCK_SHM_CHANNEL, *PVM_SOCK_SHM_CHANNEL;
+
 typedef struct _VM_SOCKET
 {
     VM_SOCK_TYPE                     type;
@@ -20,19 +32,95 @@ typedef struct _VM_SOCKET
     int                              fd;
     SSL*                             ssl;
     BOOLEAN                          bSSLHandShakeCompleted;
+    BOOLEAN                          bKTLSSend;
+    uint64_t                         nTLSBytesSent;
+    uint64_t                         lastTLSWriteMs;
+    uint64_t                         acceptNs;
+    uint64_t                         tlsDoneNs;
+    uint32_t                         nRequests;
     BOOLEAN                          bTimerExpired;
+    BOOLEAN                          bUnlinkPath;
+    BOOLEAN                          bShmListener;
+    PVM_SOCK_SHM_CHANNEL             pShm;
+    PREST_RESPONSE_SINK              pSink;
     char*                            pszBuffer;
     uint32_t                         nBufData;
     uint32_t                         nProcessed;
     PREST_REQUEST                    pRequest;
     struct _VM_SOCKET*               pIoSocket;
     struct _VM_SOCKET*               pTimerSocket;
+    PVMREST_HANDLE                   pRESTHandle;
 } VM_SOCKET;
 
+typedef struct _VM_SOCK_HANDSHAKE_POOL
+{
+    PVMREST_HANDLE                   pRESTHandle;
+    PVMREST_MUTEX                    pMutex;
+    PVMREST_COND                     pCond;
+    BOOLEAN                          bShutdown;
+    PVMREST_THREAD                   pThreads;
+    uint32_t                         nThreads;
+    PVM_SOCKET*                      ppSockets;
+    uint32_t                         nCapacity;
+    uint32_t                         nHead;
+    uint32_t                         nCount;
+    REST_HANDSHAKE_STATS             stats;
+} VM_SOCK_HANDSHAKE_POOL;
+
+typedef struct _VM_SOCK_SSL_CTX_ENTRY
+{
+    SSL_CTX*                         sslContext;
+    unsigned char                    digest[VM_SOCK_POSIX_SSL_CTX_DIGEST_LEN];
+    uint32_t                         nRef;
+    struct _VM_SOCK_SSL_CTX_ENTRY*   pNext;
+} VM_SOCK_SSL_CTX_ENTRY, *PVM_SOCK_SSL_CTX_ENTRY;
+
+/**** Backoff of a socket write which could not make progress ****/
+typedef struct _VM_SOCK_WRITE_RETRY
+{
+    uint32_t                         cntRty;
+    int                              maxTry;
+    uint32_t                         timerMs;
+    int                              timeOutSec;
+} VM_SOCK_WRITE_RETRY, *PVM_SOCK_WRITE_RETRY;
+
+/**** Data part of listener handoff message, fds travel as SCM_RIGHTS ****/
+typedef struct _VM_SOCK_LISTENER_HANDOFF
+{
+    uint32_t                         magic;
+    uint32_t                         nFds;
+} VM_SOCK_LISTENER_HANDOFF;
+
+/**** One per live client connection, slot index is the fd ****/
+typedef struct _VM_SOCK_CONN_ENTRY
+{
+    PVM_SOCKET                       pSocket;
+    PVMREST_HANDLE                   pRESTHandle;
+    uint64_t                         nBytesIn;
+    uint64_t                         nBytesOut;
+    uint64_t                         nAllocBytes;
+    uint64_t                         lastActivityMs;
+    uint32_t                         nRequests;
+    uint8_t                          phase;
+} VM_SOCK_CONN_ENTRY, *PVM_SOCK_CONN_ENTRY;
+
+typedef struct _VM_SOCK_CONN_TABLE
+{
+    PVMREST_MUTEX                    pMutex;
+    PVM_SOCK_CONN_ENTRY*             ppChunks;
+    uint32_t                         nChunks;
+    uint32_t                         maxFd;
+    uint32_t                         nConnections;
+} VM_SOCK_CONN_TABLE, *PVM_SOCK_CONN_TABLE;
+
 typedef struct _VM_SOCK_EVENT_QUEUE
 {
+    PVMREST_HANDLE                   pRESTHandle;
     PVMREST_MUTEX                    pMutex;
     uint32_t                         bShutdown;
+    BOOLEAN                          bDraining;
+    uint32_t                         nDrainSignals;
+    uint32_t                         nDrainsHandled;
     PVM_SOCKET                       pSignalReader;
     PVM_SOCKET                       pSignalWriter;
     VM_SOCK_POSIX_EVENT_STATE        state;
@@ -42,4 +130,5 @@ typedef struct _VM_SOCK_EVENT_QUEUE
     int                              nReady;
     int                              iReady;
     uint32_t                         thrCnt;
+    PVM_SOCK_CONN_TABLE              pConnTable;
 } VM_SOCK_EVENT_QUEUE;
@@ -264,7 +264,7 @@ VmSockWinOpenServer(
         }
     }
 
-    dwError = VmRESTAllocateMemory(sizeof(*pSocket), (PVOID*)&pSocket);
+    dwError = VmRESTAllocateMemory(sizeof(*pSocket), (PVOID*)&pSocket, REST_MEM_SOCKET);
     BAIL_ON_VMREST_ERROR(dwError);
 
     pSocket->pStreamBuffer = NULL;
@@ -355,10 +355,10 @@ VmSockWinCreateEventQueue(
         iEventQueueSize = VM_SOCK_WINDOWS_DEFAULT_QUEUE_SIZE;
     }
 
-    dwError = VmRESTAllocateMemory(sizeof(*pQueue), (PVOID*)&pQueue);
+    dwError = VmRESTAllocateMemory(sizeof(*pQueue), (PVOID*)&pQueue, REST_MEM_SOCKET);
     BAIL_ON_VMREST_ERROR(dwError);
 
-    dwError = VmRESTAllocateMutex(&pQueue->pMutex);
+    dwError = VmRESTAllocateNamedMutex(&pQueue->pMutex, "event_queue");
     BAIL_ON_VMREST_ERROR(dwError);
 
     pQueue->hIOCP = CreateIoCompletionPort(
@@ -396,11 +396,11 @@ error:
     VmSockWinCloseEventQueue(pRESTHandle, pQueue);
 	if (pQueue && pQueue->pMutex)
 	{
-        VmRESTFreeMemory(pQueue->pMutex);
+        VmRESTFreeMemory(pQueue->pMutex, REST_MEM_OTHER);
 	}
 	if (pQueue)
 	{
-        VmRESTFreeMemory(pQueue);
+        VmRESTFreeMemory(pQueue, REST_MEM_SOCKET);
 	}
 
     goto cleanup;
@@ -607,11 +607,11 @@ cleanup:
 		}
         if (pQueue && pQueue->pMutex)
 	    {
-            VmRESTFreeMemory(pQueue->pMutex);
+            VmRESTFreeMemory(pQueue->pMutex, REST_MEM_OTHER);
 	    }
 	    if (pQueue)
 	    {
-            VmRESTFreeMemory(pQueue);
+            VmRESTFreeMemory(pQueue, REST_MEM_SOCKET);
 	    }
        pRESTHandle->pSSLInfo->isQueueInUse = 0;
     }
@@ -927,11 +927,11 @@ VmSockWinFreeSocket(
     }
     if (pSocket->pStreamBuffer)
     {
-        VmRESTFreeMemory(pSocket->pStreamBuffer);
+        VmRESTFreeMemory(pSocket->pStreamBuffer, REST_MEM_SOCKET);
     }
     if(pSocket != NULL)
 	{
-        VmRESTFreeMemory(pSocket);
+        VmRESTFreeMemory(pSocket, REST_MEM_SOCKET);
 	}
 	
 }
@@ -984,12 +984,13 @@ VmSockWinAcceptConnection(
 
 	dwError = VmRESTAllocateMemory(
                     sizeof(VM_SOCKET),
-                    (void **)&pClientSocket);
+                    (void **)&pClientSocket, REST_MEM_SOCKET);
     BAIL_ON_VMREST_ERROR(dwError);
 
     dwError = VmRESTAllocateMemory(
                   sizeof(VM_STREAM_BUFFER),
-                  (void**)&pStrmBuf
+                  (void**)&pStrmBuf,
+                  REST_MEM_SOCKET
                   );
     BAIL_ON_VMREST_ERROR(dwError);
 
@@ -1087,7 +1088,7 @@ VmSockWinAllocateIoBuffer(
         BAIL_ON_VMREST_ERROR(dwError);
     }
 
-    dwError = VmRESTAllocateMemory(sizeof(VM_SOCK_IO_CONTEXT) + dwSize, (PVOID*)&pIoContext);
+    dwError = VmRESTAllocateMemory(sizeof(VM_SOCK_IO_CONTEXT) + dwSize, (PVOID*)&pIoContext, REST_MEM_SOCKET);
     BAIL_ON_VMREST_ERROR(dwError);
 
     pIoContext->eventType = eventType;
@@ -1123,7 +1124,7 @@ VmSockWinFreeIoBuffer(
     PVM_SOCK_IO_CONTEXT pIoContext = CONTAINING_RECORD(pIoBuffer, VM_SOCK_IO_CONTEXT, IoBuffer);
 	if (pIoContext)
 	{
-	    VmRESTFreeMemory(pIoContext);
+	    VmRESTFreeMemory(pIoContext, REST_MEM_SOCKET);
 	}
 }
 